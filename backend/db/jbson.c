@@ -838,3 +838,193 @@ j_bson_append_document_end(bson_t* bson, bson_t* bson_child, GError** error)
 _error:
 	return FALSE;
 }
+
+/**
+ * Determines the type of an aggregate's result.
+ * This is shared by the client and the backends so that both agree on how aggregates are encoded.
+ **/
+G_GNUC_UNUSED
+static gboolean
+j_bson_aggregate_type(JDBAggregate aggregate, JDBType field_type, JDBType* type, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean numeric;
+
+	numeric = (field_type == J_DB_TYPE_SINT32 || field_type == J_DB_TYPE_UINT32 || field_type == J_DB_TYPE_FLOAT32 || field_type == J_DB_TYPE_SINT64 || field_type == J_DB_TYPE_UINT64 || field_type == J_DB_TYPE_FLOAT64);
+
+	switch (aggregate)
+	{
+		case J_DB_AGGREGATE_COUNT:
+			*type = J_DB_TYPE_UINT64;
+			break;
+		case J_DB_AGGREGATE_MIN:
+		case J_DB_AGGREGATE_MAX:
+			*type = field_type;
+			break;
+		case J_DB_AGGREGATE_SUM:
+			if (field_type == J_DB_TYPE_SINT32 || field_type == J_DB_TYPE_SINT64)
+			{
+				*type = J_DB_TYPE_SINT64;
+			}
+			else if (field_type == J_DB_TYPE_UINT32 || field_type == J_DB_TYPE_UINT64)
+			{
+				*type = J_DB_TYPE_UINT64;
+			}
+			else
+			{
+				*type = J_DB_TYPE_FLOAT64;
+			}
+			break;
+		case J_DB_AGGREGATE_AVG:
+			*type = J_DB_TYPE_FLOAT64;
+			break;
+		default:
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_OPERATOR_INVALID, "aggregate invalid");
+			goto _error;
+	}
+
+	if (G_UNLIKELY(field_type == J_DB_TYPE_ID || ((aggregate == J_DB_AGGREGATE_SUM || aggregate == J_DB_AGGREGATE_AVG) && !numeric)))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_DB_TYPE_INVALID, "aggregate not applicable to type");
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Sets a column of the binary row format, see JBackendDBRow.
+ * Values are encoded like j_bson_append_value encodes them, NULL strings and blobs are not set.
+ **/
+G_GNUC_UNUSED
+static void
+j_row_set_value(JBackendDBRow* row, guint index, JDBType type, JDBTypeValue const* value)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+			j_backend_db_row_set_int32(row, index, value->val_sint32);
+			break;
+		case J_DB_TYPE_ID:
+		case J_DB_TYPE_UINT32:
+			j_backend_db_row_set_int32(row, index, (gint32)value->val_uint32);
+			break;
+		case J_DB_TYPE_SINT64:
+			j_backend_db_row_set_int64(row, index, value->val_sint64);
+			break;
+		case J_DB_TYPE_UINT64:
+			j_backend_db_row_set_int64(row, index, (gint64)value->val_uint64);
+			break;
+		case J_DB_TYPE_FLOAT32:
+			j_backend_db_row_set_double(row, index, (gdouble)value->val_float32);
+			break;
+		case J_DB_TYPE_FLOAT64:
+			j_backend_db_row_set_double(row, index, value->val_float64);
+			break;
+		case J_DB_TYPE_STRING:
+			if (value->val_string != NULL)
+			{
+				j_backend_db_row_set_data(row, index, value->val_string, strlen(value->val_string) + 1);
+			}
+			break;
+		case J_DB_TYPE_BLOB:
+			if (value->val_blob != NULL)
+			{
+				j_backend_db_row_set_data(row, index, value->val_blob, value->val_blob_length);
+			}
+			break;
+		default:
+			g_assert_not_reached();
+	}
+}
+
+/**
+ * Reads a value from a serialized row.
+ * Strings and blobs point into the row, unset values are zeroed.
+ *
+ * \return TRUE on success, FALSE if a string or blob does not fit into the row.
+ **/
+G_GNUC_UNUSED
+static gboolean
+j_row_get_value(gconstpointer data, guint column_count, guint index, JDBType type, JDBTypeValue* value, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gconstpointer slot;
+	gint32 val_int32;
+	gint64 val_int64;
+	gdouble val_double;
+
+	memset(value, 0, sizeof(*value));
+
+	if ((slot = j_backend_db_row_get(data, column_count, index)) == NULL)
+	{
+		return TRUE;
+	}
+
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+			memcpy(&val_int32, slot, sizeof(val_int32));
+			value->val_sint32 = val_int32;
+			break;
+		case J_DB_TYPE_ID:
+		case J_DB_TYPE_UINT32:
+			memcpy(&val_int32, slot, sizeof(val_int32));
+			value->val_uint32 = (guint32)val_int32;
+			break;
+		case J_DB_TYPE_SINT64:
+			memcpy(&val_int64, slot, sizeof(val_int64));
+			value->val_sint64 = val_int64;
+			break;
+		case J_DB_TYPE_UINT64:
+			memcpy(&val_int64, slot, sizeof(val_int64));
+			value->val_uint64 = (guint64)val_int64;
+			break;
+		case J_DB_TYPE_FLOAT32:
+			memcpy(&val_double, slot, sizeof(val_double));
+			value->val_float32 = val_double;
+			break;
+		case J_DB_TYPE_FLOAT64:
+			memcpy(&val_double, slot, sizeof(val_double));
+			value->val_float64 = val_double;
+			break;
+		case J_DB_TYPE_STRING:
+		{
+			guint32 length;
+
+			value->val_string = j_backend_db_row_get_data(data, column_count, index, &length);
+
+			// Strings have to be terminated within the row
+			if (G_UNLIKELY(value->val_string == NULL || length == 0 || value->val_string[length - 1] != '\0'))
+			{
+				value->val_string = NULL;
+				goto _error;
+			}
+
+			break;
+		}
+		case J_DB_TYPE_BLOB:
+			if (G_UNLIKELY((value->val_blob = j_backend_db_row_get_data(data, column_count, index, &value->val_blob_length)) == NULL))
+			{
+				goto _error;
+			}
+
+			break;
+		default:
+			g_assert_not_reached();
+	}
+
+	return TRUE;
+
+_error:
+	g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_INVALID, "row invalid");
+
+	return FALSE;
+}
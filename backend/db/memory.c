@@ -22,245 +22,2652 @@
 #include <glib.h>
 #include <gmodule.h>
 
+#include <string.h>
+
 #include <julea.h>
+#include <julea-db.h>
+
+#include "jbson.c"
+
+/*
+ * Every schema is stored as a table of columns, which contain the values of all rows.
+ * Rows are found by their _id using a hash table.
+ * The leading field of each index declared in the schema additionally gets an ordered index, which is used for equality and range conditions.
+ *
+ * Batches are atomic: the first modification acquires the backend's write lock, which is held until the batch is executed.
+ * All modifications are recorded in an undo log, which is replayed in reverse if an operation fails.
+ */
+
+struct JMemoryIndexEntry
+{
+	/**
+	 * The indexed value.
+	 * Strings and blobs are owned by the column.
+	 **/
+	JDBTypeValue value;
+
+	/**
+	 * The row's _id, which makes entries with equal values unique.
+	 **/
+	guint32 id;
+};
+
+typedef struct JMemoryIndexEntry JMemoryIndexEntry;
+
+struct JMemoryIndex
+{
+	/**
+	 * The entries, sorted by value and _id.
+	 * Contains JMemoryIndexEntry.
+	 **/
+	GSequence* entries;
+
+	/**
+	 * The position of each row's entry, NULL if the row's value is not set.
+	 * Contains GSequenceIter*.
+	 **/
+	GArray* positions;
+};
+
+typedef struct JMemoryIndex JMemoryIndex;
+
+struct JMemoryColumn
+{
+	gchar* name;
+	JDBType type;
+
+	/**
+	 * The values of all rows, strings and blobs are owned by the column.
+	 * Contains JDBTypeValue.
+	 **/
+	GArray* values;
+
+	/**
+	 * Whether a row's value is set.
+	 * Contains gboolean.
+	 **/
+	GArray* set;
+
+	/**
+	 * The ordered index, NULL if the column is not indexed.
+	 **/
+	JMemoryIndex* index;
+};
+
+typedef struct JMemoryColumn JMemoryColumn;
+
+struct JMemoryTable
+{
+	/**
+	 * The columns in schema order.
+	 * Contains JMemoryColumn*.
+	 **/
+	GPtrArray* columns;
+	GHashTable* columns_by_name;
+
+	/**
+	 * The _id of each row, 0 for free rows.
+	 * Contains guint32.
+	 **/
+	GArray* ids;
+
+	/**
+	 * Rows that can be reused.
+	 * Contains guint.
+	 **/
+	GArray* free_rows;
+
+	/**
+	 * Maps each _id to its row.
+	 **/
+	GHashTable* rows;
+
+	guint32 next_id;
+};
+
+typedef struct JMemoryTable JMemoryTable;
+
+enum JMemoryUndoType
+{
+	J_MEMORY_UNDO_INSERT,
+	J_MEMORY_UNDO_UPDATE,
+	J_MEMORY_UNDO_DELETE,
+	J_MEMORY_UNDO_SCHEMA_CREATE,
+	J_MEMORY_UNDO_SCHEMA_DELETE
+};
+
+typedef enum JMemoryUndoType JMemoryUndoType;
+
+struct JMemoryUndo
+{
+	JMemoryUndoType type;
+	gchar* key;
+	guint32 id;
+
+	/**
+	 * The previous values of an updated or deleted row.
+	 **/
+	bson_t* row;
+
+	/**
+	 * The deleted table.
+	 **/
+	JMemoryTable* table;
+};
+
+typedef struct JMemoryUndo JMemoryUndo;
+
+struct JMemoryBatch
+{
+	gchar const* namespace;
+
+	/**
+	 * Whether the batch holds the write lock.
+	 **/
+	gboolean write;
+
+	/**
+	 * Contains JMemoryUndo.
+	 **/
+	GArray* undo;
+};
+
+typedef struct JMemoryBatch JMemoryBatch;
+
+struct JMemoryData
+{
+	/**
+	 * Maps namespace_name to JMemoryTable.
+	 **/
+	GHashTable* tables;
+
+	GRWLock lock[1];
+};
+
+typedef struct JMemoryData JMemoryData;
+
+struct JMemoryCondition
+{
+	JDBSelectorMode mode;
+
+	/**
+	 * The subconditions, NULL for comparisons.
+	 * Contains JMemoryCondition*.
+	 **/
+	GPtrArray* children;
+
+	/**
+	 * The compared column, NULL for _id.
+	 **/
+	JMemoryColumn* column;
+	JDBSelectorOperator op;
+
+	/**
+	 * The compared value, which references the selector.
+	 **/
+	JDBTypeValue value;
+};
+
+typedef struct JMemoryCondition JMemoryCondition;
+
+struct JMemorySortKey
+{
+	/**
+	 * The column, NULL for _id.
+	 **/
+	JMemoryColumn* column;
+	JDBSelectorOrder order;
+};
+
+typedef struct JMemorySortKey JMemorySortKey;
+
+struct JMemorySort
+{
+	JMemoryTable* table;
+
+	/**
+	 * Contains JMemorySortKey.
+	 **/
+	GArray* keys;
+};
+
+typedef struct JMemorySort JMemorySort;
+
+struct JMemoryAggregate
+{
+	JDBAggregate aggregate;
+
+	/**
+	 * The aggregated column, NULL for _id and counting all rows.
+	 **/
+	JMemoryColumn* column;
+	JDBType type;
+};
+
+typedef struct JMemoryAggregate JMemoryAggregate;
+
+struct JMemoryGroup
+{
+	/**
+	 * The group's first row, which is used to order groups.
+	 **/
+	guint row;
+	bson_t* result;
+};
+
+typedef struct JMemoryGroup JMemoryGroup;
+
+struct JMemoryIterator
+{
+	gchar* key;
+
+	/**
+	 * The fields requested by the query, NULL if all fields are returned.
+	 **/
+	gchar** fields;
+
+	/**
+	 * The _ids of the remaining rows, NULL for aggregating queries.
+	 * Contains guint32.
+	 **/
+	GArray* ids;
+
+	/**
+	 * The results of aggregating queries, NULL otherwise.
+	 * Contains bson_t*.
+	 **/
+	GPtrArray* results;
+
+	guint position;
+};
+
+typedef struct JMemoryIterator JMemoryIterator;
+
+/**
+ * Set to the backend data while the current thread holds the write lock.
+ * Operations of a batch that holds the write lock must not acquire the read lock.
+ **/
+static GPrivate memory_writer = G_PRIVATE_INIT(NULL);
+
+static void
+memory_read_lock(JMemoryData* bd)
+{
+	if (g_private_get(&memory_writer) != bd)
+	{
+		g_rw_lock_reader_lock(bd->lock);
+	}
+}
+
+static void
+memory_read_unlock(JMemoryData* bd)
+{
+	if (g_private_get(&memory_writer) != bd)
+	{
+		g_rw_lock_reader_unlock(bd->lock);
+	}
+}
+
+static gint
+memory_value_compare(JDBType type, JDBTypeValue const* a, JDBTypeValue const* b)
+{
+	gint ret = 0;
+
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+			ret = (a->val_sint32 > b->val_sint32) - (a->val_sint32 < b->val_sint32);
+			break;
+		case J_DB_TYPE_UINT32:
+			ret = (a->val_uint32 > b->val_uint32) - (a->val_uint32 < b->val_uint32);
+			break;
+		case J_DB_TYPE_FLOAT32:
+			ret = (a->val_float32 > b->val_float32) - (a->val_float32 < b->val_float32);
+			break;
+		case J_DB_TYPE_SINT64:
+			ret = (a->val_sint64 > b->val_sint64) - (a->val_sint64 < b->val_sint64);
+			break;
+		case J_DB_TYPE_UINT64:
+			ret = (a->val_uint64 > b->val_uint64) - (a->val_uint64 < b->val_uint64);
+			break;
+		case J_DB_TYPE_FLOAT64:
+			ret = (a->val_float64 > b->val_float64) - (a->val_float64 < b->val_float64);
+			break;
+		case J_DB_TYPE_STRING:
+			ret = g_strcmp0(a->val_string, b->val_string);
+			break;
+		case J_DB_TYPE_BLOB:
+			if (MIN(a->val_blob_length, b->val_blob_length) > 0)
+			{
+				ret = memcmp(a->val_blob, b->val_blob, MIN(a->val_blob_length, b->val_blob_length));
+			}
+
+			if (ret == 0)
+			{
+				ret = (a->val_blob_length > b->val_blob_length) - (a->val_blob_length < b->val_blob_length);
+			}
+
+			break;
+		case J_DB_TYPE_ID:
+		default:
+			g_assert_not_reached();
+	}
+
+	return ret;
+}
+
+static gdouble
+memory_value_to_double(JDBType type, JDBTypeValue const* value)
+{
+	switch (type)
+	{
+		case J_DB_TYPE_SINT32:
+			return value->val_sint32;
+		case J_DB_TYPE_UINT32:
+			return value->val_uint32;
+		case J_DB_TYPE_FLOAT32:
+			return value->val_float32;
+		case J_DB_TYPE_SINT64:
+			return value->val_sint64;
+		case J_DB_TYPE_UINT64:
+			return value->val_uint64;
+		case J_DB_TYPE_FLOAT64:
+			return value->val_float64;
+		case J_DB_TYPE_STRING:
+		case J_DB_TYPE_BLOB:
+		case J_DB_TYPE_ID:
+		default:
+			g_assert_not_reached();
+	}
+
+	return 0.0;
+}
+
+static void
+memory_value_copy(JDBType type, JDBTypeValue const* value, JDBTypeValue* copy)
+{
+	*copy = *value;
+
+	if (type == J_DB_TYPE_STRING)
+	{
+		copy->val_string = g_strdup(value->val_string);
+	}
+	else if (type == J_DB_TYPE_BLOB && value->val_blob != NULL)
+	{
+		gchar* blob;
+
+		blob = g_malloc(value->val_blob_length);
+		memcpy(blob, value->val_blob, value->val_blob_length);
+		copy->val_blob = blob;
+	}
+}
+
+static void
+memory_value_clear(JDBType type, JDBTypeValue* value)
+{
+	if (type == J_DB_TYPE_STRING)
+	{
+		g_free((gchar*)value->val_string);
+	}
+	else if (type == J_DB_TYPE_BLOB)
+	{
+		g_free((gchar*)value->val_blob);
+	}
+
+	memset(value, 0, sizeof(*value));
+}
+
+static gint
+memory_index_entry_compare(gconstpointer a, gconstpointer b, gpointer data)
+{
+	JMemoryIndexEntry const* entry_a = a;
+	JMemoryIndexEntry const* entry_b = b;
+	JMemoryColumn const* column = data;
+	gint ret;
+
+	ret = memory_value_compare(column->type, &entry_a->value, &entry_b->value);
+
+	if (ret == 0)
+	{
+		ret = (entry_a->id > entry_b->id) - (entry_a->id < entry_b->id);
+	}
+
+	return ret;
+}
+
+static void
+memory_index_entry_free(gpointer data)
+{
+	g_slice_free(JMemoryIndexEntry, data);
+}
+
+static JMemoryColumn*
+memory_column_new(gchar const* name, JDBType type)
+{
+	JMemoryColumn* column;
+
+	column = g_slice_new(JMemoryColumn);
+	column->name = g_strdup(name);
+	// The SQL backends store _id-typed fields as integers
+	column->type = (type == J_DB_TYPE_ID) ? J_DB_TYPE_UINT32 : type;
+	column->values = g_array_new(FALSE, TRUE, sizeof(JDBTypeValue));
+	column->set = g_array_new(FALSE, TRUE, sizeof(gboolean));
+	column->index = NULL;
+
+	return column;
+}
+
+static void
+memory_column_add_index(JMemoryColumn* column)
+{
+	if (column->index != NULL)
+	{
+		return;
+	}
+
+	column->index = g_slice_new(JMemoryIndex);
+	column->index->entries = g_sequence_new(memory_index_entry_free);
+	column->index->positions = g_array_new(FALSE, TRUE, sizeof(GSequenceIter*));
+	g_array_set_size(column->index->positions, column->values->len);
+}
+
+static void
+memory_column_free(gpointer data)
+{
+	JMemoryColumn* column = data;
+
+	for (guint i = 0; i < column->values->len; i++)
+	{
+		if (g_array_index(column->set, gboolean, i))
+		{
+			memory_value_clear(column->type, &g_array_index(column->values, JDBTypeValue, i));
+		}
+	}
+
+	if (column->index != NULL)
+	{
+		g_sequence_free(column->index->entries);
+		g_array_free(column->index->positions, TRUE);
+		g_slice_free(JMemoryIndex, column->index);
+	}
+
+	g_array_free(column->values, TRUE);
+	g_array_free(column->set, TRUE);
+	g_free(column->name);
+
+	g_slice_free(JMemoryColumn, column);
+}
+
+/**
+ * Sets the value of a row, NULL unsets it.
+ * The column's index is updated accordingly.
+ **/
+static void
+memory_column_set(JMemoryColumn* column, guint row, guint32 id, JDBTypeValue const* value)
+{
+	JDBTypeValue* stored;
+	gboolean* set;
+
+	stored = &g_array_index(column->values, JDBTypeValue, row);
+	set = &g_array_index(column->set, gboolean, row);
+
+	if (column->index != NULL)
+	{
+		GSequenceIter** position;
+
+		position = &g_array_index(column->index->positions, GSequenceIter*, row);
+
+		if (*position != NULL)
+		{
+			g_sequence_remove(*position);
+			*position = NULL;
+		}
+	}
+
+	if (*set)
+	{
+		memory_value_clear(column->type, stored);
+		*set = FALSE;
+	}
+
+	// Blobs can be NULL, which is handled like unset values
+	if (value == NULL || (column->type == J_DB_TYPE_BLOB && value->val_blob == NULL))
+	{
+		return;
+	}
+
+	memory_value_copy(column->type, value, stored);
+	*set = TRUE;
+
+	if (column->index != NULL)
+	{
+		JMemoryIndexEntry* entry;
+
+		entry = g_slice_new(JMemoryIndexEntry);
+		entry->value = *stored;
+		entry->id = id;
+
+		g_array_index(column->index->positions, GSequenceIter*, row) = g_sequence_insert_sorted(column->index->entries, entry, memory_index_entry_compare, column);
+	}
+}
+
+static JMemoryTable*
+memory_table_new(void)
+{
+	JMemoryTable* table;
+
+	table = g_slice_new(JMemoryTable);
+	table->columns = g_ptr_array_new_with_free_func(memory_column_free);
+	table->columns_by_name = g_hash_table_new(g_str_hash, g_str_equal);
+	table->ids = g_array_new(FALSE, TRUE, sizeof(guint32));
+	table->free_rows = g_array_new(FALSE, FALSE, sizeof(guint));
+	table->rows = g_hash_table_new(NULL, NULL);
+	table->next_id = 1;
+
+	return table;
+}
+
+static void
+memory_table_free(gpointer data)
+{
+	JMemoryTable* table = data;
+
+	if (table == NULL)
+	{
+		return;
+	}
+
+	g_hash_table_unref(table->rows);
+	g_array_free(table->free_rows, TRUE);
+	g_array_free(table->ids, TRUE);
+	g_hash_table_unref(table->columns_by_name);
+	g_ptr_array_unref(table->columns);
+
+	g_slice_free(JMemoryTable, table);
+}
+
+/**
+ * Looks up a column by name, _id returns NULL.
+ **/
+static gboolean
+memory_table_column(JMemoryTable* table, gchar const* name, JMemoryColumn** column, GError** error)
+{
+	if (g_strcmp0(name, "_id") == 0)
+	{
+		*column = NULL;
+		return TRUE;
+	}
+
+	*column = g_hash_table_lookup(table->columns_by_name, name);
+
+	if (G_UNLIKELY(*column == NULL))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static JDBType
+memory_column_type(JMemoryColumn const* column)
+{
+	return (column != NULL) ? column->type : J_DB_TYPE_UINT32;
+}
+
+static gchar const*
+memory_column_name(JMemoryColumn const* column)
+{
+	return (column != NULL) ? column->name : "_id";
+}
+
+/**
+ * Returns a row's value, unset values are returned as zero.
+ *
+ * \return TRUE if the value is set, FALSE otherwise.
+ **/
+static gboolean
+memory_table_value(JMemoryTable* table, guint row, JMemoryColumn const* column, JDBTypeValue* value)
+{
+	if (column == NULL)
+	{
+		memset(value, 0, sizeof(*value));
+		value->val_uint32 = g_array_index(table->ids, guint32, row);
+		return TRUE;
+	}
+
+	if (!g_array_index(column->set, gboolean, row))
+	{
+		memset(value, 0, sizeof(*value));
+		return FALSE;
+	}
+
+	*value = g_array_index(column->values, JDBTypeValue, row);
+
+	return TRUE;
+}
+
+static gboolean
+memory_table_row(JMemoryTable* table, guint32 id, guint* row)
+{
+	gpointer row_ptr;
+
+	if (!g_hash_table_lookup_extended(table->rows, GUINT_TO_POINTER(id), NULL, &row_ptr))
+	{
+		return FALSE;
+	}
+
+	*row = GPOINTER_TO_UINT(row_ptr);
+
+	return TRUE;
+}
+
+static guint
+memory_table_row_new(JMemoryTable* table, guint32 id)
+{
+	guint row;
+
+	if (table->free_rows->len > 0)
+	{
+		row = g_array_index(table->free_rows, guint, table->free_rows->len - 1);
+		g_array_set_size(table->free_rows, table->free_rows->len - 1);
+	}
+	else
+	{
+		row = table->ids->len;
+		g_array_set_size(table->ids, row + 1);
+
+		for (guint i = 0; i < table->columns->len; i++)
+		{
+			JMemoryColumn* column = g_ptr_array_index(table->columns, i);
+
+			g_array_set_size(column->values, row + 1);
+			g_array_set_size(column->set, row + 1);
+
+			if (column->index != NULL)
+			{
+				g_array_set_size(column->index->positions, row + 1);
+			}
+		}
+	}
+
+	g_array_index(table->ids, guint32, row) = id;
+	g_hash_table_insert(table->rows, GUINT_TO_POINTER(id), GUINT_TO_POINTER(row));
+
+	return row;
+}
+
+static void
+memory_table_row_delete(JMemoryTable* table, guint row)
+{
+	guint32 id;
+
+	id = g_array_index(table->ids, guint32, row);
+
+	for (guint i = 0; i < table->columns->len; i++)
+	{
+		memory_column_set(g_ptr_array_index(table->columns, i), row, id, NULL);
+	}
+
+	g_hash_table_remove(table->rows, GUINT_TO_POINTER(id));
+	g_array_index(table->ids, guint32, row) = 0;
+	g_array_append_val(table->free_rows, row);
+}
+
+/**
+ * Sets the fields contained in metadata.
+ **/
+static gboolean
+memory_table_row_set(JMemoryTable* table, guint row, bson_t const* metadata, GError** error)
+{
+	bson_iter_t iter;
+	gboolean has_next;
+	guint32 id;
+
+	id = g_array_index(table->ids, guint32, row);
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, metadata, error)))
+	{
+		goto _error;
+	}
+
+	while (TRUE)
+	{
+		JMemoryColumn* column;
+		JDBTypeValue value;
+		gchar const* key;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY((key = j_bson_iter_key(&iter, error)) == NULL))
+		{
+			goto _error;
+		}
+
+		// _id can not be modified
+		if (G_UNLIKELY((column = g_hash_table_lookup(table->columns_by_name, key)) == NULL))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, column->type, &value, error)))
+		{
+			goto _error;
+		}
+
+		memory_column_set(column, row, id, &value);
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Returns the set values of a row, which can be restored using memory_table_row_restore().
+ **/
+static bson_t*
+memory_table_row_snapshot(JMemoryTable* table, guint row)
+{
+	bson_t* snapshot;
+
+	snapshot = bson_new();
+
+	for (guint i = 0; i < table->columns->len; i++)
+	{
+		JMemoryColumn* column = g_ptr_array_index(table->columns, i);
+		JDBTypeValue value;
+
+		if (memory_table_value(table, row, column, &value))
+		{
+			j_bson_append_value(snapshot, column->name, column->type, &value, NULL);
+		}
+	}
+
+	return snapshot;
+}
+
+static void
+memory_table_row_restore(JMemoryTable* table, guint row, bson_t const* snapshot)
+{
+	guint32 id;
+
+	id = g_array_index(table->ids, guint32, row);
+
+	for (guint i = 0; i < table->columns->len; i++)
+	{
+		memory_column_set(g_ptr_array_index(table->columns, i), row, id, NULL);
+	}
+
+	memory_table_row_set(table, row, snapshot, NULL);
+}
+
+static void
+memory_undo_clear(gpointer data)
+{
+	JMemoryUndo* undo = data;
+
+	g_free(undo->key);
+
+	if (undo->row != NULL)
+	{
+		bson_destroy(undo->row);
+	}
+
+	memory_table_free(undo->table);
+}
+
+static void
+memory_undo_add(JMemoryBatch* batch, JMemoryUndoType type, gchar const* key, guint32 id, bson_t* row, JMemoryTable* table)
+{
+	JMemoryUndo undo;
+
+	undo.type = type;
+	undo.key = g_strdup(key);
+	undo.id = id;
+	undo.row = row;
+	undo.table = table;
+
+	g_array_append_val(batch->undo, undo);
+}
+
+/**
+ * Acquires the write lock for the rest of the batch.
+ **/
+static void
+memory_batch_write(JMemoryData* bd, JMemoryBatch* batch)
+{
+	if (batch->write)
+	{
+		return;
+	}
+
+	g_rw_lock_writer_lock(bd->lock);
+	g_private_set(&memory_writer, bd);
+	batch->write = TRUE;
+}
+
+static void
+memory_batch_release(JMemoryData* bd, JMemoryBatch* batch)
+{
+	// Committed modifications can not be undone anymore
+	g_array_set_size(batch->undo, 0);
+
+	if (!batch->write)
+	{
+		return;
+	}
+
+	g_private_set(&memory_writer, NULL);
+	g_rw_lock_writer_unlock(bd->lock);
+	batch->write = FALSE;
+}
+
+/**
+ * Undoes all modifications of the batch in reverse order and releases the write lock.
+ **/
+static void
+memory_batch_abort(JMemoryData* bd, JMemoryBatch* batch)
+{
+	for (guint i = batch->undo->len; i > 0; i--)
+	{
+		JMemoryUndo* undo = &g_array_index(batch->undo, JMemoryUndo, i - 1);
+		JMemoryTable* table;
+		guint row;
+
+		table = g_hash_table_lookup(bd->tables, undo->key);
+
+		switch (undo->type)
+		{
+			case J_MEMORY_UNDO_INSERT:
+				if (table != NULL && memory_table_row(table, undo->id, &row))
+				{
+					memory_table_row_delete(table, row);
+				}
+
+				break;
+			case J_MEMORY_UNDO_UPDATE:
+				if (table != NULL && memory_table_row(table, undo->id, &row))
+				{
+					memory_table_row_restore(table, row, undo->row);
+				}
+
+				break;
+			case J_MEMORY_UNDO_DELETE:
+				if (table != NULL)
+				{
+					row = memory_table_row_new(table, undo->id);
+					memory_table_row_restore(table, row, undo->row);
+				}
+
+				break;
+			case J_MEMORY_UNDO_SCHEMA_CREATE:
+				g_hash_table_remove(bd->tables, undo->key);
+				break;
+			case J_MEMORY_UNDO_SCHEMA_DELETE:
+				g_hash_table_insert(bd->tables, g_strdup(undo->key), undo->table);
+				undo->table = NULL;
+				break;
+			default:
+				g_assert_not_reached();
+		}
+	}
+
+	memory_batch_release(bd, batch);
+}
+
+static void
+memory_condition_free(gpointer data)
+{
+	JMemoryCondition* condition = data;
+
+	if (condition->children != NULL)
+	{
+		g_ptr_array_unref(condition->children);
+	}
+
+	g_slice_free(JMemoryCondition, condition);
+}
+
+/**
+ * Translates a selector into a tree of conditions.
+ * iter has to point to the selector's first key.
+ **/
+static JMemoryCondition*
+memory_condition_new(JMemoryTable* table, bson_iter_t* iter, GError** error)
+{
+	JMemoryCondition* condition;
+	bson_iter_t iter_child;
+	JDBTypeValue value;
+	gboolean has_next;
+
+	condition = g_slice_new0(JMemoryCondition);
+	condition->mode = J_DB_SELECTOR_MODE_AND;
+	condition->children = g_ptr_array_new_with_free_func(memory_condition_free);
+
+	while (TRUE)
+	{
+		JMemoryCondition* child;
+		gchar const* key;
+
+		if (G_UNLIKELY(!j_bson_iter_next(iter, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY((key = j_bson_iter_key(iter, error)) == NULL))
+		{
+			goto _error;
+		}
+
+		if (g_strcmp0(key, "_mode") == 0)
+		{
+			if (G_UNLIKELY(!j_bson_iter_value(iter, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+
+			condition->mode = value.val_uint32;
+			continue;
+		}
+
+		// Conditions are numbered, all other keys describe the query, for example, its sort keys
+		if (key[0] == '_')
+		{
+			continue;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		if (j_bson_iter_find(&iter_child, "_mode", NULL))
+		{
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iter_child, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY((child = memory_condition_new(table, &iter_child, error)) == NULL))
+			{
+				goto _error;
+			}
+
+			g_ptr_array_add(condition->children, child);
+			continue;
+		}
+
+		child = g_slice_new0(JMemoryCondition);
+		g_ptr_array_add(condition->children, child);
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter_child, "_name", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_STRING, &value, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!memory_table_column(table, value.val_string, &child->column, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter_child, "_operator", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_UINT32, &value, error)))
+		{
+			goto _error;
+		}
+
+		child->op = value.val_uint32;
+
+		if (G_UNLIKELY(child->op > J_DB_SELECTOR_OPERATOR_NE))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_OPERATOR_INVALID, "operator invalid");
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter_child, "_value", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_child, memory_column_type(child->column), &child->value, error)))
+		{
+			goto _error;
+		}
+	}
+
+	if (G_UNLIKELY(condition->mode != J_DB_SELECTOR_MODE_AND && condition->mode != J_DB_SELECTOR_MODE_OR))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_OPERATOR_INVALID, "operator invalid");
+		goto _error;
+	}
+
+	return condition;
+
+_error:
+	memory_condition_free(condition);
+
+	return NULL;
+}
+
+/**
+ * Checks whether the selector contains any conditions.
+ * Besides the conditions, a selector contains its mode and, for queries, modifiers such as the requested fields.
+ **/
+static gboolean
+memory_selector_has_conditions(bson_t const* selector)
+{
+	bson_iter_t iter;
+	gboolean has_next;
+	gchar const* key;
+
+	if (selector == NULL || !j_bson_iter_init(&iter, selector, NULL))
+	{
+		return FALSE;
+	}
+
+	while (j_bson_iter_next(&iter, &has_next, NULL) && has_next)
+	{
+		if ((key = j_bson_iter_key(&iter, NULL)) != NULL && key[0] != '_')
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * Translates the conditions of a selector, the condition is NULL if the selector does not contain any.
+ **/
+static gboolean
+memory_selector_condition(JMemoryTable* table, bson_t const* selector, JMemoryCondition** condition, GError** error)
+{
+	bson_iter_t iter;
+
+	*condition = NULL;
+
+	if (!memory_selector_has_conditions(selector))
+	{
+		return TRUE;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+	{
+		return FALSE;
+	}
+
+	*condition = memory_condition_new(table, &iter, error);
+
+	return (*condition != NULL);
+}
+
+static gboolean
+memory_condition_match(JMemoryTable* table, JMemoryCondition const* condition, guint row)
+{
+	if (condition->children == NULL)
+	{
+		JDBTypeValue value;
+		gint cmp;
+
+		// Comparisons with unset values are never true, just like with NULL in SQL
+		if (!memory_table_value(table, row, condition->column, &value))
+		{
+			return FALSE;
+		}
+
+		cmp = memory_value_compare(memory_column_type(condition->column), &value, &condition->value);
+
+		switch (condition->op)
+		{
+			case J_DB_SELECTOR_OPERATOR_LT:
+				return (cmp < 0);
+			case J_DB_SELECTOR_OPERATOR_LE:
+				return (cmp <= 0);
+			case J_DB_SELECTOR_OPERATOR_GT:
+				return (cmp > 0);
+			case J_DB_SELECTOR_OPERATOR_GE:
+				return (cmp >= 0);
+			case J_DB_SELECTOR_OPERATOR_EQ:
+				return (cmp == 0);
+			case J_DB_SELECTOR_OPERATOR_NE:
+				return (cmp != 0);
+			default:
+				g_assert_not_reached();
+		}
+	}
+
+	for (guint i = 0; i < condition->children->len; i++)
+	{
+		gboolean match;
+
+		match = memory_condition_match(table, g_ptr_array_index(condition->children, i), row);
+
+		if (condition->mode == J_DB_SELECTOR_MODE_AND && !match)
+		{
+			return FALSE;
+		}
+
+		if (condition->mode == J_DB_SELECTOR_MODE_OR && match)
+		{
+			return TRUE;
+		}
+	}
+
+	return (condition->mode == J_DB_SELECTOR_MODE_AND);
+}
+
+/**
+ * Scans an ordered index between two bounds, NULL bounds are unlimited.
+ **/
+static void
+memory_table_select_index(JMemoryTable* table, JMemoryColumn* column, JDBTypeValue const* lower, gboolean lower_inclusive, JDBTypeValue const* upper, gboolean upper_inclusive, JMemoryCondition const* condition, GArray* rows)
+{
+	GSequenceIter* position;
+
+	if (lower != NULL)
+	{
+		JMemoryIndexEntry probe;
+
+		// _ids start at 1, so the probe is placed before or after all entries with the same value
+		probe.value = *lower;
+		probe.id = (lower_inclusive) ? 0 : G_MAXUINT32;
+
+		position = g_sequence_search(column->index->entries, &probe, memory_index_entry_compare, column);
+	}
+	else
+	{
+		position = g_sequence_get_begin_iter(column->index->entries);
+	}
+
+	for (; !g_sequence_iter_is_end(position); position = g_sequence_iter_next(position))
+	{
+		JMemoryIndexEntry const* entry = g_sequence_get(position);
+		guint row;
+
+		if (upper != NULL)
+		{
+			gint cmp;
+
+			cmp = memory_value_compare(column->type, &entry->value, upper);
+
+			if (cmp > 0 || (cmp == 0 && !upper_inclusive))
+			{
+				break;
+			}
+		}
+
+		if (memory_table_row(table, entry->id, &row) && memory_condition_match(table, condition, row))
+		{
+			g_array_append_val(rows, row);
+		}
+	}
+}
+
+/**
+ * Collects all rows matching the condition.
+ * If the condition is a conjunction, an equality condition on _id uses the hash index and conditions on indexed columns use their ordered index.
+ * All other conditions are checked by scanning the whole table.
+ **/
+static void
+memory_table_select(JMemoryTable* table, JMemoryCondition const* condition, GArray* rows)
+{
+	JMemoryCondition const* best = NULL;
+
+	if (condition != NULL && (condition->mode == J_DB_SELECTOR_MODE_AND || condition->children->len == 1))
+	{
+		for (guint i = 0; i < condition->children->len; i++)
+		{
+			JMemoryCondition const* child = g_ptr_array_index(condition->children, i);
+
+			if (child->children != NULL || child->op == J_DB_SELECTOR_OPERATOR_NE)
+			{
+				continue;
+			}
+
+			if (child->column == NULL && child->op == J_DB_SELECTOR_OPERATOR_EQ)
+			{
+				guint row;
+
+				if (memory_table_row(table, child->value.val_uint32, &row) && memory_condition_match(table, condition, row))
+				{
+					g_array_append_val(rows, row);
+				}
+
+				return;
+			}
+
+			if (child->column == NULL || child->column->index == NULL)
+			{
+				continue;
+			}
+
+			if (best == NULL || (child->op == J_DB_SELECTOR_OPERATOR_EQ && best->op != J_DB_SELECTOR_OPERATOR_EQ))
+			{
+				best = child;
+			}
+		}
+	}
+
+	if (best != NULL)
+	{
+		JDBTypeValue const* lower = NULL;
+		JDBTypeValue const* upper = NULL;
+		gboolean lower_inclusive = TRUE;
+		gboolean upper_inclusive = TRUE;
+
+		if (best->op == J_DB_SELECTOR_OPERATOR_EQ)
+		{
+			lower = &best->value;
+			upper = &best->value;
+		}
+		else
+		{
+			// Use the first bounds on the column, the remaining conditions are checked for each row
+			for (guint i = 0; i < condition->children->len; i++)
+			{
+				JMemoryCondition const* child = g_ptr_array_index(condition->children, i);
+
+				if (child->children != NULL || child->column != best->column)
+				{
+					continue;
+				}
+
+				if (lower == NULL && (child->op == J_DB_SELECTOR_OPERATOR_GT || child->op == J_DB_SELECTOR_OPERATOR_GE))
+				{
+					lower = &child->value;
+					lower_inclusive = (child->op == J_DB_SELECTOR_OPERATOR_GE);
+				}
+				else if (upper == NULL && (child->op == J_DB_SELECTOR_OPERATOR_LT || child->op == J_DB_SELECTOR_OPERATOR_LE))
+				{
+					upper = &child->value;
+					upper_inclusive = (child->op == J_DB_SELECTOR_OPERATOR_LE);
+				}
+			}
+		}
+
+		memory_table_select_index(table, best->column, lower, lower_inclusive, upper, upper_inclusive, condition, rows);
+
+		return;
+	}
+
+	for (guint row = 0; row < table->ids->len; row++)
+	{
+		if (g_array_index(table->ids, guint32, row) == 0)
+		{
+			continue;
+		}
+
+		if (condition == NULL || memory_condition_match(table, condition, row))
+		{
+			g_array_append_val(rows, row);
+		}
+	}
+}
+
+/**
+ * Compares two rows using the sort keys only.
+ * Unset values are sorted first, just like NULL in SQLite.
+ **/
+static gint
+memory_row_compare_keys(JMemorySort const* sort, guint row_a, guint row_b)
+{
+	for (guint i = 0; i < sort->keys->len; i++)
+	{
+		JMemorySortKey const* key = &g_array_index(sort->keys, JMemorySortKey, i);
+		JDBTypeValue value_a;
+		JDBTypeValue value_b;
+		gboolean set_a;
+		gboolean set_b;
+		gint ret;
+
+		set_a = memory_table_value(sort->table, row_a, key->column, &value_a);
+		set_b = memory_table_value(sort->table, row_b, key->column, &value_b);
+
+		if (set_a && set_b)
+		{
+			ret = memory_value_compare(memory_column_type(key->column), &value_a, &value_b);
+		}
+		else
+		{
+			ret = set_a - set_b;
+		}
+
+		if (key->order == J_DB_SELECTOR_ORDER_DESCENDING)
+		{
+			ret = -ret;
+		}
+
+		if (ret != 0)
+		{
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Compares two rows using the sort keys and their _id.
+ **/
+static gint
+memory_row_compare(gconstpointer a, gconstpointer b, gpointer data)
+{
+	JMemorySort const* sort = data;
+	guint row_a = *(guint const*)a;
+	guint row_b = *(guint const*)b;
+	guint32 id_a;
+	guint32 id_b;
+	gint ret;
+
+	if ((ret = memory_row_compare_keys(sort, row_a, row_b)) != 0)
+	{
+		return ret;
+	}
+
+	id_a = g_array_index(sort->table->ids, guint32, row_a);
+	id_b = g_array_index(sort->table->ids, guint32, row_b);
+
+	return (id_a > id_b) - (id_a < id_b);
+}
+
+static gint
+memory_group_compare(gconstpointer a, gconstpointer b, gpointer data)
+{
+	JMemoryGroup const* group_a = a;
+	JMemoryGroup const* group_b = b;
+
+	return memory_row_compare(&group_a->row, &group_b->row, data);
+}
+
+static void
+memory_group_clear(gpointer data)
+{
+	JMemoryGroup* group = data;
+
+	if (group->result != NULL)
+	{
+		bson_destroy(group->result);
+	}
+}
+
+/**
+ * Parses an array of field names, _id is included.
+ **/
+static gboolean
+memory_selector_columns(JMemoryTable* table, bson_t const* selector, gchar const* name, GPtrArray* columns, GError** error)
+{
+	bson_iter_t iter;
+	bson_iter_t iter_child;
+	JDBTypeValue value;
+	gboolean has_next;
+
+	if (selector == NULL || !j_bson_iter_init(&iter, selector, NULL) || !j_bson_iter_find(&iter, name, NULL))
+	{
+		return TRUE;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+	{
+		goto _error;
+	}
+
+	while (TRUE)
+	{
+		JMemoryColumn* column;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter_child, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_STRING, &value, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!memory_table_column(table, value.val_string, &column, error)))
+		{
+			goto _error;
+		}
+
+		g_ptr_array_add(columns, column);
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+static gboolean
+memory_selector_order(JMemoryTable* table, bson_t const* selector, GArray* keys, GError** error)
+{
+	bson_iter_t iter;
+	bson_iter_t iter_child;
+	bson_iter_t iter_order;
+	JDBTypeValue value;
+	gboolean has_next;
+
+	if (selector == NULL || !j_bson_iter_init(&iter, selector, NULL) || !j_bson_iter_find(&iter, "_order", NULL))
+	{
+		return TRUE;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+	{
+		goto _error;
+	}
+
+	while (TRUE)
+	{
+		JMemorySortKey key;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter_child, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_order, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter_order, "_name", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_order, J_DB_TYPE_STRING, &value, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!memory_table_column(table, value.val_string, &key.column, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_order, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter_order, "_order", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_order, J_DB_TYPE_UINT32, &value, error)))
+		{
+			goto _error;
+		}
+
+		key.order = value.val_uint32;
+		g_array_append_val(keys, key);
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+static gboolean
+memory_selector_aggregates(JMemoryTable* table, bson_t const* selector, GArray* aggregates, GError** error)
+{
+	bson_iter_t iter;
+	bson_iter_t iter_child;
+	bson_iter_t iter_aggregate;
+	JDBTypeValue value;
+	gboolean has_next;
+
+	if (selector == NULL || !j_bson_iter_init(&iter, selector, NULL) || !j_bson_iter_find(&iter, "_aggregate", NULL))
+	{
+		return TRUE;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+	{
+		goto _error;
+	}
+
+	while (TRUE)
+	{
+		JMemoryAggregate aggregate;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter_child, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		aggregate.column = NULL;
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_aggregate, error)))
+		{
+			goto _error;
+		}
+
+		// Counting all rows does not need a field, counting _id is equivalent
+		if (j_bson_iter_find(&iter_aggregate, "_name", NULL))
+		{
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_aggregate, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!memory_table_column(table, value.val_string, &aggregate.column, error)))
+			{
+				goto _error;
+			}
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_aggregate, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_find(&iter_aggregate, "_aggregate", error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_aggregate, J_DB_TYPE_UINT32, &value, error)))
+		{
+			goto _error;
+		}
+
+		aggregate.aggregate = value.val_uint32;
+
+		if (G_UNLIKELY(!j_bson_aggregate_type(aggregate.aggregate, memory_column_type(aggregate.column), &aggregate.type, error)))
+		{
+			goto _error;
+		}
+
+		g_array_append_val(aggregates, aggregate);
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Computes an aggregate over rows[start, end) and appends it to result.
+ * Unset values are ignored, just like NULL in SQL.
+ **/
+static gboolean
+memory_aggregate_append(JMemoryTable* table, JMemoryAggregate const* aggregate, GArray* rows, guint start, guint end, bson_t* result, gchar const* key, GError** error)
+{
+	JDBType type;
+	JDBTypeValue value;
+	JDBTypeValue aggregated;
+	guint64 count = 0;
 
-struct JMemoryData
+	type = memory_column_type(aggregate->column);
+	memset(&aggregated, 0, sizeof(aggregated));
+
+	for (guint i = start; i < end; i++)
+	{
+		if (!memory_table_value(table, g_array_index(rows, guint, i), aggregate->column, &value))
+		{
+			continue;
+		}
+
+		switch (aggregate->aggregate)
+		{
+			case J_DB_AGGREGATE_COUNT:
+				break;
+			case J_DB_AGGREGATE_MIN:
+				if (count == 0 || memory_value_compare(type, &value, &aggregated) < 0)
+				{
+					aggregated = value;
+				}
+
+				break;
+			case J_DB_AGGREGATE_MAX:
+				if (count == 0 || memory_value_compare(type, &value, &aggregated) > 0)
+				{
+					aggregated = value;
+				}
+
+				break;
+			case J_DB_AGGREGATE_SUM:
+			case J_DB_AGGREGATE_AVG:
+				if (aggregate->type == J_DB_TYPE_SINT64)
+				{
+					aggregated.val_sint64 += (type == J_DB_TYPE_SINT32) ? value.val_sint32 : value.val_sint64;
+				}
+				else if (aggregate->type == J_DB_TYPE_UINT64)
+				{
+					aggregated.val_uint64 += (type == J_DB_TYPE_UINT32) ? value.val_uint32 : value.val_uint64;
+				}
+				else
+				{
+					aggregated.val_float64 += memory_value_to_double(type, &value);
+				}
+
+				break;
+			default:
+				g_assert_not_reached();
+		}
+
+		count++;
+	}
+
+	if (aggregate->aggregate == J_DB_AGGREGATE_COUNT)
+	{
+		aggregated.val_uint64 = count;
+	}
+	else if (aggregate->aggregate == J_DB_AGGREGATE_AVG && count > 0)
+	{
+		aggregated.val_float64 /= count;
+	}
+
+	return j_bson_append_value(result, key, aggregate->type, &aggregated, error);
+}
+
+/**
+ * Computes the aggregates of the group formed by rows[start, end).
+ **/
+static gboolean
+memory_group_add(JMemoryTable* table, GArray* rows, guint start, guint end, GPtrArray* group_by, GArray* aggregates, GArray* groups, GError** error)
 {
-	bson_t* schema_cache;
-	bson_t* entry_cache;
-	guint32 entry_counter;
+	JMemoryGroup group;
 
-	GMutex lock[1];
-};
+	group.row = (start < end) ? g_array_index(rows, guint, start) : 0;
+	group.result = bson_new();
+	g_array_append_val(groups, group);
 
-typedef struct JMemoryData JMemoryData;
+	for (guint i = 0; i < group_by->len; i++)
+	{
+		JMemoryColumn* column = g_ptr_array_index(group_by, i);
+		JDBTypeValue value;
+
+		memory_table_value(table, group.row, column, &value);
+
+		if (G_UNLIKELY(!j_bson_append_value(group.result, memory_column_name(column), memory_column_type(column), &value, error)))
+		{
+			goto _error;
+		}
+	}
+
+	for (guint i = 0; i < aggregates->len; i++)
+	{
+		g_autofree gchar* key = NULL;
+
+		key = g_strdup_printf("_aggregate_%u", i);
+
+		if (G_UNLIKELY(!memory_aggregate_append(table, &g_array_index(aggregates, JMemoryAggregate, i), rows, start, end, group.result, key, error)))
+		{
+			goto _error;
+		}
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Groups the matching rows and computes the aggregates for each group.
+ * Without grouping fields, a single result is returned, even if no rows match.
+ **/
+static gboolean
+memory_table_aggregate(JMemoryTable* table, GArray* rows, GPtrArray* group_by, GArray* aggregates, GArray* groups, GError** error)
+{
+	JMemorySort sort;
+	guint end;
+
+	if (group_by->len == 0)
+	{
+		return memory_group_add(table, rows, 0, rows->len, group_by, aggregates, groups, error);
+	}
+
+	sort.table = table;
+	sort.keys = g_array_new(FALSE, FALSE, sizeof(JMemorySortKey));
+
+	for (guint i = 0; i < group_by->len; i++)
+	{
+		JMemorySortKey key;
+
+		key.column = g_ptr_array_index(group_by, i);
+		key.order = J_DB_SELECTOR_ORDER_ASCENDING;
+		g_array_append_val(sort.keys, key);
+	}
+
+	g_array_sort_with_data(rows, memory_row_compare, &sort);
+
+	for (guint start = 0; start < rows->len; start = end)
+	{
+		for (end = start + 1; end < rows->len; end++)
+		{
+			if (memory_row_compare_keys(&sort, g_array_index(rows, guint, start), g_array_index(rows, guint, end)) != 0)
+			{
+				break;
+			}
+		}
+
+		if (G_UNLIKELY(!memory_group_add(table, rows, start, end, group_by, aggregates, groups, error)))
+		{
+			goto _error;
+		}
+	}
+
+	g_array_free(sort.keys, TRUE);
+
+	return TRUE;
+
+_error:
+	g_array_free(sort.keys, TRUE);
+
+	return FALSE;
+}
+
+static void
+memory_iterator_free(JMemoryIterator* iterator)
+{
+	g_free(iterator->key);
+	g_strfreev(iterator->fields);
+
+	if (iterator->ids != NULL)
+	{
+		g_array_free(iterator->ids, TRUE);
+	}
+
+	if (iterator->results != NULL)
+	{
+		g_ptr_array_unref(iterator->results);
+	}
+
+	g_slice_free(JMemoryIterator, iterator);
+}
 
 static gboolean
-backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* batch, GError** error)
+backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* _batch, GError** error)
 {
+	JMemoryBatch* batch;
+
 	(void)backend_data;
 	(void)semantics;
-	(void)namespace;
-	(void)batch;
 	(void)error;
 
-	// Return something != NULL
-	*batch = batch;
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(_batch != NULL, FALSE);
+
+	batch = g_slice_new(JMemoryBatch);
+	batch->namespace = namespace;
+	batch->write = FALSE;
+	batch->undo = g_array_new(FALSE, FALSE, sizeof(JMemoryUndo));
+	g_array_set_clear_func(batch->undo, memory_undo_clear);
+
+	*_batch = batch;
 
 	return TRUE;
 }
 
 static gboolean
-backend_batch_execute(gpointer backend_data, gpointer batch, GError** error)
+backend_batch_execute(gpointer backend_data, gpointer _batch, GError** error)
 {
-	(void)backend_data;
-	(void)batch;
+	JMemoryData* bd = backend_data;
+	JMemoryBatch* batch = _batch;
+
 	(void)error;
 
+	g_return_val_if_fail(batch != NULL, FALSE);
+
+	memory_batch_release(bd, batch);
+
+	g_array_unref(batch->undo);
+	g_slice_free(JMemoryBatch, batch);
+
 	return TRUE;
 }
 
 static gboolean
-backend_schema_create(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* schema, GError** error)
+backend_schema_create(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* schema, GError** error)
 {
 	JMemoryData* bd = backend_data;
+	JMemoryBatch* batch = _batch;
+	JMemoryTable* table = NULL;
+	bson_iter_t iter;
+	bson_iter_t iter_index;
+	bson_iter_t iter_fields;
+	JDBTypeValue value;
+	gboolean has_next;
+	g_autofree gchar* key = NULL;
 
-	(void)batch;
-	(void)name;
-	(void)schema;
-	(void)error;
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(schema != NULL, FALSE);
+
+	key = g_strdup_printf("%s_%s", batch->namespace, name);
+
+	memory_batch_write(bd, batch);
+
+	if (G_UNLIKELY(g_hash_table_contains(bd->tables, key)))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_FAILED, "schema already exists");
+		goto _error;
+	}
+
+	table = memory_table_new();
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, schema, error)))
+	{
+		goto _error;
+	}
 
-	g_mutex_lock(bd->lock);
+	while (TRUE)
+	{
+		JMemoryColumn* column;
+		gchar const* field;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY((field = j_bson_iter_key(&iter, error)) == NULL))
+		{
+			goto _error;
+		}
+
+		if (g_strcmp0(field, "_index") == 0 || g_strcmp0(field, "_id") == 0)
+		{
+			continue;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT32, &value, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(value.val_uint32 > J_DB_TYPE_ID))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_DB_TYPE_INVALID, "db type invalid");
+			goto _error;
+		}
+
+		column = memory_column_new(field, value.val_uint32);
+		g_ptr_array_add(table->columns, column);
+		g_hash_table_insert(table->columns_by_name, column->name, column);
+	}
 
-	if (bd->schema_cache != NULL)
+	if (G_UNLIKELY(table->columns->len == 0))
 	{
-		bson_destroy(bd->schema_cache);
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_EMPTY, "schema empty");
+		goto _error;
 	}
 
-	bd->schema_cache = bson_copy(schema);
+	// Only the leading field of an index is indexed, conditions on further fields are checked for each row
+	if (j_bson_iter_init(&iter, schema, NULL) && j_bson_iter_find(&iter, "_index", NULL))
+	{
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_index, error)))
+		{
+			goto _error;
+		}
+
+		while (TRUE)
+		{
+			JMemoryColumn* column;
+
+			if (G_UNLIKELY(!j_bson_iter_next(&iter_index, &has_next, error)))
+			{
+				goto _error;
+			}
+
+			if (!has_next)
+			{
+				break;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter_index, &iter_fields, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_next(&iter_fields, &has_next, error)))
+			{
+				goto _error;
+			}
+
+			if (!has_next)
+			{
+				continue;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_fields, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!memory_table_column(table, value.val_string, &column, error)))
+			{
+				goto _error;
+			}
+
+			// _id already has a hash index
+			if (column != NULL)
+			{
+				memory_column_add_index(column);
+			}
+		}
+	}
 
-	g_mutex_unlock(bd->lock);
+	g_hash_table_insert(bd->tables, g_strdup(key), table);
+	memory_undo_add(batch, J_MEMORY_UNDO_SCHEMA_CREATE, key, 0, NULL, NULL);
 
 	return TRUE;
+
+_error:
+	memory_table_free(table);
+	memory_batch_abort(bd, batch);
+
+	return FALSE;
 }
 
 static gboolean
-backend_schema_get(gpointer backend_data, gpointer batch, gchar const* name, bson_t* schema, GError** error)
+backend_schema_get(gpointer backend_data, gpointer _batch, gchar const* name, bson_t* schema, GError** error)
 {
-	gboolean ret = FALSE;
 	JMemoryData* bd = backend_data;
+	JMemoryBatch* batch = _batch;
+	JMemoryTable* table;
+	JDBTypeValue value;
+	gboolean bson_initialized = FALSE;
+	g_autofree gchar* key = NULL;
 
-	(void)batch;
-	(void)name;
-	(void)schema;
-	(void)error;
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
 
-	g_mutex_lock(bd->lock);
+	key = g_strdup_printf("%s_%s", batch->namespace, name);
 
-	if (bd->schema_cache != NULL)
+	memory_read_lock(bd);
+
+	if (G_UNLIKELY((table = g_hash_table_lookup(bd->tables, key)) == NULL))
 	{
-		// FIXME schema is uninitialized if backend is running on the server but initialized if running on the client
-		// bson_copy_to requires the destination to be uninitialized
-		//bson_destroy(schema);
-		bson_copy_to(bd->schema_cache, schema);
-		ret = TRUE;
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND, "schema not found");
+		goto _error;
 	}
 
-	g_mutex_unlock(bd->lock);
+	if (schema != NULL)
+	{
+		if (G_UNLIKELY(!j_bson_init(schema, error)))
+		{
+			goto _error;
+		}
+
+		bson_initialized = TRUE;
+		value.val_uint32 = J_DB_TYPE_UINT32;
+
+		if (G_UNLIKELY(!j_bson_append_value(schema, "_id", J_DB_TYPE_UINT32, &value, error)))
+		{
+			goto _error;
+		}
+
+		for (guint i = 0; i < table->columns->len; i++)
+		{
+			JMemoryColumn* column = g_ptr_array_index(table->columns, i);
+
+			value.val_uint32 = column->type;
+
+			if (G_UNLIKELY(!j_bson_append_value(schema, column->name, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+		}
+	}
 
-	return ret;
+	memory_read_unlock(bd);
+
+	return TRUE;
+
+_error:
+	memory_read_unlock(bd);
+
+	if (bson_initialized)
+	{
+		j_bson_destroy(schema);
+	}
+
+	memory_batch_abort(bd, batch);
+
+	return FALSE;
 }
 
 static gboolean
-backend_schema_delete(gpointer backend_data, gpointer batch, gchar const* name, GError** error)
+backend_schema_delete(gpointer backend_data, gpointer _batch, gchar const* name, GError** error)
 {
 	JMemoryData* bd = backend_data;
+	JMemoryBatch* batch = _batch;
+	gpointer table;
+	gpointer orig_key;
+	g_autofree gchar* key = NULL;
 
-	(void)batch;
-	(void)name;
-	(void)error;
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+
+	key = g_strdup_printf("%s_%s", batch->namespace, name);
 
-	g_mutex_lock(bd->lock);
+	memory_batch_write(bd, batch);
 
-	if (bd->schema_cache != NULL)
+	if (G_UNLIKELY(!g_hash_table_lookup_extended(bd->tables, key, &orig_key, &table)))
 	{
-		bson_destroy(bd->schema_cache);
-		bd->schema_cache = NULL;
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND, "schema not found");
+		goto _error;
 	}
 
-	g_mutex_unlock(bd->lock);
+	// The table is freed once the batch has been executed, so that it can be restored if the batch is aborted
+	g_hash_table_steal(bd->tables, key);
+	g_free(orig_key);
+	memory_undo_add(batch, J_MEMORY_UNDO_SCHEMA_DELETE, key, 0, NULL, table);
 
 	return TRUE;
+
+_error:
+	memory_batch_abort(bd, batch);
+
+	return FALSE;
 }
 
 static gboolean
-backend_insert(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* metadata, bson_t* id, GError** error)
+backend_insert(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* metadata, bson_t* id, GError** error)
 {
 	JMemoryData* bd = backend_data;
+	JMemoryBatch* batch = _batch;
+	JMemoryTable* table;
+	JDBTypeValue value;
+	guint row;
+	g_autofree gchar* key = NULL;
 
-	(void)batch;
-	(void)name;
-	(void)metadata;
-	(void)id;
-	(void)error;
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(metadata != NULL, FALSE);
+
+	key = g_strdup_printf("%s_%s", batch->namespace, name);
+
+	memory_batch_write(bd, batch);
+
+	if (G_UNLIKELY((table = g_hash_table_lookup(bd->tables, key)) == NULL))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND, "schema not found");
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_has_enough_keys(metadata, 1, error)))
+	{
+		goto _error;
+	}
+
+	value.val_uint32 = table->next_id++;
+	row = memory_table_row_new(table, value.val_uint32);
+	memory_undo_add(batch, J_MEMORY_UNDO_INSERT, key, value.val_uint32, NULL, NULL);
 
-	g_mutex_lock(bd->lock);
+	if (G_UNLIKELY(!memory_table_row_set(table, row, metadata, error)))
+	{
+		goto _error;
+	}
 
-	if (bd->entry_cache != NULL)
+	if (G_UNLIKELY(!j_bson_append_value(id, "_value", J_DB_TYPE_UINT32, &value, error)))
 	{
-		bson_destroy(bd->entry_cache);
+		goto _error;
 	}
 
-	bd->entry_cache = bson_copy(metadata);
-	bd->entry_counter++;
+	value.val_uint32 = J_DB_TYPE_UINT32;
 
-	g_mutex_unlock(bd->lock);
+	if (G_UNLIKELY(!j_bson_append_value(id, "_value_type", J_DB_TYPE_UINT32, &value, error)))
+	{
+		goto _error;
+	}
 
 	return TRUE;
+
+_error:
+	memory_batch_abort(bd, batch);
+
+	return FALSE;
 }
 
 static gboolean
-backend_update(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* selector, bson_t const* metadata, GError** error)
+backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, bson_t const* metadata, guint64* count, GError** error)
 {
-	(void)backend_data;
-	(void)batch;
-	(void)name;
-	(void)selector;
-	(void)metadata;
-	(void)error;
+	JMemoryData* bd = backend_data;
+	JMemoryBatch* batch = _batch;
+	JMemoryTable* table;
+	JMemoryCondition* condition = NULL;
+	g_autoptr(GArray) rows = NULL;
+	g_autofree gchar* key = NULL;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(metadata != NULL, FALSE);
+	g_return_val_if_fail(count != NULL, FALSE);
+
+	key = g_strdup_printf("%s_%s", batch->namespace, name);
+	rows = g_array_new(FALSE, FALSE, sizeof(guint));
+
+	memory_batch_write(bd, batch);
+
+	if (G_UNLIKELY((table = g_hash_table_lookup(bd->tables, key)) == NULL))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND, "schema not found");
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!memory_selector_has_conditions(selector)))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SELECTOR_EMPTY, "selector empty");
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_has_enough_keys(metadata, 1, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!memory_selector_condition(table, selector, &condition, error)))
+	{
+		goto _error;
+	}
+
+	// Rows are collected first because modifying them changes the indexes
+	memory_table_select(table, condition, rows);
+
+	for (guint i = 0; i < rows->len; i++)
+	{
+		guint row = g_array_index(rows, guint, i);
+
+		memory_undo_add(batch, J_MEMORY_UNDO_UPDATE, key, g_array_index(table->ids, guint32, row), memory_table_row_snapshot(table, row), NULL);
+
+		if (G_UNLIKELY(!memory_table_row_set(table, row, metadata, error)))
+		{
+			goto _error;
+		}
+	}
+
+	*count = rows->len;
+
+	memory_condition_free(condition);
 
 	return TRUE;
+
+_error:
+	if (condition != NULL)
+	{
+		memory_condition_free(condition);
+	}
+
+	memory_batch_abort(bd, batch);
+
+	return FALSE;
 }
 
 static gboolean
-backend_delete(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* selector, GError** error)
+backend_delete(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, guint64* count, GError** error)
 {
 	JMemoryData* bd = backend_data;
+	JMemoryBatch* batch = _batch;
+	JMemoryTable* table;
+	JMemoryCondition* condition = NULL;
+	g_autoptr(GArray) rows = NULL;
+	g_autofree gchar* key = NULL;
 
-	(void)batch;
-	(void)name;
-	(void)selector;
-	(void)error;
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(count != NULL, FALSE);
+
+	key = g_strdup_printf("%s_%s", batch->namespace, name);
+	rows = g_array_new(FALSE, FALSE, sizeof(guint));
+
+	memory_batch_write(bd, batch);
+
+	if (G_UNLIKELY((table = g_hash_table_lookup(bd->tables, key)) == NULL))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND, "schema not found");
+		goto _error;
+	}
+
+	// Without conditions, all rows are deleted
+	if (G_UNLIKELY(!memory_selector_condition(table, selector, &condition, error)))
+	{
+		goto _error;
+	}
 
-	g_mutex_lock(bd->lock);
+	memory_table_select(table, condition, rows);
 
-	if (bd->entry_cache != NULL)
+	for (guint i = 0; i < rows->len; i++)
 	{
-		bson_destroy(bd->entry_cache);
-		bd->entry_cache = NULL;
+		guint row = g_array_index(rows, guint, i);
+
+		memory_undo_add(batch, J_MEMORY_UNDO_DELETE, key, g_array_index(table->ids, guint32, row), memory_table_row_snapshot(table, row), NULL);
+		memory_table_row_delete(table, row);
 	}
 
-	bd->entry_counter--;
+	*count = rows->len;
 
-	g_mutex_unlock(bd->lock);
+	if (condition != NULL)
+	{
+		memory_condition_free(condition);
+	}
 
 	return TRUE;
+
+_error:
+	memory_batch_abort(bd, batch);
+
+	return FALSE;
 }
 
 static gboolean
-backend_query(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* selector, gpointer* iterator, GError** error)
+backend_query(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, gpointer* iterator, GError** error)
 {
 	JMemoryData* bd = backend_data;
-	guint32* counter;
+	JMemoryBatch* batch = _batch;
+	JMemoryIterator* it = NULL;
+	JMemoryTable* table;
+	JMemoryCondition* condition = NULL;
+	JMemorySort sort;
+	bson_iter_t iter;
+	JDBTypeValue value;
+	guint64 limit = 0;
+	guint64 offset = 0;
+	guint length;
+	g_autoptr(GArray) rows = NULL;
+	g_autoptr(GArray) aggregates = NULL;
+	g_autoptr(GArray) groups = NULL;
+	g_autoptr(GPtrArray) fields = NULL;
+	g_autoptr(GPtrArray) group_by = NULL;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(iterator != NULL, FALSE);
+
+	sort.keys = g_array_new(FALSE, FALSE, sizeof(JMemorySortKey));
+	rows = g_array_new(FALSE, FALSE, sizeof(guint));
+	aggregates = g_array_new(FALSE, FALSE, sizeof(JMemoryAggregate));
+	groups = g_array_new(FALSE, FALSE, sizeof(JMemoryGroup));
+	g_array_set_clear_func(groups, memory_group_clear);
+	fields = g_ptr_array_new();
+	group_by = g_ptr_array_new();
+
+	it = g_slice_new0(JMemoryIterator);
+	it->key = g_strdup_printf("%s_%s", batch->namespace, name);
+
+	memory_read_lock(bd);
+
+	if (G_UNLIKELY((table = g_hash_table_lookup(bd->tables, it->key)) == NULL))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND, "schema not found");
+		goto _error;
+	}
 
-	(void)batch;
-	(void)name;
-	(void)selector;
-	(void)error;
+	sort.table = table;
+
+	if (G_UNLIKELY(!memory_selector_condition(table, selector, &condition, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!memory_selector_columns(table, selector, "_fields", fields, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!memory_selector_columns(table, selector, "_group_by", group_by, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!memory_selector_order(table, selector, sort.keys, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!memory_selector_aggregates(table, selector, aggregates, error)))
+	{
+		goto _error;
+	}
+
+	if (selector != NULL && j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_limit", NULL))
+	{
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT64, &value, error)))
+		{
+			goto _error;
+		}
+
+		limit = value.val_uint64;
+	}
+
+	if (selector != NULL && j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_offset", NULL))
+	{
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT64, &value, error)))
+		{
+			goto _error;
+		}
 
-	counter = g_new(guint32, 1);
-	*iterator = counter;
+		offset = value.val_uint64;
+	}
 
-	g_mutex_lock(bd->lock);
+	memory_table_select(table, condition, rows);
 
-	if (bd->entry_cache == NULL)
+	if (aggregates->len > 0 || group_by->len > 0)
+	{
+		if (G_UNLIKELY(!memory_table_aggregate(table, rows, group_by, aggregates, groups, error)))
+		{
+			goto _error;
+		}
+
+		// Groups are returned sorted by their grouping fields unless sort keys are given
+		if (sort.keys->len > 0)
+		{
+			g_array_sort_with_data(groups, memory_group_compare, &sort);
+		}
+
+		length = groups->len;
+	}
+	else
 	{
-		*counter = 0;
+		// Rows are returned in the order of their _id unless sort keys are given
+		g_array_sort_with_data(rows, memory_row_compare, &sort);
+
+		length = rows->len;
 	}
-	else if (selector != NULL)
+
+	offset = MIN(offset, length);
+	length = (limit > 0) ? MIN(length - offset, limit) : length - offset;
+
+	if (aggregates->len > 0 || group_by->len > 0)
 	{
-		*counter = 1;
+		it->results = g_ptr_array_new_with_free_func((GDestroyNotify)bson_destroy);
+
+		for (guint i = offset; i < offset + length; i++)
+		{
+			JMemoryGroup* group = &g_array_index(groups, JMemoryGroup, i);
+
+			g_ptr_array_add(it->results, group->result);
+			group->result = NULL;
+		}
 	}
 	else
 	{
-		*counter = bd->entry_counter;
+		it->ids = g_array_sized_new(FALSE, FALSE, sizeof(guint32), length);
+
+		for (guint i = offset; i < offset + length; i++)
+		{
+			g_array_append_val(it->ids, g_array_index(table->ids, guint32, g_array_index(rows, guint, i)));
+		}
+
+		if (fields->len > 0)
+		{
+			it->fields = g_new0(gchar*, fields->len + 1);
+
+			for (guint i = 0; i < fields->len; i++)
+			{
+				it->fields[i] = g_strdup(memory_column_name(g_ptr_array_index(fields, i)));
+			}
+		}
+	}
+
+	memory_read_unlock(bd);
+
+	if (condition != NULL)
+	{
+		memory_condition_free(condition);
 	}
 
-	g_mutex_unlock(bd->lock);
+	g_array_free(sort.keys, TRUE);
+
+	*iterator = it;
 
 	return TRUE;
+
+_error:
+	memory_read_unlock(bd);
+
+	if (condition != NULL)
+	{
+		memory_condition_free(condition);
+	}
+
+	g_array_free(sort.keys, TRUE);
+	memory_iterator_free(it);
+
+	return FALSE;
 }
 
 static gboolean
 backend_iterate(gpointer backend_data, gpointer iterator, bson_t* metadata, GError** error)
 {
-	gboolean ret = TRUE;
-	guint32* counter = iterator;
 	JMemoryData* bd = backend_data;
+	JMemoryIterator* it = iterator;
+	JMemoryTable* table;
+	JDBTypeValue value;
+	gboolean found = FALSE;
 
-	(void)iterator;
-	(void)metadata;
-	(void)error;
+	g_return_val_if_fail(iterator != NULL, FALSE);
+	g_return_val_if_fail(metadata != NULL, FALSE);
+
+	if (it->results != NULL)
+	{
+		if (it->position < it->results->len)
+		{
+			bson_concat(metadata, g_ptr_array_index(it->results, it->position));
+			it->position++;
+			found = TRUE;
+		}
+
+		goto _end;
+	}
+
+	memory_read_lock(bd);
+
+	table = g_hash_table_lookup(bd->tables, it->key);
+
+	// Rows might have been deleted since the query
+	while (table != NULL && !found && it->position < it->ids->len)
+	{
+		guint32 id;
+		guint row;
+
+		id = g_array_index(it->ids, guint32, it->position);
+		it->position++;
+
+		if (!memory_table_row(table, id, &row))
+		{
+			continue;
+		}
+
+		value.val_uint32 = id;
+		j_bson_append_value(metadata, "_id", J_DB_TYPE_UINT32, &value, NULL);
+
+		for (guint i = 0; i < table->columns->len; i++)
+		{
+			JMemoryColumn* column = g_ptr_array_index(table->columns, i);
+
+			if (it->fields != NULL && !g_strv_contains((gchar const* const*)it->fields, column->name))
+			{
+				continue;
+			}
+
+			// Unset values are returned like NULL values by the SQL backends
+			memory_table_value(table, row, column, &value);
+			j_bson_append_value(metadata, column->name, column->type, &value, NULL);
+		}
+
+		found = TRUE;
+	}
 
-	g_mutex_lock(bd->lock);
+	memory_read_unlock(bd);
 
-	if (*counter <= 0 || bd->entry_cache == NULL)
+_end:
+	if (!found)
 	{
-		g_free(counter);
+		memory_iterator_free(it);
 		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
-		ret = FALSE;
-		goto end;
 	}
 
-	(*counter)--;
-	// bson_copy_to requires the destination to be uninitialized
-	bson_destroy(metadata);
-	bson_copy_to(bd->entry_cache, metadata);
+	return found;
+}
+
+static gboolean
+backend_iterate_row(gpointer backend_data, gpointer iterator, JBackendDBRow* db_row, GError** error)
+{
+	JMemoryData* bd = backend_data;
+	JMemoryIterator* it = iterator;
+	JMemoryTable* table;
+	JDBTypeValue value;
+	gboolean found = FALSE;
+	gint index;
 
-end:
-	g_mutex_unlock(bd->lock);
+	g_return_val_if_fail(iterator != NULL, FALSE);
+	g_return_val_if_fail(db_row != NULL, FALSE);
 
-	return ret;
+	// Aggregated results are only a few rows, so they are simply converted
+	if (it->results != NULL)
+	{
+		if (it->position < it->results->len)
+		{
+			if (!j_backend_db_row_set_bson(db_row, g_ptr_array_index(it->results, it->position), error))
+			{
+				memory_iterator_free(it);
+				return FALSE;
+			}
+
+			it->position++;
+			found = TRUE;
+		}
+
+		goto _end;
+	}
+
+	memory_read_lock(bd);
+
+	table = g_hash_table_lookup(bd->tables, it->key);
+
+	// Rows might have been deleted since the query
+	while (table != NULL && !found && it->position < it->ids->len)
+	{
+		guint32 id;
+		guint row;
+
+		id = g_array_index(it->ids, guint32, it->position);
+		it->position++;
+
+		if (!memory_table_row(table, id, &row))
+		{
+			continue;
+		}
+
+		if ((index = j_backend_db_row_get_index(db_row, "_id")) >= 0)
+		{
+			j_backend_db_row_set_int32(db_row, index, id);
+		}
+
+		for (guint i = 0; i < table->columns->len; i++)
+		{
+			JMemoryColumn* column = g_ptr_array_index(table->columns, i);
+
+			if (it->fields != NULL && !g_strv_contains((gchar const* const*)it->fields, column->name))
+			{
+				continue;
+			}
+
+			if ((index = j_backend_db_row_get_index(db_row, column->name)) < 0)
+			{
+				continue;
+			}
+
+			// Unset values are left unset, the client reads them as zero or NULL
+			if (memory_table_value(table, row, column, &value))
+			{
+				j_row_set_value(db_row, index, column->type, &value);
+			}
+		}
+
+		found = TRUE;
+	}
+
+	memory_read_unlock(bd);
+
+_end:
+	if (!found)
+	{
+		memory_iterator_free(it);
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
+	}
+
+	return found;
+}
+
+static void
+backend_iterate_free(gpointer backend_data, gpointer iterator)
+{
+	(void)backend_data;
+
+	g_return_if_fail(iterator != NULL);
+
+	// Iterators only hold copies of the matching IDs, so no lock is needed
+	memory_iterator_free(iterator);
 }
 
 static gboolean
@@ -271,10 +2678,8 @@ backend_init(gchar const* path, gpointer* backend_data)
 	(void)path;
 
 	bd = g_slice_new(JMemoryData);
-	bd->schema_cache = NULL;
-	bd->entry_cache = NULL;
-	bd->entry_counter = 0;
-	g_mutex_init(bd->lock);
+	bd->tables = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, memory_table_free);
+	g_rw_lock_init(bd->lock);
 
 	*backend_data = bd;
 
@@ -286,17 +2691,9 @@ backend_fini(gpointer backend_data)
 {
 	JMemoryData* bd = backend_data;
 
-	if (bd->schema_cache != NULL)
-	{
-		bson_destroy(bd->schema_cache);
-	}
-
-	if (bd->entry_cache != NULL)
-	{
-		bson_destroy(bd->entry_cache);
-	}
+	g_hash_table_unref(bd->tables);
+	g_rw_lock_clear(bd->lock);
 
-	g_mutex_clear(bd->lock);
 	g_slice_free(JMemoryData, bd);
 }
 
@@ -314,6 +2711,8 @@ static JBackend memory_backend = {
 		.backend_delete = backend_delete,
 		.backend_query = backend_query,
 		.backend_iterate = backend_iterate,
+		.backend_iterate_row = backend_iterate_row,
+		.backend_iterate_free = backend_iterate_free,
 		.backend_batch_start = backend_batch_start,
 		.backend_batch_execute = backend_batch_execute }
 };
@@ -32,12 +32,22 @@
 
 #define SQL_MODE_SINGLE_THREAD 0
 #define SQL_MODE_MULTI_THREAD 1
-#define SQL_MODE SQL_MODE_MULTI_THREAD
+#define SQL_MODE(backend_data) SQL_MODE_MULTI_THREAD
 
 #define SQL_AUTOINCREMENT_STRING " NOT NULL AUTO_INCREMENT "
 #define SQL_UINT64_TYPE " BIGINT UNSIGNED "
 #define SQL_LAST_INSERT_ID_STRING " SELECT LAST_INSERT_ID() "
+// LAST_INSERT_ID() returns the id of the first row inserted by a multi-row INSERT
+#define SQL_LAST_INSERT_ID_IS_FIRST 1
+#define SQL_RETURNING_ID(backend_data) 0
+// Checked when the backend is initialized, see j_sql_check_consecutive_ids()
+#define SQL_CONSECUTIVE_IDS(backend_data) (((JMySQLData*)(backend_data))->consecutive_ids)
+#define SQL_MAX_VARIABLES 65535
+// InnoDB uses row-level locking, so transactions do not have to be upgraded for writing
+#define SQL_WRITE_UPGRADE 0
 #define SQL_QUOTE "`"
+// Maximum number of cached statements per connection, see getCacheStatement()
+#define SQL_STATEMENT_CACHE_SIZE(backend_data) 256
 
 struct JMySQLData
 {
@@ -45,6 +55,8 @@ struct JMySQLData
 	gchar* db_database;
 	gchar* db_user;
 	gchar* db_password;
+	// Whether multi-row INSERTs assign consecutive ids
+	gboolean consecutive_ids;
 };
 
 typedef struct JMySQLData JMySQLData;
@@ -567,6 +579,30 @@ _error2:
 	return FALSE;
 }
 
+static gboolean
+j_sql_changes(MYSQL* backend_db, void* _stmt, guint64* changes, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	mysql_stmt_wrapper* wrapper = _stmt;
+	guint64 affected;
+
+	(void)backend_db;
+
+	g_return_val_if_fail(_stmt != NULL, FALSE);
+
+	// Connections are opened with CLIENT_FOUND_ROWS, so this returns matched instead of changed rows like SQLite
+	if ((affected = mysql_stmt_affected_rows(wrapper->stmt)) == (guint64)-1)
+	{
+		g_set_error(error, J_BACKEND_SQL_ERROR, J_BACKEND_SQL_ERROR_STEP, "sql step failed error was '%s'", mysql_stmt_error(wrapper->stmt));
+		return FALSE;
+	}
+
+	*changes = affected;
+
+	return TRUE;
+}
+
 static void*
 j_sql_open(gpointer backend_data)
 {
@@ -587,7 +623,7 @@ j_sql_open(gpointer backend_data)
 				bd->db_database, //database name
 				3306, //port number
 				NULL, //unix socket
-				0 //client flags
+				CLIENT_FOUND_ROWS //client flags
 				))
 	{
 		goto _error;
@@ -614,10 +650,13 @@ j_sql_close(MYSQL* backend_db)
 }
 
 static gboolean
-j_sql_start_transaction(MYSQL* backend_db, GError** error)
+j_sql_start_transaction(gpointer backend_data, MYSQL* backend_db, JSemantics* semantics, gboolean write, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	(void)backend_data;
+	(void)semantics;
+	(void)write;
 	(void)error;
 
 	mysql_query(backend_db, "START TRANSACTION");
@@ -626,10 +665,13 @@ j_sql_start_transaction(MYSQL* backend_db, GError** error)
 }
 
 static gboolean
-j_sql_commit_transaction(MYSQL* backend_db, GError** error)
+j_sql_commit_transaction(gpointer backend_data, MYSQL* backend_db, JSemantics* semantics, gboolean write, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	(void)backend_data;
+	(void)semantics;
+	(void)write;
 	(void)error;
 
 	mysql_query(backend_db, "COMMIT");
@@ -638,10 +680,12 @@ j_sql_commit_transaction(MYSQL* backend_db, GError** error)
 }
 
 static gboolean
-j_sql_abort_transaction(MYSQL* backend_db, GError** error)
+j_sql_abort_transaction(gpointer backend_data, MYSQL* backend_db, gboolean write, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	(void)backend_data;
+	(void)write;
 	(void)error;
 
 	mysql_query(backend_db, "ROLLBACK");
@@ -649,6 +693,57 @@ j_sql_abort_transaction(MYSQL* backend_db, GError** error)
 	return TRUE;
 }
 
+/**
+ * Checks whether multi-row INSERTs assign consecutive ids, which allows deriving all ids from LAST_INSERT_ID().
+ * This is only guaranteed for the traditional and consecutive auto-increment lock modes with an increment of 1.
+ **/
+static gboolean
+j_sql_check_consecutive_ids(gpointer backend_data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	MYSQL* backend_db;
+	MYSQL_RES* result = NULL;
+	MYSQL_ROW row;
+	gboolean ret = FALSE;
+
+	if ((backend_db = j_sql_open(backend_data)) == NULL)
+	{
+		goto _error;
+	}
+
+	if (mysql_query(backend_db, "SELECT @@innodb_autoinc_lock_mode, @@auto_increment_increment") != 0)
+	{
+		goto _error;
+	}
+
+	if ((result = mysql_store_result(backend_db)) == NULL)
+	{
+		goto _error;
+	}
+
+	if ((row = mysql_fetch_row(result)) != NULL && row[0] != NULL && row[1] != NULL)
+	{
+		guint64 lock_mode;
+		guint64 increment;
+
+		lock_mode = g_ascii_strtoull(row[0], NULL, 10);
+		increment = g_ascii_strtoull(row[1], NULL, 10);
+
+		ret = (lock_mode == 0 || lock_mode == 1) && increment == 1;
+	}
+
+_error:
+	if (result != NULL)
+	{
+		mysql_free_result(result);
+	}
+
+	j_sql_close(backend_db);
+
+	return ret;
+}
+
 #include "sql-generic.c"
 
 static gboolean
@@ -679,6 +774,9 @@ backend_init(gchar const* path, gpointer* backend_data)
 	g_return_val_if_fail(bd->db_user != NULL, FALSE);
 	g_return_val_if_fail(bd->db_password != NULL, FALSE);
 
+	// Entries are inserted one by one otherwise, see backend_insert_many()
+	bd->consecutive_ids = j_sql_check_consecutive_ids(bd);
+
 	*backend_data = bd;
 
 	sql_generic_init();
@@ -712,10 +810,13 @@ static JBackend mysql_backend = {
 		.backend_schema_get = backend_schema_get,
 		.backend_schema_delete = backend_schema_delete,
 		.backend_insert = backend_insert,
+		.backend_insert_many = backend_insert_many,
 		.backend_update = backend_update,
 		.backend_delete = backend_delete,
 		.backend_query = backend_query,
 		.backend_iterate = backend_iterate,
+		.backend_iterate_row = backend_iterate_row,
+		.backend_iterate_free = backend_iterate_free,
 		.backend_batch_start = backend_batch_start,
 		.backend_batch_execute = backend_batch_execute,
 	},
@@ -98,7 +98,7 @@ backend_insert(gpointer backend_data, gpointer batch, gchar const* name, bson_t
 }
 
 static gboolean
-backend_update(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* selector, bson_t const* metadata, GError** error)
+backend_update(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* selector, bson_t const* metadata, guint64* count, GError** error)
 {
 	(void)backend_data;
 	(void)batch;
@@ -107,11 +107,13 @@ backend_update(gpointer backend_data, gpointer batch, gchar const* name, bson_t
 	(void)metadata;
 	(void)error;
 
+	*count = 0;
+
 	return TRUE;
 }
 
 static gboolean
-backend_delete(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* selector, GError** error)
+backend_delete(gpointer backend_data, gpointer batch, gchar const* name, bson_t const* selector, guint64* count, GError** error)
 {
 	(void)backend_data;
 	(void)batch;
@@ -119,6 +121,8 @@ backend_delete(gpointer backend_data, gpointer batch, gchar const* name, bson_t
 	(void)selector;
 	(void)error;
 
+	*count = 0;
+
 	return TRUE;
 }
 
@@ -28,6 +28,12 @@ struct JThreadVariables
 	gboolean initialized;
 	void* sql_backend;
 	GHashTable* namespaces;
+	// Statements of queries, updates, deletes and bulk inserts, see getCacheStatement()
+	GHashTable* statements; // shape(GBytes*) -> (JSqlCacheSQLPrepared*)
+	// The cached statements, most recently used first
+	GQueue statements_lru;
+	guint64 statements_hits;
+	guint64 statements_misses;
 };
 
 typedef struct JThreadVariables JThreadVariables;
@@ -42,7 +48,7 @@ typedef struct JSqlCacheNames JSqlCacheNames;
 struct JSqlCacheSQLQueries
 {
 	GHashTable* types; // variablename(char*) -> variabletype(JDBType)
-	GHashTable* queries; //sql(char*) -> (JSqlCacheSQLPrepared*)
+	GHashTable* queries; //name(char*) -> (JSqlCacheSQLPrepared*), for statements that do not depend on a selector
 };
 
 typedef struct JSqlCacheSQLQueries JSqlCacheSQLQueries;
@@ -53,10 +59,17 @@ struct JSqlCacheSQLPrepared
 	void* stmt;
 	guint variables_count;
 	GHashTable* variables_index;
+	// The types of the result columns, only set for queries
+	GArray* variables_type;
 	gboolean initialized;
 	gchar* namespace;
 	gchar* name;
 	gpointer backend_data;
+	// The selector shape identifying the statement and its link in statements_lru, lru is NULL for statements that are not cached
+	GBytes* shape;
+	GList* lru;
+	// Whether the statement belongs to a query whose results have not been iterated completely
+	gboolean active;
 };
 
 typedef struct JSqlCacheSQLPrepared JSqlCacheSQLPrepared;
@@ -67,20 +80,14 @@ struct JSqlBatch
 	JSemantics* semantics;
 	gboolean open;
 	gboolean aborted;
+	// Whether the transaction has been started, see _backend_batch_begin()
+	gboolean started;
+	// Whether the transaction has been started for writing, see _backend_batch_write()
+	gboolean write;
 };
 
 typedef struct JSqlBatch JSqlBatch;
 
-struct JSqlIterator
-{
-	char* namespace;
-	char* name;
-	GArray* arr;
-	guint index;
-};
-
-typedef struct JSqlIterator JSqlIterator;
-
 static void thread_variables_fini(void* ptr);
 static GPrivate thread_variables_global = G_PRIVATE_INIT(thread_variables_fini);
 
@@ -96,6 +103,8 @@ sql_generic_fini(void)
 	J_TRACE_FUNCTION(NULL);
 }
 
+static void freeCacheStatement(JThreadVariables* thread_variables, JSqlCacheSQLPrepared* prepared);
+
 static void
 thread_variables_fini(void* ptr)
 {
@@ -105,6 +114,18 @@ thread_variables_fini(void* ptr)
 
 	if (thread_variables)
 	{
+		if (thread_variables->statements)
+		{
+			JSqlCacheSQLPrepared* prepared;
+
+			while ((prepared = g_queue_pop_head(&thread_variables->statements_lru)) != NULL)
+			{
+				freeCacheStatement(thread_variables, prepared);
+			}
+
+			g_hash_table_destroy(thread_variables->statements);
+		}
+
 		if (thread_variables->namespaces)
 		{
 			g_hash_table_destroy(thread_variables->namespaces);
@@ -151,6 +172,8 @@ thread_variables_get(gpointer backend_data, GError** error)
 		}
 
 		thread_variables->namespaces = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, freeJSqlCacheNames);
+		thread_variables->statements = g_hash_table_new(g_bytes_hash, g_bytes_equal);
+		g_queue_init(&thread_variables->statements_lru);
 		thread_variables->initialized = TRUE;
 		g_private_replace(&thread_variables_global, thread_variables);
 	}
@@ -161,22 +184,6 @@ _error:
 	return NULL;
 }
 
-static void
-freeJSqlIterator(gpointer ptr)
-{
-	J_TRACE_FUNCTION(NULL);
-
-	JSqlIterator* iter = ptr;
-
-	if (ptr)
-	{
-		g_free(iter->namespace);
-		g_free(iter->name);
-		g_array_free(iter->arr, TRUE);
-		g_free(iter);
-	}
-}
-
 static void
 freeJSqlCacheNames(void* ptr)
 {
@@ -238,6 +245,11 @@ freeJSqlCacheSQLPrepared(void* ptr)
 				g_hash_table_destroy(p->variables_index);
 			}
 
+			if (p->variables_type)
+			{
+				g_array_unref(p->variables_type);
+			}
+
 			if (p->sql)
 			{
 				g_string_free(p->sql, TRUE);
@@ -434,6 +446,264 @@ _error:
 	return NULL;
 }
 
+static void
+freeCacheStatement(JThreadVariables* thread_variables, JSqlCacheSQLPrepared* prepared)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (prepared->variables_index)
+	{
+		g_hash_table_destroy(prepared->variables_index);
+	}
+
+	if (prepared->variables_type)
+	{
+		g_array_unref(prepared->variables_type);
+	}
+
+	if (prepared->sql)
+	{
+		g_string_free(prepared->sql, TRUE);
+	}
+
+	if (prepared->initialized && prepared->stmt)
+	{
+		j_sql_finalize(thread_variables->sql_backend, prepared->stmt, NULL);
+	}
+
+	g_bytes_unref(prepared->shape);
+	g_free(prepared->namespace);
+	g_free(prepared->name);
+	g_free(prepared);
+}
+
+/**
+ * Removes a statement from the statement cache.
+ * Statements of queries that are still being iterated are freed by releaseCacheStatement() instead.
+ **/
+static void
+removeCacheStatement(JThreadVariables* thread_variables, JSqlCacheSQLPrepared* prepared)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_hash_table_remove(thread_variables->statements, prepared->shape);
+	g_queue_delete_link(&thread_variables->statements_lru, prepared->lru);
+	prepared->lru = NULL;
+
+	if (!prepared->active)
+	{
+		freeCacheStatement(thread_variables, prepared);
+	}
+}
+
+/**
+ * Marks the statement of a query as no longer being iterated.
+ **/
+static void
+releaseCacheStatement(JThreadVariables* thread_variables, JSqlCacheSQLPrepared* prepared)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	prepared->active = FALSE;
+
+	if (prepared->lru == NULL)
+	{
+		freeCacheStatement(thread_variables, prepared);
+	}
+}
+
+/**
+ * Starts the shape of a statement, see getCacheStatement().
+ **/
+static GByteArray*
+shape_new(gchar kind, gchar const* namespace, gchar const* name)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GByteArray* shape;
+
+	shape = g_byte_array_sized_new(128);
+	g_byte_array_append(shape, (guint8 const*)&kind, 1);
+	g_byte_array_append(shape, (guint8 const*)namespace, strlen(namespace) + 1);
+	g_byte_array_append(shape, (guint8 const*)name, strlen(name) + 1);
+
+	return shape;
+}
+
+/**
+ * Appends the shape of a selector to shape.
+ * Each key is followed by its type and, for strings and integers, its value.
+ * The shape covers everything the generated SQL depends on, that is, the keys, field names, modes, operators, sort orders and aggregates.
+ * The values being compared and the values of _limit and _offset are only bound to the statement and therefore skipped.
+ **/
+static gboolean
+shape_append_selector(GByteArray* shape, bson_iter_t* iter, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean has_next;
+	gchar const* key;
+	bson_iter_t child;
+	guint8 tag;
+	JDBTypeValue value;
+
+	while (TRUE)
+	{
+		if (G_UNLIKELY(!j_bson_iter_next(iter, &has_next, error)))
+		{
+			goto _error;
+		}
+
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY(!(key = j_bson_iter_key(iter, error))))
+		{
+			goto _error;
+		}
+
+		if (g_strcmp0(key, "_value") == 0 || g_strcmp0(key, "_row") == 0)
+		{
+			continue;
+		}
+
+		tag = bson_iter_type(iter);
+		g_byte_array_append(shape, (guint8 const*)key, strlen(key) + 1);
+		g_byte_array_append(shape, &tag, 1);
+
+		if (BSON_ITER_HOLDS_DOCUMENT(iter) || BSON_ITER_HOLDS_ARRAY(iter))
+		{
+			if (BSON_ITER_HOLDS_DOCUMENT(iter) && G_UNLIKELY(!j_bson_iter_recurse_document(iter, &child, error)))
+			{
+				goto _error;
+			}
+
+			if (BSON_ITER_HOLDS_ARRAY(iter) && G_UNLIKELY(!j_bson_iter_recurse_array(iter, &child, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!shape_append_selector(shape, &child, error)))
+			{
+				goto _error;
+			}
+		}
+		else if (BSON_ITER_HOLDS_UTF8(iter))
+		{
+			if (G_UNLIKELY(!j_bson_iter_value(iter, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
+
+			g_byte_array_append(shape, (guint8 const*)value.val_string, strlen(value.val_string) + 1);
+		}
+		else if (BSON_ITER_HOLDS_INT32(iter))
+		{
+			if (G_UNLIKELY(!j_bson_iter_value(iter, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+
+			g_byte_array_append(shape, (guint8 const*)&value.val_uint32, sizeof(value.val_uint32));
+		}
+	}
+
+	// Keys are never empty, so an empty key terminates the document
+	tag = 0;
+	g_byte_array_append(shape, &tag, 1);
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Returns the cached statement for a shape, which has to be built and prepared if it is not initialized.
+ * Looking up the shape avoids generating the SQL for statements that have already been prepared.
+ * Statements are cached per thread because they belong to the thread's connection.
+ * The least recently used statements are evicted once there are more than SQL_STATEMENT_CACHE_SIZE, except for those of queries that are still being iterated.
+ * A query with the same shape as one that is still being iterated gets an uncached statement.
+ * The cache takes ownership of shape.
+ **/
+static JSqlCacheSQLPrepared*
+getCacheStatement(gpointer backend_data, gchar const* namespace, gchar const* name, GByteArray* shape, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GBytes) key = NULL;
+	JSqlCacheSQLPrepared* prepared = NULL;
+	JSqlCacheSQLPrepared* cached = NULL;
+	JThreadVariables* thread_variables = NULL;
+	GList* link;
+
+	key = g_byte_array_free_to_bytes(shape);
+
+	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
+	{
+		goto _error;
+	}
+
+	cached = g_hash_table_lookup(thread_variables->statements, key);
+
+	// Statements whose preparation failed are built again
+	if (cached != NULL && !cached->initialized && !cached->active)
+	{
+		removeCacheStatement(thread_variables, cached);
+		cached = NULL;
+	}
+
+	if (cached != NULL && !cached->active)
+	{
+		thread_variables->statements_hits++;
+		j_trace_counter("sql_statement_cache_hits", thread_variables->statements_hits);
+
+		g_queue_unlink(&thread_variables->statements_lru, cached->lru);
+		g_queue_push_head_link(&thread_variables->statements_lru, cached->lru);
+
+		return cached;
+	}
+
+	thread_variables->statements_misses++;
+	j_trace_counter("sql_statement_cache_misses", thread_variables->statements_misses);
+
+	prepared = g_new0(JSqlCacheSQLPrepared, 1);
+	prepared->namespace = g_strdup(namespace);
+	prepared->name = g_strdup(name);
+	prepared->backend_data = backend_data;
+	prepared->shape = g_bytes_ref(key);
+
+	if (cached != NULL)
+	{
+		return prepared;
+	}
+
+	g_queue_push_head(&thread_variables->statements_lru, prepared);
+	prepared->lru = thread_variables->statements_lru.head;
+	g_hash_table_insert(thread_variables->statements, prepared->shape, prepared);
+
+	link = thread_variables->statements_lru.tail;
+
+	while (thread_variables->statements_lru.length > SQL_STATEMENT_CACHE_SIZE(backend_data) && link != prepared->lru)
+	{
+		JSqlCacheSQLPrepared* evicted = link->data;
+
+		link = link->prev;
+
+		if (!evicted->active)
+		{
+			removeCacheStatement(thread_variables, evicted);
+		}
+	}
+
+	return prepared;
+
+_error:
+	return NULL;
+}
+
 static void
 deleteCachePrepared(gpointer backend_data, gchar const* namespace, gchar const* name)
 {
@@ -449,6 +719,18 @@ deleteCachePrepared(gpointer backend_data, gchar const* namespace, gchar const*
 
 	g_return_if_fail(thread_variables->namespaces != NULL);
 
+	for (GList* link = thread_variables->statements_lru.head; link != NULL;)
+	{
+		JSqlCacheSQLPrepared* prepared = link->data;
+
+		link = link->next;
+
+		if (g_strcmp0(prepared->namespace, namespace) == 0 && g_strcmp0(prepared->name, name) == 0)
+		{
+			removeCacheStatement(thread_variables, prepared);
+		}
+	}
+
 	if (G_UNLIKELY(!(cacheNames = g_hash_table_lookup(thread_variables->namespaces, namespace))))
 	{
 		goto _error;
@@ -462,27 +744,53 @@ _error:
 	return;
 }
 
+/**
+ * Opens the batch, its transaction is only started by its first operation, see _backend_batch_begin().
+ **/
 static gboolean
 _backend_batch_start(gpointer backend_data, JSqlBatch* batch, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JThreadVariables* thread_variables = NULL;
+	(void)backend_data;
+	(void)error;
 
 	g_return_val_if_fail(!batch->open, FALSE);
 
+	batch->open = TRUE;
+	batch->aborted = FALSE;
+	batch->started = FALSE;
+	batch->write = FALSE;
+
+	return TRUE;
+}
+
+/**
+ * Starts the batch's transaction before its first operation.
+ * Batches that start with a modification take the write lock up front, so that everything they read is consistent with their writes.
+ **/
+static gboolean
+_backend_batch_begin(gpointer backend_data, JSqlBatch* batch, gboolean write, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JThreadVariables* thread_variables = NULL;
+
+	g_return_val_if_fail(batch->open, FALSE);
+	g_return_val_if_fail(!batch->started, FALSE);
+
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	if (!j_sql_start_transaction(thread_variables->sql_backend, error))
+	if (!j_sql_start_transaction(backend_data, thread_variables->sql_backend, batch->semantics, write, error))
 	{
 		goto _error;
 	}
 
-	batch->open = TRUE;
-	batch->aborted = FALSE;
+	batch->started = TRUE;
+	batch->write = write;
 
 	return TRUE;
 
@@ -490,6 +798,28 @@ _error:
 	return FALSE;
 }
 
+/**
+ * Makes sure the batch's transaction has been started before reading.
+ * Atomic batches are started for writing if upgrading a read transaction would not be atomic, see _backend_batch_write().
+ **/
+static gboolean
+_backend_batch_read(gpointer backend_data, JSqlBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean write;
+
+	if (batch->started)
+	{
+		return TRUE;
+	}
+
+	// This also serializes atomic batches that only read with writers, since it is not known whether they will write
+	write = SQL_WRITE_UPGRADE && SQL_MODE(backend_data) == SQL_MODE_MULTI_THREAD && j_semantics_get(batch->semantics, J_SEMANTICS_ATOMICITY) == J_SEMANTICS_ATOMICITY_BATCH;
+
+	return _backend_batch_begin(backend_data, batch, write, error);
+}
+
 static gboolean
 _backend_batch_execute(gpointer backend_data, JSqlBatch* batch, GError** error)
 {
@@ -499,17 +829,35 @@ _backend_batch_execute(gpointer backend_data, JSqlBatch* batch, GError** error)
 
 	g_return_val_if_fail(batch->open || (!batch->open && batch->aborted), FALSE);
 
+	if (!batch->open)
+	{
+		g_set_error_literal(error, J_BACKEND_SQL_ERROR, J_BACKEND_SQL_ERROR_FAILED, "batch has been aborted");
+		goto _error;
+	}
+
+	if (!batch->started)
+	{
+		// The batch did not contain any operations
+		batch->open = FALSE;
+
+		return TRUE;
+	}
+
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	if (!j_sql_commit_transaction(thread_variables->sql_backend, error))
+	if (!j_sql_commit_transaction(backend_data, thread_variables->sql_backend, batch->semantics, batch->write, error))
 	{
+		batch->started = FALSE;
+		batch->write = FALSE;
 		goto _error;
 	}
 
 	batch->open = FALSE;
+	batch->started = FALSE;
+	batch->write = FALSE;
 
 	return TRUE;
 
@@ -526,18 +874,75 @@ _backend_batch_abort(gpointer backend_data, JSqlBatch* batch, GError** error)
 
 	g_return_val_if_fail(batch->open, FALSE);
 
+	if (batch->started)
+	{
+		if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
+		{
+			goto _error;
+		}
+
+		if (!j_sql_abort_transaction(backend_data, thread_variables->sql_backend, batch->write, error))
+		{
+			batch->started = FALSE;
+			batch->write = FALSE;
+			goto _error;
+		}
+	}
+
+	batch->open = FALSE;
+	batch->aborted = TRUE;
+	batch->started = FALSE;
+	batch->write = FALSE;
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Makes sure the batch's transaction has been started for writing before its first modification.
+ * This allows backends with a single writer to run read-only batches concurrently.
+ **/
+static gboolean
+_backend_batch_write(gpointer backend_data, JSqlBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JThreadVariables* thread_variables = NULL;
+
+	if (!batch->started)
+	{
+		return _backend_batch_begin(backend_data, batch, TRUE, error);
+	}
+
+	// Batches are serialized in single-threaded mode, so the read transaction can be used for writing
+	if (!SQL_WRITE_UPGRADE || batch->write || SQL_MODE(backend_data) == SQL_MODE_SINGLE_THREAD)
+	{
+		return TRUE;
+	}
+
+	g_return_val_if_fail(batch->open, FALSE);
+
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	if (!j_sql_abort_transaction(thread_variables->sql_backend, error))
+	// The batch has read before writing, which happens rarely since batches usually consist of one kind of operation
+	// The read transaction has to be finished first, its snapshot might be outdated once the write lock has been acquired
+	// Reads that happened before are therefore not atomic with the writes, atomic batches are started for writing by _backend_batch_read()
+	if (!j_sql_commit_transaction(backend_data, thread_variables->sql_backend, batch->semantics, FALSE, error))
 	{
 		goto _error;
 	}
 
-	batch->open = FALSE;
-	batch->aborted = TRUE;
+	if (!j_sql_start_transaction(backend_data, thread_variables->sql_backend, batch->semantics, TRUE, error))
+	{
+		goto _error;
+	}
+
+	batch->write = TRUE;
 
 	return TRUE;
 
@@ -558,7 +963,7 @@ backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* s
 	g_return_val_if_fail(semantics != NULL, FALSE);
 	g_return_val_if_fail(_batch != NULL, FALSE);
 
-	if (SQL_MODE == SQL_MODE_SINGLE_THREAD)
+	if (SQL_MODE(backend_data) == SQL_MODE_SINGLE_THREAD)
 		G_LOCK(sql_backend_lock);
 
 	batch = *_batch = g_new(JSqlBatch, 1);
@@ -577,7 +982,7 @@ _error:
 	j_semantics_unref(batch->semantics);
 	g_free(batch);
 
-	if (SQL_MODE == SQL_MODE_SINGLE_THREAD)
+	if (SQL_MODE(backend_data) == SQL_MODE_SINGLE_THREAD)
 		G_UNLOCK(sql_backend_lock);
 
 	return FALSE;
@@ -600,7 +1005,7 @@ backend_batch_execute(gpointer backend_data, gpointer _batch, GError** error)
 	j_semantics_unref(batch->semantics);
 	g_free(batch);
 
-	if (SQL_MODE == SQL_MODE_SINGLE_THREAD)
+	if (SQL_MODE(backend_data) == SQL_MODE_SINGLE_THREAD)
 		G_UNLOCK(sql_backend_lock);
 
 	return TRUE;
@@ -609,7 +1014,7 @@ _error:
 	j_semantics_unref(batch->semantics);
 	g_free(batch);
 
-	if (SQL_MODE == SQL_MODE_SINGLE_THREAD)
+	if (SQL_MODE(backend_data) == SQL_MODE_SINGLE_THREAD)
 		G_UNLOCK(sql_backend_lock);
 
 	return FALSE;
@@ -1012,8 +1417,13 @@ _backend_schema_get(gpointer backend_data, gpointer _batch, gchar const* name, b
 		goto _error;
 	}
 
-	prepared = getCachePrepared(backend_data, batch->namespace, name, "_schema_get", error);
-
+	if (G_UNLIKELY(!_backend_batch_read(backend_data, batch, error)))
+	{
+		goto _error;
+	}
+
+	prepared = getCachePrepared(backend_data, batch->namespace, name, "_schema_get", error);
+
 	if (G_UNLIKELY(!prepared))
 	{
 		goto _error;
@@ -1283,6 +1693,11 @@ backend_insert(gpointer backend_data, gpointer _batch, gchar const* name, bson_t
 		goto _error;
 	}
 
+	if (G_UNLIKELY(!_backend_batch_write(backend_data, batch, error)))
+	{
+		goto _error;
+	}
+
 	if (G_UNLIKELY(!j_bson_has_enough_keys(metadata, 1, error)))
 	{
 		goto _error;
@@ -1480,32 +1895,88 @@ _error2:
 	return FALSE;
 }
 
+/**
+ * Compares two ids, see backend_insert_many().
+ **/
+static gint
+compare_ids(gconstpointer a, gconstpointer b)
+{
+	guint32 id_a = *((guint32 const*)a);
+	guint32 id_b = *((guint32 const*)b);
+
+	return (id_a > id_b) - (id_a < id_b);
+}
+
 static gboolean
-build_selector_query(gpointer backend_data, bson_iter_t* iter, GString* sql, JDBSelectorMode mode, guint* variables_count, GArray* arr_types_in, GHashTable* schema_cache, GError** error)
+backend_insert_many(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* entries, bson_t* ids, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JDBSelectorMode mode_child;
-	gboolean equals;
+	JSqlBatch* batch = _batch;
+	bson_iter_t iter;
+	bson_t ids_array;
+	JDBType type;
+	gpointer type_tmp;
+	GHashTable* schema_cache = NULL;
+	GString* sql = NULL;
+	JSqlCacheSQLPrepared* prepared = NULL;
+	JSqlCacheSQLPrepared* prepared_id = NULL;
+	JThreadVariables* thread_variables = NULL;
+	g_autoptr(GArray) arr_types_in = NULL;
+	g_autoptr(GArray) id_arr_types_out = NULL;
+	g_autoptr(GArray) column_types = NULL;
+	g_autoptr(GArray) columns = NULL;
+	g_autoptr(GArray) returned_ids = NULL;
+	g_autoptr(GPtrArray) column_names = NULL;
+	g_autoptr(GByteArray) shape = NULL;
 	gboolean has_next;
-	JDBSelectorOperator op;
-	gboolean first = TRUE;
-	const char* string_tmp;
+	gboolean found;
+	guint32 count = 0;
+	guint32 done = 0;
+	guint32 max_rows;
 	JDBTypeValue value;
-	bson_iter_t iterchild;
-	JThreadVariables* thread_variables = NULL;
-	JDBType type;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(entries != NULL, FALSE);
+	g_return_val_if_fail(ids != NULL, FALSE);
+
+	arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
+	id_arr_types_out = g_array_new(FALSE, FALSE, sizeof(JDBType));
+	column_types = g_array_new(FALSE, FALSE, sizeof(JDBType));
+	columns = g_array_new(FALSE, FALSE, sizeof(bson_iter_t));
+	returned_ids = g_array_new(FALSE, FALSE, sizeof(guint32));
+	column_names = g_ptr_array_new();
+
+	type = J_DB_TYPE_UINT32;
+	g_array_append_val(id_arr_types_out, type);
 
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	g_string_append(sql, "( ");
+	if (G_UNLIKELY(!_backend_batch_write(backend_data, batch, error)))
+	{
+		goto _error;
+	}
+
+	if (!(schema_cache = getCacheSchema(backend_data, batch, name, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, entries, error)))
+	{
+		goto _error;
+	}
 
 	while (TRUE)
 	{
-		if (G_UNLIKELY(!j_bson_iter_next(iter, &has_next, error)))
+		gchar const* key;
+		bson_iter_t column;
+
+		if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
 		{
 			goto _error;
 		}
@@ -1515,171 +1986,346 @@ build_selector_query(gpointer backend_data, bson_iter_t* iter, GString* sql, JDB
 			break;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_key_equals(iter, "_mode", &equals, error)))
+		key = j_bson_iter_key(&iter, error);
+
+		if (G_UNLIKELY(!key))
 		{
 			goto _error;
 		}
 
-		if (equals)
+		if (g_strcmp0(key, "_count") == 0)
 		{
+			if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+
+			count = value.val_uint32;
 			continue;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+		if (G_UNLIKELY(!g_hash_table_lookup_extended(schema_cache, key, NULL, &type_tmp)))
 		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
 			goto _error;
 		}
 
-		if (!first)
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &column, error)))
 		{
-			switch (mode)
+			goto _error;
+		}
+
+		type = GPOINTER_TO_INT(type_tmp);
+		g_array_append_val(column_types, type);
+		g_array_append_val(columns, column);
+		g_ptr_array_add(column_names, (gpointer)key);
+	}
+
+	if (G_UNLIKELY(!columns->len || !count))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_NO_VARIABLE_SET, "no variable set");
+		goto _error;
+	}
+
+	if (!SQL_RETURNING_ID(backend_data))
+	{
+		prepared_id = getCachePrepared(backend_data, batch->namespace, name, "_insert_id", error);
+
+		if (G_UNLIKELY(!prepared_id))
+		{
+			goto _error;
+		}
+
+		if (!prepared_id->initialized)
+		{
+			if (G_UNLIKELY(!j_sql_prepare(thread_variables->sql_backend, SQL_LAST_INSERT_ID_STRING, &prepared_id->stmt, NULL, id_arr_types_out, error)))
 			{
-				case J_DB_SELECTOR_MODE_AND:
-					g_string_append(sql, " AND ");
-					break;
-				case J_DB_SELECTOR_MODE_OR:
-					g_string_append(sql, " OR ");
-					break;
-				default:
-					g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_OPERATOR_INVALID, "operator invalid");
-					goto _error;
+				goto _error;
 			}
+
+			prepared_id->initialized = TRUE;
 		}
+	}
 
-		first = FALSE;
+	// Without RETURNING, the ids of a multi-row INSERT can only be derived from the last insert id if they are consecutive
+	max_rows = (SQL_RETURNING_ID(backend_data) || SQL_CONSECUTIVE_IDS(backend_data)) ? MAX(SQL_MAX_VARIABLES / columns->len, 1) : 1;
 
-		if (j_bson_iter_find(&iterchild, "_mode", NULL))
+	if (G_UNLIKELY(!j_bson_append_array_begin(ids, "_value", &ids_array, error)))
+	{
+		goto _error;
+	}
+
+	while (done < count)
+	{
+		guint32 rows;
+
+		// Rows are inserted in power-of-two chunks to bound the number of cached statements per column set
+		rows = MIN(max_rows, count - done);
+		rows = 1 << (g_bit_storage(rows) - 1);
+
+		shape = shape_new('I', batch->namespace, name);
+		g_byte_array_append(shape, (guint8 const*)&rows, sizeof(rows));
+
+		for (guint j = 0; j < columns->len; j++)
 		{
-			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_UINT32, &value, error)))
+			gchar const* column_name = g_ptr_array_index(column_names, j);
+
+			g_byte_array_append(shape, (guint8 const*)column_name, strlen(column_name) + 1);
+		}
+
+		prepared = getCacheStatement(backend_data, batch->namespace, name, g_steal_pointer(&shape), error);
+
+		if (G_UNLIKELY(!prepared))
+		{
+			goto _error;
+		}
+
+		if (!prepared->initialized)
+		{
+			sql = g_string_new(NULL);
+			g_string_append_printf(sql, "INSERT INTO " SQL_QUOTE "%s_%s" SQL_QUOTE " (", batch->namespace, name);
+
+			for (guint j = 0; j < columns->len; j++)
 			{
-				goto _error;
+				g_string_append_printf(sql, "%s" SQL_QUOTE "%s" SQL_QUOTE, j ? ", " : "", (gchar const*)g_ptr_array_index(column_names, j));
 			}
 
-			mode_child = value.val_uint32;
+			g_string_append(sql, ") VALUES");
 
-			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			for (guint32 r = 0; r < rows; r++)
 			{
-				goto _error;
+				g_string_append(sql, r ? ", (" : " (");
+
+				for (guint j = 0; j < columns->len; j++)
+				{
+					g_string_append(sql, j ? ", ?" : "?");
+				}
+
+				g_string_append(sql, ")");
 			}
 
-			if (G_UNLIKELY(!build_selector_query(backend_data, &iterchild, sql, mode_child, variables_count, arr_types_in, schema_cache, error)))
+			if (SQL_RETURNING_ID(backend_data))
+			{
+				g_string_append(sql, " RETURNING _id");
+			}
+
+			g_array_set_size(arr_types_in, 0);
+
+			for (guint32 r = 0; r < rows; r++)
+			{
+				g_array_append_vals(arr_types_in, column_types->data, column_types->len);
+			}
+
+			prepared->sql = sql;
+			sql = NULL;
+			prepared->variables_count = rows * columns->len;
+
+			if (G_UNLIKELY(!j_sql_prepare(thread_variables->sql_backend, prepared->sql->str, &prepared->stmt, arr_types_in, (SQL_RETURNING_ID(backend_data)) ? id_arr_types_out : NULL, error)))
 			{
 				goto _error;
 			}
+
+			prepared->initialized = TRUE;
 		}
-		else
+
+		for (guint32 r = 0; r < rows; r++)
 		{
-			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			for (guint j = 0; j < columns->len; j++)
 			{
-				goto _error;
+				bson_iter_t* column = &g_array_index(columns, bson_iter_t, j);
+				guint index = r * columns->len + j + 1;
+
+				type = g_array_index(column_types, JDBType, j);
+
+				if (G_UNLIKELY(!j_bson_iter_next(column, &has_next, error)))
+				{
+					goto _error;
+				}
+
+				if (G_UNLIKELY(!has_next))
+				{
+					g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_BSON_NOT_ENOUGH_KEYS, "bson not enough keys");
+					goto _error;
+				}
+
+				if (BSON_ITER_HOLDS_NULL(column))
+				{
+					if (G_UNLIKELY(!j_sql_bind_null(thread_variables->sql_backend, prepared->stmt, index, error)))
+					{
+						goto _error;
+					}
+
+					continue;
+				}
+
+				if (G_UNLIKELY(!j_bson_iter_value(column, type, &value, error)))
+				{
+					goto _error;
+				}
+
+				if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, index, type, &value, error)))
+				{
+					goto _error;
+				}
 			}
+		}
 
-			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_name", error)))
+		g_array_set_size(returned_ids, 0);
+
+		if (SQL_RETURNING_ID(backend_data))
+		{
+			while (TRUE)
 			{
-				goto _error;
+				if (G_UNLIKELY(!j_sql_step(thread_variables->sql_backend, prepared->stmt, &found, error)))
+				{
+					j_sql_reset(thread_variables->sql_backend, prepared->stmt, NULL);
+					goto _error;
+				}
+
+				if (!found)
+				{
+					break;
+				}
+
+				if (G_UNLIKELY(!j_sql_column(thread_variables->sql_backend, prepared->stmt, 0, J_DB_TYPE_UINT32, &value, error)))
+				{
+					j_sql_reset(thread_variables->sql_backend, prepared->stmt, NULL);
+					goto _error;
+				}
+
+				g_array_append_val(returned_ids, value.val_uint32);
 			}
 
-			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_STRING, &value, error)))
+			if (G_UNLIKELY(!j_sql_reset(thread_variables->sql_backend, prepared->stmt, error)))
 			{
 				goto _error;
 			}
 
-			string_tmp = value.val_string;
-			g_string_append_printf(sql, SQL_QUOTE "%s" SQL_QUOTE " ", string_tmp);
+			// The order of the returned rows is undefined, but ids are assigned in ascending order of the inserted rows
+			g_array_sort(returned_ids, compare_ids);
+		}
+		else
+		{
+			guint32 first_id;
 
-			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			if (G_UNLIKELY(!j_sql_step_and_reset_check_done(thread_variables->sql_backend, prepared->stmt, error)))
 			{
 				goto _error;
 			}
 
-			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_value", error)))
+			if (G_UNLIKELY(!j_sql_step(thread_variables->sql_backend, prepared_id->stmt, &found, error)))
 			{
 				goto _error;
 			}
 
-			type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
-			g_array_append_val(arr_types_in, type);
-
-			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			if (!found)
 			{
+				g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
 				goto _error;
 			}
 
-			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_operator", error)))
+			if (G_UNLIKELY(!j_sql_column(thread_variables->sql_backend, prepared_id->stmt, 0, J_DB_TYPE_UINT32, &value, error)))
 			{
 				goto _error;
 			}
 
-			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_UINT32, &value, error)))
+			if (G_UNLIKELY(!j_sql_reset(thread_variables->sql_backend, prepared_id->stmt, error)))
 			{
 				goto _error;
 			}
 
-			op = value.val_uint32;
+			// The backend reports either the first or the last id, the ids of multiple rows have been checked to be consecutive
+			first_id = SQL_LAST_INSERT_ID_IS_FIRST ? value.val_uint32 : value.val_uint32 - rows + 1;
 
-			switch (op)
+			for (guint32 r = 0; r < rows; r++)
 			{
-				case J_DB_SELECTOR_OPERATOR_LT:
-					g_string_append(sql, "<");
-					break;
-				case J_DB_SELECTOR_OPERATOR_LE:
-					g_string_append(sql, "<=");
-					break;
-				case J_DB_SELECTOR_OPERATOR_GT:
-					g_string_append(sql, ">");
-					break;
-				case J_DB_SELECTOR_OPERATOR_GE:
-					g_string_append(sql, ">=");
-					break;
-				case J_DB_SELECTOR_OPERATOR_EQ:
-					g_string_append(sql, "=");
-					break;
-				case J_DB_SELECTOR_OPERATOR_NE:
-					g_string_append(sql, "!=");
-					break;
-				default:
-					g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_COMPARATOR_INVALID, "comparator invalid");
-					goto _error;
+				value.val_uint32 = first_id + r;
+				g_array_append_val(returned_ids, value.val_uint32);
 			}
+		}
 
-			(*variables_count)++;
+		if (G_UNLIKELY(returned_ids->len != rows))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
+			goto _error;
+		}
 
-			g_string_append_printf(sql, " ?");
+		for (guint32 r = 0; r < rows; r++)
+		{
+			char key_buf[16];
+			const char* key;
+
+			if (G_UNLIKELY(!j_bson_array_generate_key(done + r, &key, key_buf, sizeof(key_buf), error)))
+			{
+				goto _error;
+			}
+
+			value.val_uint32 = g_array_index(returned_ids, guint32, r);
+
+			if (G_UNLIKELY(!j_bson_append_value(&ids_array, key, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
 		}
+
+		done += rows;
 	}
 
-	g_string_append(sql, " )");
+	if (G_UNLIKELY(!j_bson_append_array_end(ids, &ids_array, error)))
+	{
+		goto _error;
+	}
 
-	if (first)
+	value.val_uint32 = J_DB_TYPE_UINT32;
+
+	if (G_UNLIKELY(!j_bson_append_value(ids, "_value_type", J_DB_TYPE_UINT32, &value, error)))
 	{
-		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SELECTOR_EMPTY, "selector empty");
 		goto _error;
 	}
 
 	return TRUE;
 
 _error:
-	return FALSE;
-}
+	if (sql)
+	{
+		g_string_free(sql, TRUE);
+	}
 
-static gboolean
-bind_selector_query(gpointer backend_data, bson_iter_t* iter, JSqlCacheSQLPrepared* prepared, guint* variables_count, GHashTable* schema_cache, GError** error)
-{
-	J_TRACE_FUNCTION(NULL);
+	if (G_UNLIKELY(!_backend_batch_abort(backend_data, batch, NULL)))
+	{
+		goto _error2;
+	}
 
-	bson_iter_t iterchild;
-	JDBTypeValue value;
-	JDBType type;
+	return FALSE;
+
+_error2:
+	/*something failed very hard*/
+	return FALSE;
+}
+
+static gboolean
+build_selector_query(gpointer backend_data, bson_iter_t* iter, GString* sql, JDBSelectorMode mode, guint* variables_count, GArray* arr_types_in, GHashTable* schema_cache, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSelectorMode mode_child;
+	gchar const* key;
 	gboolean has_next;
-	gboolean equals;
+	JDBSelectorOperator op;
+	gboolean first = TRUE;
+	const char* string_tmp;
+	JDBTypeValue value;
+	bson_iter_t iterchild;
 	JThreadVariables* thread_variables = NULL;
-	char const* string_tmp;
+	JDBType type;
 
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
+	g_string_append(sql, "( ");
+
 	while (TRUE)
 	{
 		if (G_UNLIKELY(!j_bson_iter_next(iter, &has_next, error)))
@@ -1692,12 +2338,13 @@ bind_selector_query(gpointer backend_data, bson_iter_t* iter, JSqlCacheSQLPrepar
 			break;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_key_equals(iter, "_mode", &equals, error)))
+		if (G_UNLIKELY(!(key = j_bson_iter_key(iter, error))))
 		{
 			goto _error;
 		}
 
-		if (equals)
+		// Conditions are numbered, all other keys describe the query, for example, its mode or sort keys
+		if (key[0] == '_')
 		{
 			continue;
 		}
@@ -1707,22 +2354,45 @@ bind_selector_query(gpointer backend_data, bson_iter_t* iter, JSqlCacheSQLPrepar
 			goto _error;
 		}
 
+		if (!first)
+		{
+			switch (mode)
+			{
+				case J_DB_SELECTOR_MODE_AND:
+					g_string_append(sql, " AND ");
+					break;
+				case J_DB_SELECTOR_MODE_OR:
+					g_string_append(sql, " OR ");
+					break;
+				default:
+					g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_OPERATOR_INVALID, "operator invalid");
+					goto _error;
+			}
+		}
+
+		first = FALSE;
+
 		if (j_bson_iter_find(&iterchild, "_mode", NULL))
 		{
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+
+			mode_child = value.val_uint32;
+
 			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
 			{
 				goto _error;
 			}
 
-			if (G_UNLIKELY(!bind_selector_query(backend_data, &iterchild, prepared, variables_count, schema_cache, error)))
+			if (G_UNLIKELY(!build_selector_query(backend_data, &iterchild, sql, mode_child, variables_count, arr_types_in, schema_cache, error)))
 			{
 				goto _error;
 			}
 		}
 		else
 		{
-			(*variables_count)++;
-
 			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
 			{
 				goto _error;
@@ -1739,6 +2409,7 @@ bind_selector_query(gpointer backend_data, bson_iter_t* iter, JSqlCacheSQLPrepar
 			}
 
 			string_tmp = value.val_string;
+			g_string_append_printf(sql, SQL_QUOTE "%s" SQL_QUOTE " ", string_tmp);
 
 			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
 			{
@@ -1751,227 +2422,331 @@ bind_selector_query(gpointer backend_data, bson_iter_t* iter, JSqlCacheSQLPrepar
 			}
 
 			type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
+			g_array_append_val(arr_types_in, type);
 
-			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, type, &value, error)))
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
 			{
 				goto _error;
 			}
 
-			if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, *variables_count, type, &value, error)))
+			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_operator", error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_UINT32, &value, error)))
 			{
 				goto _error;
 			}
+
+			op = value.val_uint32;
+
+			switch (op)
+			{
+				case J_DB_SELECTOR_OPERATOR_LT:
+					g_string_append(sql, "<");
+					break;
+				case J_DB_SELECTOR_OPERATOR_LE:
+					g_string_append(sql, "<=");
+					break;
+				case J_DB_SELECTOR_OPERATOR_GT:
+					g_string_append(sql, ">");
+					break;
+				case J_DB_SELECTOR_OPERATOR_GE:
+					g_string_append(sql, ">=");
+					break;
+				case J_DB_SELECTOR_OPERATOR_EQ:
+					g_string_append(sql, "=");
+					break;
+				case J_DB_SELECTOR_OPERATOR_NE:
+					g_string_append(sql, "!=");
+					break;
+				default:
+					g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_COMPARATOR_INVALID, "comparator invalid");
+					goto _error;
+			}
+
+			(*variables_count)++;
+
+			g_string_append_printf(sql, " ?");
 		}
 	}
 
+	g_string_append(sql, " )");
+
+	if (first)
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_SELECTOR_EMPTY, "selector empty");
+		goto _error;
+	}
+
 	return TRUE;
 
 _error:
 	return FALSE;
 }
+
 static gboolean
-_backend_query(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, gpointer* iterator, GError** error)
+bind_selector_query(gpointer backend_data, bson_iter_t* iter, JSqlCacheSQLPrepared* prepared, guint* variables_count, GHashTable* schema_cache, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JDBSelectorMode mode_child;
-	JSqlBatch* batch = _batch;
-	gboolean sql_found;
+	bson_iter_t iterchild;
 	JDBTypeValue value;
-	guint count = 0;
-	bson_iter_t iter;
-	guint variables_count;
-	JSqlCacheSQLPrepared* prepared = NULL;
-	GString* sql = g_string_new(NULL);
-	JSqlIterator* iteratorOut = NULL;
-	JThreadVariables* thread_variables = NULL;
-	g_autoptr(GArray) arr_types_in = NULL;
-	g_autoptr(GArray) arr_types_out = NULL;
 	JDBType type;
-	GHashTable* schema_cache = NULL;
-
-	if (!(schema_cache = getCacheSchema(backend_data, batch, name, error)))
-	{
-		goto _error;
-	}
-
-	arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
-	arr_types_out = g_array_new(FALSE, FALSE, sizeof(JDBType));
-	type = J_DB_TYPE_UINT32;
-	g_array_append_val(arr_types_out, type);
+	gboolean has_next;
+	gchar const* key;
+	JThreadVariables* thread_variables = NULL;
+	char const* string_tmp;
 
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	*iterator = NULL;
-	iteratorOut = g_new(JSqlIterator, 1);
-	iteratorOut->namespace = g_strdup(batch->namespace);
-	iteratorOut->name = g_strdup(name);
-	iteratorOut->index = 0;
-	iteratorOut->arr = g_array_new(FALSE, FALSE, sizeof(guint64));
-
-	g_string_append_printf(sql, "SELECT DISTINCT _id FROM " SQL_QUOTE "%s_%s" SQL_QUOTE, batch->namespace, name);
-
-	if (selector && j_bson_has_enough_keys(selector, 2, NULL))
+	while (TRUE)
 	{
-		g_string_append(sql, " WHERE ");
-
-		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+		if (G_UNLIKELY(!j_bson_iter_next(iter, &has_next, error)))
 		{
 			goto _error;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_find(&iter, "_mode", error)))
+		if (!has_next)
 		{
-			goto _error;
+			break;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT32, &value, error)))
+		if (G_UNLIKELY(!(key = j_bson_iter_key(iter, error))))
 		{
 			goto _error;
 		}
 
-		mode_child = value.val_uint32;
+		// Conditions are numbered, all other keys describe the query, for example, its mode or sort keys
+		if (key[0] == '_')
+		{
+			continue;
+		}
 
-		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+		if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
 		{
 			goto _error;
 		}
 
-		variables_count = 0;
-
-		if (G_UNLIKELY(!build_selector_query(backend_data, &iter, sql, mode_child, &variables_count, arr_types_in, schema_cache, error)))
+		if (j_bson_iter_find(&iterchild, "_mode", NULL))
 		{
-			goto _error;
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!bind_selector_query(backend_data, &iterchild, prepared, variables_count, schema_cache, error)))
+			{
+				goto _error;
+			}
 		}
-	}
+		else
+		{
+			(*variables_count)++;
 
-	prepared = getCachePrepared(backend_data, batch->namespace, name, sql->str, error);
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			{
+				goto _error;
+			}
 
-	if (G_UNLIKELY(!prepared))
-	{
-		goto _error;
-	}
+			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_name", error)))
+			{
+				goto _error;
+			}
 
-	if (!prepared->initialized)
-	{
-		prepared->sql = g_string_new(sql->str);
-		prepared->variables_count = variables_count;
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
 
-		if (G_UNLIKELY(!j_sql_prepare(thread_variables->sql_backend, prepared->sql->str, &prepared->stmt, arr_types_in, arr_types_out, error)))
-		{
-			goto _error;
-		}
+			string_tmp = value.val_string;
 
-		prepared->initialized = TRUE;
-	}
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(iter, &iterchild, error)))
+			{
+				goto _error;
+			}
 
-	if (selector && j_bson_has_enough_keys(selector, 2, NULL))
-	{
-		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
-		{
-			goto _error;
-		}
+			if (G_UNLIKELY(!j_bson_iter_find(&iterchild, "_value", error)))
+			{
+				goto _error;
+			}
 
-		variables_count = 0;
+			type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
 
-		if (G_UNLIKELY(!bind_selector_query(backend_data, &iter, prepared, &variables_count, schema_cache, error)))
-		{
-			goto _error;
+			if (G_UNLIKELY(!j_bson_iter_value(&iterchild, type, &value, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, *variables_count, type, &value, error)))
+			{
+				goto _error;
+			}
 		}
 	}
 
-	while (TRUE)
-	{
-		if (G_UNLIKELY(!j_sql_step(thread_variables->sql_backend, prepared->stmt, &sql_found, error)))
-		{
-			goto _error;
-		}
+	return TRUE;
 
-		if (!sql_found)
-		{
-			break;
-		}
-		count++;
+_error:
+	return FALSE;
+}
 
-		if (G_UNLIKELY(!j_sql_column(thread_variables->sql_backend, prepared->stmt, 0, J_DB_TYPE_UINT32, &value, error)))
-		{
-			goto _error;
-		}
+/**
+ * Checks whether the selector contains any conditions.
+ * Besides the conditions, a selector contains its mode and, for queries, modifiers such as the requested fields.
+ **/
+static gboolean
+selector_has_conditions(bson_t const* selector)
+{
+	J_TRACE_FUNCTION(NULL);
 
-		g_array_append_val(iteratorOut->arr, value.val_uint32);
-	}
+	bson_iter_t iter;
+	gboolean has_next;
+	gchar const* key;
 
-	if (G_UNLIKELY(!j_sql_reset(thread_variables->sql_backend, prepared->stmt, error)))
+	if (selector == NULL || !j_bson_iter_init(&iter, selector, NULL))
 	{
-		goto _error;
+		return FALSE;
 	}
 
-	if (!count)
+	while (j_bson_iter_next(&iter, &has_next, NULL) && has_next)
 	{
-		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
-		goto _error;
+		if ((key = j_bson_iter_key(&iter, NULL)) != NULL && key[0] != '_')
+		{
+			return TRUE;
+		}
 	}
 
-	if (sql)
-	{
-		g_string_free(sql, TRUE);
-		sql = NULL;
-	}
+	return FALSE;
+}
+
+/**
+ * Appends the WHERE clause for a selector to sql.
+ * Nothing is appended for empty selectors, which match all entries.
+ **/
+static gboolean
+build_selector_where(gpointer backend_data, bson_t const* selector, GString* sql, guint* variables_count, GArray* arr_types_in, GHashTable* schema_cache, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSelectorMode mode_child;
+	JDBTypeValue value;
+	bson_iter_t iter;
+
+	if (!selector_has_conditions(selector))
+	{
+		return TRUE;
+	}
+
+	g_string_append(sql, " WHERE ");
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_find(&iter, "_mode", error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT32, &value, error)))
+	{
+		goto _error;
+	}
+
+	mode_child = value.val_uint32;
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+	{
+		goto _error;
+	}
 
-	*iterator = iteratorOut;
+	if (G_UNLIKELY(!build_selector_query(backend_data, &iter, sql, mode_child, variables_count, arr_types_in, schema_cache, error)))
+	{
+		goto _error;
+	}
 
 	return TRUE;
 
 _error:
-	if (sql)
+	return FALSE;
+}
+
+static gboolean
+bind_selector_where(gpointer backend_data, bson_t const* selector, JSqlCacheSQLPrepared* prepared, guint* variables_count, GHashTable* schema_cache, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_iter_t iter;
+
+	if (!selector_has_conditions(selector))
 	{
-		g_string_free(sql, TRUE);
+		return TRUE;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!bind_selector_query(backend_data, &iter, prepared, variables_count, schema_cache, error)))
+	{
+		goto _error;
 	}
 
-	freeJSqlIterator(iteratorOut);
+	return TRUE;
 
+_error:
 	return FALSE;
 }
+
 static gboolean
-backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, bson_t const* metadata, GError** error)
+backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, bson_t const* metadata, guint64* count, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	JSqlBatch* batch = _batch;
-	guint count;
 	gboolean equals;
 	JDBType type;
 	JDBTypeValue value;
-	JSqlIterator* iterator = NULL;
 	guint variables_count;
 	bson_iter_t iter;
 	guint index;
-	guint j;
 	GHashTable* schema_cache = NULL;
 	const char* string_tmp;
 	gboolean has_next;
-	GString* sql = g_string_new(NULL);
+	GString* sql = NULL;
 	JSqlCacheSQLPrepared* prepared = NULL;
 	GHashTable* variables_index = NULL;
 	JThreadVariables* thread_variables = NULL;
 	g_autoptr(GArray) arr_types_in = NULL;
+	g_autoptr(GByteArray) shape = NULL;
 
 	g_return_val_if_fail(name != NULL, FALSE);
 	g_return_val_if_fail(batch != NULL, FALSE);
 	g_return_val_if_fail(metadata != NULL, FALSE);
 	g_return_val_if_fail(selector != NULL, FALSE);
+	g_return_val_if_fail(count != NULL, FALSE);
 
-	if (!(schema_cache = getCacheSchema(backend_data, batch, name, error)))
+	*count = 0;
+
+	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
+	// Start writing before reading the schema, so that it cannot change until the batch is executed
+	if (G_UNLIKELY(!_backend_batch_write(backend_data, batch, error)))
+	{
+		goto _error;
+	}
 
-	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
+	if (!(schema_cache = getCacheSchema(backend_data, batch, name, error)))
 	{
 		goto _error;
 	}
@@ -1981,9 +2756,9 @@ backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t
 		goto _error;
 	}
 
+	// The shape consists of the names of the variables being set and the selector's shape
+	shape = shape_new('U', batch->namespace, name);
 	variables_count = 0;
-	variables_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
-	g_string_append_printf(sql, "UPDATE " SQL_QUOTE "%s_%s" SQL_QUOTE " SET ", batch->namespace, name);
 
 	if (G_UNLIKELY(!j_bson_iter_init(&iter, metadata, error)))
 	{
@@ -2012,12 +2787,6 @@ backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t
 			continue;
 		}
 
-		if (variables_count)
-		{
-			g_string_append(sql, ", ");
-		}
-
-		variables_count++;
 		string_tmp = j_bson_iter_key(&iter, error);
 
 		if (G_UNLIKELY(!string_tmp))
@@ -2025,18 +2794,29 @@ backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t
 			goto _error;
 		}
 
-		type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
-		g_array_append_val(arr_types_in, type);
-		g_string_append_printf(sql, SQL_QUOTE "%s" SQL_QUOTE " = ?", string_tmp);
-		g_hash_table_insert(variables_index, g_strdup(string_tmp), GINT_TO_POINTER(variables_count));
+		g_byte_array_append(shape, (guint8 const*)string_tmp, strlen(string_tmp) + 1);
+		variables_count++;
 	}
 
-	variables_count++;
-	type = J_DB_TYPE_UINT32;
-	g_array_append_val(arr_types_in, type);
-	g_string_append_printf(sql, " WHERE _id = ?");
-	g_hash_table_insert(variables_index, g_strdup("_id"), GINT_TO_POINTER(variables_count));
-	prepared = getCachePrepared(backend_data, batch->namespace, name, sql->str, error);
+	if (G_UNLIKELY(!variables_count))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_NO_VARIABLE_SET, "no variable set");
+		goto _error;
+	}
+
+	g_byte_array_append(shape, (guint8 const*)"", 1);
+
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!shape_append_selector(shape, &iter, error)))
+	{
+		goto _error;
+	}
+
+	prepared = getCacheStatement(backend_data, batch->namespace, name, g_steal_pointer(&shape), error);
 
 	if (G_UNLIKELY(!prepared))
 	{
@@ -2045,6 +2825,66 @@ backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t
 
 	if (!prepared->initialized)
 	{
+		arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
+		sql = g_string_new(NULL);
+		variables_count = 0;
+		variables_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+		g_string_append_printf(sql, "UPDATE " SQL_QUOTE "%s_%s" SQL_QUOTE " SET ", batch->namespace, name);
+
+		if (G_UNLIKELY(!j_bson_iter_init(&iter, metadata, error)))
+		{
+			goto _error;
+		}
+
+		while (TRUE)
+		{
+			if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
+			{
+				goto _error;
+			}
+
+			if (!has_next)
+			{
+				break;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_key_equals(&iter, "_index", &equals, error)))
+			{
+				goto _error;
+			}
+
+			if (equals)
+			{
+				continue;
+			}
+
+			if (variables_count)
+			{
+				g_string_append(sql, ", ");
+			}
+
+			variables_count++;
+			string_tmp = j_bson_iter_key(&iter, error);
+
+			if (G_UNLIKELY(!string_tmp))
+			{
+				goto _error;
+			}
+
+			type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
+			g_array_append_val(arr_types_in, type);
+			g_string_append_printf(sql, SQL_QUOTE "%s" SQL_QUOTE " = ?", string_tmp);
+			g_hash_table_insert(variables_index, g_strdup(string_tmp), GINT_TO_POINTER(variables_count));
+		}
+
+		// The selector's variables are numbered after the ones being set
+		index = variables_count;
+
+		if (G_UNLIKELY(!build_selector_where(backend_data, selector, sql, &index, arr_types_in, schema_cache, error)))
+		{
+			goto _error;
+		}
+
 		prepared->sql = sql;
 		sql = NULL;
 		prepared->variables_count = variables_count;
@@ -2059,207 +2899,638 @@ backend_update(gpointer backend_data, gpointer _batch, gchar const* name, bson_t
 		prepared->initialized = TRUE;
 	}
 
-	if (G_UNLIKELY(!_backend_query(backend_data, batch, name, selector, (gpointer*)&iterator, error)))
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, metadata, error)))
 	{
 		goto _error;
 	}
 
-	for (j = 0; j < iterator->arr->len; j++)
+	while (TRUE)
 	{
-		count = 0;
-		index = GPOINTER_TO_INT(g_hash_table_lookup(prepared->variables_index, "_id"));
+		if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
+		{
+			goto _error;
+		}
 
-		if (G_UNLIKELY(!index))
+		if (!has_next)
+		{
+			break;
+		}
+
+		if (G_UNLIKELY(!j_bson_iter_key_equals(&iter, "_index", &equals, error)))
 		{
-			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
 			goto _error;
 		}
 
-		value.val_uint32 = g_array_index(iterator->arr, guint64, j);
+		if (equals)
+		{
+			continue;
+		}
+
+		string_tmp = j_bson_iter_key(&iter, error);
 
-		if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, index, J_DB_TYPE_UINT32, &value, error)))
+		if (G_UNLIKELY(!string_tmp))
 		{
 			goto _error;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_init(&iter, metadata, error)))
+		type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
+		index = GPOINTER_TO_INT(g_hash_table_lookup(prepared->variables_index, string_tmp));
+
+		if (G_UNLIKELY(!index))
 		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
 			goto _error;
 		}
 
-		while (TRUE)
+		if (G_UNLIKELY(!j_bson_iter_value(&iter, type, &value, error)))
 		{
-			if (G_UNLIKELY(!j_bson_iter_next(&iter, &has_next, error)))
-			{
-				goto _error;
-			}
+			goto _error;
+		}
 
-			if (!has_next)
-			{
-				break;
-			}
+		if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, index, type, &value, error)))
+		{
+			goto _error;
+		}
+	}
 
-			string_tmp = j_bson_iter_key(&iter, error);
+	index = prepared->variables_count;
+
+	if (G_UNLIKELY(!bind_selector_where(backend_data, selector, prepared, &index, schema_cache, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_sql_step_and_reset_check_done(thread_variables->sql_backend, prepared->stmt, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_sql_changes(thread_variables->sql_backend, prepared->stmt, count, error)))
+	{
+		goto _error;
+	}
+
+	if (sql)
+	{
+		g_string_free(sql, TRUE);
+		sql = NULL;
+	}
+
+	if (variables_index)
+		g_hash_table_destroy(variables_index);
+
+	return TRUE;
+
+_error:
+	if (sql)
+	{
+		g_string_free(sql, TRUE);
+		sql = NULL;
+	}
+
+	if (variables_index)
+		g_hash_table_destroy(variables_index);
+
+	if (G_UNLIKELY(!_backend_batch_abort(backend_data, batch, NULL)))
+	{
+		goto _error2;
+	}
+
+	return FALSE;
+
+_error2:
+	/*something failed very hard*/
+	return FALSE;
+}
+
+static gboolean
+backend_delete(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, guint64* count, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JSqlBatch* batch = _batch;
+	guint variables_count;
+	GHashTable* schema_cache = NULL;
+	GString* sql = NULL;
+	JSqlCacheSQLPrepared* prepared = NULL;
+	JThreadVariables* thread_variables = NULL;
+	bson_iter_t iter;
+	g_autoptr(GArray) arr_types_in = NULL;
+	g_autoptr(GByteArray) shape = NULL;
+
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(count != NULL, FALSE);
+
+	*count = 0;
+
+	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
+	{
+		goto _error;
+	}
+
+	// Start writing before reading the schema, so that it cannot change until the batch is executed
+	if (G_UNLIKELY(!_backend_batch_write(backend_data, batch, error)))
+	{
+		goto _error;
+	}
+
+	if (!(schema_cache = getCacheSchema(backend_data, batch, name, error)))
+	{
+		goto _error;
+	}
+
+	shape = shape_new('D', batch->namespace, name);
+
+	if (selector != NULL)
+	{
+		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!shape_append_selector(shape, &iter, error)))
+		{
+			goto _error;
+		}
+	}
+
+	prepared = getCacheStatement(backend_data, batch->namespace, name, g_steal_pointer(&shape), error);
+
+	if (G_UNLIKELY(!prepared))
+	{
+		goto _error;
+	}
+
+	if (!prepared->initialized)
+	{
+		arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
+		sql = g_string_new(NULL);
+		g_string_append_printf(sql, "DELETE FROM " SQL_QUOTE "%s_%s" SQL_QUOTE, batch->namespace, name);
+		variables_count = 0;
+
+		if (G_UNLIKELY(!build_selector_where(backend_data, selector, sql, &variables_count, arr_types_in, schema_cache, error)))
+		{
+			goto _error;
+		}
+
+		prepared->sql = sql;
+		sql = NULL;
+		prepared->variables_count = variables_count;
+
+		if (G_UNLIKELY(!j_sql_prepare(thread_variables->sql_backend, prepared->sql->str, &prepared->stmt, arr_types_in, NULL, error)))
+		{
+			goto _error;
+		}
+
+		prepared->initialized = TRUE;
+	}
+
+	variables_count = 0;
+
+	if (G_UNLIKELY(!bind_selector_where(backend_data, selector, prepared, &variables_count, schema_cache, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_sql_step_and_reset_check_done(thread_variables->sql_backend, prepared->stmt, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_sql_changes(thread_variables->sql_backend, prepared->stmt, count, error)))
+	{
+		goto _error;
+	}
+
+	if (sql)
+	{
+		g_string_free(sql, TRUE);
+	}
+
+	return TRUE;
+
+_error:
+	if (sql)
+	{
+		g_string_free(sql, TRUE);
+	}
+
+	if (G_UNLIKELY(!_backend_batch_abort(backend_data, batch, NULL)))
+	{
+		goto _error2;
+	}
+
+	return FALSE;
+
+_error2:
+	/*something failed very hard*/
+	return FALSE;
+}
+
+/**
+ * Looks up the type of a column that is referenced by a query's modifiers.
+ **/
+static gboolean
+selector_column_type(GHashTable* schema_cache, gchar const* column, JDBType* type, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gpointer type_tmp;
+
+	if (G_UNLIKELY(!g_hash_table_lookup_extended(schema_cache, column, NULL, &type_tmp)))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
+		goto _error;
+	}
+
+	*type = GPOINTER_TO_INT(type_tmp);
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Appends a result column to a query.
+ **/
+static void
+append_result_column(GString* sql, gchar const* expression, gchar const* column, JDBType type, GHashTable* variables_index, guint* variables_count, GArray* arr_types_out)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_string_append_printf(sql, "%s%s", (*variables_count > 0) ? ", " : "", expression);
+	g_hash_table_insert(variables_index, GINT_TO_POINTER(*variables_count), g_strdup(column));
+	g_array_append_val(arr_types_out, type);
+	(*variables_count)++;
+}
+
+/**
+ * Appends the result columns of a query to sql.
+ * Aggregating queries return the grouped columns and one column per aggregate, all other queries return _id and the requested fields.
+ **/
+static gboolean
+build_selector_columns(bson_t const* selector, GString* sql, GHashTable* variables_index, guint* variables_count, GArray* arr_types_out, GHashTable* schema_cache, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	static gchar const* const aggregate_functions[] = { "COUNT", "MIN", "MAX", "SUM", "AVG" };
+
+	GHashTableIter schema_iter;
+	bson_iter_t iter;
+	bson_iter_t iter_child;
+	bson_iter_t iter_aggregate;
+	gboolean has_next;
+	gboolean aggregated = FALSE;
+	JDBTypeValue value;
+	JDBType type;
+	gpointer type_tmp;
+	gchar* string_tmp;
+
+	if (selector && j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_group_by", NULL))
+	{
+		aggregated = TRUE;
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		while (j_bson_iter_next(&iter_child, &has_next, NULL) && has_next)
+		{
+			g_autofree gchar* expression = NULL;
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!selector_column_type(schema_cache, value.val_string, &type, error)))
+			{
+				goto _error;
+			}
+
+			expression = g_strdup_printf(SQL_QUOTE "%s" SQL_QUOTE, value.val_string);
+			append_result_column(sql, expression, value.val_string, type, variables_index, variables_count, arr_types_out);
+		}
+	}
+
+	if (selector && j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_aggregate", NULL))
+	{
+		aggregated = TRUE;
+
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		for (guint i = 0; j_bson_iter_next(&iter_child, &has_next, NULL) && has_next; i++)
+		{
+			JDBAggregate aggregate;
+			gchar const* column = NULL;
+			JDBType column_type = J_DB_TYPE_UINT64;
+			g_autofree gchar* expression = NULL;
+			g_autofree gchar* key = NULL;
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_aggregate, error)))
+			{
+				goto _error;
+			}
+
+			if (j_bson_iter_find(&iter_aggregate, "_name", NULL))
+			{
+				if (G_UNLIKELY(!j_bson_iter_value(&iter_aggregate, J_DB_TYPE_STRING, &value, error)))
+				{
+					goto _error;
+				}
+
+				column = value.val_string;
+
+				if (G_UNLIKELY(!selector_column_type(schema_cache, column, &column_type, error)))
+				{
+					goto _error;
+				}
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_aggregate, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_find(&iter_aggregate, "_aggregate", error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_aggregate, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
+
+			aggregate = value.val_uint32;
+
+			if (G_UNLIKELY(!j_bson_aggregate_type(aggregate, column_type, &type, error)))
+			{
+				goto _error;
+			}
+
+			if (column != NULL)
+			{
+				expression = g_strdup_printf("%s(" SQL_QUOTE "%s" SQL_QUOTE ")", aggregate_functions[aggregate], column);
+			}
+			else
+			{
+				expression = g_strdup_printf("%s(*)", aggregate_functions[aggregate]);
+			}
+
+			// Aggregates are returned as _aggregate_<index>, see j_db_iterator_get_aggregate()
+			key = g_strdup_printf("_aggregate_%u", i);
+			append_result_column(sql, expression, key, type, variables_index, variables_count, arr_types_out);
+		}
+	}
+
+	if (aggregated)
+	{
+		return TRUE;
+	}
+
+	append_result_column(sql, "_id", "_id", J_DB_TYPE_UINT32, variables_index, variables_count, arr_types_out);
+
+	// Only fetch the requested fields if the query contains a projection
+	if (selector && j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_fields", NULL))
+	{
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		while (TRUE)
+		{
+			g_autofree gchar* expression = NULL;
+
+			if (G_UNLIKELY(!j_bson_iter_next(&iter_child, &has_next, error)))
+			{
+				goto _error;
+			}
+
+			if (!has_next)
+			{
+				break;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
+
+			if (strcmp(value.val_string, "_id") == 0)
+				continue;
+
+			if (G_UNLIKELY(!selector_column_type(schema_cache, value.val_string, &type, error)))
+			{
+				goto _error;
+			}
+
+			expression = g_strdup_printf(SQL_QUOTE "%s" SQL_QUOTE, value.val_string);
+			append_result_column(sql, expression, value.val_string, type, variables_index, variables_count, arr_types_out);
+		}
+
+		return TRUE;
+	}
+
+	g_hash_table_iter_init(&schema_iter, schema_cache);
+
+	while (g_hash_table_iter_next(&schema_iter, (gpointer*)&string_tmp, &type_tmp))
+	{
+		g_autofree gchar* expression = NULL;
+
+		if (strcmp(string_tmp, "_id") == 0)
+			continue;
+
+		expression = g_strdup_printf(SQL_QUOTE "%s" SQL_QUOTE, string_tmp);
+		append_result_column(sql, expression, string_tmp, GPOINTER_TO_INT(type_tmp), variables_index, variables_count, arr_types_out);
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Appends the GROUP BY, ORDER BY and LIMIT clauses of a query to sql.
+ * The limit and offset are bound as parameters so that the prepared statement can be reused.
+ **/
+static gboolean
+build_selector_modifiers(bson_t const* selector, GString* sql, guint* variables_count, GArray* arr_types_in, GHashTable* schema_cache, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_iter_t iter;
+	bson_iter_t iter_child;
+	bson_iter_t iter_order;
+	gboolean has_next;
+	JDBTypeValue value;
+	JDBType type;
+
+	if (selector == NULL)
+	{
+		return TRUE;
+	}
+
+	if (j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_group_by", NULL))
+	{
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		for (guint i = 0; j_bson_iter_next(&iter_child, &has_next, NULL) && has_next; i++)
+		{
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_STRING, &value, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!selector_column_type(schema_cache, value.val_string, &type, error)))
+			{
+				goto _error;
+			}
+
+			g_string_append_printf(sql, "%s" SQL_QUOTE "%s" SQL_QUOTE, (i == 0) ? " GROUP BY " : ", ", value.val_string);
+		}
+	}
+
+	if (j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_order", NULL))
+	{
+		if (G_UNLIKELY(!j_bson_iter_recurse_array(&iter, &iter_child, error)))
+		{
+			goto _error;
+		}
+
+		for (guint i = 0; j_bson_iter_next(&iter_child, &has_next, NULL) && has_next; i++)
+		{
+			gchar const* column;
+
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_order, error)))
+			{
+				goto _error;
+			}
+
+			if (G_UNLIKELY(!j_bson_iter_find(&iter_order, "_name", error)))
+			{
+				goto _error;
+			}
 
-			if (G_UNLIKELY(!string_tmp))
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_order, J_DB_TYPE_STRING, &value, error)))
 			{
 				goto _error;
 			}
 
-			type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
-			index = GPOINTER_TO_INT(g_hash_table_lookup(prepared->variables_index, string_tmp));
+			column = value.val_string;
 
-			if (G_UNLIKELY(!index))
+			if (G_UNLIKELY(!selector_column_type(schema_cache, column, &type, error)))
 			{
-				g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_VARIABLE_NOT_FOUND, "variable not found");
 				goto _error;
 			}
 
-			count++;
-
-			if (G_UNLIKELY(!j_bson_iter_value(&iter, type, &value, error)))
+			if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter_child, &iter_order, error)))
 			{
 				goto _error;
 			}
 
-			if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, index, type, &value, error)))
+			if (G_UNLIKELY(!j_bson_iter_find(&iter_order, "_order", error)))
 			{
 				goto _error;
 			}
-		}
 
-		if (G_UNLIKELY(!j_sql_step_and_reset_check_done(thread_variables->sql_backend, prepared->stmt, error)))
-		{
-			goto _error;
-		}
+			if (G_UNLIKELY(!j_bson_iter_value(&iter_order, J_DB_TYPE_UINT32, &value, error)))
+			{
+				goto _error;
+			}
 
-		if (!count)
-		{
-			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
-			goto _error;
+			g_string_append_printf(sql, "%s" SQL_QUOTE "%s" SQL_QUOTE " %s", (i == 0) ? " ORDER BY " : ", ", column, (value.val_uint32 == J_DB_SELECTOR_ORDER_DESCENDING) ? "DESC" : "ASC");
 		}
 	}
 
-	if (sql)
+	if (j_bson_iter_init(&iter, selector, NULL) && j_bson_iter_find(&iter, "_limit", NULL))
 	{
-		g_string_free(sql, TRUE);
-		sql = NULL;
+		g_string_append(sql, " LIMIT ? OFFSET ?");
+		type = J_DB_TYPE_UINT64;
+		g_array_append_val(arr_types_in, type);
+		g_array_append_val(arr_types_in, type);
+		*variables_count += 2;
 	}
 
-	if (variables_index)
-		g_hash_table_destroy(variables_index);
-
-	freeJSqlIterator(iterator);
-
 	return TRUE;
 
 _error:
-	if (sql)
-	{
-		g_string_free(sql, TRUE);
-		sql = NULL;
-	}
-
-	if (variables_index)
-		g_hash_table_destroy(variables_index);
-
-	freeJSqlIterator(iterator);
-
-	if (G_UNLIKELY(!_backend_batch_abort(backend_data, batch, NULL)))
-	{
-		goto _error2;
-	}
-
-	return FALSE;
-
-_error2:
-	/*something failed very hard*/
 	return FALSE;
 }
 
 static gboolean
-backend_delete(gpointer backend_data, gpointer _batch, gchar const* name, bson_t const* selector, GError** error)
+bind_selector_modifiers(gpointer backend_data, bson_t const* selector, JSqlCacheSQLPrepared* prepared, guint* variables_count, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JDBType type;
-	JSqlBatch* batch = _batch;
-	JSqlIterator* iterator = NULL;
-	guint j;
+	bson_iter_t iter;
 	JDBTypeValue value;
-	JSqlCacheSQLPrepared* prepared = NULL;
 	JThreadVariables* thread_variables = NULL;
-	g_autoptr(GArray) arr_types_in = NULL;
-
-	g_return_val_if_fail(name != NULL, FALSE);
-	g_return_val_if_fail(batch != NULL, FALSE);
 
-	arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
-	type = J_DB_TYPE_UINT32;
-	g_array_append_val(arr_types_in, type);
+	if (selector == NULL || !j_bson_iter_init(&iter, selector, NULL) || !j_bson_iter_find(&iter, "_limit", NULL))
+	{
+		return TRUE;
+	}
 
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	if (G_UNLIKELY(!_backend_query(backend_data, batch, name, selector, (gpointer*)&iterator, error)))
+	if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT64, &value, error)))
 	{
 		goto _error;
 	}
 
-	prepared = getCachePrepared(backend_data, batch->namespace, name, "_delete", error);
+	// A limit of 0 means no limit, which is expressed as the largest unsigned value (MySQL) or -1 (SQLite)
+	if (value.val_uint64 == 0)
+	{
+		value.val_uint64 = G_MAXUINT64;
+	}
 
-	if (G_UNLIKELY(!prepared))
+	(*variables_count)++;
+
+	if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, *variables_count, J_DB_TYPE_UINT64, &value, error)))
 	{
 		goto _error;
 	}
 
-	if (!prepared->initialized)
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
 	{
-		prepared->sql = g_string_new(NULL);
-		prepared->variables_count = 1;
-		g_string_append_printf(prepared->sql, "DELETE FROM " SQL_QUOTE "%s_%s" SQL_QUOTE " WHERE _id = ?", batch->namespace, name);
-
-		if (G_UNLIKELY(!j_sql_prepare(thread_variables->sql_backend, prepared->sql->str, &prepared->stmt, arr_types_in, NULL, error)))
-		{
-			goto _error;
-		}
-
-		prepared->initialized = TRUE;
+		goto _error;
 	}
 
-	for (j = 0; j < iterator->arr->len; j++)
+	if (G_UNLIKELY(!j_bson_iter_find(&iter, "_offset", error)))
 	{
-		value.val_uint32 = g_array_index(iterator->arr, guint64, j);
-
-		if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, 1, J_DB_TYPE_UINT32, &value, error)))
-		{
-			goto _error;
-		}
-
-		if (G_UNLIKELY(!j_sql_step_and_reset_check_done(thread_variables->sql_backend, prepared->stmt, error)))
-		{
-			goto _error;
-		}
+		goto _error;
 	}
 
-	freeJSqlIterator(iterator);
-
-	return TRUE;
+	if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT64, &value, error)))
+	{
+		goto _error;
+	}
 
-_error:
-	freeJSqlIterator(iterator);
+	(*variables_count)++;
 
-	if (G_UNLIKELY(!_backend_batch_abort(backend_data, batch, NULL)))
+	if (G_UNLIKELY(!j_sql_bind_value(thread_variables->sql_backend, prepared->stmt, *variables_count, J_DB_TYPE_UINT64, &value, error)))
 	{
-		goto _error2;
+		goto _error;
 	}
 
-	return FALSE;
+	return TRUE;
 
-_error2:
-	/*something failed very hard*/
+_error:
 	return FALSE;
 }
 
@@ -2268,151 +3539,118 @@ backend_query(gpointer backend_data, gpointer _batch, gchar const* name, bson_t
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JDBSelectorMode mode_child;
-	GHashTableIter schema_iter;
-
 	GHashTable* schema_cache = NULL;
-	JDBType type;
-	gpointer type_tmp;
 
 	JSqlBatch* batch = _batch;
-	bson_iter_t iter;
 	guint variables_count;
 	guint variables_count2;
-	JDBTypeValue value;
-	char* string_tmp;
 	JSqlCacheSQLPrepared* prepared = NULL;
 	GHashTable* variables_index = NULL;
-	GString* sql = g_string_new(NULL);
+	GString* sql = NULL;
 	JThreadVariables* thread_variables = NULL;
+	bson_iter_t iter;
 	g_autoptr(GArray) arr_types_in = NULL;
 	g_autoptr(GArray) arr_types_out = NULL;
+	g_autoptr(GByteArray) shape = NULL;
 
 	g_return_val_if_fail(name != NULL, FALSE);
 	g_return_val_if_fail(batch != NULL, FALSE);
 
-	arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
-	arr_types_out = g_array_new(FALSE, FALSE, sizeof(JDBType));
-
 	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
 	{
 		goto _error;
 	}
 
-	variables_index = g_hash_table_new_full(g_direct_hash, NULL, NULL, g_free);
-	g_string_append(sql, "SELECT ");
-	variables_count = 0;
-
-	if (!(schema_cache = getCacheSchema(backend_data, batch, name, error)))
+	if (G_UNLIKELY(!_backend_batch_read(backend_data, batch, error)))
 	{
 		goto _error;
 	}
 
-	g_hash_table_iter_init(&schema_iter, schema_cache);
-
-	g_string_append(sql, "_id");
-	g_hash_table_insert(variables_index, GINT_TO_POINTER(variables_count), g_strdup("_id"));
-	type = J_DB_TYPE_UINT32;
-	g_array_append_val(arr_types_out, type);
-	variables_count++;
-
-	while (g_hash_table_iter_next(&schema_iter, (gpointer*)&string_tmp, &type_tmp))
+	if (!(schema_cache = getCacheSchema(backend_data, batch, name, error)))
 	{
-		type = GPOINTER_TO_INT(type_tmp);
-
-		if (strcmp(string_tmp, "_id") == 0)
-			continue;
-
-		g_string_append_printf(sql, ", " SQL_QUOTE "%s" SQL_QUOTE, string_tmp);
-		g_hash_table_insert(variables_index, GINT_TO_POINTER(variables_count), g_strdup(string_tmp));
-		g_array_append_val(arr_types_out, type);
-		variables_count++;
+		goto _error;
 	}
 
-	g_string_append_printf(sql, " FROM " SQL_QUOTE "%s_%s" SQL_QUOTE, batch->namespace, name);
+	shape = shape_new('Q', batch->namespace, name);
 
-	if (selector && j_bson_has_enough_keys(selector, 2, NULL))
+	if (selector != NULL)
 	{
-		g_string_append(sql, " WHERE ");
-
 		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
 		{
 			goto _error;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_find(&iter, "_mode", error)))
+		if (G_UNLIKELY(!shape_append_selector(shape, &iter, error)))
 		{
 			goto _error;
 		}
+	}
 
-		if (G_UNLIKELY(!j_bson_iter_value(&iter, J_DB_TYPE_UINT32, &value, error)))
-		{
-			goto _error;
-		}
+	prepared = getCacheStatement(backend_data, batch->namespace, name, g_steal_pointer(&shape), error);
+
+	if (G_UNLIKELY(!prepared))
+	{
+		goto _error;
+	}
 
-		mode_child = value.val_uint32;
+	if (!prepared->initialized)
+	{
+		arr_types_in = g_array_new(FALSE, FALSE, sizeof(JDBType));
+		arr_types_out = g_array_new(FALSE, FALSE, sizeof(JDBType));
+		variables_index = g_hash_table_new_full(g_direct_hash, NULL, NULL, g_free);
+		sql = g_string_new("SELECT ");
+		variables_count = 0;
 
-		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
+		if (G_UNLIKELY(!build_selector_columns(selector, sql, variables_index, &variables_count, arr_types_out, schema_cache, error)))
 		{
 			goto _error;
 		}
 
+		g_string_append_printf(sql, " FROM " SQL_QUOTE "%s_%s" SQL_QUOTE, batch->namespace, name);
+
 		variables_count2 = 0;
 
-		if (G_UNLIKELY(!build_selector_query(backend_data, &iter, sql, mode_child, &variables_count2, arr_types_in, schema_cache, error)))
+		if (G_UNLIKELY(!build_selector_where(backend_data, selector, sql, &variables_count2, arr_types_in, schema_cache, error)))
 		{
 			goto _error;
 		}
-	}
 
-	prepared = getCachePrepared(backend_data, batch->namespace, name, sql->str, error);
-
-	if (G_UNLIKELY(!prepared))
-	{
-		goto _error;
-	}
+		if (G_UNLIKELY(!build_selector_modifiers(selector, sql, &variables_count2, arr_types_in, schema_cache, error)))
+		{
+			goto _error;
+		}
 
-	if (!prepared->initialized)
-	{
-		prepared->sql = g_string_new(sql->str);
+		prepared->sql = sql;
+		sql = NULL;
 		prepared->variables_index = variables_index;
+		variables_index = NULL;
+		prepared->variables_type = g_array_ref(arr_types_out);
 		prepared->variables_count = variables_count;
 
 		if (G_UNLIKELY(!j_sql_prepare(thread_variables->sql_backend, prepared->sql->str, &prepared->stmt, arr_types_in, arr_types_out, error)))
 		{
 			goto _error;
 		}
+
 		prepared->initialized = TRUE;
 	}
-	else
+
+	variables_count2 = 0;
+
+	if (G_UNLIKELY(!bind_selector_where(backend_data, selector, prepared, &variables_count2, schema_cache, error)))
 	{
-		g_hash_table_destroy(variables_index);
-		variables_index = NULL;
+		goto _error;
 	}
 
-	if (selector && j_bson_has_enough_keys(selector, 2, NULL))
+	if (G_UNLIKELY(!bind_selector_modifiers(backend_data, selector, prepared, &variables_count2, error)))
 	{
-		if (G_UNLIKELY(!j_bson_iter_init(&iter, selector, error)))
-		{
-			goto _error;
-		}
-
-		variables_count2 = 0;
-
-		if (G_UNLIKELY(!bind_selector_query(backend_data, &iter, prepared, &variables_count2, schema_cache, error)))
-		{
-			goto _error;
-		}
+		goto _error;
 	}
 
+	// The statement is released once backend_iterate runs out of elements
+	prepared->active = TRUE;
 	*iterator = prepared;
 
-	if (sql)
-	{
-		g_string_free(sql, TRUE);
-		sql = NULL;
-	}
-
 	return TRUE;
 
 _error:
@@ -2473,7 +3711,7 @@ backend_iterate(gpointer backend_data, gpointer _iterator, bson_t* metadata, GEr
 		for (i = 0; i < prepared->variables_count; i++)
 		{
 			string_tmp = g_hash_table_lookup(prepared->variables_index, GINT_TO_POINTER(i));
-			type = GPOINTER_TO_INT(g_hash_table_lookup(schema_cache, string_tmp));
+			type = g_array_index(prepared->variables_type, JDBType, i);
 
 			if (G_UNLIKELY(!j_sql_column(thread_variables->sql_backend, prepared->stmt, i, type, &value, error)))
 			{
@@ -2501,10 +3739,110 @@ _error:
 		goto _error3;
 	}
 
+	releaseCacheStatement(thread_variables, prepared);
+
+	return FALSE;
+
+_error3:
+	/*something failed very hard*/
+	releaseCacheStatement(thread_variables, prepared);
+
+	return FALSE;
+}
+
+static gboolean
+backend_iterate_row(gpointer backend_data, gpointer _iterator, JBackendDBRow* row, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	const char* string_tmp;
+	guint i;
+	gint index;
+	JDBTypeValue value;
+	JDBType type;
+	gboolean sql_found;
+	JSqlCacheSQLPrepared* prepared = _iterator;
+	gboolean found = FALSE;
+	JThreadVariables* thread_variables = NULL;
+
+	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, error))))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_sql_step(thread_variables->sql_backend, prepared->stmt, &sql_found, error)))
+	{
+		goto _error;
+	}
+
+	if (sql_found)
+	{
+		found = TRUE;
+
+		for (i = 0; i < prepared->variables_count; i++)
+		{
+			string_tmp = g_hash_table_lookup(prepared->variables_index, GINT_TO_POINTER(i));
+
+			if ((index = j_backend_db_row_get_index(row, string_tmp)) < 0)
+			{
+				continue;
+			}
+
+			type = g_array_index(prepared->variables_type, JDBType, i);
+
+			if (G_UNLIKELY(!j_sql_column(thread_variables->sql_backend, prepared->stmt, i, type, &value, error)))
+			{
+				goto _error;
+			}
+
+			// Values are copied, so strings and blobs may point into the statement's buffers
+			j_row_set_value(row, index, type, &value);
+		}
+	}
+
+	if (!found)
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	if (thread_variables == NULL || G_UNLIKELY(!j_sql_reset(thread_variables->sql_backend, prepared->stmt, NULL)))
+	{
+		goto _error3;
+	}
+
+	releaseCacheStatement(thread_variables, prepared);
+
 	return FALSE;
 
 _error3:
 	/*something failed very hard*/
+	if (thread_variables != NULL)
+	{
+		releaseCacheStatement(thread_variables, prepared);
+	}
+
 	return FALSE;
 }
+
+static void
+backend_iterate_free(gpointer backend_data, gpointer _iterator)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JSqlCacheSQLPrepared* prepared = _iterator;
+	JThreadVariables* thread_variables = NULL;
+
+	if (G_UNLIKELY(!(thread_variables = thread_variables_get(backend_data, NULL))))
+	{
+		return;
+	}
+
+	// Resetting the statement releases the locks it holds without stepping through the remaining rows
+	j_sql_reset(thread_variables->sql_backend, prepared->stmt, NULL);
+	releaseCacheStatement(thread_variables, prepared);
+}
 #endif
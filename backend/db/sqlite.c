@@ -19,8 +19,13 @@
 #include <julea-config.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <gmodule.h>
 
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
 #include <sqlite3.h>
 
 #include <julea.h>
@@ -31,22 +36,55 @@
 /*
  * sqlite supports multithread, but only for concurrent read. concurrent write requires manual retrys
  * to remove errors due to concurrent access.
- * if SQL_MODE is defined as SQL_MODE_SINGLE_THREAD, the sqlite-generic code uses a global lock to prevent concurrency errors.
- * otherwise there is no lock
+ * if SQL_MODE() is SQL_MODE_SINGLE_THREAD, the sqlite-generic code uses a global lock to prevent concurrency errors.
+ * otherwise there is no lock, readers run concurrently in WAL mode and writers are serialized by write_mutex.
+ * the mode is chosen per database in backend_init.
  */
 #define SQL_MODE_SINGLE_THREAD 0
 #define SQL_MODE_MULTI_THREAD 1
-#define SQL_MODE SQL_MODE_SINGLE_THREAD
+#define SQL_MODE(backend_data) (((JSQLiteData*)(backend_data))->multi_thread ? SQL_MODE_MULTI_THREAD : SQL_MODE_SINGLE_THREAD)
 
 #define SQL_AUTOINCREMENT_STRING " "
 #define SQL_UINT64_TYPE " UNSIGNED BIGINT "
 #define SQL_LAST_INSERT_ID_STRING " SELECT last_insert_rowid() "
+// last_insert_rowid() returns the id of the last row inserted by a multi-row INSERT
+#define SQL_LAST_INSERT_ID_IS_FIRST 0
+// RETURNING is supported since SQLite 3.35.0, the library used at runtime might be older than the headers
+#define SQL_RETURNING_ID(backend_data) (((JSQLiteData*)(backend_data))->returning_id)
+// New rowids are one larger than the largest one, the write lock is held while inserting
+#define SQL_CONSECUTIVE_IDS(backend_data) 1
+#define SQL_MAX_VARIABLES 999
+// Batches that read before writing have to upgrade their deferred transaction in multi-threaded mode, see _backend_batch_write()
+#define SQL_WRITE_UPGRADE 1
 #define SQL_QUOTE "\""
+// Maximum number of cached statements per connection, see getCacheStatement()
+#define SQL_STATEMENT_CACHE_SIZE(backend_data) (((JSQLiteData*)(backend_data))->statement_cache)
 
 struct JSQLiteData
 {
 	gchar* path;
 	sqlite3* db;
+
+	// Whether the database is accessed concurrently using per-thread connections in WAL mode
+	gboolean multi_thread;
+	guint busy_timeout;
+
+	// Maximum number of statements each connection caches for queries, updates, deletes and bulk inserts
+	guint statement_cache;
+
+	// Whether the SQLite library supports RETURNING
+	gboolean returning_id;
+
+	// Only one connection writes at a time, readers are not blocked in WAL mode
+	GMutex write_mutex[1];
+
+	// Commits requiring storage safety share a single sync of the WAL, protected by sync_mutex
+	GMutex sync_mutex[1];
+	GCond sync_cond[1];
+	guint64 sync_requested;
+	guint64 sync_completed;
+	gboolean syncing;
+	gboolean sync_ret;
 };
 
 typedef struct JSQLiteData JSQLiteData;
@@ -358,6 +396,20 @@ _error2:
 	return FALSE;
 }
 
+static gboolean
+j_sql_changes(sqlite3* backend_db, void* _stmt, guint64* changes, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	(void)_stmt;
+	(void)error;
+
+	// Rows matched by the last INSERT, UPDATE or DELETE statement, even if their values did not change
+	*changes = sqlite3_changes(backend_db);
+
+	return TRUE;
+}
+
 static void*
 j_sql_open(gpointer backend_data)
 {
@@ -393,6 +445,9 @@ j_sql_open(gpointer backend_data)
 		goto _error;
 	}
 
+	// Concurrent writers wait for each other instead of failing immediately
+	sqlite3_busy_timeout(backend_db, bd->busy_timeout);
+
 	return backend_db;
 
 _error:
@@ -409,48 +464,286 @@ j_sql_close(sqlite3* backend_db)
 	sqlite3_close(backend_db);
 }
 
+/**
+ * Maps the batch's safety to SQLite's synchronous setting.
+ * In WAL mode, storage safety is provided by j_sql_group_sync() after the commit.
+ **/
+static gchar const*
+j_sql_synchronous(JSQLiteData* bd, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	switch (j_semantics_get(semantics, J_SEMANTICS_SAFETY))
+	{
+		case J_SEMANTICS_SAFETY_STORAGE:
+			return (bd->multi_thread) ? "PRAGMA synchronous = NORMAL" : "PRAGMA synchronous = FULL";
+		case J_SEMANTICS_SAFETY_NETWORK:
+			return "PRAGMA synchronous = NORMAL";
+		case J_SEMANTICS_SAFETY_NONE:
+			return "PRAGMA synchronous = OFF";
+		default:
+			g_warn_if_reached();
+	}
+
+	return "PRAGMA synchronous = FULL";
+}
+
 static gboolean
-j_sql_start_transaction(sqlite3* backend_db, GError** error)
+j_sql_sync_wal(JSQLiteData* bd)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return j_sql_exec(backend_db, "BEGIN TRANSACTION", error);
+	g_autofree gchar* wal_path = NULL;
+	gboolean ret;
+	gint fd;
+
+	wal_path = g_strconcat(bd->path, "-wal", NULL);
+	fd = g_open(wal_path, O_RDONLY, 0);
+
+	if (fd == -1)
+	{
+		// Without a WAL there is nothing left to sync
+		return TRUE;
+	}
+
+	ret = (fdatasync(fd) == 0);
+	close(fd);
+
+	return ret;
 }
 
+/**
+ * Makes all commits up to now durable.
+ * Concurrent callers are handled by a single sync, which is started by whichever caller finds no sync in progress.
+ **/
 static gboolean
-j_sql_commit_transaction(sqlite3* backend_db, GError** error)
+j_sql_group_sync(JSQLiteData* bd)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return j_sql_exec(backend_db, "COMMIT", error);
+	guint64 ticket;
+	gboolean ret;
+
+	g_mutex_lock(bd->sync_mutex);
+
+	ticket = ++bd->sync_requested;
+
+	while (bd->sync_completed < ticket)
+	{
+		if (!bd->syncing)
+		{
+			// Become the leader and sync on behalf of all commits requested so far
+			guint64 target = bd->sync_requested;
+			gboolean sync_ret;
+
+			bd->syncing = TRUE;
+
+			g_mutex_unlock(bd->sync_mutex);
+
+			sync_ret = j_sql_sync_wal(bd);
+
+			g_mutex_lock(bd->sync_mutex);
+
+			bd->sync_completed = target;
+			bd->sync_ret = sync_ret;
+			bd->syncing = FALSE;
+			g_cond_broadcast(bd->sync_cond);
+		}
+		else
+		{
+			g_cond_wait(bd->sync_cond, bd->sync_mutex);
+		}
+	}
+
+	ret = bd->sync_ret;
+
+	g_mutex_unlock(bd->sync_mutex);
+
+	return ret;
 }
 
 static gboolean
-j_sql_abort_transaction(sqlite3* backend_db, GError** error)
+j_sql_start_transaction(gpointer backend_data, sqlite3* backend_db, JSemantics* semantics, gboolean write, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return j_sql_exec(backend_db, "ROLLBACK", error);
+	JSQLiteData* bd = backend_data;
+
+	if (write && bd->multi_thread)
+	{
+		g_mutex_lock(bd->write_mutex);
+	}
+
+	if (G_UNLIKELY(!j_sql_exec(backend_db, j_sql_synchronous(bd, semantics), error)))
+	{
+		goto _error;
+	}
+
+	// Write transactions take the write lock immediately, read transactions only use a snapshot
+	if (G_UNLIKELY(!j_sql_exec(backend_db, (write) ? "BEGIN IMMEDIATE" : "BEGIN DEFERRED", error)))
+	{
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	if (write && bd->multi_thread)
+	{
+		g_mutex_unlock(bd->write_mutex);
+	}
+
+	return FALSE;
+}
+
+static gboolean
+j_sql_commit_transaction(gpointer backend_data, sqlite3* backend_db, JSemantics* semantics, gboolean write, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JSQLiteData* bd = backend_data;
+	gboolean ret;
+
+	ret = j_sql_exec(backend_db, "COMMIT", error);
+
+	if (!ret)
+	{
+		// Do not leave the transaction open, the next batch could not be started otherwise
+		j_sql_exec(backend_db, "ROLLBACK", NULL);
+	}
+
+	if (write && bd->multi_thread)
+	{
+		g_mutex_unlock(bd->write_mutex);
+
+		if (ret && j_semantics_get(semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_STORAGE)
+		{
+			ret = j_sql_group_sync(bd);
+
+			if (!ret)
+			{
+				g_set_error_literal(error, J_BACKEND_SQL_ERROR, J_BACKEND_SQL_ERROR_FAILED, "sql sync failed");
+			}
+		}
+	}
+
+	return ret;
+}
+
+static gboolean
+j_sql_abort_transaction(gpointer backend_data, sqlite3* backend_db, gboolean write, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JSQLiteData* bd = backend_data;
+	gboolean ret;
+
+	ret = j_sql_exec(backend_db, "ROLLBACK", error);
+
+	if (write && bd->multi_thread)
+	{
+		g_mutex_unlock(bd->write_mutex);
+	}
+
+	return ret;
 }
 
 #include "sql-generic.c"
 
 static gboolean
-backend_init(gchar const* _path, gpointer* backend_data)
+backend_init(gchar const* path, gpointer* backend_data)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	JSQLiteData* bd;
+	g_auto(GStrv) split = NULL;
+	gchar const* options;
+
+	g_return_val_if_fail(path != NULL, FALSE);
 
 	bd = g_slice_new(JSQLiteData);
-	bd->path = g_strdup(_path);
 	bd->db = NULL;
+	bd->multi_thread = FALSE;
+	bd->busy_timeout = 5000;
+	bd->statement_cache = 256;
+	bd->returning_id = (sqlite3_libversion_number() >= 3035000);
+	bd->sync_requested = 0;
+	bd->sync_completed = 0;
+	bd->syncing = FALSE;
+	bd->sync_ret = TRUE;
+
+	g_mutex_init(bd->write_mutex);
+	g_mutex_init(bd->sync_mutex);
+	g_cond_init(bd->sync_cond);
+
+	// The path can be followed by options (path:option=value:...), :memory: contains colons itself
+	if (g_str_has_prefix(path, ":memory:"))
+	{
+		bd->path = g_strdup(":memory:");
+		options = path + strlen(":memory:");
+	}
+	else
+	{
+		options = strchr(path, ':');
+		bd->path = (options != NULL) ? g_strndup(path, options - path) : g_strdup(path);
+		options = (options != NULL) ? options + 1 : "";
+	}
+
+	split = g_strsplit(options, ":", 0);
+
+	for (guint i = 0; split[i] != NULL; i++)
+	{
+		g_auto(GStrv) option = NULL;
+
+		if (split[i][0] == '\0')
+		{
+			continue;
+		}
+
+		option = g_strsplit(split[i], "=", 2);
+
+		if (g_strcmp0(option[0], "multi-thread") == 0)
+		{
+			bd->multi_thread = TRUE;
+		}
+		else if (g_strcmp0(option[0], "busy-timeout") == 0 && option[1] != NULL)
+		{
+			bd->busy_timeout = g_ascii_strtoull(option[1], NULL, 10);
+		}
+		else if (g_strcmp0(option[0], "statement-cache") == 0 && option[1] != NULL)
+		{
+			bd->statement_cache = g_ascii_strtoull(option[1], NULL, 10);
+		}
+		else
+		{
+			g_warning("Unknown SQLite option %s.", split[i]);
+		}
+	}
 
 	if (g_strcmp0(bd->path, ":memory:") == 0)
 	{
+		if (bd->multi_thread)
+		{
+			// The shared cache uses table-level locks and in-memory databases do not support WAL
+			g_warning("SQLite option multi-thread is not supported for in-memory databases.");
+			bd->multi_thread = FALSE;
+		}
+
 		// Hold an extra reference to the shared in-memory database to make sure it is not freed.
 		sqlite3_open_v2("file:julea-db", &(bd->db), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI | SQLITE_OPEN_MEMORY | SQLITE_OPEN_SHAREDCACHE, NULL);
 	}
+	else if (bd->multi_thread)
+	{
+		// Switch to WAL before any concurrent connection exists, the mode is stored in the database file.
+		// The extra connection also keeps the WAL around until the backend is finalized.
+		bd->db = j_sql_open(bd);
+
+		if (bd->db == NULL || !j_sql_exec(bd->db, "PRAGMA journal_mode = WAL", NULL))
+		{
+			g_warning("SQLite could not enable WAL mode for %s.", bd->path);
+			bd->multi_thread = FALSE;
+		}
+	}
 
 	*backend_data = bd;
 
@@ -473,10 +766,25 @@ backend_fini(gpointer backend_data)
 		sqlite3_close(bd->db);
 	}
 
+	g_mutex_clear(bd->write_mutex);
+	g_mutex_clear(bd->sync_mutex);
+	g_cond_clear(bd->sync_cond);
+
 	g_free(bd->path);
 	g_slice_free(JSQLiteData, bd);
 }
 
+static gboolean
+backend_iterate_pageable(gpointer backend_data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JSQLiteData* bd = backend_data;
+
+	// Without WAL, an open statement's read lock blocks writers on other connections
+	return bd->multi_thread;
+}
+
 static JBackend sqlite_backend = {
 	.type = J_BACKEND_TYPE_DB,
 	.component = J_BACKEND_COMPONENT_SERVER,
@@ -487,10 +795,14 @@ static JBackend sqlite_backend = {
 		.backend_schema_get = backend_schema_get,
 		.backend_schema_delete = backend_schema_delete,
 		.backend_insert = backend_insert,
+		.backend_insert_many = backend_insert_many,
 		.backend_update = backend_update,
 		.backend_delete = backend_delete,
 		.backend_query = backend_query,
 		.backend_iterate = backend_iterate,
+		.backend_iterate_row = backend_iterate_row,
+		.backend_iterate_free = backend_iterate_free,
+		.backend_iterate_pageable = backend_iterate_pageable,
 		.backend_batch_start = backend_batch_start,
 		.backend_batch_execute = backend_batch_execute,
 	},
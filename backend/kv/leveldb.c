@@ -25,10 +25,80 @@
 
 #include <julea.h>
 
+/**
+ * A namespaced key.
+ * Short keys are built in the stack buffer, only long keys require an allocation.
+ **/
+struct JLevelDBKey
+{
+	gchar* data;
+	gsize len;
+	gchar* heap;
+	gchar stack[256];
+};
+
+typedef struct JLevelDBKey JLevelDBKey;
+
+enum JLevelDBAtomicType
+{
+	J_LEVELDB_ATOMIC_PUT_IF_ABSENT,
+	J_LEVELDB_ATOMIC_COMPARE_AND_SWAP,
+	J_LEVELDB_ATOMIC_FETCH_ADD
+};
+
+typedef enum JLevelDBAtomicType JLevelDBAtomicType;
+
+/**
+ * An atomic operation that has been queued in a batch.
+ * Atomic operations are evaluated when the batch is executed, their results are returned afterwards.
+ **/
+struct JLevelDBAtomic
+{
+	JLevelDBAtomicType type;
+	/**
+	 * The writes queued before this operation, which have to be written first.
+	 **/
+	leveldb_writebatch_t* preceding;
+	/**
+	 * The namespaced key, stored in the batch's key buffer.
+	 **/
+	gsize key_offset;
+	gsize key_len;
+	gchar* value;
+	guint32 len;
+	gchar* expected;
+	guint32 expected_len;
+	gint64 delta;
+
+	gboolean* result;
+	gint64* previous;
+};
+
+typedef struct JLevelDBAtomic JLevelDBAtomic;
+
 struct JLevelDBBatch
 {
+	/**
+	 * The writes queued after the last atomic operation.
+	 **/
 	leveldb_writebatch_t* batch;
-	gchar* namespace;
+	/**
+	 * The queued atomic operations (JLevelDBAtomic).
+	 **/
+	GArray* atomics;
+	/**
+	 * The keys of the queued atomic operations, which are stored consecutively to avoid an allocation per operation.
+	 **/
+	GByteArray* keys;
+	/**
+	 * The stripes of all keys written by the batch, as a bit mask.
+	 **/
+	guint32 stripes;
+	/**
+	 * The key prefix ("namespace:").
+	 **/
+	gchar* prefix;
+	gsize prefix_len;
 	JSemantics* semantics;
 };
 
@@ -41,6 +111,13 @@ struct JLevelDBData
 	leveldb_readoptions_t* read_options;
 	leveldb_writeoptions_t* write_options;
 	leveldb_writeoptions_t* write_options_sync;
+
+	/**
+	 * Serializes writes to the same keys.
+	 * LevelDB does not offer transactions, so batches lock the stripes of all keys they write while they are executed.
+	 * This makes atomic operations atomic with respect to all other writes.
+	 **/
+	GMutex stripe_mutex[16];
 };
 
 typedef struct JLevelDBData JLevelDBData;
@@ -49,12 +126,197 @@ struct JLevelDBIterator
 {
 	leveldb_iterator_t* iterator;
 	gboolean first;
-	gchar* prefix;
+	/**
+	 * The seek prefix ("namespace:prefix").
+	 **/
+	JLevelDBKey prefix;
 	gsize namespace_len;
 };
 
 typedef struct JLevelDBIterator JLevelDBIterator;
 
+static void
+namespace_key_init(JLevelDBKey* nskey, gchar const* prefix, gsize prefix_len, gchar const* key)
+{
+	gsize key_len;
+
+	key_len = strlen(key) + 1;
+
+	nskey->len = prefix_len + key_len;
+	nskey->heap = NULL;
+	nskey->data = nskey->stack;
+
+	if (nskey->len > sizeof(nskey->stack))
+	{
+		nskey->heap = g_malloc(nskey->len);
+		nskey->data = nskey->heap;
+	}
+
+	memcpy(nskey->data, prefix, prefix_len);
+	memcpy(nskey->data + prefix_len, key, key_len);
+}
+
+/**
+ * Builds the seek prefix used by iterators, the namespace's terminator is replaced by the separator.
+ **/
+static void
+namespace_prefix_init(JLevelDBKey* nskey, gchar const* namespace, gsize namespace_len, gchar const* prefix)
+{
+	namespace_key_init(nskey, namespace, namespace_len + 1, prefix);
+	nskey->data[namespace_len] = ':';
+}
+
+static void
+namespace_key_clear(JLevelDBKey* nskey)
+{
+	g_free(nskey->heap);
+}
+
+static leveldb_writeoptions_t*
+get_write_options(JLevelDBData* bd, JLevelDBBatch* batch)
+{
+	if (j_semantics_get(batch->semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_STORAGE)
+	{
+		return bd->write_options_sync;
+	}
+
+	return bd->write_options;
+}
+
+static guint32
+get_stripe(JLevelDBData* bd, gchar const* nskey)
+{
+	return 1 << (g_str_hash(nskey) % G_N_ELEMENTS(bd->stripe_mutex));
+}
+
+/**
+ * Locks stripes in ascending order, so batches cannot deadlock.
+ **/
+static void
+lock_stripes(JLevelDBData* bd, guint32 stripes)
+{
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		if (stripes & (1 << i))
+		{
+			g_mutex_lock(&(bd->stripe_mutex[i]));
+		}
+	}
+}
+
+static void
+unlock_stripes(JLevelDBData* bd, guint32 stripes)
+{
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		if (stripes & (1 << i))
+		{
+			g_mutex_unlock(&(bd->stripe_mutex[i]));
+		}
+	}
+}
+
+static void
+atomic_clear(gpointer data)
+{
+	JLevelDBAtomic* atomic = data;
+
+	leveldb_writebatch_destroy(atomic->preceding);
+	g_free(atomic->value);
+	g_free(atomic->expected);
+}
+
+static JLevelDBAtomic*
+atomic_queue(JLevelDBData* bd, JLevelDBBatch* batch, JLevelDBAtomicType type, gchar const* key)
+{
+	JLevelDBAtomic atomic;
+	gsize key_len;
+
+	key_len = strlen(key) + 1;
+
+	atomic.type = type;
+	atomic.preceding = batch->batch;
+	atomic.key_offset = batch->keys->len;
+	atomic.key_len = batch->prefix_len + key_len;
+	atomic.value = NULL;
+	atomic.len = 0;
+	atomic.expected = NULL;
+	atomic.expected_len = 0;
+	atomic.delta = 0;
+	atomic.result = NULL;
+	atomic.previous = NULL;
+
+	// Writes queued after the atomic operation have to be written after it has been applied
+	batch->batch = leveldb_writebatch_create();
+	g_byte_array_append(batch->keys, (guint8 const*)batch->prefix, batch->prefix_len);
+	g_byte_array_append(batch->keys, (guint8 const*)key, key_len);
+	batch->stripes |= get_stripe(bd, (gchar const*)batch->keys->data + atomic.key_offset);
+
+	g_array_append_val(batch->atomics, atomic);
+
+	return &g_array_index(batch->atomics, JLevelDBAtomic, batch->atomics->len - 1);
+}
+
+/**
+ * Applies an atomic operation, the stripe of its key has to be locked.
+ **/
+static gboolean
+atomic_apply(JLevelDBData* bd, JLevelDBBatch* batch, JLevelDBAtomic* atomic)
+{
+	g_autofree gchar* result = NULL;
+	g_autofree gchar* leveldb_error = NULL;
+	gchar const* key;
+	gsize result_len;
+	guint64 counter = 0;
+
+	key = (gchar const*)batch->keys->data + atomic->key_offset;
+	result = leveldb_get(bd->db, bd->read_options, key, atomic->key_len, &result_len, &leveldb_error);
+
+	if (leveldb_error != NULL)
+	{
+		return FALSE;
+	}
+
+	switch (atomic->type)
+	{
+		case J_LEVELDB_ATOMIC_PUT_IF_ABSENT:
+			if (result == NULL)
+			{
+				leveldb_put(bd->db, get_write_options(bd, batch), key, atomic->key_len, atomic->value, atomic->len, &leveldb_error);
+				*(atomic->result) = (leveldb_error == NULL);
+			}
+			break;
+		case J_LEVELDB_ATOMIC_COMPARE_AND_SWAP:
+			if (result != NULL && result_len == atomic->expected_len && memcmp(result, atomic->expected, atomic->expected_len) == 0)
+			{
+				leveldb_put(bd->db, get_write_options(bd, batch), key, atomic->key_len, atomic->value, atomic->len, &leveldb_error);
+				*(atomic->result) = (leveldb_error == NULL);
+			}
+			break;
+		case J_LEVELDB_ATOMIC_FETCH_ADD:
+			// Values that are not 8 bytes long are not counters
+			if (result != NULL && result_len != sizeof(counter))
+			{
+				return FALSE;
+			}
+
+			if (result != NULL)
+			{
+				memcpy(&counter, result, sizeof(counter));
+			}
+
+			*(atomic->previous) = GUINT64_FROM_LE(counter);
+			counter = GUINT64_TO_LE((guint64)(*(atomic->previous)) + (guint64)atomic->delta);
+
+			leveldb_put(bd->db, get_write_options(bd, batch), key, atomic->key_len, (gchar const*)&counter, sizeof(counter), &leveldb_error);
+			break;
+		default:
+			g_warn_if_reached();
+	}
+
+	return (leveldb_error == NULL);
+}
+
 static gboolean
 backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* backend_batch)
 {
@@ -68,7 +330,13 @@ backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* s
 	batch = g_slice_new(JLevelDBBatch);
 
 	batch->batch = leveldb_writebatch_create();
-	batch->namespace = g_strdup(namespace);
+	batch->atomics = g_array_new(FALSE, FALSE, sizeof(JLevelDBAtomic));
+	batch->keys = g_byte_array_new();
+	batch->stripes = 0;
+	batch->prefix = g_strconcat(namespace, ":", NULL);
+
+	g_array_set_clear_func(batch->atomics, atomic_clear);
+	batch->prefix_len = strlen(batch->prefix);
 	batch->semantics = j_semantics_ref(semantics);
 
 	*backend_batch = batch;
@@ -82,41 +350,57 @@ backend_batch_execute(gpointer backend_data, gpointer backend_batch)
 	JLevelDBBatch* batch = backend_batch;
 	JLevelDBData* bd = backend_data;
 
-	g_autofree gchar* leveldb_error = NULL;
-
-	leveldb_writeoptions_t* write_options = bd->write_options;
+	gboolean ret = TRUE;
 
 	g_return_val_if_fail(backend_batch != NULL, FALSE);
 
-	if (j_semantics_get(batch->semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_STORAGE)
+	lock_stripes(bd, batch->stripes);
+
+	// Atomic operations split the batch, the parts are written in order while all stripes are locked
+	for (guint i = 0; i < batch->atomics->len && ret; i++)
 	{
-		write_options = bd->write_options_sync;
+		JLevelDBAtomic* atomic = &g_array_index(batch->atomics, JLevelDBAtomic, i);
+		g_autofree gchar* leveldb_error = NULL;
+
+		leveldb_write(bd->db, get_write_options(bd, batch), atomic->preceding, &leveldb_error);
+		ret = (leveldb_error == NULL) && atomic_apply(bd, batch, atomic);
+	}
+
+	if (ret)
+	{
+		g_autofree gchar* leveldb_error = NULL;
+
+		leveldb_write(bd->db, get_write_options(bd, batch), batch->batch, &leveldb_error);
+		ret = (leveldb_error == NULL);
 	}
 
-	leveldb_write(bd->db, write_options, batch->batch, &leveldb_error);
+	unlock_stripes(bd, batch->stripes);
 
 	j_semantics_unref(batch->semantics);
-	g_free(batch->namespace);
+	g_free(batch->prefix);
+	g_array_unref(batch->atomics);
+	g_byte_array_unref(batch->keys);
 	leveldb_writebatch_destroy(batch->batch);
 	g_slice_free(JLevelDBBatch, batch);
 
-	return (leveldb_error == NULL);
+	return ret;
 }
 
 static gboolean
 backend_put(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer value, guint32 len)
 {
 	JLevelDBBatch* batch = backend_batch;
-	g_autofree gchar* nskey = NULL;
-
-	(void)backend_data;
+	JLevelDBData* bd = backend_data;
+	JLevelDBKey nskey;
 
 	g_return_val_if_fail(backend_batch != NULL, FALSE);
 	g_return_val_if_fail(key != NULL, FALSE);
 	g_return_val_if_fail(value != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
-	leveldb_writebatch_put(batch->batch, nskey, strlen(nskey) + 1, value, len);
+	namespace_key_init(&nskey, batch->prefix, batch->prefix_len, key);
+	leveldb_writebatch_put(batch->batch, nskey.data, nskey.len, value, len);
+	batch->stripes |= get_stripe(bd, nskey.data);
+	namespace_key_clear(&nskey);
 
 	return TRUE;
 }
@@ -125,15 +409,16 @@ static gboolean
 backend_delete(gpointer backend_data, gpointer backend_batch, gchar const* key)
 {
 	JLevelDBBatch* batch = backend_batch;
-	g_autofree gchar* nskey = NULL;
-
-	(void)backend_data;
+	JLevelDBData* bd = backend_data;
+	JLevelDBKey nskey;
 
 	g_return_val_if_fail(backend_batch != NULL, FALSE);
 	g_return_val_if_fail(key != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
-	leveldb_writebatch_delete(batch->batch, nskey, strlen(nskey) + 1);
+	namespace_key_init(&nskey, batch->prefix, batch->prefix_len, key);
+	leveldb_writebatch_delete(batch->batch, nskey.data, nskey.len);
+	batch->stripes |= get_stripe(bd, nskey.data);
+	namespace_key_clear(&nskey);
 
 	return TRUE;
 }
@@ -143,7 +428,7 @@ backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpo
 {
 	JLevelDBBatch* batch = backend_batch;
 	JLevelDBData* bd = backend_data;
-	g_autofree gchar* nskey = NULL;
+	JLevelDBKey nskey;
 	g_autofree gpointer result = NULL;
 	gsize result_len;
 
@@ -152,8 +437,9 @@ backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpo
 	g_return_val_if_fail(value != NULL, FALSE);
 	g_return_val_if_fail(len != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
-	result = leveldb_get(bd->db, bd->read_options, nskey, strlen(nskey) + 1, &result_len, NULL);
+	namespace_key_init(&nskey, batch->prefix, batch->prefix_len, key);
+	result = leveldb_get(bd->db, bd->read_options, nskey.data, nskey.len, &result_len, NULL);
+	namespace_key_clear(&nskey);
 
 	if (result != NULL)
 	{
@@ -168,6 +454,76 @@ backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpo
 	return (result != NULL);
 }
 
+static gboolean
+backend_put_if_absent(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer value, guint32 len, gboolean* inserted)
+{
+	JLevelDBBatch* batch = backend_batch;
+	JLevelDBData* bd = backend_data;
+	JLevelDBAtomic* atomic;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(inserted != NULL, FALSE);
+
+	atomic = atomic_queue(bd, batch, J_LEVELDB_ATOMIC_PUT_IF_ABSENT, key);
+#if GLIB_CHECK_VERSION(2, 68, 0)
+	atomic->value = g_memdup2(value, len);
+#else
+	atomic->value = g_memdup(value, len);
+#endif
+	atomic->len = len;
+	atomic->result = inserted;
+
+	return TRUE;
+}
+
+static gboolean
+backend_compare_and_swap(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer expected, guint32 expected_len, gconstpointer value, guint32 len, gboolean* swapped)
+{
+	JLevelDBBatch* batch = backend_batch;
+	JLevelDBData* bd = backend_data;
+	JLevelDBAtomic* atomic;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(expected != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(swapped != NULL, FALSE);
+
+	atomic = atomic_queue(bd, batch, J_LEVELDB_ATOMIC_COMPARE_AND_SWAP, key);
+#if GLIB_CHECK_VERSION(2, 68, 0)
+	atomic->value = g_memdup2(value, len);
+	atomic->expected = g_memdup2(expected, expected_len);
+#else
+	atomic->value = g_memdup(value, len);
+	atomic->expected = g_memdup(expected, expected_len);
+#endif
+	atomic->len = len;
+	atomic->expected_len = expected_len;
+	atomic->result = swapped;
+
+	return TRUE;
+}
+
+static gboolean
+backend_fetch_add(gpointer backend_data, gpointer backend_batch, gchar const* key, gint64 delta, gint64* previous)
+{
+	JLevelDBBatch* batch = backend_batch;
+	JLevelDBData* bd = backend_data;
+	JLevelDBAtomic* atomic;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(previous != NULL, FALSE);
+
+	atomic = atomic_queue(bd, batch, J_LEVELDB_ATOMIC_FETCH_ADD, key);
+	atomic->delta = delta;
+	atomic->previous = previous;
+
+	return TRUE;
+}
+
 static gboolean
 backend_get_all(gpointer backend_data, gchar const* namespace, gpointer* backend_iterator)
 {
@@ -185,8 +541,8 @@ backend_get_all(gpointer backend_data, gchar const* namespace, gpointer* backend
 		iterator = g_slice_new(JLevelDBIterator);
 		iterator->iterator = it;
 		iterator->first = TRUE;
-		iterator->prefix = g_strdup_printf("%s:", namespace);
 		iterator->namespace_len = strlen(namespace) + 1;
+		namespace_prefix_init(&(iterator->prefix), namespace, iterator->namespace_len - 1, "");
 
 		*backend_iterator = iterator;
 	}
@@ -212,8 +568,8 @@ backend_get_by_prefix(gpointer backend_data, gchar const* namespace, gchar const
 		iterator = g_slice_new(JLevelDBIterator);
 		iterator->iterator = it;
 		iterator->first = TRUE;
-		iterator->prefix = g_strdup_printf("%s:%s", namespace, prefix);
 		iterator->namespace_len = strlen(namespace) + 1;
+		namespace_prefix_init(&(iterator->prefix), namespace, iterator->namespace_len - 1, prefix);
 
 		*backend_iterator = iterator;
 	}
@@ -234,7 +590,7 @@ backend_iterate(gpointer backend_data, gpointer backend_iterator, gchar const**
 
 	if (iterator->first)
 	{
-		leveldb_iter_seek(iterator->iterator, iterator->prefix, strlen(iterator->prefix));
+		leveldb_iter_seek(iterator->iterator, iterator->prefix.data, iterator->prefix.len - 1);
 		iterator->first = FALSE;
 	}
 	else
@@ -249,7 +605,7 @@ backend_iterate(gpointer backend_data, gpointer backend_iterator, gchar const**
 
 		key_ = leveldb_iter_key(iterator->iterator, &tmp);
 
-		if (!g_str_has_prefix(key_, iterator->prefix))
+		if (!g_str_has_prefix(key_, iterator->prefix.data))
 		{
 			goto out;
 		}
@@ -262,7 +618,7 @@ backend_iterate(gpointer backend_data, gpointer backend_iterator, gchar const**
 	}
 
 out:
-	g_free(iterator->prefix);
+	namespace_key_clear(&(iterator->prefix));
 	leveldb_iter_destroy(iterator->iterator);
 	g_slice_free(JLevelDBIterator, iterator);
 
@@ -283,6 +639,12 @@ backend_init(gchar const* path, gpointer* backend_data)
 	g_mkdir_with_parents(dirname, 0700);
 
 	bd = g_slice_new(JLevelDBData);
+
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		g_mutex_init(&(bd->stripe_mutex[i]));
+	}
+
 	bd->read_options = leveldb_readoptions_create();
 	bd->write_options = leveldb_writeoptions_create();
 	bd->write_options_sync = leveldb_writeoptions_create();
@@ -325,6 +687,11 @@ backend_fini(gpointer backend_data)
 		leveldb_close(bd->db);
 	}
 
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		g_mutex_clear(&(bd->stripe_mutex[i]));
+	}
+
 	g_slice_free(JLevelDBData, bd);
 }
 
@@ -341,7 +708,10 @@ static JBackend leveldb_backend = {
 		.backend_get = backend_get,
 		.backend_get_all = backend_get_all,
 		.backend_get_by_prefix = backend_get_by_prefix,
-		.backend_iterate = backend_iterate }
+		.backend_iterate = backend_iterate,
+		.backend_put_if_absent = backend_put_if_absent,
+		.backend_compare_and_swap = backend_compare_and_swap,
+		.backend_fetch_add = backend_fetch_add }
 };
 
 G_MODULE_EXPORT
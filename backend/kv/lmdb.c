@@ -25,11 +25,66 @@
 
 #include <julea.h>
 
+enum JLMDBOperationType
+{
+	J_LMDB_OPERATION_PUT,
+	J_LMDB_OPERATION_DELETE,
+	J_LMDB_OPERATION_PUT_IF_ABSENT,
+	J_LMDB_OPERATION_COMPARE_AND_SWAP,
+	J_LMDB_OPERATION_FETCH_ADD
+};
+
+typedef enum JLMDBOperationType JLMDBOperationType;
+
+/**
+ * A write operation that has been queued in a batch.
+ * Write operations are only applied when the batch is committed, which allows multiple batches to share one commit.
+ * Atomic operations are evaluated inside the commit's write transaction, their results are returned when the batch has been executed.
+ **/
+struct JLMDBOperation
+{
+	JLMDBOperationType type;
+	gchar* key;
+	gsize key_len;
+	/**
+	 * A copy of the caller's value, since the value is only written when the batch is committed.
+	 **/
+	gpointer value;
+	guint32 len;
+	gpointer expected;
+	guint32 expected_len;
+	gint64 delta;
+
+	gboolean* result;
+	gint64* previous;
+	gboolean result_value;
+	gint64 previous_value;
+};
+
+typedef struct JLMDBOperation JLMDBOperation;
+
 struct JLMDBBatch
 {
+	/**
+	 * The read-only transaction, begun lazily by the first get.
+	 **/
 	MDB_txn* txn;
+	/**
+	 * The queued write operations (JLMDBOperation).
+	 **/
+	GArray* operations;
 	gchar* namespace;
 	JSemantics* semantics;
+
+	/**
+	 * Whether the batch has been committed, protected by commit_mutex.
+	 **/
+	gboolean committed;
+	gboolean ret;
+	/**
+	 * Whether committing operations early for a get has failed.
+	 **/
+	gboolean failed;
 };
 
 typedef struct JLMDBBatch JLMDBBatch;
@@ -38,6 +93,15 @@ struct JLMDBData
 {
 	MDB_env* env;
 	MDB_dbi dbi;
+
+	/**
+	 * Batches waiting to be committed.
+	 * The first thread to find no commit in progress becomes the leader and commits all queued batches in a single write transaction.
+	 **/
+	GQueue* commit_queue;
+	gboolean committing;
+	GMutex commit_mutex[1];
+	GCond commit_cond[1];
 };
 
 typedef struct JLMDBData JLMDBData;
@@ -53,52 +117,372 @@ struct JLMDBIterator
 
 typedef struct JLMDBIterator JLMDBIterator;
 
+static void
+lmdb_operation_clear(gpointer data)
+{
+	JLMDBOperation* operation = data;
+
+	g_free(operation->key);
+	g_free(operation->value);
+	g_free(operation->expected);
+}
+
+static void
+lmdb_batch_free(JLMDBBatch* batch)
+{
+	if (batch->txn != NULL)
+	{
+		mdb_txn_abort(batch->txn);
+	}
+
+	g_array_unref(batch->operations);
+	j_semantics_unref(batch->semantics);
+	g_free(batch->namespace);
+	g_slice_free(JLMDBBatch, batch);
+}
+
+/**
+ * Applies the operations of a batch in a nested transaction.
+ * If one of the operations fails, only this batch is rolled back while the other batches of the group are kept.
+ **/
 static gboolean
-backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* data)
+lmdb_batch_apply(JLMDBData* bd, MDB_txn* parent, JLMDBBatch* batch)
 {
-	JLMDBData* bd = backend_data;
-	JLMDBBatch* batch = NULL;
 	MDB_txn* txn;
 
-	g_return_val_if_fail(namespace != NULL, FALSE);
-	g_return_val_if_fail(data != NULL, FALSE);
+	if (mdb_txn_begin(bd->env, parent, 0, &txn) != 0)
+	{
+		return FALSE;
+	}
+
+	for (guint i = 0; i < batch->operations->len; i++)
+	{
+		JLMDBOperation* operation = &g_array_index(batch->operations, JLMDBOperation, i);
+		MDB_val m_key;
+		MDB_val m_value;
+		gint ret = 0;
+
+		m_key.mv_size = operation->key_len;
+		m_key.mv_data = operation->key;
+
+		operation->result_value = FALSE;
+		operation->previous_value = 0;
+
+		switch (operation->type)
+		{
+			case J_LMDB_OPERATION_PUT:
+				m_value.mv_size = operation->len;
+				m_value.mv_data = operation->value;
+
+				ret = mdb_put(txn, bd->dbi, &m_key, &m_value, 0);
+				break;
+			case J_LMDB_OPERATION_DELETE:
+				ret = mdb_del(txn, bd->dbi, &m_key, NULL);
+
+				// A missing key only fails this delete, which has already been reported by backend_delete
+				if (ret == MDB_NOTFOUND)
+				{
+					ret = 0;
+				}
+				break;
+			case J_LMDB_OPERATION_PUT_IF_ABSENT:
+				m_value.mv_size = operation->len;
+				m_value.mv_data = operation->value;
+
+				ret = mdb_put(txn, bd->dbi, &m_key, &m_value, MDB_NOOVERWRITE);
+
+				if (ret == MDB_KEYEXIST)
+				{
+					ret = 0;
+				}
+				else if (ret == 0)
+				{
+					operation->result_value = TRUE;
+				}
+				break;
+			case J_LMDB_OPERATION_COMPARE_AND_SWAP:
+				ret = mdb_get(txn, bd->dbi, &m_key, &m_value);
+
+				if (ret == MDB_NOTFOUND)
+				{
+					ret = 0;
+				}
+				else if (ret == 0 && m_value.mv_size == operation->expected_len && memcmp(m_value.mv_data, operation->expected, operation->expected_len) == 0)
+				{
+					m_value.mv_size = operation->len;
+					m_value.mv_data = operation->value;
+
+					ret = mdb_put(txn, bd->dbi, &m_key, &m_value, 0);
+					operation->result_value = (ret == 0);
+				}
+				break;
+			case J_LMDB_OPERATION_FETCH_ADD:
+			{
+				guint64 counter = 0;
+
+				ret = mdb_get(txn, bd->dbi, &m_key, &m_value);
+
+				if (ret == 0)
+				{
+					if (m_value.mv_size != sizeof(counter))
+					{
+						// Not a counter
+						ret = MDB_INCOMPATIBLE;
+						break;
+					}
+
+					memcpy(&counter, m_value.mv_data, sizeof(counter));
+				}
+				else if (ret != MDB_NOTFOUND)
+				{
+					break;
+				}
+
+				operation->previous_value = GUINT64_FROM_LE(counter);
+				counter = GUINT64_TO_LE((guint64)operation->previous_value + (guint64)operation->delta);
+
+				// mdb_put copies the value, so the stack variable is fine
+				m_value.mv_size = sizeof(counter);
+				m_value.mv_data = &counter;
+
+				ret = mdb_put(txn, bd->dbi, &m_key, &m_value, 0);
+			}
+			break;
+			default:
+				g_warn_if_reached();
+		}
+
+		if (ret != 0)
+		{
+			mdb_txn_abort(txn);
+			return FALSE;
+		}
+	}
+
+	return (mdb_txn_commit(txn) == 0);
+}
+
+/**
+ * Sets the environment's sync mode according to the strongest safety requested by a group of batches.
+ * Must only be called by the commit leader because the flags are shared by the whole environment.
+ **/
+static void
+lmdb_set_safety(JLMDBData* bd, JSemanticsSafety safety)
+{
+	switch (safety)
+	{
+		case J_SEMANTICS_SAFETY_STORAGE:
+			mdb_env_set_flags(bd->env, MDB_NOSYNC | MDB_NOMETASYNC, 0);
+			break;
+		case J_SEMANTICS_SAFETY_NETWORK:
+			mdb_env_set_flags(bd->env, MDB_NOSYNC, 0);
+			mdb_env_set_flags(bd->env, MDB_NOMETASYNC, 1);
+			break;
+		case J_SEMANTICS_SAFETY_NONE:
+			mdb_env_set_flags(bd->env, MDB_NOSYNC, 1);
+			break;
+		default:
+			g_warn_if_reached();
+	}
+}
+
+/**
+ * Commits a group of batches in one write transaction.
+ **/
+static void
+lmdb_group_commit(JLMDBData* bd, GQueue* group)
+{
+	MDB_txn* txn;
+	JSemanticsSafety safety = J_SEMANTICS_SAFETY_NONE;
+	gboolean ret = FALSE;
 
 	if (mdb_txn_begin(bd->env, NULL, 0, &txn) == 0)
 	{
-		batch = g_slice_new(JLMDBBatch);
-		batch->txn = txn;
-		batch->namespace = g_strdup(namespace);
-		batch->semantics = j_semantics_ref(semantics);
+		for (GList* l = group->head; l != NULL; l = l->next)
+		{
+			JLMDBBatch* batch = l->data;
+			JSemanticsSafety batch_safety;
+
+			batch->ret = lmdb_batch_apply(bd, txn, batch);
+
+			// Smaller values mean stronger safety guarantees
+			batch_safety = j_semantics_get(batch->semantics, J_SEMANTICS_SAFETY);
+			safety = MIN(safety, batch_safety);
+		}
+
+		lmdb_set_safety(bd, safety);
+
+		ret = (mdb_txn_commit(txn) == 0);
 	}
 
+	if (!ret)
+	{
+		for (GList* l = group->head; l != NULL; l = l->next)
+		{
+			JLMDBBatch* batch = l->data;
+
+			batch->ret = FALSE;
+		}
+	}
+}
+
+static gboolean
+lmdb_batch_commit(JLMDBData* bd, JLMDBBatch* batch)
+{
+	batch->committed = FALSE;
+	batch->ret = FALSE;
+
+	g_mutex_lock(bd->commit_mutex);
+
+	g_queue_push_tail(bd->commit_queue, batch);
+
+	while (!batch->committed)
+	{
+		if (!bd->committing)
+		{
+			GQueue group;
+
+			// Become the leader and take over all batches queued so far
+			bd->committing = TRUE;
+			group = *(bd->commit_queue);
+			g_queue_init(bd->commit_queue);
+
+			g_mutex_unlock(bd->commit_mutex);
+
+			lmdb_group_commit(bd, &group);
+
+			g_mutex_lock(bd->commit_mutex);
+
+			for (GList* l = group.head; l != NULL; l = l->next)
+			{
+				JLMDBBatch* committed_batch = l->data;
+
+				committed_batch->committed = TRUE;
+			}
+
+			g_queue_clear(&group);
+
+			bd->committing = FALSE;
+			g_cond_broadcast(bd->commit_cond);
+		}
+		else
+		{
+			g_cond_wait(bd->commit_cond, bd->commit_mutex);
+		}
+	}
+
+	g_mutex_unlock(bd->commit_mutex);
+
+	return batch->ret;
+}
+
+static JLMDBOperation*
+lmdb_batch_queue(JLMDBBatch* batch, JLMDBOperationType type, gchar const* key, gconstpointer value, guint32 len)
+{
+	JLMDBOperation operation;
+
+	operation.type = type;
+	operation.key = g_strdup_printf("%s:%s", batch->namespace, key);
+	operation.key_len = strlen(operation.key) + 1;
+#if GLIB_CHECK_VERSION(2, 68, 0)
+	operation.value = g_memdup2(value, len);
+#else
+	operation.value = g_memdup(value, len);
+#endif
+	operation.len = len;
+	operation.expected = NULL;
+	operation.expected_len = 0;
+	operation.delta = 0;
+	operation.result = NULL;
+	operation.previous = NULL;
+	operation.result_value = FALSE;
+	operation.previous_value = 0;
+
+	g_array_append_val(batch->operations, operation);
+
+	return &g_array_index(batch->operations, JLMDBOperation, batch->operations->len - 1);
+}
+
+/**
+ * Commits the operations queued so far and returns the results of atomic operations.
+ **/
+static gboolean
+lmdb_batch_flush(JLMDBData* bd, JLMDBBatch* batch)
+{
+	gboolean ret;
+
+	ret = lmdb_batch_commit(bd, batch);
+
+	for (guint i = 0; i < batch->operations->len; i++)
+	{
+		JLMDBOperation* operation = &g_array_index(batch->operations, JLMDBOperation, i);
+
+		if (operation->result != NULL)
+		{
+			*(operation->result) = ret && operation->result_value;
+		}
+
+		if (operation->previous != NULL)
+		{
+			*(operation->previous) = operation->previous_value;
+		}
+	}
+
+	g_array_set_size(batch->operations, 0);
+
+	return ret;
+}
+
+static gboolean
+backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* data)
+{
+	JLMDBBatch* batch = NULL;
+
+	(void)backend_data;
+
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(data != NULL, FALSE);
+
+	// Transactions are only begun when needed, that is, by the first get or when committing queued writes
+	batch = g_slice_new(JLMDBBatch);
+	batch->txn = NULL;
+	batch->operations = g_array_new(FALSE, FALSE, sizeof(JLMDBOperation));
+	batch->namespace = g_strdup(namespace);
+	batch->semantics = j_semantics_ref(semantics);
+	batch->failed = FALSE;
+
+	g_array_set_clear_func(batch->operations, lmdb_operation_clear);
+
 	*data = batch;
 
-	return (batch != NULL);
+	return TRUE;
 }
 
 static gboolean
 backend_batch_execute(gpointer backend_data, gpointer data)
 {
-	gboolean ret = FALSE;
+	gboolean ret = TRUE;
 
+	JLMDBData* bd = backend_data;
 	JLMDBBatch* batch = data;
 
-	(void)backend_data;
-
 	g_return_val_if_fail(data != NULL, FALSE);
 
-	// FIXME do something with batch->semantics
+	if (batch->txn != NULL)
+	{
+		mdb_txn_abort(batch->txn);
+		batch->txn = NULL;
+	}
 
-	if (mdb_txn_commit(batch->txn) == 0)
+	// Batches that only contain gets do not have to be committed
+	if (batch->operations->len > 0)
 	{
-		ret = TRUE;
+		ret = lmdb_batch_flush(bd, batch);
 	}
 
-	// FIXME free txn
+	ret = ret && !batch->failed;
 
-	j_semantics_unref(batch->semantics);
-	g_free(batch->namespace);
-	g_slice_free(JLMDBBatch, batch);
+	lmdb_batch_free(batch);
 
 	return ret;
 }
@@ -106,77 +490,223 @@ backend_batch_execute(gpointer backend_data, gpointer data)
 static gboolean
 backend_put(gpointer backend_data, gpointer data, gchar const* key, gconstpointer value, guint32 len)
 {
-	JLMDBData* bd = backend_data;
 	JLMDBBatch* batch = data;
-	MDB_val m_key;
-	MDB_val m_value;
-	g_autofree gchar* nskey = NULL;
+
+	(void)backend_data;
 
 	g_return_val_if_fail(data != NULL, FALSE);
 	g_return_val_if_fail(key != NULL, FALSE);
 	g_return_val_if_fail(value != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
+	lmdb_batch_queue(batch, J_LMDB_OPERATION_PUT, key, value, len);
+
+	return TRUE;
+}
 
-	m_key.mv_size = strlen(nskey) + 1;
-	m_key.mv_data = nskey;
-	m_value.mv_size = len;
-	m_value.mv_data = value;
 
-	return (mdb_put(batch->txn, bd->dbi, &m_key, &m_value, 0) == 0);
+static gboolean
+backend_put_if_absent(gpointer backend_data, gpointer data, gchar const* key, gconstpointer value, guint32 len, gboolean* inserted)
+{
+	JLMDBBatch* batch = data;
+	JLMDBOperation* operation;
+
+	(void)backend_data;
+
+	g_return_val_if_fail(data != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(inserted != NULL, FALSE);
+
+	operation = lmdb_batch_queue(batch, J_LMDB_OPERATION_PUT_IF_ABSENT, key, value, len);
+	operation->result = inserted;
+
+	return TRUE;
 }
 
 static gboolean
-backend_delete(gpointer backend_data, gpointer data, gchar const* key)
+backend_compare_and_swap(gpointer backend_data, gpointer data, gchar const* key, gconstpointer expected, guint32 expected_len, gconstpointer value, guint32 len, gboolean* swapped)
 {
-	JLMDBData* bd = backend_data;
 	JLMDBBatch* batch = data;
-	MDB_val m_key;
-	g_autofree gchar* nskey = NULL;
+	JLMDBOperation* operation;
+
+	(void)backend_data;
+
+	g_return_val_if_fail(data != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(expected != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(swapped != NULL, FALSE);
+
+	operation = lmdb_batch_queue(batch, J_LMDB_OPERATION_COMPARE_AND_SWAP, key, value, len);
+#if GLIB_CHECK_VERSION(2, 68, 0)
+	operation->expected = g_memdup2(expected, expected_len);
+#else
+	operation->expected = g_memdup(expected, expected_len);
+#endif
+	operation->expected_len = expected_len;
+	operation->result = swapped;
+
+	return TRUE;
+}
+
+static gboolean
+backend_fetch_add(gpointer backend_data, gpointer data, gchar const* key, gint64 delta, gint64* previous)
+{
+	JLMDBBatch* batch = data;
+	JLMDBOperation* operation;
+
+	(void)backend_data;
 
 	g_return_val_if_fail(data != NULL, FALSE);
 	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(previous != NULL, FALSE);
+
+	operation = lmdb_batch_queue(batch, J_LMDB_OPERATION_FETCH_ADD, key, NULL, 0);
+	operation->delta = delta;
+	operation->previous = previous;
+
+	return TRUE;
+}
+
+/**
+ * Copies the requested range of a value.
+ **/
+static void
+lmdb_copy_range(gconstpointer data, gsize size, guint64 offset, guint64 length, gpointer* value, guint32* len)
+{
+	*value = NULL;
+	*len = 0;
+
+	if (offset < size)
+	{
+		*len = MIN(length, size - offset);
+#if GLIB_CHECK_VERSION(2, 68, 0)
+		*value = g_memdup2((gchar const*)data + offset, *len);
+#else
+		*value = g_memdup((gchar const*)data + offset, *len);
+#endif
+	}
+}
+
+/**
+ * Gets a range of a value, only the requested range is copied out of the memory map.
+ **/
+static gboolean
+lmdb_get(JLMDBData* bd, JLMDBBatch* batch, gchar const* key, guint64 offset, guint64 length, gpointer* value, guint32* len)
+{
+	gboolean ret = FALSE;
+
+	MDB_val m_key;
+	MDB_val m_value;
+	g_autofree gchar* nskey = NULL;
+	gsize nskey_len;
 
 	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
+	nskey_len = strlen(nskey) + 1;
+
+	// Writes queued in this batch have not been committed yet, so they have to be checked first
+	for (guint i = batch->operations->len; i > 0; i--)
+	{
+		JLMDBOperation* operation = &g_array_index(batch->operations, JLMDBOperation, i - 1);
+
+		if (operation->key_len != nskey_len || memcmp(operation->key, nskey, nskey_len) != 0)
+		{
+			continue;
+		}
+
+		if (operation->type == J_LMDB_OPERATION_PUT)
+		{
+			lmdb_copy_range(operation->value, operation->len, offset, length, value, len);
+
+			return TRUE;
+		}
+		else if (operation->type == J_LMDB_OPERATION_DELETE)
+		{
+			return FALSE;
+		}
+
+		// The outcome of atomic operations is only known after committing, so the queued operations are committed now
+		if (!lmdb_batch_flush(bd, batch))
+		{
+			batch->failed = TRUE;
+		}
 
-	m_key.mv_size = strlen(nskey) + 1;
+		// The read-only transaction's snapshot does not contain the committed operations
+		if (batch->txn != NULL)
+		{
+			mdb_txn_abort(batch->txn);
+			batch->txn = NULL;
+		}
+
+		break;
+	}
+
+	if (batch->txn == NULL && mdb_txn_begin(bd->env, NULL, MDB_RDONLY, &(batch->txn)) != 0)
+	{
+		batch->txn = NULL;
+		return FALSE;
+	}
+
+	m_key.mv_size = nskey_len;
 	m_key.mv_data = nskey;
 
-	return (mdb_del(batch->txn, bd->dbi, &m_key, NULL) == 0);
+	if (mdb_get(batch->txn, bd->dbi, &m_key, &m_value) == 0)
+	{
+		// The value is only valid until the transaction ends
+		lmdb_copy_range(m_value.mv_data, m_value.mv_size, offset, length, value, len);
+
+		ret = TRUE;
+	}
+
+	return ret;
 }
 
 static gboolean
 backend_get(gpointer backend_data, gpointer data, gchar const* key, gpointer* value, guint32* len)
 {
-	gboolean ret = FALSE;
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = data;
+
+	g_return_val_if_fail(data != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(len != NULL, FALSE);
+
+	return lmdb_get(bd, batch, key, 0, G_MAXUINT64, value, len);
+}
 
+static gboolean
+backend_get_range(gpointer backend_data, gpointer data, gchar const* key, guint64 offset, guint64 length, gpointer* value, guint32* len)
+{
 	JLMDBData* bd = backend_data;
 	JLMDBBatch* batch = data;
-	MDB_val m_key;
-	MDB_val m_value;
-	g_autofree gchar* nskey = NULL;
 
 	g_return_val_if_fail(data != NULL, FALSE);
 	g_return_val_if_fail(key != NULL, FALSE);
 	g_return_val_if_fail(value != NULL, FALSE);
 	g_return_val_if_fail(len != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
+	return lmdb_get(bd, batch, key, offset, length, value, len);
+}
 
-	m_key.mv_size = strlen(nskey) + 1;
-	m_key.mv_data = nskey;
+static gboolean
+backend_delete(gpointer backend_data, gpointer data, gchar const* key)
+{
+	JLMDBData* bd = backend_data;
+	JLMDBBatch* batch = data;
+	g_autofree gpointer value = NULL;
+	guint32 len;
+	gboolean ret;
 
-	if (mdb_get(batch->txn, bd->dbi, &m_key, &m_value) == 0)
-	{
-		// FIXME check whether copies can be avoided
-#if GLIB_CHECK_VERSION(2, 68, 0)
-		*value = g_memdup2(m_value.mv_data, m_value.mv_size);
-#else
-		*value = g_memdup(m_value.mv_data, m_value.mv_size);
-#endif
-		*len = m_value.mv_size;
+	g_return_val_if_fail(data != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
 
-		ret = TRUE;
+	// Deleting a missing key fails, the key is looked up now because the delete is only applied when committing
+	ret = lmdb_get(bd, batch, key, 0, 0, &value, &len);
+
+	if (ret)
+	{
+		lmdb_batch_queue(batch, J_LMDB_OPERATION_DELETE, key, NULL, 0);
 	}
 
 	return ret;
@@ -196,7 +726,7 @@ backend_get_all(gpointer backend_data, gchar const* namespace, gpointer* data)
 	iterator->prefix = g_strdup_printf("%s:", namespace);
 	iterator->namespace_len = strlen(namespace) + 1;
 
-	mdb_txn_begin(bd->env, NULL, 0, &(iterator->txn));
+	mdb_txn_begin(bd->env, NULL, MDB_RDONLY, &(iterator->txn));
 	mdb_cursor_open(iterator->txn, bd->dbi, &(iterator->cursor));
 
 	*data = iterator;
@@ -219,7 +749,7 @@ backend_get_by_prefix(gpointer backend_data, gchar const* namespace, gchar const
 	iterator->prefix = g_strdup_printf("%s:%s", namespace, prefix);
 	iterator->namespace_len = strlen(namespace) + 1;
 
-	mdb_txn_begin(bd->env, NULL, 0, &(iterator->txn));
+	mdb_txn_begin(bd->env, NULL, MDB_RDONLY, &(iterator->txn));
 	mdb_cursor_open(iterator->txn, bd->dbi, &(iterator->cursor));
 
 	*data = iterator;
@@ -268,7 +798,8 @@ backend_iterate(gpointer backend_data, gpointer data, gchar const** key, gconstp
 	}
 
 out:
-	mdb_txn_commit(iterator->txn);
+	mdb_cursor_close(iterator->cursor);
+	mdb_txn_abort(iterator->txn);
 
 	g_free(iterator->prefix);
 	g_slice_free(JLMDBIterator, iterator);
@@ -287,6 +818,10 @@ backend_init(gchar const* path, gpointer* backend_data)
 	g_mkdir_with_parents(path, 0700);
 
 	bd = g_slice_new(JLMDBData);
+	bd->commit_queue = g_queue_new();
+	bd->committing = FALSE;
+	g_mutex_init(bd->commit_mutex);
+	g_cond_init(bd->commit_cond);
 
 	if (mdb_env_create(&(bd->env)) == 0)
 	{
@@ -296,7 +831,8 @@ backend_init(gchar const* path, gpointer* backend_data)
 			goto error;
 		}
 
-		if (mdb_env_open(bd->env, path, 0, 0600) != 0)
+		// Read-only transactions are used for gets and iterators, which might overlap within one thread
+		if (mdb_env_open(bd->env, path, MDB_NOTLS, 0600) != 0)
 		{
 			goto error;
 		}
@@ -323,6 +859,9 @@ backend_init(gchar const* path, gpointer* backend_data)
 
 error:
 	mdb_env_close(bd->env);
+	g_queue_free(bd->commit_queue);
+	g_mutex_clear(bd->commit_mutex);
+	g_cond_clear(bd->commit_cond);
 	g_slice_free(JLMDBData, bd);
 
 	return FALSE;
@@ -338,6 +877,9 @@ backend_fini(gpointer backend_data)
 		mdb_env_close(bd->env);
 	}
 
+	g_queue_free(bd->commit_queue);
+	g_mutex_clear(bd->commit_mutex);
+	g_cond_clear(bd->commit_cond);
 	g_slice_free(JLMDBData, bd);
 }
 
@@ -352,9 +894,13 @@ static JBackend lmdb_backend = {
 		.backend_put = backend_put,
 		.backend_delete = backend_delete,
 		.backend_get = backend_get,
+		.backend_get_range = backend_get_range,
 		.backend_get_all = backend_get_all,
 		.backend_get_by_prefix = backend_get_by_prefix,
-		.backend_iterate = backend_iterate }
+		.backend_iterate = backend_iterate,
+		.backend_put_if_absent = backend_put_if_absent,
+		.backend_compare_and_swap = backend_compare_and_swap,
+		.backend_fetch_add = backend_fetch_add }
 };
 
 G_MODULE_EXPORT
@@ -0,0 +1,1072 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2017-2021 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gmodule.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <julea.h>
+
+/**
+ * A key-value pair.
+ * Entries are immutable once they have been published, updates replace the whole entry.
+ **/
+struct JMemoryEntry
+{
+	gint ref_count;
+	guint hash;
+	/**
+	 * The key is stored as "namespace\0key\0", which sorts entries by namespace first.
+	 **/
+	gchar* key;
+	gsize key_len;
+	gsize namespace_len;
+	/**
+	 * The value, NULL for queued deletes.
+	 **/
+	gpointer value;
+	guint32 len;
+};
+
+typedef struct JMemoryEntry JMemoryEntry;
+
+/**
+ * An open addressing hash table with linear probing.
+ * Buckets are read without locking, writers replace them atomically while holding the write mutex.
+ **/
+struct JMemoryTable
+{
+	gsize size;
+	/**
+	 * The number of used buckets, including tombstones.
+	 **/
+	gsize used;
+	gsize count;
+	JMemoryEntry** buckets;
+};
+
+typedef struct JMemoryTable JMemoryTable;
+
+struct JMemoryBatch
+{
+	gchar* namespace;
+	gsize namespace_len;
+	/**
+	 * The queued writes (JMemoryEntry), applied when the batch is executed.
+	 **/
+	GPtrArray* entries;
+};
+
+typedef struct JMemoryBatch JMemoryBatch;
+
+struct JMemoryData
+{
+	JMemoryTable* table;
+	/**
+	 * The ordered index used for prefix iteration, protected by write_mutex.
+	 **/
+	GSequence* index;
+	GMutex write_mutex[1];
+
+	/**
+	 * Readers register in the counter of the current epoch.
+	 * Replaced entries and tables are only freed after all readers of the previous epoch have left.
+	 **/
+	gint epoch;
+	gint readers[2];
+	GPtrArray* garbage_entries;
+	GPtrArray* garbage_tables;
+
+	/**
+	 * The snapshot file, NULL if the data should not be persisted.
+	 **/
+	gchar* path;
+};
+
+typedef struct JMemoryData JMemoryData;
+
+struct JMemoryIterator
+{
+	GPtrArray* entries;
+	guint position;
+};
+
+typedef struct JMemoryIterator JMemoryIterator;
+
+static gchar const memory_snapshot_magic[8] = "JULEAKV1";
+static gchar memory_tombstone;
+
+#define J_MEMORY_TOMBSTONE ((JMemoryEntry*)&memory_tombstone)
+
+static guint
+memory_hash(gchar const* data, gsize len)
+{
+	// FNV-1a, keys contain a NUL byte between namespace and key
+	guint32 hash = 2166136261U;
+
+	for (gsize i = 0; i < len; i++)
+	{
+		hash ^= (guchar)data[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static JMemoryEntry*
+memory_entry_new(gchar const* namespace, gsize namespace_len, gchar const* key, gconstpointer value, guint32 len)
+{
+	JMemoryEntry* entry;
+	gsize key_len;
+
+	key_len = strlen(key) + 1;
+
+	// Key and value are stored in the same allocation
+	entry = g_malloc(sizeof(JMemoryEntry) + namespace_len + 1 + key_len + len);
+	entry->ref_count = 1;
+	entry->key = (gchar*)(entry + 1);
+	entry->key_len = namespace_len + 1 + key_len;
+	entry->namespace_len = namespace_len;
+	entry->value = NULL;
+	entry->len = len;
+
+	memcpy(entry->key, namespace, namespace_len + 1);
+	memcpy(entry->key + namespace_len + 1, key, key_len);
+
+	if (value != NULL)
+	{
+		entry->value = entry->key + entry->key_len;
+		memcpy(entry->value, value, len);
+	}
+
+	entry->hash = memory_hash(entry->key, entry->key_len);
+
+	return entry;
+}
+
+static JMemoryEntry*
+memory_entry_ref(JMemoryEntry* entry)
+{
+	g_atomic_int_inc(&(entry->ref_count));
+
+	return entry;
+}
+
+static void
+memory_entry_unref(gpointer data)
+{
+	JMemoryEntry* entry = data;
+
+	if (g_atomic_int_dec_and_test(&(entry->ref_count)))
+	{
+		g_free(entry);
+	}
+}
+
+static gint
+memory_entry_compare(gconstpointer a, gconstpointer b, gpointer data)
+{
+	JMemoryEntry const* entry_a = a;
+	JMemoryEntry const* entry_b = b;
+	gint ret;
+
+	(void)data;
+
+	ret = memcmp(entry_a->key, entry_b->key, MIN(entry_a->key_len, entry_b->key_len));
+
+	if (ret == 0)
+	{
+		ret = (entry_a->key_len > entry_b->key_len) - (entry_a->key_len < entry_b->key_len);
+	}
+
+	return ret;
+}
+
+static JMemoryTable*
+memory_table_new(gsize size)
+{
+	JMemoryTable* table;
+
+	table = g_slice_new(JMemoryTable);
+	table->size = size;
+	table->used = 0;
+	table->count = 0;
+	table->buckets = g_new0(JMemoryEntry*, size);
+
+	return table;
+}
+
+static void
+memory_table_free(gpointer data)
+{
+	JMemoryTable* table = data;
+
+	g_free(table->buckets);
+	g_slice_free(JMemoryTable, table);
+}
+
+/**
+ * Looks up the bucket of an entry with the given key.
+ * Can be called without holding the write mutex, as long as the caller has entered the current epoch.
+ **/
+static JMemoryEntry*
+memory_table_lookup(JMemoryTable* table, gchar const* key, gsize key_len, guint hash, gsize* position)
+{
+	gsize mask = table->size - 1;
+
+	for (gsize i = hash & mask;; i = (i + 1) & mask)
+	{
+		JMemoryEntry* entry;
+
+		entry = g_atomic_pointer_get(&(table->buckets[i]));
+
+		if (entry == NULL)
+		{
+			return NULL;
+		}
+
+		if (entry != J_MEMORY_TOMBSTONE && entry->hash == hash && entry->key_len == key_len && memcmp(entry->key, key, key_len) == 0)
+		{
+			if (position != NULL)
+			{
+				*position = i;
+			}
+
+			return entry;
+		}
+	}
+}
+
+/**
+ * Inserts an entry into a table that has not been published yet.
+ **/
+static void
+memory_table_insert_unpublished(JMemoryTable* table, JMemoryEntry* entry)
+{
+	gsize mask = table->size - 1;
+
+	for (gsize i = entry->hash & mask;; i = (i + 1) & mask)
+	{
+		if (table->buckets[i] == NULL)
+		{
+			table->buckets[i] = entry;
+			table->used++;
+			table->count++;
+
+			return;
+		}
+	}
+}
+
+static void
+memory_reader_enter(JMemoryData* bd, gint* epoch)
+{
+	while (TRUE)
+	{
+		gint current;
+
+		current = g_atomic_int_get(&(bd->epoch));
+		g_atomic_int_inc(&(bd->readers[current & 1]));
+
+		// The epoch might have changed before registering, retry in this case
+		if (g_atomic_int_get(&(bd->epoch)) == current)
+		{
+			*epoch = current;
+			return;
+		}
+
+		g_atomic_int_add(&(bd->readers[current & 1]), -1);
+	}
+}
+
+static void
+memory_reader_leave(JMemoryData* bd, gint epoch)
+{
+	g_atomic_int_add(&(bd->readers[epoch & 1]), -1);
+}
+
+/**
+ * Frees replaced entries and tables once no reader can access them anymore.
+ * Must be called with the write mutex held.
+ **/
+static void
+memory_reclaim(JMemoryData* bd)
+{
+	gint epoch;
+
+	if (bd->garbage_entries->len == 0 && bd->garbage_tables->len == 0)
+	{
+		return;
+	}
+
+	// Readers of the previous epoch have left when we started the current one
+	epoch = g_atomic_int_get(&(bd->epoch));
+	g_atomic_int_set(&(bd->epoch), epoch + 1);
+
+	while (g_atomic_int_get(&(bd->readers[epoch & 1])) > 0)
+	{
+		g_thread_yield();
+	}
+
+	g_ptr_array_set_size(bd->garbage_entries, 0);
+	g_ptr_array_set_size(bd->garbage_tables, 0);
+}
+
+/**
+ * Reclaims memory once enough garbage has accumulated, which amortizes the cost of waiting for readers.
+ * Must be called with the write mutex held.
+ **/
+static void
+memory_maybe_reclaim(JMemoryData* bd)
+{
+	if (bd->garbage_entries->len >= 1024 || bd->garbage_tables->len > 0)
+	{
+		memory_reclaim(bd);
+	}
+}
+
+/**
+ * Grows the table or removes tombstones if it is too full.
+ * Must be called with the write mutex held.
+ **/
+static void
+memory_table_maintain(JMemoryData* bd)
+{
+	JMemoryTable* table = bd->table;
+	JMemoryTable* new_table;
+	gsize size;
+
+	if ((table->used + 1) * 4 < table->size * 3)
+	{
+		return;
+	}
+
+	size = table->size;
+
+	// Only grow if the table is actually full, otherwise just get rid of the tombstones
+	if ((table->count + 1) * 2 > size)
+	{
+		size *= 2;
+	}
+
+	new_table = memory_table_new(size);
+
+	for (gsize i = 0; i < table->size; i++)
+	{
+		JMemoryEntry* entry = table->buckets[i];
+
+		if (entry != NULL && entry != J_MEMORY_TOMBSTONE)
+		{
+			memory_table_insert_unpublished(new_table, entry);
+		}
+	}
+
+	g_atomic_pointer_set(&(bd->table), new_table);
+	g_ptr_array_add(bd->garbage_tables, table);
+}
+
+/**
+ * Publishes an entry, replacing or deleting an existing one.
+ * Takes over the caller's reference.
+ * Must be called with the write mutex held.
+ **/
+static void
+memory_apply(JMemoryData* bd, JMemoryEntry* entry)
+{
+	JMemoryTable* table;
+	JMemoryEntry* old_entry;
+	gsize position;
+
+	memory_table_maintain(bd);
+
+	table = bd->table;
+	old_entry = memory_table_lookup(table, entry->key, entry->key_len, entry->hash, &position);
+
+	if (entry->value == NULL)
+	{
+		// Deletes are represented by entries without a value
+		if (old_entry != NULL)
+		{
+			g_atomic_pointer_set(&(table->buckets[position]), J_MEMORY_TOMBSTONE);
+			table->count--;
+
+			g_sequence_remove(g_sequence_lookup(bd->index, old_entry, memory_entry_compare, NULL));
+			g_ptr_array_add(bd->garbage_entries, old_entry);
+		}
+
+		memory_entry_unref(entry);
+
+		return;
+	}
+
+	if (old_entry != NULL)
+	{
+		g_atomic_pointer_set(&(table->buckets[position]), entry);
+
+		g_sequence_set(g_sequence_lookup(bd->index, old_entry, memory_entry_compare, NULL), entry);
+		g_ptr_array_add(bd->garbage_entries, old_entry);
+	}
+	else
+	{
+		gsize mask = table->size - 1;
+
+		for (gsize i = entry->hash & mask;; i = (i + 1) & mask)
+		{
+			JMemoryEntry* bucket = table->buckets[i];
+
+			if (bucket == NULL || bucket == J_MEMORY_TOMBSTONE)
+			{
+				if (bucket == NULL)
+				{
+					table->used++;
+				}
+
+				table->count++;
+				g_atomic_pointer_set(&(table->buckets[i]), entry);
+
+				break;
+			}
+		}
+
+		g_sequence_insert_sorted(bd->index, entry, memory_entry_compare, NULL);
+	}
+}
+
+/**
+ * Applies the writes queued in a batch.
+ * Must be called with the write mutex held.
+ **/
+static void
+memory_batch_flush(JMemoryData* bd, JMemoryBatch* batch)
+{
+	for (guint i = 0; i < batch->entries->len; i++)
+	{
+		// The table takes over the batch's reference
+		memory_apply(bd, g_ptr_array_index(batch->entries, i));
+	}
+
+	// Do not unref the entries that have been handed over
+	g_ptr_array_set_free_func(batch->entries, NULL);
+	g_ptr_array_set_size(batch->entries, 0);
+	g_ptr_array_set_free_func(batch->entries, memory_entry_unref);
+}
+
+/**
+ * Looks up an entry and returns a copy of its value.
+ **/
+static gboolean
+memory_get(JMemoryData* bd, JMemoryBatch* batch, gchar const* key, gpointer* value, guint32* len)
+{
+	gboolean ret = FALSE;
+
+	JMemoryEntry* probe;
+	JMemoryEntry* entry;
+	gint epoch;
+
+	probe = memory_entry_new(batch->namespace, batch->namespace_len, key, NULL, 0);
+
+	// Writes queued in this batch have not been applied yet, so they have to be checked first
+	for (guint i = batch->entries->len; i > 0; i--)
+	{
+		entry = g_ptr_array_index(batch->entries, i - 1);
+
+		if (entry->hash == probe->hash && memory_entry_compare(entry, probe, NULL) == 0)
+		{
+			if (entry->value != NULL)
+			{
+#if GLIB_CHECK_VERSION(2, 68, 0)
+				*value = g_memdup2(entry->value, entry->len);
+#else
+				*value = g_memdup(entry->value, entry->len);
+#endif
+				*len = entry->len;
+				ret = TRUE;
+			}
+
+			memory_entry_unref(probe);
+
+			return ret;
+		}
+	}
+
+	memory_reader_enter(bd, &epoch);
+
+	entry = memory_table_lookup(g_atomic_pointer_get(&(bd->table)), probe->key, probe->key_len, probe->hash, NULL);
+
+	if (entry != NULL)
+	{
+#if GLIB_CHECK_VERSION(2, 68, 0)
+		*value = g_memdup2(entry->value, entry->len);
+#else
+		*value = g_memdup(entry->value, entry->len);
+#endif
+		*len = entry->len;
+		ret = TRUE;
+	}
+
+	memory_reader_leave(bd, epoch);
+
+	memory_entry_unref(probe);
+
+	return ret;
+}
+
+/**
+ * Looks up an entry for an atomic operation.
+ * Must be called with the write mutex held, the entry stays valid until the mutex is released.
+ **/
+static JMemoryEntry*
+memory_get_locked(JMemoryData* bd, JMemoryEntry* probe)
+{
+	return memory_table_lookup(bd->table, probe->key, probe->key_len, probe->hash, NULL);
+}
+
+static gboolean
+memory_snapshot_load(JMemoryData* bd)
+{
+	gboolean ret = FALSE;
+
+	FILE* file;
+	gchar magic[sizeof(memory_snapshot_magic)];
+
+	file = g_fopen(bd->path, "rb");
+
+	if (file == NULL)
+	{
+		// There is no snapshot yet
+		return TRUE;
+	}
+
+	if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, memory_snapshot_magic, sizeof(magic)) != 0)
+	{
+		goto end;
+	}
+
+	while (TRUE)
+	{
+		JMemoryEntry* entry;
+		guint32 key_len;
+		guint32 namespace_len;
+		guint32 len;
+
+		if (fread(&key_len, sizeof(key_len), 1, file) != 1)
+		{
+			ret = (feof(file) != 0);
+			break;
+		}
+
+		if (fread(&namespace_len, sizeof(namespace_len), 1, file) != 1 || fread(&len, sizeof(len), 1, file) != 1)
+		{
+			break;
+		}
+
+		key_len = GUINT32_FROM_LE(key_len);
+		namespace_len = GUINT32_FROM_LE(namespace_len);
+		len = GUINT32_FROM_LE(len);
+
+		if (namespace_len + 2 > key_len)
+		{
+			break;
+		}
+
+		entry = g_malloc(sizeof(JMemoryEntry) + key_len + len);
+		entry->ref_count = 1;
+		entry->key = (gchar*)(entry + 1);
+		entry->key_len = key_len;
+		entry->namespace_len = namespace_len;
+		entry->value = entry->key + key_len;
+		entry->len = len;
+
+		if (fread(entry->key, key_len + len, 1, file) != 1)
+		{
+			g_free(entry);
+			break;
+		}
+
+		entry->hash = memory_hash(entry->key, entry->key_len);
+
+		memory_apply(bd, entry);
+	}
+
+end:
+	fclose(file);
+
+	return ret;
+}
+
+static gboolean
+memory_snapshot_save(JMemoryData* bd)
+{
+	gboolean ret = TRUE;
+
+	FILE* file;
+	GSequenceIter* iter;
+	g_autofree gchar* tmp_path = NULL;
+
+	// Write to a temporary file first to not destroy an existing snapshot on errors
+	tmp_path = g_strconcat(bd->path, ".tmp", NULL);
+	file = g_fopen(tmp_path, "wb");
+
+	if (file == NULL)
+	{
+		return FALSE;
+	}
+
+	ret = (fwrite(memory_snapshot_magic, sizeof(memory_snapshot_magic), 1, file) == 1);
+
+	for (iter = g_sequence_get_begin_iter(bd->index); ret && !g_sequence_iter_is_end(iter); iter = g_sequence_iter_next(iter))
+	{
+		JMemoryEntry* entry = g_sequence_get(iter);
+		guint32 key_len;
+		guint32 namespace_len;
+		guint32 len;
+
+		key_len = GUINT32_TO_LE(entry->key_len);
+		namespace_len = GUINT32_TO_LE(entry->namespace_len);
+		len = GUINT32_TO_LE(entry->len);
+
+		ret = ret && fwrite(&key_len, sizeof(key_len), 1, file) == 1;
+		ret = ret && fwrite(&namespace_len, sizeof(namespace_len), 1, file) == 1;
+		ret = ret && fwrite(&len, sizeof(len), 1, file) == 1;
+		ret = ret && fwrite(entry->key, entry->key_len, 1, file) == 1;
+		ret = ret && (entry->len == 0 || fwrite(entry->value, entry->len, 1, file) == 1);
+	}
+
+	ret = (fclose(file) == 0) && ret;
+
+	if (ret)
+	{
+		ret = (g_rename(tmp_path, bd->path) == 0);
+	}
+	else
+	{
+		g_unlink(tmp_path);
+	}
+
+	return ret;
+}
+
+static gboolean
+backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* backend_batch)
+{
+	JMemoryBatch* batch;
+
+	(void)backend_data;
+	(void)semantics;
+
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+
+	batch = g_slice_new(JMemoryBatch);
+	batch->namespace = g_strdup(namespace);
+	batch->namespace_len = strlen(namespace);
+	batch->entries = g_ptr_array_new_with_free_func(memory_entry_unref);
+
+	*backend_batch = batch;
+
+	return TRUE;
+}
+
+static gboolean
+backend_batch_execute(gpointer backend_data, gpointer backend_batch)
+{
+	JMemoryBatch* batch = backend_batch;
+	JMemoryData* bd = backend_data;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+
+	if (batch->entries->len > 0)
+	{
+		g_mutex_lock(bd->write_mutex);
+		memory_batch_flush(bd, batch);
+		memory_maybe_reclaim(bd);
+		g_mutex_unlock(bd->write_mutex);
+	}
+
+	g_ptr_array_unref(batch->entries);
+	g_free(batch->namespace);
+	g_slice_free(JMemoryBatch, batch);
+
+	return TRUE;
+}
+
+static gboolean
+backend_put(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer value, guint32 len)
+{
+	JMemoryBatch* batch = backend_batch;
+
+	(void)backend_data;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+
+	g_ptr_array_add(batch->entries, memory_entry_new(batch->namespace, batch->namespace_len, key, value, len));
+
+	return TRUE;
+}
+
+static gboolean
+backend_delete(gpointer backend_data, gpointer backend_batch, gchar const* key)
+{
+	JMemoryBatch* batch = backend_batch;
+
+	(void)backend_data;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+
+	g_ptr_array_add(batch->entries, memory_entry_new(batch->namespace, batch->namespace_len, key, NULL, 0));
+
+	return TRUE;
+}
+
+static gboolean
+backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpointer* value, guint32* len)
+{
+	JMemoryBatch* batch = backend_batch;
+	JMemoryData* bd = backend_data;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(len != NULL, FALSE);
+
+	return memory_get(bd, batch, key, value, len);
+}
+
+/**
+ * Atomic operations are applied immediately after the writes queued so far.
+ **/
+static gboolean
+backend_put_if_absent(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer value, guint32 len, gboolean* inserted)
+{
+	JMemoryBatch* batch = backend_batch;
+	JMemoryData* bd = backend_data;
+	JMemoryEntry* entry;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(inserted != NULL, FALSE);
+
+	entry = memory_entry_new(batch->namespace, batch->namespace_len, key, value, len);
+
+	g_mutex_lock(bd->write_mutex);
+	memory_batch_flush(bd, batch);
+
+	if (memory_get_locked(bd, entry) == NULL)
+	{
+		memory_apply(bd, entry);
+		*inserted = TRUE;
+	}
+	else
+	{
+		memory_entry_unref(entry);
+	}
+
+	memory_maybe_reclaim(bd);
+	g_mutex_unlock(bd->write_mutex);
+
+	return TRUE;
+}
+
+static gboolean
+backend_compare_and_swap(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer expected, guint32 expected_len, gconstpointer value, guint32 len, gboolean* swapped)
+{
+	JMemoryBatch* batch = backend_batch;
+	JMemoryData* bd = backend_data;
+	JMemoryEntry* entry;
+	JMemoryEntry* old_entry;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(expected != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(swapped != NULL, FALSE);
+
+	entry = memory_entry_new(batch->namespace, batch->namespace_len, key, value, len);
+
+	g_mutex_lock(bd->write_mutex);
+	memory_batch_flush(bd, batch);
+
+	old_entry = memory_get_locked(bd, entry);
+
+	if (old_entry != NULL && old_entry->len == expected_len && memcmp(old_entry->value, expected, expected_len) == 0)
+	{
+		memory_apply(bd, entry);
+		*swapped = TRUE;
+	}
+	else
+	{
+		memory_entry_unref(entry);
+	}
+
+	memory_maybe_reclaim(bd);
+	g_mutex_unlock(bd->write_mutex);
+
+	return TRUE;
+}
+
+static gboolean
+backend_fetch_add(gpointer backend_data, gpointer backend_batch, gchar const* key, gint64 delta, gint64* previous)
+{
+	gboolean ret = FALSE;
+
+	JMemoryBatch* batch = backend_batch;
+	JMemoryData* bd = backend_data;
+	JMemoryEntry* entry;
+	JMemoryEntry* old_entry;
+	guint64 counter = 0;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(previous != NULL, FALSE);
+
+	entry = memory_entry_new(batch->namespace, batch->namespace_len, key, &counter, sizeof(counter));
+
+	g_mutex_lock(bd->write_mutex);
+	memory_batch_flush(bd, batch);
+
+	old_entry = memory_get_locked(bd, entry);
+
+	// Values that are not 8 bytes long are not counters
+	if (old_entry == NULL || old_entry->len == sizeof(counter))
+	{
+		if (old_entry != NULL)
+		{
+			memcpy(&counter, old_entry->value, sizeof(counter));
+		}
+
+		*previous = GUINT64_FROM_LE(counter);
+		counter = GUINT64_TO_LE((guint64)*previous + (guint64)delta);
+		memcpy(entry->value, &counter, sizeof(counter));
+
+		memory_apply(bd, entry);
+		ret = TRUE;
+	}
+	else
+	{
+		memory_entry_unref(entry);
+	}
+
+	memory_maybe_reclaim(bd);
+	g_mutex_unlock(bd->write_mutex);
+
+	return ret;
+}
+
+static gboolean
+backend_get_by_prefix(gpointer backend_data, gchar const* namespace, gchar const* prefix, gpointer* backend_iterator)
+{
+	JMemoryData* bd = backend_data;
+	JMemoryIterator* iterator;
+	JMemoryEntry* probe;
+	GSequenceIter* iter;
+	gsize prefix_len;
+
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(prefix != NULL, FALSE);
+	g_return_val_if_fail(backend_iterator != NULL, FALSE);
+
+	iterator = g_slice_new(JMemoryIterator);
+	iterator->entries = g_ptr_array_new_with_free_func(memory_entry_unref);
+	iterator->position = 0;
+
+	probe = memory_entry_new(namespace, strlen(namespace), prefix, NULL, 0);
+	// Ignore the key's terminating null byte to match all keys starting with the prefix
+	prefix_len = probe->key_len - 1;
+
+	g_mutex_lock(bd->write_mutex);
+
+	// An entry that is equal to the probe is sorted before the returned position
+	iter = g_sequence_search(bd->index, probe, memory_entry_compare, NULL);
+
+	if (!g_sequence_iter_is_begin(iter))
+	{
+		GSequenceIter* prev = g_sequence_iter_prev(iter);
+
+		if (memory_entry_compare(g_sequence_get(prev), probe, NULL) == 0)
+		{
+			iter = prev;
+		}
+	}
+
+	for (; !g_sequence_iter_is_end(iter); iter = g_sequence_iter_next(iter))
+	{
+		JMemoryEntry* entry = g_sequence_get(iter);
+
+		if (entry->key_len < prefix_len || memcmp(entry->key, probe->key, prefix_len) != 0)
+		{
+			break;
+		}
+
+		// The references keep the entries alive after they have been replaced
+		g_ptr_array_add(iterator->entries, memory_entry_ref(entry));
+	}
+
+	g_mutex_unlock(bd->write_mutex);
+
+	memory_entry_unref(probe);
+
+	*backend_iterator = iterator;
+
+	return TRUE;
+}
+
+static gboolean
+backend_get_all(gpointer backend_data, gchar const* namespace, gpointer* backend_iterator)
+{
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(backend_iterator != NULL, FALSE);
+
+	return backend_get_by_prefix(backend_data, namespace, "", backend_iterator);
+}
+
+static gboolean
+backend_iterate(gpointer backend_data, gpointer backend_iterator, gchar const** key, gconstpointer* value, guint32* len)
+{
+	JMemoryIterator* iterator = backend_iterator;
+
+	(void)backend_data;
+
+	g_return_val_if_fail(backend_iterator != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(len != NULL, FALSE);
+
+	if (iterator->position < iterator->entries->len)
+	{
+		JMemoryEntry* entry = g_ptr_array_index(iterator->entries, iterator->position);
+
+		*key = entry->key + entry->namespace_len + 1;
+		*value = entry->value;
+		*len = entry->len;
+
+		iterator->position++;
+
+		return TRUE;
+	}
+
+	g_ptr_array_unref(iterator->entries);
+	g_slice_free(JMemoryIterator, iterator);
+
+	return FALSE;
+}
+
+static gboolean
+backend_init(gchar const* path, gpointer* backend_data)
+{
+	JMemoryData* bd;
+
+	g_return_val_if_fail(path != NULL, FALSE);
+
+	bd = g_slice_new(JMemoryData);
+	bd->table = memory_table_new(1024);
+	bd->index = g_sequence_new(NULL);
+	g_mutex_init(bd->write_mutex);
+	bd->epoch = 0;
+	bd->readers[0] = 0;
+	bd->readers[1] = 0;
+	bd->garbage_entries = g_ptr_array_new_with_free_func(memory_entry_unref);
+	bd->garbage_tables = g_ptr_array_new_with_free_func(memory_table_free);
+	bd->path = NULL;
+
+	// An empty path disables snapshots
+	if (path[0] != '\0')
+	{
+		g_autofree gchar* dirname = NULL;
+
+		bd->path = g_strdup(path);
+
+		dirname = g_path_get_dirname(path);
+		g_mkdir_with_parents(dirname, 0700);
+
+		if (!memory_snapshot_load(bd))
+		{
+			g_warning("Could not load snapshot %s.", path);
+		}
+
+		g_ptr_array_set_size(bd->garbage_entries, 0);
+		g_ptr_array_set_size(bd->garbage_tables, 0);
+	}
+
+	*backend_data = bd;
+
+	return TRUE;
+}
+
+static void
+backend_fini(gpointer backend_data)
+{
+	JMemoryData* bd = backend_data;
+	JMemoryTable* table = bd->table;
+
+	if (bd->path != NULL && !memory_snapshot_save(bd))
+	{
+		g_warning("Could not save snapshot %s.", bd->path);
+	}
+
+	g_ptr_array_unref(bd->garbage_entries);
+	g_ptr_array_unref(bd->garbage_tables);
+
+	for (gsize i = 0; i < table->size; i++)
+	{
+		if (table->buckets[i] != NULL && table->buckets[i] != J_MEMORY_TOMBSTONE)
+		{
+			memory_entry_unref(table->buckets[i]);
+		}
+	}
+
+	memory_table_free(table);
+	g_sequence_free(bd->index);
+	g_mutex_clear(bd->write_mutex);
+	g_free(bd->path);
+
+	g_slice_free(JMemoryData, bd);
+}
+
+static JBackend memory_backend = {
+	.type = J_BACKEND_TYPE_KV,
+	.component = J_BACKEND_COMPONENT_CLIENT | J_BACKEND_COMPONENT_SERVER,
+	.kv = {
+		.backend_init = backend_init,
+		.backend_fini = backend_fini,
+		.backend_batch_start = backend_batch_start,
+		.backend_batch_execute = backend_batch_execute,
+		.backend_put = backend_put,
+		.backend_delete = backend_delete,
+		.backend_get = backend_get,
+		.backend_get_all = backend_get_all,
+		.backend_get_by_prefix = backend_get_by_prefix,
+		.backend_iterate = backend_iterate,
+		.backend_put_if_absent = backend_put_if_absent,
+		.backend_compare_and_swap = backend_compare_and_swap,
+		.backend_fetch_add = backend_fetch_add }
+};
+
+G_MODULE_EXPORT
+JBackend*
+backend_info(void)
+{
+	return &memory_backend;
+}
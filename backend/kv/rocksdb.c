@@ -25,10 +25,91 @@
 
 #include <julea.h>
 
+/**
+ * Column families used for namespaces are prefixed, so they cannot clash with RocksDB's default column family.
+ **/
+#define J_ROCKSDB_COLUMN_FAMILY_PREFIX "julea:"
+
+/**
+ * A namespaced key.
+ * Short keys are built in the stack buffer, only long keys require an allocation.
+ **/
+struct JRocksDBKey
+{
+	gchar* data;
+	gsize len;
+	gchar* heap;
+	gchar stack[256];
+};
+
+typedef struct JRocksDBKey JRocksDBKey;
+
+enum JRocksDBAtomicType
+{
+	J_ROCKSDB_ATOMIC_PUT_IF_ABSENT,
+	J_ROCKSDB_ATOMIC_COMPARE_AND_SWAP,
+	J_ROCKSDB_ATOMIC_FETCH_ADD
+};
+
+typedef enum JRocksDBAtomicType JRocksDBAtomicType;
+
+/**
+ * An atomic operation that has been queued in a batch.
+ * Atomic operations are evaluated when the batch is executed, their results are returned afterwards.
+ **/
+struct JRocksDBAtomic
+{
+	JRocksDBAtomicType type;
+	/**
+	 * The writes queued before this operation, which have to be written first.
+	 **/
+	rocksdb_writebatch_t* preceding;
+	/**
+	 * The namespaced key, stored in the batch's key buffer.
+	 **/
+	gsize key_offset;
+	gsize key_len;
+	gchar* value;
+	guint32 len;
+	gchar* expected;
+	guint32 expected_len;
+	gint64 delta;
+
+	gboolean* result;
+	gint64* previous;
+};
+
+typedef struct JRocksDBAtomic JRocksDBAtomic;
+
 struct JRocksDBBatch
 {
+	/**
+	 * The writes queued after the last atomic operation.
+	 **/
 	rocksdb_writebatch_t* batch;
+	/**
+	 * The queued atomic operations (JRocksDBAtomic).
+	 **/
+	GArray* atomics;
+	/**
+	 * The keys of the queued atomic operations, which are stored consecutively to avoid an allocation per operation.
+	 **/
+	GByteArray* keys;
+	/**
+	 * The stripes of all keys written by the batch, as a bit mask.
+	 **/
+	guint32 stripes;
+	/**
+	 * The namespace's column family, if column families are used.
+	 * It is only created by the batch's first put or atomic operation, so it is NULL for batches that only read or delete in new namespaces.
+	 **/
+	rocksdb_column_family_handle_t* column_family;
 	gchar* namespace;
+	/**
+	 * The key prefix, "namespace:" if column families are not used and "" otherwise.
+	 **/
+	gchar* prefix;
+	gsize prefix_len;
 	JSemantics* semantics;
 };
 
@@ -37,10 +118,34 @@ typedef struct JRocksDBBatch JRocksDBBatch;
 struct JRocksDBData
 {
 	rocksdb_t* db;
+	/**
+	 * The options are also used when creating new column families.
+	 **/
+	rocksdb_options_t* options;
+	rocksdb_cache_t* block_cache;
 
 	rocksdb_readoptions_t* read_options;
 	rocksdb_writeoptions_t* write_options;
 	rocksdb_writeoptions_t* write_options_sync;
+
+	/**
+	 * Whether namespaces are mapped to column families.
+	 **/
+	gboolean column_families;
+	/**
+	 * The length of the fixed key prefix used for prefix bloom filters within column families.
+	 **/
+	gsize prefix_length;
+
+	GHashTable* column_family_handles;
+	GMutex column_family_mutex[1];
+
+	/**
+	 * Serializes writes to the same keys.
+	 * The C API does not offer optimistic transactions for plain databases, so batches lock the stripes of all keys they write while they are executed.
+	 * This makes atomic operations atomic with respect to all other writes.
+	 **/
+	GMutex stripe_mutex[16];
 };
 
 typedef struct JRocksDBData JRocksDBData;
@@ -48,19 +153,354 @@ typedef struct JRocksDBData JRocksDBData;
 struct JRocksDBIterator
 {
 	rocksdb_iterator_t* iterator;
+	rocksdb_readoptions_t* read_options;
 	gboolean first;
-	gchar* prefix;
+	/**
+	 * The seek prefix, "namespace:prefix" if column families are not used and "prefix" otherwise.
+	 **/
+	JRocksDBKey prefix;
 	gsize namespace_len;
 };
 
 typedef struct JRocksDBIterator JRocksDBIterator;
 
+static void
+namespace_key_init(JRocksDBKey* nskey, gchar const* prefix, gsize prefix_len, gchar const* key)
+{
+	gsize key_len;
+
+	key_len = strlen(key) + 1;
+
+	nskey->len = prefix_len + key_len;
+	nskey->heap = NULL;
+	nskey->data = nskey->stack;
+
+	if (nskey->len > sizeof(nskey->stack))
+	{
+		nskey->heap = g_malloc(nskey->len);
+		nskey->data = nskey->heap;
+	}
+
+	memcpy(nskey->data, prefix, prefix_len);
+	memcpy(nskey->data + prefix_len, key, key_len);
+}
+
+/**
+ * Builds the seek prefix used by iterators, the namespace's terminator is replaced by the separator.
+ **/
+static void
+namespace_prefix_init(JRocksDBKey* nskey, gchar const* namespace, gsize namespace_len, gchar const* prefix)
+{
+	namespace_key_init(nskey, namespace, namespace_len + 1, prefix);
+	nskey->data[namespace_len] = ':';
+}
+
+static void
+namespace_key_clear(JRocksDBKey* nskey)
+{
+	g_free(nskey->heap);
+}
+
+static void
+column_family_free(gpointer data)
+{
+	rocksdb_column_family_handle_destroy(data);
+}
+
+/**
+ * Returns the column family for a namespace, optionally creating it.
+ **/
+static rocksdb_column_family_handle_t*
+get_column_family(JRocksDBData* bd, gchar const* namespace, gboolean create)
+{
+	rocksdb_column_family_handle_t* column_family;
+
+	g_mutex_lock(bd->column_family_mutex);
+
+	column_family = g_hash_table_lookup(bd->column_family_handles, namespace);
+
+	if (column_family == NULL && create)
+	{
+		g_autofree gchar* error = NULL;
+		g_autofree gchar* name = NULL;
+
+		name = g_strconcat(J_ROCKSDB_COLUMN_FAMILY_PREFIX, namespace, NULL);
+		column_family = rocksdb_create_column_family(bd->db, bd->options, name, &error);
+
+		if (error == NULL)
+		{
+			g_hash_table_insert(bd->column_family_handles, g_strdup(namespace), column_family);
+		}
+		else
+		{
+			column_family = NULL;
+		}
+	}
+
+	g_mutex_unlock(bd->column_family_mutex);
+
+	return column_family;
+}
+
+/**
+ * Makes sure that a batch that writes has a column family, if column families are used.
+ **/
 static gboolean
-backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* backend_batch)
+batch_prepare_write(JRocksDBData* bd, JRocksDBBatch* batch)
 {
-	JRocksDBBatch* batch;
+	if (bd->column_families && batch->column_family == NULL)
+	{
+		batch->column_family = get_column_family(bd, batch->namespace, TRUE);
 
-	(void)backend_data;
+		return (batch->column_family != NULL);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Looks up the column family of a batch without creating it.
+ * Another batch might have created it since the batch was started.
+ **/
+static rocksdb_column_family_handle_t*
+batch_lookup_column_family(JRocksDBData* bd, JRocksDBBatch* batch)
+{
+	if (batch->column_family == NULL)
+	{
+		batch->column_family = get_column_family(bd, batch->namespace, FALSE);
+	}
+
+	return batch->column_family;
+}
+
+/**
+ * Extracts the namespace (including the separator) from a key.
+ * This allows bloom filters and iterators to work on a per-namespace basis.
+ **/
+static char*
+namespace_transform(void* state, char const* key, size_t length, size_t* dst_length)
+{
+	char const* separator;
+
+	(void)state;
+
+	separator = memchr(key, ':', length);
+	*dst_length = (separator != NULL) ? (gsize)(separator - key) + 1 : length;
+
+	return (char*)key;
+}
+
+static unsigned char
+namespace_in_domain(void* state, char const* key, size_t length)
+{
+	(void)state;
+
+	return (memchr(key, ':', length) != NULL);
+}
+
+static unsigned char
+namespace_in_range(void* state, char const* key, size_t length)
+{
+	(void)state;
+	(void)key;
+	(void)length;
+
+	return 0;
+}
+
+static char const*
+namespace_name(void* state)
+{
+	(void)state;
+
+	return "julea.namespace";
+}
+
+static void
+namespace_destroy(void* state)
+{
+	(void)state;
+}
+
+static rocksdb_writeoptions_t*
+get_write_options(JRocksDBData* bd, JRocksDBBatch* batch)
+{
+	if (j_semantics_get(batch->semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_STORAGE)
+	{
+		return bd->write_options_sync;
+	}
+
+	return bd->write_options;
+}
+
+static guint32
+get_stripe(JRocksDBData* bd, gchar const* key)
+{
+	return 1 << (g_str_hash(key) % G_N_ELEMENTS(bd->stripe_mutex));
+}
+
+/**
+ * Locks stripes in ascending order, so batches cannot deadlock.
+ **/
+static void
+lock_stripes(JRocksDBData* bd, guint32 stripes)
+{
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		if (stripes & (1 << i))
+		{
+			g_mutex_lock(&(bd->stripe_mutex[i]));
+		}
+	}
+}
+
+static void
+unlock_stripes(JRocksDBData* bd, guint32 stripes)
+{
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		if (stripes & (1 << i))
+		{
+			g_mutex_unlock(&(bd->stripe_mutex[i]));
+		}
+	}
+}
+
+static void
+atomic_clear(gpointer data)
+{
+	JRocksDBAtomic* atomic = data;
+
+	rocksdb_writebatch_destroy(atomic->preceding);
+	g_free(atomic->value);
+	g_free(atomic->expected);
+}
+
+static JRocksDBAtomic*
+atomic_queue(JRocksDBData* bd, JRocksDBBatch* batch, JRocksDBAtomicType type, gchar const* key)
+{
+	JRocksDBAtomic atomic;
+	gsize key_len;
+
+	key_len = strlen(key) + 1;
+
+	atomic.type = type;
+	atomic.preceding = batch->batch;
+	// In column family mode, the prefix is empty
+	atomic.key_offset = batch->keys->len;
+	atomic.key_len = batch->prefix_len + key_len;
+	atomic.value = NULL;
+	atomic.len = 0;
+	atomic.expected = NULL;
+	atomic.expected_len = 0;
+	atomic.delta = 0;
+	atomic.result = NULL;
+	atomic.previous = NULL;
+
+	// Writes queued after the atomic operation have to be written after it has been applied
+	batch->batch = rocksdb_writebatch_create();
+	g_byte_array_append(batch->keys, (guint8 const*)batch->prefix, batch->prefix_len);
+	g_byte_array_append(batch->keys, (guint8 const*)key, key_len);
+	batch->stripes |= get_stripe(bd, (gchar const*)batch->keys->data + atomic.key_offset);
+
+	g_array_append_val(batch->atomics, atomic);
+
+	return &g_array_index(batch->atomics, JRocksDBAtomic, batch->atomics->len - 1);
+}
+
+/**
+ * Writes a value directly to the database, bypassing the batch.
+ **/
+static void
+atomic_put(JRocksDBData* bd, JRocksDBBatch* batch, JRocksDBAtomic const* atomic, gconstpointer value, gsize len, gchar** error)
+{
+	gchar const* key;
+
+	key = (gchar const*)batch->keys->data + atomic->key_offset;
+
+	if (batch->column_family != NULL)
+	{
+		rocksdb_put_cf(bd->db, get_write_options(bd, batch), batch->column_family, key, atomic->key_len, value, len, error);
+	}
+	else
+	{
+		rocksdb_put(bd->db, get_write_options(bd, batch), key, atomic->key_len, value, len, error);
+	}
+}
+
+/**
+ * Applies an atomic operation, the stripe of its key has to be locked.
+ **/
+static gboolean
+atomic_apply(JRocksDBData* bd, JRocksDBBatch* batch, JRocksDBAtomic* atomic)
+{
+	g_autofree gchar* result = NULL;
+	g_autofree gchar* rocksdb_error = NULL;
+	gchar const* key;
+	gsize result_len;
+	guint64 counter = 0;
+
+	key = (gchar const*)batch->keys->data + atomic->key_offset;
+
+	if (batch->column_family != NULL)
+	{
+		result = rocksdb_get_cf(bd->db, bd->read_options, batch->column_family, key, atomic->key_len, &result_len, &rocksdb_error);
+	}
+	else
+	{
+		result = rocksdb_get(bd->db, bd->read_options, key, atomic->key_len, &result_len, &rocksdb_error);
+	}
+
+	if (rocksdb_error != NULL)
+	{
+		return FALSE;
+	}
+
+	switch (atomic->type)
+	{
+		case J_ROCKSDB_ATOMIC_PUT_IF_ABSENT:
+			if (result == NULL)
+			{
+				atomic_put(bd, batch, atomic, atomic->value, atomic->len, &rocksdb_error);
+				*(atomic->result) = (rocksdb_error == NULL);
+			}
+			break;
+		case J_ROCKSDB_ATOMIC_COMPARE_AND_SWAP:
+			if (result != NULL && result_len == atomic->expected_len && memcmp(result, atomic->expected, atomic->expected_len) == 0)
+			{
+				atomic_put(bd, batch, atomic, atomic->value, atomic->len, &rocksdb_error);
+				*(atomic->result) = (rocksdb_error == NULL);
+			}
+			break;
+		case J_ROCKSDB_ATOMIC_FETCH_ADD:
+			// Values that are not 8 bytes long are not counters
+			if (result != NULL && result_len != sizeof(counter))
+			{
+				return FALSE;
+			}
+
+			if (result != NULL)
+			{
+				memcpy(&counter, result, sizeof(counter));
+			}
+
+			*(atomic->previous) = GUINT64_FROM_LE(counter);
+			counter = GUINT64_TO_LE((guint64)(*(atomic->previous)) + (guint64)atomic->delta);
+
+			atomic_put(bd, batch, atomic, &counter, sizeof(counter), &rocksdb_error);
+			break;
+		default:
+			g_warn_if_reached();
+	}
+
+	return (rocksdb_error == NULL);
+}
+
+static gboolean
+backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* semantics, gpointer* backend_batch)
+{
+	JRocksDBData* bd = backend_data;
+	JRocksDBBatch* batch = NULL;
 
 	g_return_val_if_fail(namespace != NULL, FALSE);
 	g_return_val_if_fail(backend_batch != NULL, FALSE);
@@ -68,12 +508,26 @@ backend_batch_start(gpointer backend_data, gchar const* namespace, JSemantics* s
 	batch = g_slice_new(JRocksDBBatch);
 
 	batch->batch = rocksdb_writebatch_create();
+	batch->atomics = g_array_new(FALSE, FALSE, sizeof(JRocksDBAtomic));
+	batch->keys = g_byte_array_new();
+	batch->stripes = 0;
+	batch->column_family = NULL;
 	batch->namespace = g_strdup(namespace);
+	batch->prefix = (bd->column_families) ? g_strdup("") : g_strconcat(namespace, ":", NULL);
+	batch->prefix_len = strlen(batch->prefix);
 	batch->semantics = j_semantics_ref(semantics);
 
+	g_array_set_clear_func(batch->atomics, atomic_clear);
+
+	// Column families are only looked up here, they are created when the batch writes
+	if (bd->column_families)
+	{
+		batch->column_family = get_column_family(bd, namespace, FALSE);
+	}
+
 	*backend_batch = batch;
 
-	return (batch != NULL);
+	return TRUE;
 }
 
 static gboolean
@@ -82,41 +536,71 @@ backend_batch_execute(gpointer backend_data, gpointer backend_batch)
 	JRocksDBBatch* batch = backend_batch;
 	JRocksDBData* bd = backend_data;
 
-	g_autofree gchar* rocksdb_error = NULL;
-
-	rocksdb_writeoptions_t* write_options = bd->write_options;
+	gboolean ret = TRUE;
 
 	g_return_val_if_fail(backend_batch != NULL, FALSE);
 
-	if (j_semantics_get(batch->semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_STORAGE)
+	lock_stripes(bd, batch->stripes);
+
+	// Atomic operations split the batch, the parts are written in order while all stripes are locked
+	for (guint i = 0; i < batch->atomics->len && ret; i++)
 	{
-		write_options = bd->write_options_sync;
+		JRocksDBAtomic* atomic = &g_array_index(batch->atomics, JRocksDBAtomic, i);
+		g_autofree gchar* rocksdb_error = NULL;
+
+		rocksdb_write(bd->db, get_write_options(bd, batch), atomic->preceding, &rocksdb_error);
+		ret = (rocksdb_error == NULL) && atomic_apply(bd, batch, atomic);
 	}
 
-	rocksdb_write(bd->db, write_options, batch->batch, &rocksdb_error);
+	if (ret)
+	{
+		g_autofree gchar* rocksdb_error = NULL;
+
+		rocksdb_write(bd->db, get_write_options(bd, batch), batch->batch, &rocksdb_error);
+		ret = (rocksdb_error == NULL);
+	}
+
+	unlock_stripes(bd, batch->stripes);
 
 	j_semantics_unref(batch->semantics);
 	g_free(batch->namespace);
+	g_free(batch->prefix);
+	g_array_unref(batch->atomics);
+	g_byte_array_unref(batch->keys);
 	rocksdb_writebatch_destroy(batch->batch);
 	g_slice_free(JRocksDBBatch, batch);
 
-	return (rocksdb_error == NULL);
+	return ret;
 }
 
 static gboolean
 backend_put(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer value, guint32 len)
 {
 	JRocksDBBatch* batch = backend_batch;
-	g_autofree gchar* nskey = NULL;
-
-	(void)backend_data;
+	JRocksDBData* bd = backend_data;
+	JRocksDBKey nskey;
 
 	g_return_val_if_fail(backend_batch != NULL, FALSE);
 	g_return_val_if_fail(key != NULL, FALSE);
 	g_return_val_if_fail(value != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
-	rocksdb_writebatch_put(batch->batch, nskey, strlen(nskey) + 1, value, len);
+	if (!batch_prepare_write(bd, batch))
+	{
+		return FALSE;
+	}
+
+	if (batch->column_family != NULL)
+	{
+		rocksdb_writebatch_put_cf(batch->batch, batch->column_family, key, strlen(key) + 1, value, len);
+		batch->stripes |= get_stripe(bd, key);
+	}
+	else
+	{
+		namespace_key_init(&nskey, batch->prefix, batch->prefix_len, key);
+		rocksdb_writebatch_put(batch->batch, nskey.data, nskey.len, value, len);
+		batch->stripes |= get_stripe(bd, nskey.data);
+		namespace_key_clear(&nskey);
+	}
 
 	return TRUE;
 }
@@ -125,15 +609,28 @@ static gboolean
 backend_delete(gpointer backend_data, gpointer backend_batch, gchar const* key)
 {
 	JRocksDBBatch* batch = backend_batch;
-	g_autofree gchar* nskey = NULL;
-
-	(void)backend_data;
+	JRocksDBData* bd = backend_data;
+	JRocksDBKey nskey;
 
 	g_return_val_if_fail(backend_batch != NULL, FALSE);
 	g_return_val_if_fail(key != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
-	rocksdb_writebatch_delete(batch->batch, nskey, strlen(nskey) + 1);
+	if (bd->column_families)
+	{
+		// A namespace without a column family does not contain any keys, there is nothing to delete
+		if (batch_lookup_column_family(bd, batch) != NULL)
+		{
+			rocksdb_writebatch_delete_cf(batch->batch, batch->column_family, key, strlen(key) + 1);
+			batch->stripes |= get_stripe(bd, key);
+		}
+	}
+	else
+	{
+		namespace_key_init(&nskey, batch->prefix, batch->prefix_len, key);
+		rocksdb_writebatch_delete(batch->batch, nskey.data, nskey.len);
+		batch->stripes |= get_stripe(bd, nskey.data);
+		namespace_key_clear(&nskey);
+	}
 
 	return TRUE;
 }
@@ -143,7 +640,7 @@ backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpo
 {
 	JRocksDBBatch* batch = backend_batch;
 	JRocksDBData* bd = backend_data;
-	g_autofree gchar* nskey = NULL;
+	JRocksDBKey nskey;
 	g_autofree gpointer result = NULL;
 	gsize result_len;
 
@@ -152,8 +649,20 @@ backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpo
 	g_return_val_if_fail(value != NULL, FALSE);
 	g_return_val_if_fail(len != NULL, FALSE);
 
-	nskey = g_strdup_printf("%s:%s", batch->namespace, key);
-	result = rocksdb_get(bd->db, bd->read_options, nskey, strlen(nskey) + 1, &result_len, NULL);
+	if (bd->column_families)
+	{
+		// A namespace without a column family does not contain any keys
+		if (batch_lookup_column_family(bd, batch) != NULL)
+		{
+			result = rocksdb_get_cf(bd->db, bd->read_options, batch->column_family, key, strlen(key) + 1, &result_len, NULL);
+		}
+	}
+	else
+	{
+		namespace_key_init(&nskey, batch->prefix, batch->prefix_len, key);
+		result = rocksdb_get(bd->db, bd->read_options, nskey.data, nskey.len, &result_len, NULL);
+		namespace_key_clear(&nskey);
+	}
 
 	if (result != NULL)
 	{
@@ -169,56 +678,162 @@ backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpo
 }
 
 static gboolean
-backend_get_all(gpointer backend_data, gchar const* namespace, gpointer* backend_iterator)
+backend_put_if_absent(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer value, guint32 len, gboolean* inserted)
 {
+	JRocksDBBatch* batch = backend_batch;
 	JRocksDBData* bd = backend_data;
-	JRocksDBIterator* iterator = NULL;
-	rocksdb_iterator_t* it;
+	JRocksDBAtomic* atomic;
 
-	g_return_val_if_fail(namespace != NULL, FALSE);
-	g_return_val_if_fail(backend_iterator != NULL, FALSE);
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(inserted != NULL, FALSE);
+
+	if (!batch_prepare_write(bd, batch))
+	{
+		return FALSE;
+	}
 
-	it = rocksdb_create_iterator(bd->db, bd->read_options);
+	atomic = atomic_queue(bd, batch, J_ROCKSDB_ATOMIC_PUT_IF_ABSENT, key);
+#if GLIB_CHECK_VERSION(2, 68, 0)
+	atomic->value = g_memdup2(value, len);
+#else
+	atomic->value = g_memdup(value, len);
+#endif
+	atomic->len = len;
+	atomic->result = inserted;
+
+	return TRUE;
+}
+
+static gboolean
+backend_compare_and_swap(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer expected, guint32 expected_len, gconstpointer value, guint32 len, gboolean* swapped)
+{
+	JRocksDBBatch* batch = backend_batch;
+	JRocksDBData* bd = backend_data;
+	JRocksDBAtomic* atomic;
 
-	if (it != NULL)
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(expected != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(swapped != NULL, FALSE);
+
+	if (!batch_prepare_write(bd, batch))
+	{
+		return FALSE;
+	}
+
+	atomic = atomic_queue(bd, batch, J_ROCKSDB_ATOMIC_COMPARE_AND_SWAP, key);
+#if GLIB_CHECK_VERSION(2, 68, 0)
+	atomic->value = g_memdup2(value, len);
+	atomic->expected = g_memdup2(expected, expected_len);
+#else
+	atomic->value = g_memdup(value, len);
+	atomic->expected = g_memdup(expected, expected_len);
+#endif
+	atomic->len = len;
+	atomic->expected_len = expected_len;
+	atomic->result = swapped;
+
+	return TRUE;
+}
+
+static gboolean
+backend_fetch_add(gpointer backend_data, gpointer backend_batch, gchar const* key, gint64 delta, gint64* previous)
+{
+	JRocksDBBatch* batch = backend_batch;
+	JRocksDBData* bd = backend_data;
+	JRocksDBAtomic* atomic;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(previous != NULL, FALSE);
+
+	if (!batch_prepare_write(bd, batch))
+	{
+		return FALSE;
+	}
+
+	atomic = atomic_queue(bd, batch, J_ROCKSDB_ATOMIC_FETCH_ADD, key);
+	atomic->delta = delta;
+	atomic->previous = previous;
+
+	return TRUE;
+}
+
+static JRocksDBIterator*
+iterator_new(JRocksDBData* bd, gchar const* namespace, gchar const* prefix)
+{
+	JRocksDBIterator* iterator;
+
+	iterator = g_slice_new(JRocksDBIterator);
+	iterator->iterator = NULL;
+	iterator->read_options = rocksdb_readoptions_create();
+	iterator->first = TRUE;
+
+	if (bd->column_families)
+	{
+		rocksdb_column_family_handle_t* column_family;
+
+		namespace_key_init(&(iterator->prefix), "", 0, prefix);
+		iterator->namespace_len = 0;
+
+		// Prefix seeks only work if the seek key contains the whole fixed-length prefix
+		if (bd->prefix_length > 0 && iterator->prefix.len - 1 >= bd->prefix_length)
+		{
+			rocksdb_readoptions_set_prefix_same_as_start(iterator->read_options, 1);
+		}
+		else
+		{
+			rocksdb_readoptions_set_total_order_seek(iterator->read_options, 1);
+		}
+
+		// A namespace without a column family does not contain any keys
+		column_family = get_column_family(bd, namespace, FALSE);
+
+		if (column_family != NULL)
+		{
+			iterator->iterator = rocksdb_create_iterator_cf(bd->db, iterator->read_options, column_family);
+		}
+	}
+	else
 	{
-		iterator = g_slice_new(JRocksDBIterator);
-		iterator->iterator = it;
-		iterator->first = TRUE;
-		iterator->prefix = g_strdup_printf("%s:", namespace);
 		iterator->namespace_len = strlen(namespace) + 1;
+		namespace_prefix_init(&(iterator->prefix), namespace, iterator->namespace_len - 1, prefix);
 
-		*backend_iterator = iterator;
+		rocksdb_readoptions_set_prefix_same_as_start(iterator->read_options, 1);
+		iterator->iterator = rocksdb_create_iterator(bd->db, iterator->read_options);
 	}
 
-	return (iterator != NULL);
+	return iterator;
 }
 
 static gboolean
-backend_get_by_prefix(gpointer backend_data, gchar const* namespace, gchar const* prefix, gpointer* backend_iterator)
+backend_get_all(gpointer backend_data, gchar const* namespace, gpointer* backend_iterator)
 {
 	JRocksDBData* bd = backend_data;
-	JRocksDBIterator* iterator = NULL;
-	rocksdb_iterator_t* it;
 
 	g_return_val_if_fail(namespace != NULL, FALSE);
-	g_return_val_if_fail(prefix != NULL, FALSE);
 	g_return_val_if_fail(backend_iterator != NULL, FALSE);
 
-	it = rocksdb_create_iterator(bd->db, bd->read_options);
+	*backend_iterator = iterator_new(bd, namespace, "");
 
-	if (it != NULL)
-	{
-		iterator = g_slice_new(JRocksDBIterator);
-		iterator->iterator = it;
-		iterator->first = TRUE;
-		iterator->prefix = g_strdup_printf("%s:%s", namespace, prefix);
-		iterator->namespace_len = strlen(namespace) + 1;
+	return TRUE;
+}
 
-		*backend_iterator = iterator;
-	}
+static gboolean
+backend_get_by_prefix(gpointer backend_data, gchar const* namespace, gchar const* prefix, gpointer* backend_iterator)
+{
+	JRocksDBData* bd = backend_data;
 
-	return (iterator != NULL);
+	g_return_val_if_fail(namespace != NULL, FALSE);
+	g_return_val_if_fail(prefix != NULL, FALSE);
+	g_return_val_if_fail(backend_iterator != NULL, FALSE);
+
+	*backend_iterator = iterator_new(bd, namespace, prefix);
+
+	return TRUE;
 }
 
 static gboolean
@@ -233,9 +848,14 @@ backend_iterate(gpointer backend_data, gpointer backend_iterator, gchar const**
 	g_return_val_if_fail(value != NULL, FALSE);
 	g_return_val_if_fail(len != NULL, FALSE);
 
+	if (iterator->iterator == NULL)
+	{
+		goto out;
+	}
+
 	if (iterator->first)
 	{
-		rocksdb_iter_seek(iterator->iterator, iterator->prefix, strlen(iterator->prefix));
+		rocksdb_iter_seek(iterator->iterator, iterator->prefix.data, iterator->prefix.len - 1);
 		iterator->first = FALSE;
 	}
 	else
@@ -250,7 +870,7 @@ backend_iterate(gpointer backend_data, gpointer backend_iterator, gchar const**
 
 		key_ = rocksdb_iter_key(iterator->iterator, &tmp);
 
-		if (!g_str_has_prefix(key_, iterator->prefix))
+		if (tmp < iterator->prefix.len - 1 || memcmp(key_, iterator->prefix.data, iterator->prefix.len - 1) != 0)
 		{
 			goto out;
 		}
@@ -263,41 +883,182 @@ backend_iterate(gpointer backend_data, gpointer backend_iterator, gchar const**
 	}
 
 out:
-	g_free(iterator->prefix);
-	rocksdb_iter_destroy(iterator->iterator);
+	namespace_key_clear(&(iterator->prefix));
+
+	if (iterator->iterator != NULL)
+	{
+		rocksdb_iter_destroy(iterator->iterator);
+	}
+
+	rocksdb_readoptions_destroy(iterator->read_options);
 	g_slice_free(JRocksDBIterator, iterator);
 
 	return FALSE;
 }
 
+static gboolean
+open_column_families(JRocksDBData* bd, gchar const* path)
+{
+	g_autofree gchar* error = NULL;
+	g_autofree rocksdb_options_t const** column_family_options = NULL;
+	g_autofree rocksdb_column_family_handle_t** column_family_handles = NULL;
+	gchar** column_family_names;
+	gchar const* default_names[] = { "default" };
+	gchar const* const* names = default_names;
+	gsize column_family_count = 1;
+
+	column_family_names = rocksdb_list_column_families(bd->options, path, &column_family_count, &error);
+
+	if (column_family_names != NULL)
+	{
+		names = (gchar const* const*)column_family_names;
+	}
+	else
+	{
+		// The database does not exist yet
+		column_family_count = 1;
+	}
+
+	column_family_options = g_new(rocksdb_options_t const*, column_family_count);
+	column_family_handles = g_new(rocksdb_column_family_handle_t*, column_family_count);
+
+	for (gsize i = 0; i < column_family_count; i++)
+	{
+		column_family_options[i] = bd->options;
+	}
+
+	g_clear_pointer(&error, g_free);
+	bd->db = rocksdb_open_column_families(bd->options, path, column_family_count, names, column_family_options, column_family_handles, &error);
+
+	if (bd->db != NULL)
+	{
+		for (gsize i = 0; i < column_family_count; i++)
+		{
+			// Only column families belonging to namespaces are needed, the default one is unused
+			if (g_str_has_prefix(names[i], J_ROCKSDB_COLUMN_FAMILY_PREFIX))
+			{
+				g_hash_table_insert(bd->column_family_handles, g_strdup(names[i] + strlen(J_ROCKSDB_COLUMN_FAMILY_PREFIX)), column_family_handles[i]);
+			}
+			else
+			{
+				rocksdb_column_family_handle_destroy(column_family_handles[i]);
+			}
+		}
+	}
+
+	if (column_family_names != NULL)
+	{
+		rocksdb_list_column_families_destroy(column_family_names, column_family_count);
+	}
+
+	return (bd->db != NULL);
+}
+
 static gboolean
 backend_init(gchar const* path, gpointer* backend_data)
 {
 	JRocksDBData* bd;
-	rocksdb_options_t* options;
+	rocksdb_block_based_table_options_t* table_options;
+	g_auto(GStrv) split = NULL;
+	g_auto(GStrv) options = NULL;
 	g_autofree gchar* dirname = NULL;
+	gchar const* db_path;
+	// RocksDB's default block cache size is 8 MiB
+	gsize block_cache_size = 8 * 1024 * 1024;
 	gint const compressions[] = { rocksdb_lz4_compression, rocksdb_snappy_compression, rocksdb_no_compression };
 
 	g_return_val_if_fail(path != NULL, FALSE);
 
-	dirname = g_path_get_dirname(path);
+	// The path can be followed by options (path?option=value,...), only the first question mark separates them
+	split = g_strsplit(path, "?", 2);
+	db_path = split[0];
+
+	if (split[1] != NULL)
+	{
+		options = g_strsplit(split[1], ",", 0);
+	}
+
+	dirname = g_path_get_dirname(db_path);
 	g_mkdir_with_parents(dirname, 0700);
 
 	bd = g_slice_new(JRocksDBData);
+	bd->db = NULL;
+	bd->column_families = FALSE;
+	bd->prefix_length = 0;
+	bd->column_family_handles = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, column_family_free);
+	g_mutex_init(bd->column_family_mutex);
+
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		g_mutex_init(&(bd->stripe_mutex[i]));
+	}
+
+	for (guint i = 0; options != NULL && options[i] != NULL; i++)
+	{
+		g_auto(GStrv) option = NULL;
+
+		option = g_strsplit(options[i], "=", 2);
+
+		if (g_strcmp0(option[0], "column-families") == 0)
+		{
+			bd->column_families = (option[1] == NULL || g_ascii_strtoull(option[1], NULL, 10) != 0 || g_strcmp0(option[1], "true") == 0);
+		}
+		else if (g_strcmp0(option[0], "block-cache") == 0 && option[1] != NULL)
+		{
+			// The block cache size is given in MiB
+			block_cache_size = g_ascii_strtoull(option[1], NULL, 10) * 1024 * 1024;
+		}
+		else if (g_strcmp0(option[0], "prefix-length") == 0 && option[1] != NULL)
+		{
+			bd->prefix_length = g_ascii_strtoull(option[1], NULL, 10);
+		}
+		else
+		{
+			g_warning("Unknown RocksDB option %s.", options[i]);
+		}
+	}
+
 	bd->read_options = rocksdb_readoptions_create();
 	bd->write_options = rocksdb_writeoptions_create();
 	bd->write_options_sync = rocksdb_writeoptions_create();
 	rocksdb_writeoptions_set_sync(bd->write_options_sync, 1);
 
-	options = rocksdb_options_create();
-	rocksdb_options_set_create_if_missing(options, 1);
+	bd->options = rocksdb_options_create();
+	rocksdb_options_set_create_if_missing(bd->options, 1);
+
+	bd->block_cache = rocksdb_cache_create_lru(block_cache_size);
+
+	table_options = rocksdb_block_based_options_create();
+	rocksdb_block_based_options_set_block_cache(table_options, bd->block_cache);
+	rocksdb_block_based_options_set_filter_policy(table_options, rocksdb_filterpolicy_create_bloom(10));
+	rocksdb_options_set_block_based_table_factory(bd->options, table_options);
+	rocksdb_block_based_options_destroy(table_options);
+
+	if (!bd->column_families)
+	{
+		rocksdb_options_set_prefix_extractor(bd->options, rocksdb_slicetransform_create(NULL, namespace_destroy, namespace_transform, namespace_in_domain, namespace_in_range, namespace_name));
+		rocksdb_options_set_memtable_prefix_bloom_size_ratio(bd->options, 0.1);
+	}
+	else if (bd->prefix_length > 0)
+	{
+		rocksdb_options_set_prefix_extractor(bd->options, rocksdb_slicetransform_create_fixed_prefix(bd->prefix_length));
+		rocksdb_options_set_memtable_prefix_bloom_size_ratio(bd->options, 0.1);
+	}
 
 	for (guint i = 0; i < G_N_ELEMENTS(compressions); i++)
 	{
-		g_autofree gchar* error = NULL;
+		rocksdb_options_set_compression(bd->options, compressions[i]);
 
-		rocksdb_options_set_compression(options, compressions[i]);
-		bd->db = rocksdb_open(options, path, &error);
+		if (bd->column_families)
+		{
+			open_column_families(bd, db_path);
+		}
+		else
+		{
+			g_autofree gchar* error = NULL;
+
+			bd->db = rocksdb_open(bd->options, db_path, &error);
+		}
 
 		if (bd->db != NULL)
 		{
@@ -305,8 +1066,6 @@ backend_init(gchar const* path, gpointer* backend_data)
 		}
 	}
 
-	rocksdb_options_destroy(options);
-
 	*backend_data = bd;
 
 	return (bd->db != NULL);
@@ -321,11 +1080,23 @@ backend_fini(gpointer backend_data)
 	rocksdb_writeoptions_destroy(bd->write_options);
 	rocksdb_writeoptions_destroy(bd->write_options_sync);
 
+	// Column family handles have to be destroyed before closing the database
+	g_hash_table_unref(bd->column_family_handles);
+	g_mutex_clear(bd->column_family_mutex);
+
+	for (guint i = 0; i < G_N_ELEMENTS(bd->stripe_mutex); i++)
+	{
+		g_mutex_clear(&(bd->stripe_mutex[i]));
+	}
+
 	if (bd->db != NULL)
 	{
 		rocksdb_close(bd->db);
 	}
 
+	rocksdb_options_destroy(bd->options);
+	rocksdb_cache_destroy(bd->block_cache);
+
 	g_slice_free(JRocksDBData, bd);
 }
 
@@ -342,7 +1113,10 @@ static JBackend rocksdb_backend = {
 		.backend_get = backend_get,
 		.backend_get_all = backend_get_all,
 		.backend_get_by_prefix = backend_get_by_prefix,
-		.backend_iterate = backend_iterate }
+		.backend_iterate = backend_iterate,
+		.backend_put_if_absent = backend_put_if_absent,
+		.backend_compare_and_swap = backend_compare_and_swap,
+		.backend_fetch_add = backend_fetch_add }
 };
 
 G_MODULE_EXPORT
@@ -170,6 +170,116 @@ backend_get(gpointer backend_data, gpointer backend_batch, gchar const* key, gpo
 	return (result != NULL);
 }
 
+/**
+ * Atomic operations run inside the batch's transaction.
+ **/
+static gboolean
+backend_put_if_absent(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer value, guint32 len, gboolean* inserted)
+{
+	JSQLiteBatch* batch = backend_batch;
+	JSQLiteData* bd = backend_data;
+	sqlite3_stmt* stmt;
+	gint ret;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(inserted != NULL, FALSE);
+
+	// The unique index on (namespace, key) makes the insert a no-op for existing keys
+	sqlite3_prepare_v2(bd->db, "INSERT OR IGNORE INTO julea (namespace, key, value) VALUES (?, ?, ?);", -1, &stmt, NULL);
+	sqlite3_bind_text(stmt, 1, batch->namespace, -1, NULL);
+	sqlite3_bind_text(stmt, 2, key, -1, NULL);
+	sqlite3_bind_blob(stmt, 3, value, len, NULL);
+
+	ret = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	*inserted = (ret == SQLITE_DONE && sqlite3_changes(bd->db) > 0);
+
+	return (ret == SQLITE_DONE);
+}
+
+static gboolean
+backend_compare_and_swap(gpointer backend_data, gpointer backend_batch, gchar const* key, gconstpointer expected, guint32 expected_len, gconstpointer value, guint32 len, gboolean* swapped)
+{
+	JSQLiteBatch* batch = backend_batch;
+	JSQLiteData* bd = backend_data;
+	sqlite3_stmt* stmt;
+	gint ret;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(expected != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(swapped != NULL, FALSE);
+
+	sqlite3_prepare_v2(bd->db, "UPDATE julea SET value = ? WHERE namespace = ? AND key = ? AND value = ?;", -1, &stmt, NULL);
+	sqlite3_bind_blob(stmt, 1, value, len, NULL);
+	sqlite3_bind_text(stmt, 2, batch->namespace, -1, NULL);
+	sqlite3_bind_text(stmt, 3, key, -1, NULL);
+	sqlite3_bind_blob(stmt, 4, expected, expected_len, NULL);
+
+	ret = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	*swapped = (ret == SQLITE_DONE && sqlite3_changes(bd->db) > 0);
+
+	return (ret == SQLITE_DONE);
+}
+
+static gboolean
+backend_fetch_add(gpointer backend_data, gpointer backend_batch, gchar const* key, gint64 delta, gint64* previous)
+{
+	JSQLiteBatch* batch = backend_batch;
+	JSQLiteData* bd = backend_data;
+	sqlite3_stmt* stmt;
+	gint ret;
+	guint64 counter = 0;
+
+	g_return_val_if_fail(backend_batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(previous != NULL, FALSE);
+
+	sqlite3_prepare_v2(bd->db, "SELECT value FROM julea WHERE namespace = ? AND key = ?;", -1, &stmt, NULL);
+	sqlite3_bind_text(stmt, 1, batch->namespace, -1, NULL);
+	sqlite3_bind_text(stmt, 2, key, -1, NULL);
+
+	ret = sqlite3_step(stmt);
+
+	if (ret == SQLITE_ROW)
+	{
+		// Values that are not 8 bytes long are not counters
+		if (sqlite3_column_bytes(stmt, 0) != sizeof(counter))
+		{
+			sqlite3_finalize(stmt);
+			return FALSE;
+		}
+
+		memcpy(&counter, sqlite3_column_blob(stmt, 0), sizeof(counter));
+	}
+
+	sqlite3_finalize(stmt);
+
+	if (ret != SQLITE_ROW && ret != SQLITE_DONE)
+	{
+		return FALSE;
+	}
+
+	*previous = GUINT64_FROM_LE(counter);
+	counter = GUINT64_TO_LE((guint64)*previous + (guint64)delta);
+
+	sqlite3_prepare_v2(bd->db, "INSERT OR REPLACE INTO julea (namespace, key, value) VALUES (?, ?, ?);", -1, &stmt, NULL);
+	sqlite3_bind_text(stmt, 1, batch->namespace, -1, NULL);
+	sqlite3_bind_text(stmt, 2, key, -1, NULL);
+	sqlite3_bind_blob(stmt, 3, &counter, sizeof(counter), SQLITE_TRANSIENT);
+
+	ret = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	return (ret == SQLITE_DONE);
+}
+
 static gboolean
 backend_get_all(gpointer backend_data, gchar const* namespace, gpointer* backend_iterator)
 {
@@ -300,7 +410,10 @@ static JBackend sqlite_backend = {
 		.backend_get = backend_get,
 		.backend_get_all = backend_get_all,
 		.backend_get_by_prefix = backend_get_by_prefix,
-		.backend_iterate = backend_iterate }
+		.backend_iterate = backend_iterate,
+		.backend_put_if_absent = backend_put_if_absent,
+		.backend_compare_and_swap = backend_compare_and_swap,
+		.backend_fetch_add = backend_fetch_add }
 };
 
 G_MODULE_EXPORT
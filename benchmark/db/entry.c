@@ -18,8 +18,11 @@
 
 #include <julea-config.h>
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <gmodule.h>
 
 #include <string.h>
+#include <unistd.h>
 
 #include <julea.h>
 #include <julea-db.h>
@@ -275,6 +278,193 @@ _benchmark_db_update(BenchmarkRun* run, gchar const* namespace, gboolean use_bat
 
 	run->operations = ((use_index_all || use_index_single) ? N : (N / N_GET_DIVIDER));
 }
+
+static void
+_benchmark_db_insert_many(BenchmarkRun* run, gchar const* namespace, gboolean use_index_all)
+{
+	gboolean ret;
+	g_autoptr(JBatch) delete_batch = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	g_autoptr(GError) b_s_error = NULL;
+	g_autoptr(JDBSchema) b_scheme = NULL;
+	JDBEntry* entries[N];
+
+	semantics = j_benchmark_get_semantics();
+	delete_batch = j_batch_new(semantics);
+	batch = j_batch_new(semantics);
+
+	b_scheme = _benchmark_db_prepare_scheme(namespace, false, use_index_all, false, batch, delete_batch);
+
+	g_assert_nonnull(b_scheme);
+	g_assert_nonnull(run);
+
+	j_benchmark_timer_start(run);
+
+	while (j_benchmark_iterate(run))
+	{
+		for (gint i = 0; i < N; i++)
+		{
+			gint64 i_signed = ((i * SIGNED_FACTOR) % CLASS_MODULUS) - CLASS_LIMIT;
+			guint64 i_usigned = ((i * USIGNED_FACTOR) % CLASS_MODULUS);
+			gdouble i_float = i_signed * FLOAT_FACTOR;
+			g_autofree gchar* string = _benchmark_db_get_identifier(i);
+
+			entries[i] = j_db_entry_new(b_scheme, &b_s_error);
+			g_assert_null(b_s_error);
+
+			ret = j_db_entry_set_field(entries[i], "string", string, 0, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+
+			ret = j_db_entry_set_field(entries[i], "float", &i_float, 0, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+
+			ret = j_db_entry_set_field(entries[i], "sint", &i_signed, 0, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+
+			ret = j_db_entry_set_field(entries[i], "uint", &i_usigned, 0, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+		}
+
+		// All entries are shipped in one message and the ids come back in one reply
+		ret = j_db_entry_insert_many(entries, N, batch, &b_s_error);
+		g_assert_true(ret);
+		g_assert_null(b_s_error);
+
+		ret = j_batch_execute(batch);
+		g_assert_true(ret);
+
+		for (gint i = 0; i < N; i++)
+		{
+			j_db_entry_unref(entries[i]);
+		}
+	}
+
+	j_benchmark_timer_stop(run);
+
+	ret = j_batch_execute(delete_batch);
+	g_assert_true(ret);
+
+	run->operations = N;
+}
+
+static void
+_benchmark_db_update_set(BenchmarkRun* run, gchar const* namespace, gboolean use_index_all)
+{
+	gboolean ret;
+	g_autoptr(JBatch) delete_batch = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	g_autoptr(GError) b_s_error = NULL;
+	g_autoptr(JDBSchema) b_scheme = NULL;
+
+	semantics = j_benchmark_get_semantics();
+	delete_batch = j_batch_new(semantics);
+	batch = j_batch_new(semantics);
+
+	b_scheme = _benchmark_db_prepare_scheme(namespace, false, use_index_all, false, batch, delete_batch);
+
+	g_assert_nonnull(b_scheme);
+	g_assert_nonnull(run);
+
+	_benchmark_db_insert(NULL, b_scheme, NULL, true, false, false, false);
+
+	j_benchmark_timer_start(run);
+
+	while (j_benchmark_iterate(run))
+	{
+		// A single statement touches every row, since all "uint" values are below CLASS_MODULUS.
+		guint64 limit = CLASS_MODULUS;
+		gint64 i_signed = run->iterations;
+		guint64 count = 0;
+		g_autoptr(JDBSelector) selector = j_db_selector_new(b_scheme, J_DB_SELECTOR_MODE_AND, &b_s_error);
+		g_autoptr(JDBEntry) entry = j_db_entry_new(b_scheme, &b_s_error);
+
+		g_assert_null(b_s_error);
+
+		ret = j_db_entry_set_field(entry, "sint", &i_signed, 0, &b_s_error);
+		g_assert_true(ret);
+		g_assert_null(b_s_error);
+
+		ret = j_db_selector_add_field(selector, "uint", J_DB_SELECTOR_OPERATOR_LT, &limit, 0, &b_s_error);
+		g_assert_true(ret);
+		g_assert_null(b_s_error);
+
+		ret = j_db_entry_update_with_count(entry, selector, &count, batch, &b_s_error);
+		g_assert_true(ret);
+		g_assert_null(b_s_error);
+
+		ret = j_batch_execute(batch);
+		g_assert_true(ret);
+		g_assert_cmpuint(count, ==, N);
+	}
+
+	j_benchmark_timer_stop(run);
+
+	ret = j_batch_execute(delete_batch);
+	g_assert_true(ret);
+
+	run->operations = N;
+}
+
+static void
+_benchmark_db_delete_set(BenchmarkRun* run, gchar const* namespace, gboolean use_index_all)
+{
+	gboolean ret;
+	g_autoptr(JBatch) delete_batch = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	g_autoptr(GError) b_s_error = NULL;
+	g_autoptr(JDBSchema) b_scheme = NULL;
+
+	semantics = j_benchmark_get_semantics();
+	delete_batch = j_batch_new(semantics);
+	batch = j_batch_new(semantics);
+
+	b_scheme = _benchmark_db_prepare_scheme(namespace, false, use_index_all, false, batch, delete_batch);
+
+	g_assert_nonnull(b_scheme);
+	g_assert_nonnull(run);
+
+	while (j_benchmark_iterate(run))
+	{
+		guint64 limit = CLASS_MODULUS;
+		guint64 count = 0;
+		g_autoptr(JDBSelector) selector = j_db_selector_new(b_scheme, J_DB_SELECTOR_MODE_AND, &b_s_error);
+		g_autoptr(JDBEntry) entry = j_db_entry_new(b_scheme, &b_s_error);
+
+		g_assert_null(b_s_error);
+
+		// Only the delete itself is timed, the entries are reinserted every iteration.
+		_benchmark_db_insert(NULL, b_scheme, NULL, true, false, false, false);
+
+		ret = j_db_selector_add_field(selector, "uint", J_DB_SELECTOR_OPERATOR_LT, &limit, 0, &b_s_error);
+		g_assert_true(ret);
+		g_assert_null(b_s_error);
+
+		j_benchmark_timer_start(run);
+
+		ret = j_db_entry_delete_with_count(entry, selector, &count, batch, &b_s_error);
+		g_assert_true(ret);
+		g_assert_null(b_s_error);
+
+		ret = j_batch_execute(batch);
+		g_assert_true(ret);
+
+		j_benchmark_timer_stop(run);
+
+		g_assert_cmpuint(count, ==, N);
+	}
+
+	ret = j_batch_execute(delete_batch);
+	g_assert_true(ret);
+
+	run->operations = N;
+}
 static void _benchmark_db_workloadStreaming(BenchmarkRun *run,
 		gchar const *namespace, gboolean use_batch, gboolean use_index_all,
 		gboolean use_index_single) {
@@ -1693,6 +1883,406 @@ static void benchmark_db_update_batch_index_mixed(BenchmarkRun *run) {
 			true);
 }
 
+static void
+_benchmark_db_iterate(BenchmarkRun* run, gchar const* namespace, gboolean use_projection)
+{
+	gboolean ret;
+	g_autoptr(JBatch) delete_batch = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	g_autoptr(GError) b_s_error = NULL;
+	g_autoptr(JDBSchema) b_scheme = NULL;
+	gchar const* fields[] = { "uint", NULL };
+
+	semantics = j_benchmark_get_semantics();
+	delete_batch = j_batch_new(semantics);
+	batch = j_batch_new(semantics);
+
+	b_scheme = _benchmark_db_prepare_scheme(namespace, false, false, false, batch, delete_batch);
+
+	g_assert_nonnull(b_scheme);
+	g_assert_nonnull(run);
+
+	_benchmark_db_insert(NULL, b_scheme, NULL, true, false, false, false);
+
+	j_benchmark_timer_start(run);
+
+	while (j_benchmark_iterate(run))
+	{
+		g_autoptr(JDBIterator) iterator = NULL;
+		guint entries = 0;
+
+		// Only "uint" is read, so the projection does not have to transfer the other fields
+		iterator = j_db_iterator_new_with_fields(b_scheme, NULL, use_projection ? fields : NULL, &b_s_error);
+		g_assert_nonnull(iterator);
+		g_assert_null(b_s_error);
+
+		while (j_db_iterator_next(iterator, NULL))
+		{
+			JDBType type;
+			guint64 len;
+			g_autofree guint64* value = NULL;
+
+			ret = j_db_iterator_get_field(iterator, "uint", &type, (gpointer*)&value, &len, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+
+			entries++;
+		}
+
+		g_assert_cmpuint(entries, ==, N);
+	}
+
+	j_benchmark_timer_stop(run);
+
+	ret = j_batch_execute(delete_batch);
+	g_assert_true(ret);
+
+	run->operations = N;
+}
+
+static void
+_benchmark_db_count(BenchmarkRun* run, gchar const* namespace, gboolean use_aggregate)
+{
+	gboolean ret;
+	g_autoptr(JBatch) delete_batch = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JSemantics) semantics = NULL;
+	g_autoptr(GError) b_s_error = NULL;
+	g_autoptr(JDBSchema) b_scheme = NULL;
+	gchar const* fields[] = { "uint", NULL };
+
+	semantics = j_benchmark_get_semantics();
+	delete_batch = j_batch_new(semantics);
+	batch = j_batch_new(semantics);
+
+	b_scheme = _benchmark_db_prepare_scheme(namespace, false, false, false, batch, delete_batch);
+
+	g_assert_nonnull(b_scheme);
+	g_assert_nonnull(run);
+
+	_benchmark_db_insert(NULL, b_scheme, NULL, true, false, false, false);
+
+	j_benchmark_timer_start(run);
+
+	while (j_benchmark_iterate(run))
+	{
+		g_autoptr(JDBSelector) selector = j_db_selector_new(b_scheme, J_DB_SELECTOR_MODE_AND, &b_s_error);
+		g_autoptr(JDBIterator) iterator = NULL;
+		guint64 entries = 0;
+
+		g_assert_null(b_s_error);
+
+		if (use_aggregate)
+		{
+			JDBType type;
+			guint64 len;
+			g_autofree guint64* count = NULL;
+
+			// The server counts the entries and only returns the result
+			ret = j_db_selector_add_aggregate(selector, J_DB_AGGREGATE_COUNT, NULL, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+
+			iterator = j_db_iterator_new(b_scheme, selector, &b_s_error);
+			g_assert_nonnull(iterator);
+			g_assert_null(b_s_error);
+
+			ret = j_db_iterator_next(iterator, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+
+			ret = j_db_iterator_get_aggregate(iterator, 0, &type, (gpointer*)&count, &len, &b_s_error);
+			g_assert_true(ret);
+			g_assert_null(b_s_error);
+
+			entries = *count;
+		}
+		else
+		{
+			iterator = j_db_iterator_new_with_fields(b_scheme, NULL, fields, &b_s_error);
+			g_assert_nonnull(iterator);
+			g_assert_null(b_s_error);
+
+			while (j_db_iterator_next(iterator, NULL))
+			{
+				entries++;
+			}
+		}
+
+		g_assert_cmpuint(entries, ==, N);
+	}
+
+	j_benchmark_timer_stop(run);
+
+	ret = j_batch_execute(delete_batch);
+	g_assert_true(ret);
+
+	run->operations = N;
+}
+
+struct BenchmarkDBBackendThread
+{
+	JBackend* backend;
+	guint index;
+	guint n;
+};
+
+typedef struct BenchmarkDBBackendThread BenchmarkDBBackendThread;
+
+static gpointer
+_benchmark_db_backend_thread(gpointer data)
+{
+	guint const batch_size = 100;
+
+	BenchmarkDBBackendThread* thread = data;
+	g_autoptr(JSemantics) semantics = NULL;
+	gpointer batch = NULL;
+
+	semantics = j_benchmark_get_semantics();
+
+	for (guint i = 0; i < thread->n; i++)
+	{
+		bson_t entry[1];
+		bson_t id[1];
+
+		if (i % batch_size == 0)
+		{
+			j_backend_db_batch_start(thread->backend, "benchmark", semantics, &batch, NULL);
+		}
+
+		bson_init(entry);
+		bson_init(id);
+		bson_append_int32(entry, "thread", -1, thread->index);
+		bson_append_int64(entry, "value", -1, i);
+		j_backend_db_insert(thread->backend, batch, "backend", entry, id, NULL);
+		bson_destroy(id);
+		bson_destroy(entry);
+
+		if (i % batch_size == batch_size - 1 || i == thread->n - 1)
+		{
+			j_backend_db_batch_execute(thread->backend, batch, NULL);
+		}
+	}
+
+	// Read-only batches do not have to wait for writers in multi-threaded mode
+	for (guint i = 0; i < thread->n; i++)
+	{
+		bson_t selector[1];
+		bson_t condition[1];
+		bson_t row[1];
+		gpointer iterator = NULL;
+
+		bson_init(selector);
+		bson_append_int32(selector, "_mode", -1, J_DB_SELECTOR_MODE_AND);
+		bson_append_document_begin(selector, "0", -1, condition);
+		bson_append_utf8(condition, "_name", -1, "thread", -1);
+		bson_append_int32(condition, "_operator", -1, J_DB_SELECTOR_OPERATOR_EQ);
+		bson_append_int32(condition, "_value", -1, thread->index);
+		bson_append_document_end(selector, condition);
+		bson_append_document_begin(selector, "1", -1, condition);
+		bson_append_utf8(condition, "_name", -1, "value", -1);
+		bson_append_int32(condition, "_operator", -1, J_DB_SELECTOR_OPERATOR_EQ);
+		bson_append_int64(condition, "_value", -1, i);
+		bson_append_document_end(selector, condition);
+
+		j_backend_db_batch_start(thread->backend, "benchmark", semantics, &batch, NULL);
+
+		if (j_backend_db_query(thread->backend, batch, "backend", selector, &iterator, NULL))
+		{
+			while (TRUE)
+			{
+				gboolean ret;
+
+				bson_init(row);
+				ret = j_backend_db_iterate(thread->backend, iterator, row, NULL);
+				bson_destroy(row);
+
+				if (!ret)
+				{
+					break;
+				}
+			}
+		}
+
+		j_backend_db_batch_execute(thread->backend, batch, NULL);
+		bson_destroy(selector);
+	}
+
+	return NULL;
+}
+
+/**
+ * Measures how the SQLite backend scales with the number of server threads, without going through the client and server.
+ * The database is placed on tmpfs to factor out the storage device.
+ **/
+static void
+_benchmark_db_backend_sqlite(BenchmarkRun* run, gchar const* options, guint threads)
+{
+	guint const n = 10000;
+
+	GModule* module = NULL;
+	JBackend* backend = NULL;
+	g_autofree GThread** thread_handles = NULL;
+	g_autofree BenchmarkDBBackendThread* thread_data = NULL;
+	g_autofree gchar* db_path = NULL;
+	g_autofree gchar* path = NULL;
+	g_autofree gchar* wal_path = NULL;
+	g_autofree gchar* shm_path = NULL;
+
+	db_path = g_strdup_printf("/dev/shm/julea-benchmark-sqlite-%d.db", (gint)getpid());
+	path = g_strconcat(db_path, options, NULL);
+	wal_path = g_strconcat(db_path, "-wal", NULL);
+	shm_path = g_strconcat(db_path, "-shm", NULL);
+
+	if (!j_backend_load_server("sqlite", "server", J_BACKEND_TYPE_DB, &module, &backend) || backend == NULL)
+	{
+		return;
+	}
+
+	if (!j_backend_db_init(backend, path))
+	{
+		g_module_close(module);
+		return;
+	}
+
+	{
+		g_autoptr(JSemantics) semantics = NULL;
+		gpointer batch = NULL;
+		bson_t schema[1];
+		bson_t index[1];
+		bson_t index_fields[1];
+
+		semantics = j_benchmark_get_semantics();
+
+		bson_init(schema);
+		bson_append_int32(schema, "thread", -1, J_DB_TYPE_UINT32);
+		bson_append_int32(schema, "value", -1, J_DB_TYPE_UINT64);
+		bson_append_array_begin(schema, "_index", -1, index);
+		bson_append_array_begin(index, "0", -1, index_fields);
+		bson_append_utf8(index_fields, "0", -1, "thread", -1);
+		bson_append_utf8(index_fields, "1", -1, "value", -1);
+		bson_append_array_end(index, index_fields);
+		bson_append_array_end(schema, index);
+
+		j_backend_db_batch_start(backend, "benchmark", semantics, &batch, NULL);
+		j_backend_db_schema_create(backend, batch, "backend", schema, NULL);
+		j_backend_db_batch_execute(backend, batch, NULL);
+
+		bson_destroy(schema);
+	}
+
+	thread_handles = g_new(GThread*, threads);
+	thread_data = g_new(BenchmarkDBBackendThread, threads);
+
+	while (j_benchmark_iterate(run))
+	{
+		j_benchmark_timer_start(run);
+
+		for (guint i = 0; i < threads; i++)
+		{
+			thread_data[i].backend = backend;
+			thread_data[i].index = i;
+			thread_data[i].n = n / threads;
+
+			thread_handles[i] = g_thread_new("benchmark-db-backend", _benchmark_db_backend_thread, &(thread_data[i]));
+		}
+
+		for (guint i = 0; i < threads; i++)
+		{
+			g_thread_join(thread_handles[i]);
+		}
+
+		j_benchmark_timer_stop(run);
+	}
+
+	j_backend_db_fini(backend);
+	g_module_close(module);
+
+	g_unlink(db_path);
+	g_unlink(wal_path);
+	g_unlink(shm_path);
+
+	// Insert and query per entry
+	run->operations = (n / threads) * threads * 2;
+}
+
+static void
+benchmark_db_backend_sqlite_1(BenchmarkRun* run)
+{
+	_benchmark_db_backend_sqlite(run, "", 1);
+}
+
+static void
+benchmark_db_backend_sqlite_4(BenchmarkRun* run)
+{
+	_benchmark_db_backend_sqlite(run, "", 4);
+}
+
+static void
+benchmark_db_backend_sqlite_16(BenchmarkRun* run)
+{
+	_benchmark_db_backend_sqlite(run, "", 16);
+}
+
+static void
+benchmark_db_backend_sqlite_multi_thread_1(BenchmarkRun* run)
+{
+	_benchmark_db_backend_sqlite(run, ":multi-thread", 1);
+}
+
+static void
+benchmark_db_backend_sqlite_multi_thread_4(BenchmarkRun* run)
+{
+	_benchmark_db_backend_sqlite(run, ":multi-thread", 4);
+}
+
+static void
+benchmark_db_backend_sqlite_multi_thread_16(BenchmarkRun* run)
+{
+	_benchmark_db_backend_sqlite(run, ":multi-thread", 16);
+}
+
+static void benchmark_db_insert_many(BenchmarkRun *run) {
+	_benchmark_db_insert_many(run, "benchmark_insert_many", false);
+}
+
+static void benchmark_db_insert_many_index_all(BenchmarkRun *run) {
+	_benchmark_db_insert_many(run, "benchmark_insert_many_index_all", true);
+}
+
+static void benchmark_db_update_set(BenchmarkRun *run) {
+	_benchmark_db_update_set(run, "benchmark_update_set", false);
+}
+
+static void benchmark_db_update_set_index_all(BenchmarkRun *run) {
+	_benchmark_db_update_set(run, "benchmark_update_set_index_all", true);
+}
+
+static void benchmark_db_delete_set(BenchmarkRun *run) {
+	_benchmark_db_delete_set(run, "benchmark_delete_set", false);
+}
+
+static void benchmark_db_delete_set_index_all(BenchmarkRun *run) {
+	_benchmark_db_delete_set(run, "benchmark_delete_set_index_all", true);
+}
+
+static void benchmark_db_iterate_all_fields(BenchmarkRun *run) {
+	_benchmark_db_iterate(run, "benchmark_iterate_all_fields", false);
+}
+
+static void benchmark_db_iterate_projection(BenchmarkRun *run) {
+	_benchmark_db_iterate(run, "benchmark_iterate_projection", true);
+}
+
+static void benchmark_db_count_client(BenchmarkRun *run) {
+	_benchmark_db_count(run, "benchmark_count_client", false);
+}
+
+static void benchmark_db_count_aggregate(BenchmarkRun *run) {
+	_benchmark_db_count(run, "benchmark_count_aggregate", true);
+}
+
 void benchmark_db_entry(void) {
 	
 /*	
@@ -1725,6 +2315,24 @@ void benchmark_db_entry(void) {
 	j_benchmark_add("/db/entry/delete-batch-index-mixed",benchmark_db_delete_batch_index_mixed);    */
 	
 	
+	j_benchmark_add("/db/backend/sqlite-1", benchmark_db_backend_sqlite_1);
+	j_benchmark_add("/db/backend/sqlite-4", benchmark_db_backend_sqlite_4);
+	j_benchmark_add("/db/backend/sqlite-16", benchmark_db_backend_sqlite_16);
+	j_benchmark_add("/db/backend/sqlite-multi-thread-1", benchmark_db_backend_sqlite_multi_thread_1);
+	j_benchmark_add("/db/backend/sqlite-multi-thread-4", benchmark_db_backend_sqlite_multi_thread_4);
+	j_benchmark_add("/db/backend/sqlite-multi-thread-16", benchmark_db_backend_sqlite_multi_thread_16);
+
+	j_benchmark_add("/db/entry/insert-many", benchmark_db_insert_many);
+	j_benchmark_add("/db/entry/insert-many-index-all", benchmark_db_insert_many_index_all);
+	j_benchmark_add("/db/entry/update-set", benchmark_db_update_set);
+	j_benchmark_add("/db/entry/update-set-index-all", benchmark_db_update_set_index_all);
+	j_benchmark_add("/db/entry/delete-set", benchmark_db_delete_set);
+	j_benchmark_add("/db/entry/delete-set-index-all", benchmark_db_delete_set_index_all);
+	j_benchmark_add("/db/iterator/all-fields", benchmark_db_iterate_all_fields);
+	j_benchmark_add("/db/iterator/projection", benchmark_db_iterate_projection);
+	j_benchmark_add("/db/iterator/count-client", benchmark_db_count_client);
+	j_benchmark_add("/db/iterator/count-aggregate", benchmark_db_count_aggregate);
+
 	j_benchmark_add("/db/entry/workload 1(Scientific app)",benchmark_db_workloadScientific);      
 	j_benchmark_add("/db/entry/workload 2(Streaming)",benchmark_db_workloadStreaming);
 	j_benchmark_add("/db/entry/workload 3(Machine Learning)",benchmark_db_workloadML);
@@ -35,6 +35,10 @@
 
 #include <hdf5.h>
 
+// Filter identifiers registered with The HDF Group for the LZ4 and Zstandard filter plugins
+#define FILTER_LZ4 32004
+#define FILTER_ZSTD 32015
+
 static gchar const* vol_connector = NULL;
 
 static void
@@ -185,6 +189,37 @@ create_dataset(hid_t file, gchar const* name, guint dimensions)
 	return dataset;
 }
 
+/**
+ * Creates a chunked 1024x1024 dataset, filter can be 0 to disable compression.
+ **/
+static hid_t
+create_dataset_compressed(hid_t file, gchar const* name, H5Z_filter_t filter)
+{
+	hid_t dataset;
+	hid_t dataspace;
+	hid_t dcpl;
+
+	hsize_t dims[2] = { 1024, 1024 };
+	hsize_t chunk_dims[2] = { 256, 256 };
+
+	dataspace = H5Screate_simple(2, dims, NULL);
+	dcpl = H5Pcreate(H5P_DATASET_CREATE);
+	H5Pset_chunk(dcpl, 2, chunk_dims);
+
+	if (filter != 0)
+	{
+		H5Pset_shuffle(dcpl);
+		H5Pset_filter(dcpl, filter, H5Z_FLAG_OPTIONAL, 0, NULL);
+	}
+
+	dataset = H5Dcreate2(file, name, H5T_NATIVE_INT, dataspace, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+
+	H5Pclose(dcpl);
+	H5Sclose(dataspace);
+
+	return dataset;
+}
+
 static hid_t
 open_dataset(hid_t file, gchar const* name)
 {
@@ -555,6 +590,234 @@ benchmark_hdf_dataset_read_4k(BenchmarkRun* run)
 	_benchmark_hdf_dataset_read(run, 1);
 }
 
+static void
+_benchmark_hdf_dataset_compressed_write(BenchmarkRun* run, H5Z_filter_t filter)
+{
+	guint const n = 100;
+
+	hid_t file;
+	guint iter = 0;
+
+	set_semantics();
+
+	file = H5Fcreate("benchmark-dataset-compressed-write.h5", H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+
+	j_benchmark_timer_start(run);
+
+	while (j_benchmark_iterate(run))
+	{
+		for (guint i = 0; i < n; i++)
+		{
+			hid_t dataset;
+
+			g_autofree gchar* name = NULL;
+
+			name = g_strdup_printf("benchmark-dataset-compressed-write-%u", i + (iter * n));
+			dataset = create_dataset_compressed(file, name, filter);
+			// The data written by write_dataset() compresses well after being shuffled
+			write_dataset(dataset, 2);
+			H5Dclose(dataset);
+		}
+
+		iter++;
+	}
+
+	H5Fclose(file);
+
+	sync_file("benchmark-dataset-compressed-write.h5");
+
+	j_benchmark_timer_stop(run);
+
+	run->operations = n;
+	run->bytes = n * dimensions_to_size(2) * sizeof(int);
+}
+
+static void
+benchmark_hdf_dataset_compressed_write_none(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_compressed_write(run, 0);
+}
+
+static void
+benchmark_hdf_dataset_compressed_write_lz4(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_compressed_write(run, FILTER_LZ4);
+}
+
+static void
+benchmark_hdf_dataset_compressed_write_zstd(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_compressed_write(run, FILTER_ZSTD);
+}
+
+static void
+_benchmark_hdf_dataset_compressed_read(BenchmarkRun* run, H5Z_filter_t filter)
+{
+	guint const n = 100;
+
+	hid_t file;
+	guint iter = 0;
+
+	set_semantics();
+
+	file = H5Fcreate("benchmark-dataset-compressed-read.h5", H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+
+	while (j_benchmark_iterate(run))
+	{
+		for (guint i = 0; i < n; i++)
+		{
+			hid_t dataset;
+
+			g_autofree gchar* name = NULL;
+
+			name = g_strdup_printf("benchmark-dataset-compressed-read-%u", i + (iter * n));
+			dataset = create_dataset_compressed(file, name, filter);
+			write_dataset(dataset, 2);
+			H5Dclose(dataset);
+		}
+
+		discard_file("benchmark-dataset-compressed-read.h5");
+
+		j_benchmark_timer_start(run);
+
+		for (guint i = 0; i < n; i++)
+		{
+			hid_t dataset;
+
+			g_autofree gchar* name = NULL;
+
+			name = g_strdup_printf("benchmark-dataset-compressed-read-%u", i + (iter * n));
+			dataset = open_dataset(file, name);
+			read_dataset(dataset, 2);
+			H5Dclose(dataset);
+		}
+
+		j_benchmark_timer_stop(run);
+
+		iter++;
+	}
+
+	H5Fclose(file);
+
+	run->operations = n;
+	run->bytes = n * dimensions_to_size(2) * sizeof(int);
+}
+
+static void
+benchmark_hdf_dataset_compressed_read_none(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_compressed_read(run, 0);
+}
+
+static void
+benchmark_hdf_dataset_compressed_read_lz4(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_compressed_read(run, FILTER_LZ4);
+}
+
+static void
+benchmark_hdf_dataset_compressed_read_zstd(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_compressed_read(run, FILTER_ZSTD);
+}
+
+/**
+ * Writes contiguous 1024x1024 datasets of the given type.
+ * Statistics are calculated for all written data, which makes this benchmark sensitive to the statistics kernels.
+ **/
+static void
+_benchmark_hdf_dataset_type_write(BenchmarkRun* run, hid_t type)
+{
+	guint const n = 100;
+
+	hid_t dataspace;
+	hid_t file;
+	guint iter = 0;
+
+	hsize_t dims[2] = { 1024, 1024 };
+
+	gsize size;
+	g_autofree guint32* data = NULL;
+
+	set_semantics();
+
+	size = dims[0] * dims[1] * H5Tget_size(type);
+	data = g_new(guint32, size / sizeof(guint32));
+
+	// Random bits make sure that minimum and maximum change throughout the dataset
+	for (gsize i = 0; i < size / sizeof(guint32); i++)
+	{
+		data[i] = g_random_int();
+	}
+
+	if (H5Tget_class(type) == H5T_FLOAT)
+	{
+		// Avoid NaNs and infinities by restricting the exponents (this also works for doubles)
+		for (gsize i = 0; i < size / sizeof(guint32); i++)
+		{
+			data[i] &= 0x807fffff;
+			data[i] |= 0x3f800000;
+		}
+	}
+
+	dataspace = H5Screate_simple(2, dims, NULL);
+	file = H5Fcreate("benchmark-dataset-type-write.h5", H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+
+	j_benchmark_timer_start(run);
+
+	while (j_benchmark_iterate(run))
+	{
+		for (guint i = 0; i < n; i++)
+		{
+			hid_t dataset;
+
+			g_autofree gchar* name = NULL;
+
+			name = g_strdup_printf("benchmark-dataset-type-write-%u", i + (iter * n));
+			dataset = H5Dcreate2(file, name, type, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+			H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+			H5Dclose(dataset);
+		}
+
+		iter++;
+	}
+
+	H5Fclose(file);
+
+	sync_file("benchmark-dataset-type-write.h5");
+
+	j_benchmark_timer_stop(run);
+
+	H5Sclose(dataspace);
+
+	run->operations = n;
+	run->bytes = n * size;
+}
+
+static void
+benchmark_hdf_dataset_type_write_int8(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_type_write(run, H5T_NATIVE_SCHAR);
+}
+
+static void
+benchmark_hdf_dataset_type_write_int64(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_type_write(run, H5T_NATIVE_INT64);
+}
+
+static void
+benchmark_hdf_dataset_type_write_float(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_type_write(run, H5T_NATIVE_FLOAT);
+}
+
+static void
+benchmark_hdf_dataset_type_write_double(BenchmarkRun* run)
+{
+	_benchmark_hdf_dataset_type_write(run, H5T_NATIVE_DOUBLE);
+}
+
 static void
 benchmark_hdf_file_create(BenchmarkRun* run)
 {
@@ -747,6 +1010,16 @@ benchmark_hdf(void)
 	j_benchmark_add("/hdf5/dataset4K/open", benchmark_hdf_dataset_open_4k);
 	j_benchmark_add("/hdf5/dataset4K/write", benchmark_hdf_dataset_write_4k);
 	j_benchmark_add("/hdf5/dataset4K/read", benchmark_hdf_dataset_read_4k);
+	j_benchmark_add("/hdf5/dataset4M-chunked/write", benchmark_hdf_dataset_compressed_write_none);
+	j_benchmark_add("/hdf5/dataset4M-chunked/read", benchmark_hdf_dataset_compressed_read_none);
+	j_benchmark_add("/hdf5/dataset4M-lz4/write", benchmark_hdf_dataset_compressed_write_lz4);
+	j_benchmark_add("/hdf5/dataset4M-lz4/read", benchmark_hdf_dataset_compressed_read_lz4);
+	j_benchmark_add("/hdf5/dataset4M-zstd/write", benchmark_hdf_dataset_compressed_write_zstd);
+	j_benchmark_add("/hdf5/dataset4M-zstd/read", benchmark_hdf_dataset_compressed_read_zstd);
+	j_benchmark_add("/hdf5/dataset1M-int8/write", benchmark_hdf_dataset_type_write_int8);
+	j_benchmark_add("/hdf5/dataset8M-int64/write", benchmark_hdf_dataset_type_write_int64);
+	j_benchmark_add("/hdf5/dataset4M-float/write", benchmark_hdf_dataset_type_write_float);
+	j_benchmark_add("/hdf5/dataset8M-double/write", benchmark_hdf_dataset_type_write_double);
 	j_benchmark_add("/hdf5/file/create", benchmark_hdf_file_create);
 	j_benchmark_add("/hdf5/file/open", benchmark_hdf_file_open);
 	j_benchmark_add("/hdf5/group/create", benchmark_hdf_group_create);
@@ -19,8 +19,11 @@
 #include <julea-config.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <gmodule.h>
 
 #include <string.h>
+#include <unistd.h>
 
 #include <julea.h>
 #include <julea-kv.h>
@@ -1257,6 +1260,194 @@ benchmark_kv_unordered_put_delete_batch(BenchmarkRun* run)
 	_benchmark_kv_unordered_put_delete(run, TRUE);
 }
 
+struct BenchmarkKVBackendThread
+{
+	JBackend* backend;
+	guint index;
+	guint n;
+};
+
+typedef struct BenchmarkKVBackendThread BenchmarkKVBackendThread;
+
+static gpointer
+_benchmark_kv_backend_thread(gpointer data)
+{
+	guint const batch_size = 100;
+
+	BenchmarkKVBackendThread* thread = data;
+	g_autoptr(JSemantics) semantics = NULL;
+	g_autoptr(GPtrArray) keys = NULL;
+	g_autofree gchar* namespace = NULL;
+	gpointer batch = NULL;
+
+	semantics = j_benchmark_get_semantics();
+	namespace = g_strdup_printf("benchmark-%u", thread->index);
+	keys = g_ptr_array_new_full(batch_size, g_free);
+
+	for (guint i = 0; i < thread->n; i++)
+	{
+		gchar* key;
+
+		if (i % batch_size == 0)
+		{
+			j_backend_kv_batch_start(thread->backend, namespace, semantics, &batch);
+		}
+
+		// Backends may only access keys and values when the batch is executed
+		key = g_strdup_printf("benchmark-%u", i);
+		g_ptr_array_add(keys, key);
+		j_backend_kv_put(thread->backend, batch, key, key, strlen(key) + 1);
+
+		if (i % batch_size == batch_size - 1 || i == thread->n - 1)
+		{
+			j_backend_kv_batch_execute(thread->backend, batch);
+			g_ptr_array_set_size(keys, 0);
+		}
+	}
+
+	j_backend_kv_batch_start(thread->backend, namespace, semantics, &batch);
+
+	for (guint i = 0; i < thread->n; i++)
+	{
+		g_autofree gchar* key = NULL;
+		gpointer value;
+		guint32 len;
+
+		key = g_strdup_printf("benchmark-%u", i);
+
+		if (j_backend_kv_get(thread->backend, batch, key, &value, &len))
+		{
+			g_free(value);
+		}
+	}
+
+	j_backend_kv_batch_execute(thread->backend, batch);
+
+	return NULL;
+}
+
+/**
+ * Compares KV backends directly, without going through the client and server.
+ * The backends are loaded in-process, lmdb uses a directory on tmpfs to factor out the storage device.
+ **/
+static void
+_benchmark_kv_backend(BenchmarkRun* run, gchar const* name, gchar const* path, guint threads)
+{
+	guint const n = 10000;
+
+	GModule* module = NULL;
+	JBackend* backend = NULL;
+	g_autofree GThread** thread_handles = NULL;
+	g_autofree BenchmarkKVBackendThread* thread_data = NULL;
+
+	if (!j_backend_load_server(name, "server", J_BACKEND_TYPE_KV, &module, &backend) || backend == NULL)
+	{
+		return;
+	}
+
+	if (!j_backend_kv_init(backend, path))
+	{
+		g_module_close(module);
+		return;
+	}
+
+	thread_handles = g_new(GThread*, threads);
+	thread_data = g_new(BenchmarkKVBackendThread, threads);
+
+	while (j_benchmark_iterate(run))
+	{
+		j_benchmark_timer_start(run);
+
+		for (guint i = 0; i < threads; i++)
+		{
+			thread_data[i].backend = backend;
+			thread_data[i].index = i;
+			thread_data[i].n = n / threads;
+
+			thread_handles[i] = g_thread_new("benchmark-kv-backend", _benchmark_kv_backend_thread, &(thread_data[i]));
+		}
+
+		for (guint i = 0; i < threads; i++)
+		{
+			g_thread_join(thread_handles[i]);
+		}
+
+		j_benchmark_timer_stop(run);
+	}
+
+	j_backend_kv_fini(backend);
+	g_module_close(module);
+
+	// Put and get per key
+	run->operations = (n / threads) * threads * 2;
+}
+
+static void
+_benchmark_kv_backend_lmdb(BenchmarkRun* run, guint threads)
+{
+	g_autofree gchar* path = NULL;
+	g_autofree gchar* data_path = NULL;
+	g_autofree gchar* lock_path = NULL;
+
+	path = g_strdup_printf("/dev/shm/julea-benchmark-lmdb-%d", (gint)getpid());
+	data_path = g_build_filename(path, "data.mdb", NULL);
+	lock_path = g_build_filename(path, "lock.mdb", NULL);
+
+	_benchmark_kv_backend(run, "lmdb", path, threads);
+
+	g_unlink(data_path);
+	g_unlink(lock_path);
+	g_rmdir(path);
+}
+
+static void
+benchmark_kv_backend_memory_1(BenchmarkRun* run)
+{
+	_benchmark_kv_backend(run, "memory", "", 1);
+}
+
+static void
+benchmark_kv_backend_memory_4(BenchmarkRun* run)
+{
+	_benchmark_kv_backend(run, "memory", "", 4);
+}
+
+static void
+benchmark_kv_backend_memory_16(BenchmarkRun* run)
+{
+	_benchmark_kv_backend(run, "memory", "", 16);
+}
+
+static void
+benchmark_kv_backend_memory_64(BenchmarkRun* run)
+{
+	_benchmark_kv_backend(run, "memory", "", 64);
+}
+
+static void
+benchmark_kv_backend_lmdb_1(BenchmarkRun* run)
+{
+	_benchmark_kv_backend_lmdb(run, 1);
+}
+
+static void
+benchmark_kv_backend_lmdb_4(BenchmarkRun* run)
+{
+	_benchmark_kv_backend_lmdb(run, 4);
+}
+
+static void
+benchmark_kv_backend_lmdb_16(BenchmarkRun* run)
+{
+	_benchmark_kv_backend_lmdb(run, 16);
+}
+
+static void
+benchmark_kv_backend_lmdb_64(BenchmarkRun* run)
+{
+	_benchmark_kv_backend_lmdb(run, 64);
+}
+
 void
 benchmark_kv(void)
 {
@@ -1276,4 +1467,13 @@ benchmark_kv(void)
  	j_benchmark_add("/kv/benchmark_kv_AutoSysWorkload", benchmark_kv_AutoSysWorkload); 
         j_benchmark_add("/kv/benchmark_kv_MLWorkload", benchmark_kv_MLWorkload); 
   	j_benchmark_add("/kv/benchmark_kv_WriteIntensiveWorkload", benchmark_kv_WriteIntensiveWorkload);    
+
+	j_benchmark_add("/kv/backend/memory-1", benchmark_kv_backend_memory_1);
+	j_benchmark_add("/kv/backend/memory-4", benchmark_kv_backend_memory_4);
+	j_benchmark_add("/kv/backend/memory-16", benchmark_kv_backend_memory_16);
+	j_benchmark_add("/kv/backend/memory-64", benchmark_kv_backend_memory_64);
+	j_benchmark_add("/kv/backend/lmdb-1", benchmark_kv_backend_lmdb_1);
+	j_benchmark_add("/kv/backend/lmdb-4", benchmark_kv_backend_lmdb_4);
+	j_benchmark_add("/kv/backend/lmdb-16", benchmark_kv_backend_lmdb_16);
+	j_benchmark_add("/kv/backend/lmdb-64", benchmark_kv_backend_lmdb_64);
 }
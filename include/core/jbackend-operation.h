@@ -66,6 +66,12 @@ struct JBackendOperationParam
 
 			const gchar* error_quark_string;
 		};
+
+		struct
+		{
+			// Fixed-size output blobs such as counters
+			guint64 value;
+		};
 	};
 
 	union
@@ -117,9 +123,14 @@ gboolean j_backend_operation_unwrap_db_schema_create(JBackend*, gpointer, JBacke
 gboolean j_backend_operation_unwrap_db_schema_get(JBackend*, gpointer, JBackendOperation*);
 gboolean j_backend_operation_unwrap_db_schema_delete(JBackend*, gpointer, JBackendOperation*);
 gboolean j_backend_operation_unwrap_db_insert(JBackend*, gpointer, JBackendOperation*);
+gboolean j_backend_operation_unwrap_db_insert_many(JBackend*, gpointer, JBackendOperation*);
 gboolean j_backend_operation_unwrap_db_update(JBackend*, gpointer, JBackendOperation*);
 gboolean j_backend_operation_unwrap_db_delete(JBackend*, gpointer, JBackendOperation*);
 gboolean j_backend_operation_unwrap_db_query(JBackend*, gpointer, JBackendOperation*);
+gboolean j_backend_operation_unwrap_db_query_next(JBackend*, gpointer, JBackendOperation*);
+gboolean j_backend_operation_unwrap_db_query_close(JBackend*, gpointer, JBackendOperation*);
+
+void j_backend_operation_db_cursors_free(void);
 
 gboolean j_backend_operation_to_message(JMessage* message, JBackendOperationParam* data, guint len);
 gboolean j_backend_operation_from_message(JMessage* message, JBackendOperationParam* data, guint len);
@@ -144,21 +155,31 @@ static const JBackendOperation j_backend_operation_db_schema_create = {
 	.out_param_count = 1,
 };
 
+/**
+ * The last input parameter is the version of the client's cached schema (guint64), 0 if there is none.
+ * The schema's current version is returned as the second output parameter.
+ * If it matches the cached version, the schema is not fetched and an empty document is returned instead.
+ **/
 static const JBackendOperation j_backend_operation_db_schema_get = {
 	.in_param = {
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB },
 	},
 	.out_param = {
 		{
 			.type = J_BACKEND_OPERATION_PARAM_TYPE_BSON,
 			.bson_initialized = TRUE,
 		},
+		{
+			.type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB,
+			.len = sizeof(guint64),
+		},
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_ERROR },
 	},
 	.backend_func = j_backend_operation_unwrap_db_schema_get,
-	.in_param_count = 2,
-	.out_param_count = 2,
+	.in_param_count = 3,
+	.out_param_count = 3,
 };
 
 static const JBackendOperation j_backend_operation_db_schema_delete = {
@@ -195,6 +216,27 @@ static const JBackendOperation j_backend_operation_db_insert = {
 	.out_param_count = 2,
 };
 
+static const JBackendOperation j_backend_operation_db_insert_many = {
+	.in_param = {
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
+		{
+			.type = J_BACKEND_OPERATION_PARAM_TYPE_BSON,
+			.bson_initialized = TRUE,
+		},
+	},
+	.out_param = {
+		{
+			.type = J_BACKEND_OPERATION_PARAM_TYPE_BSON,
+			.bson_initialized = TRUE,
+		},
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_ERROR },
+	},
+	.backend_func = j_backend_operation_unwrap_db_insert_many,
+	.in_param_count = 3,
+	.out_param_count = 2,
+};
+
 static const JBackendOperation j_backend_operation_db_update = {
 	.in_param = {
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
@@ -209,11 +251,15 @@ static const JBackendOperation j_backend_operation_db_update = {
 		},
 	},
 	.out_param = {
+		{
+			.type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB,
+			.len = sizeof(guint64),
+		},
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_ERROR },
 	},
 	.backend_func = j_backend_operation_unwrap_db_update,
 	.in_param_count = 4,
-	.out_param_count = 1,
+	.out_param_count = 2,
 };
 
 static const JBackendOperation j_backend_operation_db_delete = {
@@ -226,13 +272,22 @@ static const JBackendOperation j_backend_operation_db_delete = {
 		},
 	},
 	.out_param = {
+		{
+			.type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB,
+			.len = sizeof(guint64),
+		},
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_ERROR },
 	},
 	.backend_func = j_backend_operation_unwrap_db_delete,
 	.in_param_count = 3,
-	.out_param_count = 1,
+	.out_param_count = 2,
 };
 
+/**
+ * The last input parameter is the page size (guint32), 0 returns all entries at once.
+ * If more entries remain, the page ends with a "_cursor" key that can be passed to j_backend_operation_db_query_next.
+ * If the selector contains "_row", the entries are returned as "_rows" in the binary row format (see JBackendDBRow).
+ **/
 static const JBackendOperation j_backend_operation_db_query = {
 	.in_param = {
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
@@ -241,6 +296,7 @@ static const JBackendOperation j_backend_operation_db_query = {
 			.type = J_BACKEND_OPERATION_PARAM_TYPE_BSON,
 			.bson_initialized = TRUE,
 		},
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB },
 	},
 	.out_param = {
 		{
@@ -250,10 +306,47 @@ static const JBackendOperation j_backend_operation_db_query = {
 		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_ERROR },
 	},
 	.backend_func = j_backend_operation_unwrap_db_query,
+	.in_param_count = 4,
+	.out_param_count = 2,
+};
+
+/**
+ * Input parameters are the namespace, the cursor (guint32) and the page size (guint32).
+ **/
+static const JBackendOperation j_backend_operation_db_query_next = {
+	.in_param = {
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB },
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB },
+	},
+	.out_param = {
+		{
+			.type = J_BACKEND_OPERATION_PARAM_TYPE_BSON,
+			.bson_initialized = TRUE,
+		},
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_ERROR },
+	},
+	.backend_func = j_backend_operation_unwrap_db_query_next,
 	.in_param_count = 3,
 	.out_param_count = 2,
 };
 
+/**
+ * Input parameters are the namespace and the cursor (guint32).
+ **/
+static const JBackendOperation j_backend_operation_db_query_close = {
+	.in_param = {
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_STR },
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_BLOB },
+	},
+	.out_param = {
+		{ .type = J_BACKEND_OPERATION_PARAM_TYPE_ERROR },
+	},
+	.backend_func = j_backend_operation_unwrap_db_query_close,
+	.in_param_count = 2,
+	.out_param_count = 1,
+};
+
 G_END_DECLS
 
 #endif
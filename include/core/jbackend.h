@@ -121,6 +121,17 @@ enum JBackendComponent
 
 typedef enum JBackendComponent JBackendComponent;
 
+/**
+ * A query result in the binary row format.
+ *
+ * The row's columns are requested by the client as part of the query.
+ * Every column has a fixed slot of 8 bytes, so values can be accessed by their column's index without looking up their name.
+ * Strings and blobs are stored behind the slots, which contain their offset and length.
+ **/
+struct JBackendDBRow;
+
+typedef struct JBackendDBRow JBackendDBRow;
+
 struct JBackend
 {
 	JBackendType type;
@@ -160,6 +171,11 @@ struct JBackend
 			gboolean (*backend_batch_start)(gpointer, gchar const*, JSemantics*, gpointer*);
 			gboolean (*backend_batch_execute)(gpointer, gpointer);
 
+			/**
+			 * Keys and values are only valid until the call returns.
+			 * Backends that defer writes until the batch is executed have to copy them.
+			 **/
+
 			gboolean (*backend_put)(gpointer, gpointer, gchar const*, gconstpointer, guint32);
 			gboolean (*backend_delete)(gpointer, gpointer, gchar const*);
 			gboolean (*backend_get)(gpointer, gpointer, gchar const*, gpointer*, guint32*);
@@ -167,6 +183,67 @@ struct JBackend
 			gboolean (*backend_get_all)(gpointer, gchar const*, gpointer*);
 			gboolean (*backend_get_by_prefix)(gpointer, gchar const*, gchar const*, gpointer*);
 			gboolean (*backend_iterate)(gpointer, gpointer, gchar const**, gconstpointer*, guint32*);
+
+			/**
+			* Gets a part of a value (optional)
+			*
+			* If a backend does not implement this, the whole value is read using backend_get.
+			*
+			* \param[in]  key    The key
+			* \param[in]  offset The offset to start reading at
+			* \param[in]  length The number of bytes to read
+			* \param[out] value  The requested part, NULL if it is empty
+			* \param[out] len    The requested part's length, which is shorter than length if the value ends earlier
+			*
+			* \return TRUE if the key exists, FALSE otherwise.
+			**/
+			gboolean (*backend_get_range)(gpointer, gpointer, gchar const*, guint64, guint64, gpointer*, guint32*);
+
+			/**
+			 * Atomic operations (optional)
+			 *
+			 * These operations are executed atomically with respect to each other.
+			 * The results might only be available after backend_batch_execute has returned.
+			 **/
+
+			/**
+			* Puts a value if the key does not exist yet
+			*
+			* \param[in]  key      The key
+			* \param[in]  value    The value
+			* \param[in]  len      The value's length
+			* \param[out] inserted Whether the value has been put
+			*
+			* \return TRUE on success, FALSE otherwise.
+			**/
+			gboolean (*backend_put_if_absent)(gpointer, gpointer, gchar const*, gconstpointer, guint32, gboolean*);
+
+			/**
+			* Replaces a value if it matches the expected value
+			*
+			* \param[in]  key          The key
+			* \param[in]  expected     The expected value
+			* \param[in]  expected_len The expected value's length
+			* \param[in]  value        The new value
+			* \param[in]  len          The new value's length
+			* \param[out] swapped      Whether the value has been replaced
+			*
+			* \return TRUE on success, FALSE otherwise.
+			**/
+			gboolean (*backend_compare_and_swap)(gpointer, gpointer, gchar const*, gconstpointer, guint32, gconstpointer, guint32, gboolean*);
+
+			/**
+			* Adds to a 64-bit counter
+			*
+			* Counters are stored as little-endian 64-bit integers, a missing key is treated as 0.
+			*
+			* \param[in]  key      The key
+			* \param[in]  delta    The value to add
+			* \param[out] previous The counter's value before adding delta
+			*
+			* \return TRUE on success, FALSE otherwise.
+			**/
+			gboolean (*backend_fetch_add)(gpointer, gpointer, gchar const*, gint64, gint64*);
 		} kv;
 
 		struct
@@ -285,9 +362,11 @@ struct JBackend
 			* }
 			* \endcode
 			*
+			* \param[out] count   The number of matched entries.
+			*
 			* \return TRUE on success, FALSE otherwise.
 			**/
-			gboolean (*backend_update)(gpointer, gpointer, gchar const*, bson_t const*, bson_t const*, GError**);
+			gboolean (*backend_update)(gpointer, gpointer, gchar const*, bson_t const*, bson_t const*, guint64*, GError**);
 
 			/**
 			* Deletes data
@@ -316,9 +395,11 @@ struct JBackend
 			* }
 			* \endcode
 			*
+			* \param[out] count   The number of deleted entries.
+			*
 			* \return TRUE on success, FALSE otherwise.
 			**/
-			gboolean (*backend_delete)(gpointer, gpointer, gchar const*, bson_t const*, GError**);
+			gboolean (*backend_delete)(gpointer, gpointer, gchar const*, bson_t const*, guint64*, GError**);
 
 			/**
 			* Creates an iterator
@@ -344,8 +425,18 @@ struct JBackend
 			*		"_operator": op2 (int32),
 			*		"_value": value2
 			*	},
+			*	"_fields": [name1 (utf8), name2 (utf8)],
+			*	"_order": [{ "_name": name1 (utf8), "_order": order (int32) }],
+			*	"_aggregate": [{ "_name": name1 (utf8, optional for count), "_aggregate": aggregate (int32) }],
+			*	"_group_by": [name1 (utf8)],
+			*	"_limit": limit (int64, 0 for no limit),
+			*	"_offset": offset (int64),
+			*	"_row": [name1 (utf8), name2 (utf8)]
 			* }
 			* \endcode
+			*                      All keys starting with an underscore are optional query modifiers.
+			*                      "_row" lists the columns of the binary row format and can be ignored by backends.
+			*                      Aggregating queries return the grouped fields and "_aggregate_<index>" instead of the entries.
 			* \param[out] iterator The iterator which can be used later for backend_iterate
 			*
 			* \return TRUE on success, FALSE otherwise.
@@ -373,6 +464,68 @@ struct JBackend
 			* \return TRUE on success, FALSE otherwise.
 			**/
 			gboolean (*backend_iterate)(gpointer, gpointer, bson_t*, GError**);
+
+			/**
+			* Inserts multiple entries into a schema (optional)
+			*
+			* Backends that do not implement this fall back to calling backend_insert once per entry.
+			*
+			* \param[in]  namespace Different use cases (e.g., "adios", "hdf5")
+			* \param[in]  name      Schema name (e.g., "files")
+			* \param[in]  entries   The data to insert, stored column by column.
+			*                       Every column contains exactly one value per entry, missing values are null.
+			* \code
+			* {
+			*	"_count": count (uint32),
+			*	"var_name1": [ value1_0, value1_1, ..., value1_count-1 ],
+			*	"var_nameN": [ valueN_0, valueN_1, ..., valueN_count-1 ]
+			* }
+			* \endcode
+			*
+			* \param[out] ids       Returns the ids of the inserted entries in insertion order.
+			* \code
+			* {
+			*	"_value_type": type (uint32),
+			*	"_value": [ id_0, id_1, ..., id_count-1 ]
+			* }
+			* \endcode
+			*
+			* \return TRUE on success, FALSE otherwise.
+			**/
+			gboolean (*backend_insert_many)(gpointer, gpointer, gchar const*, bson_t const*, bson_t*, GError**);
+
+			/**
+			* Obtains metadata in the binary row format (optional)
+			*
+			* Backends that do not implement this fall back to backend_iterate, whose result is converted.
+			*
+			* \param[in,out] iterator The iterator specifying the data to retrieve
+			* \param[out]    row      The row to fill using j_backend_db_row_set_int32() and friends.
+			*                         Its columns can be looked up using j_backend_db_row_get_index(), values of other fields are not needed.
+			*
+			* \return TRUE on success, FALSE otherwise.
+			**/
+			gboolean (*backend_iterate_row)(gpointer, gpointer, JBackendDBRow*, GError**);
+
+			/**
+			* Frees an iterator that has not run out of elements yet (optional)
+			*
+			* Backends that do not implement this fall back to calling backend_iterate until no more elements are found.
+			* Backends should release all resources held by the iterator, such as locks taken by the underlying statement.
+			*
+			* \param[in] iterator The iterator to free
+			**/
+			void (*backend_iterate_free)(gpointer, gpointer);
+
+			/**
+			* Checks whether iterators can be kept open between pages (optional)
+			*
+			* Backends that do not implement this are assumed to support it.
+			* Backends should return FALSE if open iterators prevent other connections from writing, all entries are returned at once in this case.
+			*
+			* \return TRUE if iterators can be kept open, FALSE otherwise.
+			**/
+			gboolean (*backend_iterate_pageable)(gpointer);
 		} db;
 	};
 };
@@ -416,11 +569,16 @@ gboolean j_backend_kv_batch_execute(JBackend*, gpointer);
 gboolean j_backend_kv_put(JBackend*, gpointer, gchar const*, gconstpointer, guint32);
 gboolean j_backend_kv_delete(JBackend*, gpointer, gchar const*);
 gboolean j_backend_kv_get(JBackend*, gpointer, gchar const*, gpointer*, guint32*);
+gboolean j_backend_kv_get_range(JBackend*, gpointer, gchar const*, guint64, guint64, gpointer*, guint32*);
 
 gboolean j_backend_kv_get_all(JBackend*, gchar const*, gpointer*);
 gboolean j_backend_kv_get_by_prefix(JBackend*, gchar const*, gchar const*, gpointer*);
 gboolean j_backend_kv_iterate(JBackend*, gpointer, gchar const**, gconstpointer*, guint32*);
 
+gboolean j_backend_kv_put_if_absent(JBackend*, gpointer, gchar const*, gconstpointer, guint32, gboolean*);
+gboolean j_backend_kv_compare_and_swap(JBackend*, gpointer, gchar const*, gconstpointer, guint32, gconstpointer, guint32, gboolean*);
+gboolean j_backend_kv_fetch_add(JBackend*, gpointer, gchar const*, gint64, gint64*);
+
 gboolean j_backend_db_init(JBackend*, gchar const*);
 void j_backend_db_fini(JBackend*);
 
@@ -431,12 +589,37 @@ gboolean j_backend_db_schema_create(JBackend*, gpointer, gchar const*, bson_t co
 gboolean j_backend_db_schema_get(JBackend*, gpointer, gchar const*, bson_t*, GError**);
 gboolean j_backend_db_schema_delete(JBackend*, gpointer, gchar const*, GError**);
 
+guint64 j_backend_db_schema_version(gchar const*, gchar const*);
+void j_backend_db_schema_changed(gchar const*, gchar const*);
+
 gboolean j_backend_db_insert(JBackend*, gpointer, gchar const*, bson_t const*, bson_t*, GError**);
-gboolean j_backend_db_update(JBackend*, gpointer, gchar const*, bson_t const*, bson_t const*, GError**);
-gboolean j_backend_db_delete(JBackend*, gpointer, gchar const*, bson_t const*, GError**);
+gboolean j_backend_db_insert_many(JBackend*, gpointer, gchar const*, bson_t const*, bson_t*, GError**);
+gboolean j_backend_db_update(JBackend*, gpointer, gchar const*, bson_t const*, bson_t const*, guint64*, GError**);
+gboolean j_backend_db_delete(JBackend*, gpointer, gchar const*, bson_t const*, guint64*, GError**);
 
 gboolean j_backend_db_query(JBackend*, gpointer, gchar const*, bson_t const*, gpointer*, GError**);
 gboolean j_backend_db_iterate(JBackend*, gpointer, bson_t*, GError**);
+gboolean j_backend_db_iterate_row(JBackend*, gpointer, JBackendDBRow*, GError**);
+void j_backend_db_iterate_free(JBackend*, gpointer);
+gboolean j_backend_db_iterate_pageable(JBackend*);
+
+JBackendDBRow* j_backend_db_row_new(bson_t const*);
+void j_backend_db_row_free(JBackendDBRow*);
+
+gint j_backend_db_row_get_index(JBackendDBRow*, gchar const*);
+
+void j_backend_db_row_set_int32(JBackendDBRow*, guint, gint32);
+void j_backend_db_row_set_int64(JBackendDBRow*, guint, gint64);
+void j_backend_db_row_set_double(JBackendDBRow*, guint, gdouble);
+void j_backend_db_row_set_data(JBackendDBRow*, guint, gconstpointer, guint32);
+gboolean j_backend_db_row_set_bson(JBackendDBRow*, bson_t const*, GError**);
+
+void j_backend_db_row_append(JBackendDBRow*, GByteArray*);
+
+gboolean j_backend_db_row_check(gconstpointer, guint32, guint, GError**);
+guint32 j_backend_db_row_get_length(gconstpointer);
+gconstpointer j_backend_db_row_get(gconstpointer, guint, guint);
+gconstpointer j_backend_db_row_get_data(gconstpointer, guint, guint, guint32*);
 
 G_END_DECLS
 
@@ -57,6 +57,7 @@ gchar const* j_configuration_get_backend_path(JConfiguration*, JBackendType);
 guint64 j_configuration_get_max_operation_size(JConfiguration*);
 guint32 j_configuration_get_max_connections(JConfiguration*);
 guint64 j_configuration_get_stripe_size(JConfiguration*);
+guint32 j_configuration_get_db_page_size(JConfiguration*);
 
 G_END_DECLS
 
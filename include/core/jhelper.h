@@ -34,6 +34,24 @@
 
 G_BEGIN_DECLS
 
+/**
+ * Called for each run of a strided selection, see j_helper_strided_foreach().
+ *
+ * \param length   The run's length.
+ * \param offset   The run's offset within the object.
+ * \param position The run's position within the densely packed buffer.
+ * \param data     User data.
+ *
+ * \return TRUE to continue, FALSE to stop.
+ **/
+typedef gboolean (*JHelperStridedFunc)(guint64 length, guint64 offset, guint64 position, gpointer data);
+
+/**
+ * The maximum number of dimensions of a strided selection.
+ * HDF5 dataspaces have at most 32 dimensions, each of which might need two levels.
+ **/
+#define J_HELPER_STRIDED_DIMENSIONS_MAX 64
+
 guint64 j_helper_atomic_add(guint64 volatile*, guint64);
 gboolean j_helper_execute_parallel(JBackgroundOperationFunc, gpointer*, guint);
 guint32 j_helper_hash(gchar const*);
@@ -42,6 +60,9 @@ void j_helper_set_nodelay(GSocketConnection*, gboolean);
 gchar* j_helper_str_replace(gchar const*, gchar const*, gchar const*);
 gpointer j_helper_alloc_aligned(gsize, gsize);
 
+guint64 j_helper_strided_length(guint64, guint32, guint64 const*);
+gboolean j_helper_strided_foreach(guint64, guint64, guint32, guint64 const*, guint64 const*, JHelperStridedFunc, gpointer);
+
 gboolean j_helper_file_sync(gchar const*);
 gboolean j_helper_file_discard(gchar const*);
 
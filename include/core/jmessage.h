@@ -50,17 +50,32 @@ enum JMessageType
 	J_MESSAGE_KV_GET,
 	J_MESSAGE_KV_GET_ALL,
 	J_MESSAGE_KV_GET_BY_PREFIX,
+	J_MESSAGE_KV_PUT_IF_ABSENT,
+	J_MESSAGE_KV_COMPARE_AND_SWAP,
+	J_MESSAGE_KV_FETCH_ADD,
+	J_MESSAGE_KV_GET_RANGE,
 	J_MESSAGE_DB_SCHEMA_CREATE,
 	J_MESSAGE_DB_SCHEMA_GET,
 	J_MESSAGE_DB_SCHEMA_DELETE,
 	J_MESSAGE_DB_INSERT,
 	J_MESSAGE_DB_UPDATE,
 	J_MESSAGE_DB_DELETE,
-	J_MESSAGE_DB_QUERY
+	J_MESSAGE_DB_QUERY,
+	J_MESSAGE_DB_QUERY_NEXT,
+	J_MESSAGE_DB_QUERY_CLOSE,
+	J_MESSAGE_DB_INSERT_MANY,
+	J_MESSAGE_OBJECT_READ_STRIDED,
+	J_MESSAGE_OBJECT_WRITE_STRIDED
 };
 
 typedef enum JMessageType JMessageType;
 
+/**
+ * Values larger than this are not copied into the message but sent separately using j_message_add_send().
+ * The receiver reads them directly from the connection.
+ **/
+#define J_MESSAGE_INLINE_MAX (64 * 1024)
+
 struct JMessage;
 
 typedef struct JMessage JMessage;
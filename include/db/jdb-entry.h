@@ -115,6 +115,26 @@ gboolean j_db_entry_set_field(JDBEntry* entry, gchar const* name, gconstpointer
 
 gboolean j_db_entry_insert(JDBEntry* entry, JBatch* batch, GError** error);
 
+/**
+ * Save multiple entries of the same schema in the backend.
+ * All entries are sent in a single operation and their ids are available after the batch has been executed.
+ *
+ * The entries' values are copied, so the entries may be modified or freed after this call.
+ *
+ * \param[in] entries the entries to save
+ * \param[in] count the number of entries
+ * \param[in] batch the batch to append this operation to
+ * \pre entries != NULL
+ * \pre count > 0
+ * \pre all entries belong to the same schema
+ * \pre every entry has a least 1 value set to not NULL
+ * \pre batch != NULL
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_entry_insert_many(JDBEntry** entries, guint count, JBatch* batch, GError** error);
+
 /**
  * Replayes all entrys attributes with the given entrys attributes in the backend where the selector matches.
  *
@@ -127,7 +147,6 @@ gboolean j_db_entry_insert(JDBEntry* entry, JBatch* batch, GError** error);
  * \pre entry != NULL
  * \pre entry has a least 1 value set to not NULL
  * \pre selector != NULL
- * \pre selector matches at least 1 entry
  * \pre batch != NULL
  *
  * \return TRUE on success, FALSE otherwise
@@ -135,6 +154,20 @@ gboolean j_db_entry_insert(JDBEntry* entry, JBatch* batch, GError** error);
 
 gboolean j_db_entry_update(JDBEntry* entry, JDBSelector* selector, JBatch* batch, GError** error);
 
+/**
+ * Like j_db_entry_update, but also reports the number of matched entries.
+ * All matched entries are updated using a single statement.
+ *
+ * \param[in] entry the entry defining the final values of all matched entrys
+ * \param[in] selector the selector defines which entrys should be modifies
+ * \param[out] count the number of matched entries, available after the batch has been executed
+ * \param[in] batch the batch to append this operation to
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_entry_update_with_count(JDBEntry* entry, JDBSelector* selector, guint64* count, JBatch* batch, GError** error);
+
 /**
  * Delete the entry from the backend.
  *
@@ -152,6 +185,19 @@ gboolean j_db_entry_update(JDBEntry* entry, JDBSelector* selector, JBatch* batch
 
 gboolean j_db_entry_delete(JDBEntry* entry, JDBSelector* selector, JBatch* batch, GError** error);
 
+/**
+ * Like j_db_entry_delete, but also reports the number of deleted entries.
+ *
+ * \param[in] entry specifies the schema to use
+ * \param[in] selector the selector defines what should be deleted
+ * \param[out] count the number of deleted entries, available after the batch has been executed
+ * \param[in] batch the batch to append this operation to
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_entry_delete_with_count(JDBEntry* entry, JDBSelector* selector, guint64* count, JBatch* batch, GError** error);
+
 G_END_DECLS
 
 #endif
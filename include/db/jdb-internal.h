@@ -52,17 +52,24 @@ struct JDBEntry
 
 struct JDBIterator
 {
-	bson_t bson;
+	// Current entry in the binary row format, points into the current page
+	gconstpointer row;
+
+	// Columns of the binary row format, maps names to their index + 1
+	GHashTable* columns;
+	guint column_count;
 
 	JDBSchema* schema;
 	JDBSelector* selector;
 
+	bson_t* query; //selector extended by the modifiers, the requested fields and the row's columns
+
 	gpointer iterator;
 
 	gint ref_count;
 
 	gboolean valid;
-	gboolean bson_valid;
+	gboolean row_valid;
 };
 
 struct JDBSchemaIndex
@@ -95,10 +102,21 @@ struct JDBSelector
 {
 	bson_t bson;
 
+	// Modifiers that only apply to queries, they are sent as arrays
+	bson_t bson_order;
+	bson_t bson_aggregate;
+	bson_t bson_group_by;
+
 	JDBSelectorMode mode;
 	JDBSchema* schema;
 
+	guint64 limit;
+	guint64 offset;
+
 	guint bson_count;
+	guint order_count;
+	guint aggregate_count;
+	guint group_by_count;
 	gint ref_count;
 };
 
@@ -124,10 +142,12 @@ gboolean j_db_internal_schema_create(JDBSchema* j_db_schema, JBatch* batch, GErr
 gboolean j_db_internal_schema_get(JDBSchema* j_db_schema, JBatch* batch, GError** error);
 gboolean j_db_internal_schema_delete(JDBSchema* j_db_schema, JBatch* batch, GError** error);
 gboolean j_db_internal_insert(JDBEntry* j_db_entry, JBatch* batch, GError** error);
-gboolean j_db_internal_update(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* batch, GError** error);
-gboolean j_db_internal_delete(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* batch, GError** error);
+gboolean j_db_internal_insert_many(JDBEntry** j_db_entries, guint count, JBatch* batch, GError** error);
+gboolean j_db_internal_update(JDBEntry* j_db_entry, JDBSelector* j_db_selector, guint64* count, JBatch* batch, GError** error);
+gboolean j_db_internal_delete(JDBEntry* j_db_entry, JDBSelector* j_db_selector, guint64* count, JBatch* batch, GError** error);
 gboolean j_db_internal_query(JDBSchema* j_db_schema, JDBSelector* j_db_selector, JDBIterator* j_db_iterator, JBatch* batch, GError** error);
 gboolean j_db_internal_iterate(JDBIterator* j_db_iterator, GError** error);
+void j_db_internal_iterator_free(JDBIterator* j_db_iterator);
 
 // Client-side additional internal functions
 bson_t* j_db_selector_get_bson(JDBSelector* selector);
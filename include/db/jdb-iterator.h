@@ -57,6 +57,23 @@ G_BEGIN_DECLS
 
 JDBIterator* j_db_iterator_new(JDBSchema* schema, JDBSelector* selector, GError** error);
 
+/**
+ * Allocates a new iterator that only fetches the given fields.
+ * Only the requested fields are transferred from the backend, which is considerably cheaper for wide schemas.
+ *
+ * \param[in] schema The schema defines the structure of the iterator
+ * \param[in] selector The selector defines which entrys to select
+ * \param[in] fields A NULL-terminated array of the names of the fields to fetch or NULL to fetch all fields
+ * \pre schema != NULL
+ * \pre schema is initialized
+ * \pre all fields are part of the schema
+ * \post j_db_iterator_get_field fails for fields that have not been requested
+ *
+ * \return the new iterator or NULL on failure
+ **/
+
+JDBIterator* j_db_iterator_new_with_fields(JDBSchema* schema, JDBSelector* selector, gchar const* const* fields, GError** error);
+
 /**
  * Increase the ref_count of the given iterator.
  *
@@ -111,6 +128,28 @@ gboolean j_db_iterator_next(JDBIterator* iterator, GError** error);
 
 gboolean j_db_iterator_get_field(JDBIterator* iterator, gchar const* name, JDBType* type, gpointer* value, guint64* length, GError** error);
 
+/**
+ * Get the result of an aggregate from the current entry of the iterator.
+ *
+ * \param[in] iterator to query
+ * \param[in] index the index of the aggregate, that is, the number of aggregates added to the selector before it
+ * \param[out] type the type of the retrieved value
+ * \param[out] value the retieved value
+ * \param[out] length the length of the retrieved value
+ * \pre iterator != NULL
+ * \pre the iterator's selector contains more than index aggregates
+ * \pre type != NULL
+ * \pre value != NULL
+ * \pre *value should not be initialized
+ * \pre length != NULL
+ * \post *value points to a new allocated memory region. The caller must free this later using g_free.
+ * \post *type is J_DB_TYPE_UINT64 for counts, J_DB_TYPE_FLOAT64 for averages, the widest type of the same signedness for sums and the field's type otherwise
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_iterator_get_aggregate(JDBIterator* iterator, guint index, JDBType* type, gpointer* value, guint64* length, GError** error);
+
 G_END_DECLS
 
 #endif
@@ -57,6 +57,28 @@ enum JDBSelectorOperator
 
 typedef enum JDBSelectorOperator JDBSelectorOperator;
 
+enum JDBSelectorOrder
+{
+	J_DB_SELECTOR_ORDER_ASCENDING,
+	J_DB_SELECTOR_ORDER_DESCENDING
+};
+
+typedef enum JDBSelectorOrder JDBSelectorOrder;
+
+enum JDBAggregate
+{
+	// Number of entries, the name may be NULL
+	J_DB_AGGREGATE_COUNT,
+	J_DB_AGGREGATE_MIN,
+	J_DB_AGGREGATE_MAX,
+	// Only applicable to numeric fields
+	J_DB_AGGREGATE_SUM,
+	// Only applicable to numeric fields
+	J_DB_AGGREGATE_AVG
+};
+
+typedef enum JDBAggregate JDBAggregate;
+
 struct JDBSelector;
 
 typedef struct JDBSelector JDBSelector;
@@ -138,6 +160,72 @@ gboolean j_db_selector_add_field(JDBSelector* selector, gchar const* name, JDBSe
 
 gboolean j_db_selector_add_selector(JDBSelector* selector, JDBSelector* sub_selector, GError** error);
 
+/**
+ * Sort the entries returned by a query by a field.
+ * Sort keys are applied in the order they are added.
+ *
+ * \param[in] selector to add a sort key to
+ * \param[in] name the name of the field to sort by
+ * \param[in] order whether to sort in ascending or descending order
+ *
+ * \pre selector != NULL
+ * \pre name != NULL
+ * \pre name must exist in the schema
+ * \post sort keys of sub_selectors are ignored
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_selector_add_order(JDBSelector* selector, gchar const* name, JDBSelectorOrder order, GError** error);
+
+/**
+ * Restrict the number of entries returned by a query.
+ *
+ * \param[in] selector to restrict
+ * \param[in] limit the maximum number of entries to return, 0 for no limit
+ * \param[in] offset the number of entries to skip
+ *
+ * \pre selector != NULL
+ * \post limits of sub_selectors are ignored
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_selector_set_limit(JDBSelector* selector, guint64 limit, guint64 offset, GError** error);
+
+/**
+ * Add an aggregate to the selector.
+ * A query using this selector returns one entry per group instead of the matching entries.
+ * Each entry contains the fields passed to j_db_selector_add_group_by and the aggregates, which can be read using j_db_iterator_get_aggregate.
+ *
+ * \param[in] selector to add an aggregate to
+ * \param[in] aggregate the aggregate function
+ * \param[in] name the name of the field to aggregate, may be NULL for J_DB_AGGREGATE_COUNT
+ *
+ * \pre selector != NULL
+ * \pre name must exist in the schema
+ * \post the aggregate can be read using its index, which is the number of previously added aggregates
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_selector_add_aggregate(JDBSelector* selector, JDBAggregate aggregate, gchar const* name, GError** error);
+
+/**
+ * Group the entries by a field before aggregating them.
+ *
+ * \param[in] selector to add a group to
+ * \param[in] name the name of the field to group by
+ *
+ * \pre selector != NULL
+ * \pre name != NULL
+ * \pre name must exist in the schema
+ *
+ * \return TRUE on success, FALSE otherwise
+ **/
+
+gboolean j_db_selector_add_group_by(JDBSelector* selector, gchar const* name, GError** error);
+
 G_END_DECLS
 
 #endif
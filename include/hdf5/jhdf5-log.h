@@ -0,0 +1,106 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2021 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ **/
+
+#ifndef JULEA_HDF5_LOG_H
+#define JULEA_HDF5_LOG_H
+
+#if !defined(JULEA_HDF5_DB_COMPILATION) && !defined(JULEA_HDF5_LOG_COMPILATION)
+#error "Only the julea-db VOL plugin and julea-hdf5-log can include this header."
+#endif
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * The binary operation log of the julea-db VOL plugin.
+ *
+ * A log starts with a JHDF5LogHeader that is followed by JHDF5LogRecords.
+ * Records of create and open operations are followed by name_length bytes containing the object's name without a terminating null byte.
+ * All values are stored in host byte order, records of different threads are not necessarily ordered by their timestamps.
+ **/
+
+#define J_HDF5_LOG_MAGIC "JHDF5LOG"
+#define J_HDF5_LOG_VERSION 1
+
+struct JHDF5LogHeader
+{
+	gchar magic[8];
+	guint32 version;
+	guint32 pid;
+
+	/**
+	 * Real time in microseconds that timestamps are relative to.
+	 **/
+	gint64 start_time;
+};
+
+typedef struct JHDF5LogHeader JHDF5LogHeader;
+
+struct JHDF5LogRecord
+{
+	/**
+	 * Monotonic time in microseconds since the log was started.
+	 **/
+	gint64 timestamp;
+
+	/**
+	 * Number of bytes read or written.
+	 **/
+	guint64 bytes;
+
+	/**
+	 * The first eight bytes of the object's database ID.
+	 **/
+	guint64 backend_id;
+
+	/**
+	 * The first eight bytes of the parent's database ID, 0 if there is no parent.
+	 **/
+	guint64 parent_id;
+
+	/**
+	 * Character identifying the operation, for example, C (create), O (open), R (read), W (write), G (get) or S (close).
+	 **/
+	gchar operation;
+
+	/**
+	 * Character identifying the object type, for example, F (file), G (group), D (dataset) or A (attribute).
+	 **/
+	gchar object_type;
+
+	/**
+	 * Character identifying the parent's object type.
+	 **/
+	gchar parent_type;
+
+	gchar padding;
+	guint32 name_length;
+};
+
+typedef struct JHDF5LogRecord JHDF5LogRecord;
+
+G_STATIC_ASSERT(sizeof(JHDF5LogRecord) == 40);
+
+G_END_DECLS
+
+#endif
@@ -35,8 +35,13 @@
 
 G_BEGIN_DECLS
 
+// Optional dataset operation used to implement j_hdf5_dataset_query_range()
+#define J_HDF5_DATASET_OPTIONAL_QUERY_RANGE 0x4a55
+
 void j_hdf5_set_semantics(JSemantics*);
 
+hid_t j_hdf5_dataset_query_range(hid_t, gdouble, gdouble);
+
 G_END_DECLS
 
 #endif
@@ -56,6 +56,11 @@ void j_kv_delete(JKV*, JBatch*);
 
 void j_kv_get(JKV*, gpointer*, guint32*, JBatch*);
 void j_kv_get_callback(JKV*, JKVGetFunc, gpointer, JBatch*);
+void j_kv_get_range(JKV*, gpointer, guint64, guint64, guint64*, JBatch*);
+
+void j_kv_put_if_absent(JKV*, gpointer, guint32, GDestroyNotify, gboolean*, JBatch*);
+void j_kv_compare_and_swap(JKV*, gconstpointer, guint32, gpointer, guint32, GDestroyNotify, gboolean*, JBatch*);
+void j_kv_fetch_add(JKV*, gint64, gint64*, JBatch*);
 
 G_END_DECLS
 
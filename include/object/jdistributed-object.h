@@ -49,6 +49,9 @@ void j_distributed_object_delete(JDistributedObject*, JBatch*);
 void j_distributed_object_read(JDistributedObject*, gpointer, guint64, guint64, guint64*, JBatch*);
 void j_distributed_object_write(JDistributedObject*, gconstpointer, guint64, guint64, guint64*, JBatch*);
 
+void j_distributed_object_read_strided(JDistributedObject*, gpointer, guint64, guint64, guint32, guint64 const*, guint64 const*, guint64*, JBatch*);
+void j_distributed_object_write_strided(JDistributedObject*, gconstpointer, guint64, guint64, guint32, guint64 const*, guint64 const*, guint64*, JBatch*);
+
 void j_distributed_object_status(JDistributedObject*, gint64*, guint64*, JBatch*);
 void j_distributed_object_sync(JDistributedObject*, JBatch*);
 
@@ -26,6 +26,8 @@
 #include <glib.h>
 #include <gmodule.h>
 
+#include <string.h>
+
 #include <jbackend-operation.h>
 
 #include <jtrace.h>
@@ -43,6 +45,8 @@ j_backend_operation_unwrap_db_schema_create(JBackend* backend, gpointer batch, J
 {
 	J_TRACE_FUNCTION(NULL);
 
+	j_backend_db_schema_changed(data->in_param[0].ptr, data->in_param[1].ptr);
+
 	return j_backend_db_schema_create(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, data->out_param[0].ptr);
 }
 
@@ -51,7 +55,35 @@ j_backend_operation_unwrap_db_schema_get(JBackend* backend, gpointer batch, JBac
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return j_backend_db_schema_get(backend, batch, data->in_param[1].ptr, data->out_param[0].ptr, data->out_param[1].ptr);
+	gboolean ret;
+	guint64 cached_version = 0;
+	guint64 version;
+
+	// Parameters received from the network are not necessarily aligned
+	if (data->in_param[2].ptr != NULL && data->in_param[2].len == sizeof(guint64))
+	{
+		memcpy(&cached_version, data->in_param[2].ptr, sizeof(guint64));
+	}
+
+	// The version has to be determined before the schema is fetched, in case it is changed concurrently
+	version = j_backend_db_schema_version(data->in_param[0].ptr, data->in_param[1].ptr);
+
+	if (version == cached_version)
+	{
+		bson_init(data->out_param[0].ptr);
+		ret = TRUE;
+	}
+	else
+	{
+		ret = j_backend_db_schema_get(backend, batch, data->in_param[1].ptr, data->out_param[0].ptr, data->out_param[2].ptr);
+	}
+
+	if (data->out_param[1].ptr != NULL)
+	{
+		*((guint64*)data->out_param[1].ptr) = (ret) ? version : 0;
+	}
+
+	return ret;
 }
 
 gboolean
@@ -59,6 +91,8 @@ j_backend_operation_unwrap_db_schema_delete(JBackend* backend, gpointer batch, J
 {
 	J_TRACE_FUNCTION(NULL);
 
+	j_backend_db_schema_changed(data->in_param[0].ptr, data->in_param[1].ptr);
+
 	return j_backend_db_schema_delete(backend, batch, data->in_param[1].ptr, data->out_param[0].ptr);
 }
 
@@ -85,64 +119,349 @@ _error:
 }
 
 gboolean
-j_backend_operation_unwrap_db_update(JBackend* backend, gpointer batch, JBackendOperation* data)
+j_backend_operation_unwrap_db_insert_many(JBackend* backend, gpointer batch, JBackendOperation* data)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return j_backend_db_update(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, data->in_param[3].ptr, data->out_param[0].ptr);
+	bson_t* bson = data->out_param[0].ptr;
+
+	bson_init(bson);
+
+	if (!j_backend_db_insert_many(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, data->out_param[0].ptr, data->out_param[1].ptr))
+	{
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	bson_destroy(bson);
+
+	return FALSE;
 }
 
 gboolean
-j_backend_operation_unwrap_db_delete(JBackend* backend, gpointer batch, JBackendOperation* data)
+j_backend_operation_unwrap_db_update(JBackend* backend, gpointer batch, JBackendOperation* data)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return j_backend_db_delete(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, data->out_param[0].ptr);
+	gboolean ret;
+	guint64 count = 0;
+
+	ret = j_backend_db_update(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, data->in_param[3].ptr, &count, data->out_param[1].ptr);
+
+	if (data->out_param[0].ptr != NULL)
+	{
+		*((guint64*)data->out_param[0].ptr) = count;
+	}
+
+	return ret;
 }
 
-// FIXME clean up
 gboolean
-j_backend_operation_unwrap_db_query(JBackend* backend, gpointer batch, JBackendOperation* data)
+j_backend_operation_unwrap_db_delete(JBackend* backend, gpointer batch, JBackendOperation* data)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	GError** error;
 	gboolean ret;
-	gpointer iter;
-	guint i;
+	guint64 count = 0;
+
+	ret = j_backend_db_delete(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, &count, data->out_param[1].ptr);
+
+	if (data->out_param[0].ptr != NULL)
+	{
+		*((guint64*)data->out_param[0].ptr) = count;
+	}
+
+	return ret;
+}
+
+/**
+ * A query whose result did not fit into a single page.
+ * The backend iterator stays open until all entries have been fetched or the cursor is closed.
+ * Backends might hold locks while the iterator is open, see backend_iterate_free.
+ **/
+struct JBackendDBCursor
+{
+	JBackend* backend;
+	gpointer iterator;
+	JBackendDBRow* row;
+};
+
+typedef struct JBackendDBCursor JBackendDBCursor;
+
+// Backends such as SQLite keep per-thread connections, so cursors are only valid in the thread that created them
+static GPrivate j_backend_db_cursors = G_PRIVATE_INIT((GDestroyNotify)g_hash_table_unref);
+
+static gint j_backend_db_cursor_id = 0;
+
+static GHashTable*
+j_backend_db_cursors_get(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GHashTable* cursors;
+
+	cursors = g_private_get(&j_backend_db_cursors);
+
+	if (cursors == NULL)
+	{
+		cursors = g_hash_table_new(NULL, NULL);
+		g_private_set(&j_backend_db_cursors, cursors);
+	}
+
+	return cursors;
+}
+
+static JBackendDBCursor*
+j_backend_db_cursor_take(guint32 cursor_id)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GHashTable* cursors;
+	JBackendDBCursor* cursor;
+
+	cursors = j_backend_db_cursors_get();
+	cursor = g_hash_table_lookup(cursors, GUINT_TO_POINTER(cursor_id));
+
+	if (cursor != NULL)
+	{
+		g_hash_table_steal(cursors, GUINT_TO_POINTER(cursor_id));
+	}
+
+	return cursor;
+}
+
+static void
+j_backend_db_cursor_free(JBackendDBCursor* cursor)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	j_backend_db_iterate_free(cursor->backend, cursor->iterator);
+	j_backend_db_row_free(cursor->row);
+	g_slice_free(JBackendDBCursor, cursor);
+}
+
+static guint32
+j_backend_operation_get_blob_4(JBackendOperationParam* param)
+{
+	guint32 value = 0;
+
+	// Parameters received from the network are not necessarily aligned
+	if (param->ptr != NULL && param->len == sizeof(guint32))
+	{
+		memcpy(&value, param->ptr, sizeof(guint32));
+	}
+
+	return value;
+}
+
+/**
+ * Fetches up to page_size entries from a backend iterator and appends them to bson.
+ * If row is not NULL, the entries are appended in the binary row format as "_rows".
+ * Otherwise, each entry is appended as a separate document.
+ * If the page is full, the iterator is registered as a cursor and its ID is appended as "_cursor".
+ * A page_size of 0 fetches all entries, which is also done if the backend does not support cursors.
+ * The page takes ownership of row.
+ **/
+static gboolean
+j_backend_operation_db_page(JBackend* backend, gpointer iterator, JBackendDBRow* row, guint32 cursor_id, guint32 page_size, bson_t* bson, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GError* iterate_error = NULL;
+	g_autoptr(GByteArray) rows = NULL;
+	gboolean ret = TRUE;
+	guint32 i;
 	char str_buf[16];
 	const char* key;
-	bson_t* bson = data->out_param[0].ptr;
 	bson_t tmp[1];
 
-	bson_init(bson);
-	ret = j_backend_db_query(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, &iter, data->out_param[1].ptr);
-	if (!ret)
+	if (row != NULL)
 	{
-		goto _error;
+		rows = g_byte_array_new();
 	}
-	i = 0;
-	do
+
+	// Backends whose open iterators block writers on other connections cannot keep cursors
+	if (page_size > 0 && cursor_id == 0 && !j_backend_db_iterate_pageable(backend))
 	{
+		page_size = 0;
+	}
+
+	for (i = 0; page_size == 0 || i < page_size; i++)
+	{
+		if (row != NULL)
+		{
+			if (!(ret = j_backend_db_iterate_row(backend, iterator, row, &iterate_error)))
+			{
+				break;
+			}
+
+			j_backend_db_row_append(row, rows);
+			continue;
+		}
+
 		bson_uint32_to_string(i, &key, str_buf, sizeof(str_buf));
 		bson_init(tmp);
-		ret = j_backend_db_iterate(backend, iter, tmp, data->out_param[1].ptr);
-		i++;
+		ret = j_backend_db_iterate(backend, iterator, tmp, &iterate_error);
+
 		if (ret)
 		{
 			bson_append_document(bson, key, -1, tmp);
 		}
+
 		bson_destroy(tmp);
-	} while (ret); //TODO handle the no more elements error here
-	error = data->out_param[1].ptr;
-	if (error && (*error)->code == J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS)
+
+		if (!ret)
+		{
+			break;
+		}
+	}
+
+	if (rows != NULL)
 	{
-		g_error_free(*error);
-		*error = NULL;
+		bson_append_binary(bson, "_rows", -1, BSON_SUBTYPE_BINARY, rows->data, rows->len);
 	}
+
+	if (ret)
+	{
+		JBackendDBCursor* cursor;
+
+		if (cursor_id == 0)
+		{
+			do
+			{
+				cursor_id = g_atomic_int_add(&j_backend_db_cursor_id, 1) + 1;
+			} while (cursor_id == 0);
+		}
+
+		cursor = g_slice_new(JBackendDBCursor);
+		cursor->backend = backend;
+		cursor->iterator = iterator;
+		cursor->row = row;
+
+		g_hash_table_insert(j_backend_db_cursors_get(), GUINT_TO_POINTER(cursor_id), cursor);
+		bson_append_int64(bson, "_cursor", -1, cursor_id);
+	}
+	else
+	{
+		j_backend_db_row_free(row);
+
+		if (iterate_error != NULL)
+		{
+			if (iterate_error->code == J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS)
+			{
+				g_error_free(iterate_error);
+			}
+			else
+			{
+				g_propagate_error(error, iterate_error);
+			}
+		}
+	}
+
 	return TRUE;
-_error:
-	return FALSE;
+}
+
+gboolean
+j_backend_operation_unwrap_db_query(JBackend* backend, gpointer batch, JBackendOperation* data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gpointer iter;
+	bson_t* bson = data->out_param[0].ptr;
+
+	bson_init(bson);
+
+	if (!j_backend_db_query(backend, batch, data->in_param[1].ptr, data->in_param[2].ptr, &iter, data->out_param[1].ptr))
+	{
+		return FALSE;
+	}
+
+	return j_backend_operation_db_page(backend, iter, j_backend_db_row_new(data->in_param[2].ptr), 0, j_backend_operation_get_blob_4(&data->in_param[3]), bson, data->out_param[1].ptr);
+}
+
+gboolean
+j_backend_operation_unwrap_db_query_next(JBackend* backend, gpointer batch, JBackendOperation* data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JBackendDBCursor* cursor;
+	JBackendDBRow* row;
+	gpointer iter;
+	guint32 cursor_id;
+	bson_t* bson = data->out_param[0].ptr;
+
+	(void)batch;
+
+	bson_init(bson);
+
+	cursor_id = j_backend_operation_get_blob_4(&data->in_param[1]);
+
+	if ((cursor = j_backend_db_cursor_take(cursor_id)) == NULL)
+	{
+		g_set_error_literal(data->out_param[1].ptr, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_INVALID, "iterator invalid");
+		return FALSE;
+	}
+
+	g_assert(cursor->backend == backend);
+
+	iter = cursor->iterator;
+	row = cursor->row;
+	g_slice_free(JBackendDBCursor, cursor);
+
+	return j_backend_operation_db_page(backend, iter, row, cursor_id, j_backend_operation_get_blob_4(&data->in_param[2]), bson, data->out_param[1].ptr);
+}
+
+gboolean
+j_backend_operation_unwrap_db_query_close(JBackend* backend, gpointer batch, JBackendOperation* data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JBackendDBCursor* cursor;
+	guint32 cursor_id;
+
+	(void)backend;
+	(void)batch;
+
+	cursor_id = j_backend_operation_get_blob_4(&data->in_param[1]);
+
+	// Closing an unknown cursor is not an error, it might have run out of entries already
+	if ((cursor = j_backend_db_cursor_take(cursor_id)) != NULL)
+	{
+		j_backend_db_cursor_free(cursor);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Closes all cursors that are still open in the current thread.
+ * The server calls this when a connection is closed.
+ **/
+void
+j_backend_operation_db_cursors_free(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GHashTable* cursors;
+	GHashTableIter iter;
+	gpointer value;
+
+	cursors = g_private_get(&j_backend_db_cursors);
+
+	if (cursors == NULL)
+	{
+		return;
+	}
+
+	g_hash_table_iter_init(&iter, cursors);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		j_backend_db_cursor_free(value);
+		g_hash_table_iter_remove(&iter);
+	}
 }
 
 gboolean
@@ -289,9 +608,19 @@ j_backend_operation_from_message(JMessage* message, JBackendOperationParam* data
 			switch (element->type)
 			{
 				case J_BACKEND_OPERATION_PARAM_TYPE_STR:
-				case J_BACKEND_OPERATION_PARAM_TYPE_BLOB:
 					*(gchar**)element->ptr = g_strdup(j_message_get_n(message, len));
 					break;
+				case J_BACKEND_OPERATION_PARAM_TYPE_BLOB:
+					// Output blobs have a fixed size and are copied into the caller's buffer
+					if (element->ptr != NULL)
+					{
+						memcpy(element->ptr, j_message_get_n(message, len), len);
+					}
+					else
+					{
+						j_message_get_n(message, len);
+					}
+					break;
 				case J_BACKEND_OPERATION_PARAM_TYPE_BSON:
 					ret = bson_init_static(&element->bson, j_message_get_n(message, len), len) && ret;
 					if (element->ptr)
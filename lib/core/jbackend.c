@@ -25,6 +25,8 @@
 #include <glib.h>
 #include <gmodule.h>
 
+#include <string.h>
+
 #include <jbackend.h>
 
 #include <jtrace.h>
@@ -660,6 +662,55 @@ j_backend_kv_get(JBackend* backend, gpointer batch, gchar const* key, gpointer*
 	return ret;
 }
 
+gboolean
+j_backend_kv_get_range(JBackend* backend, gpointer batch, gchar const* key, guint64 offset, guint64 length, gpointer* value, guint32* value_len)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_KV, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(value_len != NULL, FALSE);
+
+	*value = NULL;
+	*value_len = 0;
+
+	if (backend->kv.backend_get_range != NULL)
+	{
+		J_TRACE("backend_get_range", "%p, %s, %" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT ", %p, %p", batch, key, offset, length, (gpointer)value, (gpointer)value_len);
+		ret = backend->kv.backend_get_range(backend->data, batch, key, offset, length, value, value_len);
+	}
+	else
+	{
+		g_autofree gpointer whole = NULL;
+		guint32 whole_len;
+
+		J_TRACE("backend_get", "%p, %s, %p, %p", batch, key, (gpointer)&whole, (gpointer)&whole_len);
+		ret = backend->kv.backend_get(backend->data, batch, key, &whole, &whole_len);
+
+		if (ret && offset == 0 && length >= whole_len)
+		{
+			*value = g_steal_pointer(&whole);
+			*value_len = whole_len;
+		}
+		else if (ret && offset < whole_len)
+		{
+			*value_len = MIN(length, whole_len - offset);
+#if GLIB_CHECK_VERSION(2, 68, 0)
+			*value = g_memdup2((gchar*)whole + offset, *value_len);
+#else
+			*value = g_memdup((gchar*)whole + offset, *value_len);
+#endif
+		}
+	}
+
+	return ret;
+}
+
 gboolean
 j_backend_kv_get_all(JBackend* backend, gchar const* namespace, gpointer* iterator)
 {
@@ -722,6 +773,81 @@ j_backend_kv_iterate(JBackend* backend, gpointer iterator, gchar const** key, gc
 	return ret;
 }
 
+gboolean
+j_backend_kv_put_if_absent(JBackend* backend, gpointer batch, gchar const* key, gconstpointer value, guint32 value_len, gboolean* inserted)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_KV, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(inserted != NULL, FALSE);
+
+	*inserted = FALSE;
+
+	if (backend->kv.backend_put_if_absent != NULL)
+	{
+		J_TRACE("backend_put_if_absent", "%p, %s, %p, %u, %p", batch, key, (gconstpointer)value, value_len, (gpointer)inserted);
+		ret = backend->kv.backend_put_if_absent(backend->data, batch, key, value, value_len, inserted);
+	}
+
+	return ret;
+}
+
+gboolean
+j_backend_kv_compare_and_swap(JBackend* backend, gpointer batch, gchar const* key, gconstpointer expected, guint32 expected_len, gconstpointer value, guint32 value_len, gboolean* swapped)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_KV, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(expected != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(swapped != NULL, FALSE);
+
+	*swapped = FALSE;
+
+	if (backend->kv.backend_compare_and_swap != NULL)
+	{
+		J_TRACE("backend_compare_and_swap", "%p, %s, %p, %u, %p, %u, %p", batch, key, (gconstpointer)expected, expected_len, (gconstpointer)value, value_len, (gpointer)swapped);
+		ret = backend->kv.backend_compare_and_swap(backend->data, batch, key, expected, expected_len, value, value_len, swapped);
+	}
+
+	return ret;
+}
+
+gboolean
+j_backend_kv_fetch_add(JBackend* backend, gpointer batch, gchar const* key, gint64 delta, gint64* previous)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_KV, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(key != NULL, FALSE);
+	g_return_val_if_fail(previous != NULL, FALSE);
+
+	*previous = 0;
+
+	if (backend->kv.backend_fetch_add != NULL)
+	{
+		J_TRACE("backend_fetch_add", "%p, %s, %" G_GINT64_FORMAT ", %p", batch, key, delta, (gpointer)previous);
+		ret = backend->kv.backend_fetch_add(backend->data, batch, key, delta, previous);
+	}
+
+	return ret;
+}
+
 gboolean
 j_backend_db_init(JBackend* backend, gchar const* path)
 {
@@ -755,6 +881,126 @@ j_backend_db_fini(JBackend* backend)
 	}
 }
 
+/*
+ * Schema versions allow clients to cache schemas.
+ * A schema's version changes whenever it has been created or deleted.
+ */
+
+static GMutex j_backend_db_schema_versions_mutex;
+static GHashTable* j_backend_db_schema_versions = NULL;
+static guint64 j_backend_db_schema_version_initial = 0;
+static guint64 j_backend_db_schema_version_last = 0;
+
+// Schemas created or deleted within the current thread's batch, their versions change once the batch has been executed
+static GPrivate j_backend_db_schema_changes = G_PRIVATE_INIT((GDestroyNotify)g_ptr_array_unref);
+
+static gchar*
+j_backend_db_schema_key(gchar const* namespace, gchar const* name)
+{
+	// The length makes the key unambiguous even if the namespace contains the separator
+	return g_strdup_printf("%zu:%s:%s", strlen(namespace), namespace, name);
+}
+
+static void
+j_backend_db_schema_versions_init(void)
+{
+	if (j_backend_db_schema_versions == NULL)
+	{
+		j_backend_db_schema_versions = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+		// Versions must not repeat when the server is restarted, otherwise clients might keep outdated schemas
+		j_backend_db_schema_version_initial = g_get_real_time();
+		j_backend_db_schema_version_last = j_backend_db_schema_version_initial;
+	}
+}
+
+/**
+ * Returns a schema's current version.
+ *
+ * \param namespace The schema's namespace.
+ * \param name      The schema's name.
+ *
+ * \return The version, never 0.
+ **/
+guint64
+j_backend_db_schema_version(gchar const* namespace, gchar const* name)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree gchar* key = NULL;
+	guint64* version;
+	guint64 ret;
+
+	g_return_val_if_fail(namespace != NULL, 0);
+	g_return_val_if_fail(name != NULL, 0);
+
+	key = j_backend_db_schema_key(namespace, name);
+
+	g_mutex_lock(&j_backend_db_schema_versions_mutex);
+
+	j_backend_db_schema_versions_init();
+	version = g_hash_table_lookup(j_backend_db_schema_versions, key);
+	ret = (version != NULL) ? *version : j_backend_db_schema_version_initial;
+
+	g_mutex_unlock(&j_backend_db_schema_versions_mutex);
+
+	return ret;
+}
+
+/**
+ * Marks a schema as changed by the current batch.
+ * Its version changes once the batch has been executed, so clients cannot cache the old schema with the new version.
+ *
+ * \param namespace The schema's namespace.
+ * \param name      The schema's name.
+ **/
+void
+j_backend_db_schema_changed(gchar const* namespace, gchar const* name)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GPtrArray* changes;
+
+	g_return_if_fail(namespace != NULL);
+	g_return_if_fail(name != NULL);
+
+	if ((changes = g_private_get(&j_backend_db_schema_changes)) == NULL)
+	{
+		changes = g_ptr_array_new_with_free_func(g_free);
+		g_private_set(&j_backend_db_schema_changes, changes);
+	}
+
+	g_ptr_array_add(changes, j_backend_db_schema_key(namespace, name));
+}
+
+static void
+j_backend_db_schema_versions_update(void)
+{
+	GPtrArray* changes;
+
+	if ((changes = g_private_get(&j_backend_db_schema_changes)) == NULL || changes->len == 0)
+	{
+		return;
+	}
+
+	g_mutex_lock(&j_backend_db_schema_versions_mutex);
+
+	j_backend_db_schema_versions_init();
+
+	for (guint i = 0; i < changes->len; i++)
+	{
+		guint64* version;
+
+		version = g_new(guint64, 1);
+		*version = ++j_backend_db_schema_version_last;
+		g_hash_table_insert(j_backend_db_schema_versions, g_strdup(g_ptr_array_index(changes, i)), version);
+	}
+
+	g_mutex_unlock(&j_backend_db_schema_versions_mutex);
+
+	g_ptr_array_set_size(changes, 0);
+}
+
 gboolean
 j_backend_db_batch_start(JBackend* backend, gchar const* namespace, JSemantics* semantics, gpointer* batch, GError** error)
 {
@@ -794,6 +1040,9 @@ j_backend_db_batch_execute(JBackend* backend, gpointer batch, GError** error)
 		ret = backend->db.backend_batch_execute(backend->data, batch, error);
 	}
 
+	// Versions also change if the batch failed, which only causes clients to fetch the schema again
+	j_backend_db_schema_versions_update();
+
 	return ret;
 }
 
@@ -884,8 +1133,145 @@ j_backend_db_insert(JBackend* backend, gpointer batch, gchar const* name, bson_t
 	return ret;
 }
 
+struct JBackendDBColumn
+{
+	gchar const* name;
+	bson_iter_t iter;
+};
+
+typedef struct JBackendDBColumn JBackendDBColumn;
+
+static gboolean
+j_backend_db_insert_many_fallback(JBackend* backend, gpointer batch, gchar const* name, bson_t const* entries, bson_t* ids, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_iter_t iter;
+	bson_t ids_array[1];
+	g_autoptr(GArray) columns = NULL;
+	guint32 count = 0;
+	gboolean ret = TRUE;
+
+	columns = g_array_new(FALSE, FALSE, sizeof(JBackendDBColumn));
+
+	if (!bson_iter_init(&iter, entries))
+	{
+		g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_ITER_INIT, "bson iter init failed");
+		return FALSE;
+	}
+
+	while (bson_iter_next(&iter))
+	{
+		JBackendDBColumn column;
+
+		column.name = bson_iter_key(&iter);
+
+		if (g_strcmp0(column.name, "_count") == 0)
+		{
+			count = bson_iter_as_int64(&iter);
+			continue;
+		}
+
+		if (!BSON_ITER_HOLDS_ARRAY(&iter) || !bson_iter_recurse(&iter, &column.iter))
+		{
+			g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_ITER_INVALID_TYPE, "bson iter invalid type");
+			return FALSE;
+		}
+
+		g_array_append_val(columns, column);
+	}
+
+	bson_append_array_begin(ids, "_value", -1, ids_array);
+
+	for (guint32 i = 0; i < count && ret; i++)
+	{
+		bson_t row[1];
+		bson_t id[1];
+		bson_iter_t id_iter;
+		gchar key_buf[16];
+		gchar const* key;
+
+		bson_init(row);
+		bson_init(id);
+
+		// All columns are advanced in lockstep, each of them holds exactly one value per entry
+		for (guint j = 0; j < columns->len; j++)
+		{
+			JBackendDBColumn* column = &g_array_index(columns, JBackendDBColumn, j);
+
+			if (!bson_iter_next(&column->iter))
+			{
+				g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_BSON_NOT_ENOUGH_KEYS, "bson not enough keys");
+				ret = FALSE;
+				break;
+			}
+
+			if (!BSON_ITER_HOLDS_NULL(&column->iter))
+			{
+				bson_append_iter(row, column->name, -1, &column->iter);
+			}
+		}
+
+		if (ret)
+		{
+			J_TRACE("backend_insert", "%p, %s, %p, %p, %p", batch, name, (gconstpointer)row, (gpointer)id, (gpointer)error);
+			ret = backend->db.backend_insert(backend->data, batch, name, row, id, error);
+		}
+
+		if (ret)
+		{
+			bson_uint32_to_string(i, &key, key_buf, sizeof(key_buf));
+
+			if (bson_iter_init_find(&id_iter, id, "_value"))
+			{
+				bson_append_iter(ids_array, key, -1, &id_iter);
+			}
+
+			if (i == 0 && bson_iter_init_find(&id_iter, id, "_value_type"))
+			{
+				bson_append_iter(ids, "_value_type", -1, &id_iter);
+			}
+		}
+
+		bson_destroy(id);
+		bson_destroy(row);
+	}
+
+	bson_append_array_end(ids, ids_array);
+
+	return ret;
+}
+
 gboolean
-j_backend_db_update(JBackend* backend, gpointer batch, gchar const* name, bson_t const* selector, bson_t const* metadata, GError** error)
+j_backend_db_insert_many(JBackend* backend, gpointer batch, gchar const* name, bson_t const* entries, bson_t* ids, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_DB, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(entries != NULL, FALSE);
+	g_return_val_if_fail(ids != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (backend->db.backend_insert_many != NULL)
+	{
+		J_TRACE("backend_insert_many", "%p, %s, %p, %p, %p", batch, name, (gconstpointer)entries, (gpointer)ids, (gpointer)error);
+		ret = backend->db.backend_insert_many(backend->data, batch, name, entries, ids, error);
+	}
+	else
+	{
+		ret = j_backend_db_insert_many_fallback(backend, batch, name, entries, ids, error);
+	}
+
+	return ret;
+}
+
+gboolean
+j_backend_db_update(JBackend* backend, gpointer batch, gchar const* name, bson_t const* selector, bson_t const* metadata, guint64* count, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
@@ -897,18 +1283,19 @@ j_backend_db_update(JBackend* backend, gpointer batch, gchar const* name, bson_t
 	g_return_val_if_fail(name != NULL, FALSE);
 	g_return_val_if_fail(selector != NULL, FALSE);
 	g_return_val_if_fail(metadata != NULL, FALSE);
+	g_return_val_if_fail(count != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	{
-		J_TRACE("backend_update", "%p, %s, %p, %p, %p", batch, name, (gconstpointer)selector, (gconstpointer)metadata, (gpointer)error);
-		ret = backend->db.backend_update(backend->data, batch, name, selector, metadata, error);
+		J_TRACE("backend_update", "%p, %s, %p, %p, %p, %p", batch, name, (gconstpointer)selector, (gconstpointer)metadata, (gpointer)count, (gpointer)error);
+		ret = backend->db.backend_update(backend->data, batch, name, selector, metadata, count, error);
 	}
 
 	return ret;
 }
 
 gboolean
-j_backend_db_delete(JBackend* backend, gpointer batch, gchar const* name, bson_t const* selector, GError** error)
+j_backend_db_delete(JBackend* backend, gpointer batch, gchar const* name, bson_t const* selector, guint64* count, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
@@ -918,11 +1305,12 @@ j_backend_db_delete(JBackend* backend, gpointer batch, gchar const* name, bson_t
 	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_DB, FALSE);
 	g_return_val_if_fail(batch != NULL, FALSE);
 	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(count != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	{
-		J_TRACE("backend_delete", "%p, %s, %p, %p", batch, name, (gconstpointer)selector, (gpointer)error);
-		ret = backend->db.backend_delete(backend->data, batch, name, selector, error);
+		J_TRACE("backend_delete", "%p, %s, %p, %p, %p", batch, name, (gconstpointer)selector, (gpointer)count, (gpointer)error);
+		ret = backend->db.backend_delete(backend->data, batch, name, selector, count, error);
 	}
 
 	return ret;
@@ -971,6 +1359,485 @@ j_backend_db_iterate(JBackend* backend, gpointer iterator, bson_t* metadata, GEr
 	return ret;
 }
 
+gboolean
+j_backend_db_iterate_row(JBackend* backend, gpointer iterator, JBackendDBRow* row, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret;
+	bson_t metadata[1];
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_DB, FALSE);
+	g_return_val_if_fail(iterator != NULL, FALSE);
+	g_return_val_if_fail(row != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (backend->db.backend_iterate_row != NULL)
+	{
+		J_TRACE("backend_iterate_row", "%p, %p, %p", iterator, (gpointer)row, (gpointer)error);
+		ret = backend->db.backend_iterate_row(backend->data, iterator, row, error);
+	}
+	else
+	{
+		bson_init(metadata);
+		ret = j_backend_db_iterate(backend, iterator, metadata, error);
+		ret = ret && j_backend_db_row_set_bson(row, metadata, error);
+		bson_destroy(metadata);
+	}
+
+	return ret;
+}
+
+void
+j_backend_db_iterate_free(JBackend* backend, gpointer iterator)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(backend != NULL);
+	g_return_if_fail(backend->type == J_BACKEND_TYPE_DB);
+	g_return_if_fail(iterator != NULL);
+
+	if (backend->db.backend_iterate_free != NULL)
+	{
+		J_TRACE("backend_iterate_free", "%p", iterator);
+		backend->db.backend_iterate_free(backend->data, iterator);
+	}
+	else
+	{
+		GError* error = NULL;
+		bson_t metadata[1];
+
+		// Backends release their iterators once they run out of elements
+		while (TRUE)
+		{
+			gboolean ret;
+
+			bson_init(metadata);
+			ret = j_backend_db_iterate(backend, iterator, metadata, &error);
+			bson_destroy(metadata);
+
+			if (!ret)
+			{
+				break;
+			}
+		}
+
+		g_clear_error(&error);
+	}
+}
+
+gboolean
+j_backend_db_iterate_pageable(JBackend* backend)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail(backend != NULL, FALSE);
+	g_return_val_if_fail(backend->type == J_BACKEND_TYPE_DB, FALSE);
+
+	if (backend->db.backend_iterate_pageable != NULL)
+	{
+		J_TRACE("backend_iterate_pageable", "%p", backend->data);
+		ret = backend->db.backend_iterate_pageable(backend->data);
+	}
+
+	return ret;
+}
+
+/*
+ * A row is stored as follows:
+ * - its length including this header (guint32)
+ * - a bitmap of the columns that are set, padded to a multiple of 8 bytes
+ * - one slot of 8 bytes per column, containing 32 or 64 bit integers and doubles
+ *   for strings and blobs, the slot contains their offset within the data and their length (both guint32)
+ * - the data of strings (including their terminating null byte) and blobs
+ */
+
+struct JBackendDBRow
+{
+	/**
+	 * Maps column names to their index + 1.
+	 **/
+	GHashTable* columns;
+	guint column_count;
+
+	/**
+	 * The bitmap and slots of the current row.
+	 **/
+	guint8* fixed;
+	guint32 fixed_size;
+
+	/**
+	 * The strings and blobs of the current row.
+	 **/
+	GByteArray* data;
+};
+
+static guint32
+j_backend_db_row_bitmap_size(guint column_count)
+{
+	return (((column_count + 7) / 8) + 7) & ~7U;
+}
+
+static guint8*
+j_backend_db_row_slot(JBackendDBRow* row, guint index)
+{
+	row->fixed[index / 8] |= 1 << (index % 8);
+
+	return row->fixed + j_backend_db_row_bitmap_size(row->column_count) + (8 * index);
+}
+
+/**
+ * Creates a row for the columns requested by a query.
+ *
+ * \param selector The query's selector.
+ *
+ * \return A new row, NULL if the query does not request the binary row format.
+ **/
+JBackendDBRow*
+j_backend_db_row_new(bson_t const* selector)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JBackendDBRow* row;
+	bson_iter_t iter;
+	bson_iter_t iter_columns;
+
+	if (selector == NULL || !bson_iter_init_find(&iter, selector, "_row") || !BSON_ITER_HOLDS_ARRAY(&iter) || !bson_iter_recurse(&iter, &iter_columns))
+	{
+		return NULL;
+	}
+
+	row = g_slice_new(JBackendDBRow);
+	row->columns = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	row->column_count = 0;
+
+	while (bson_iter_next(&iter_columns))
+	{
+		if (!BSON_ITER_HOLDS_UTF8(&iter_columns))
+		{
+			continue;
+		}
+
+		row->column_count++;
+		g_hash_table_insert(row->columns, g_strdup(bson_iter_utf8(&iter_columns, NULL)), GUINT_TO_POINTER(row->column_count));
+	}
+
+	row->fixed_size = j_backend_db_row_bitmap_size(row->column_count) + (8 * row->column_count);
+	row->fixed = g_malloc0(row->fixed_size);
+	row->data = g_byte_array_new();
+
+	return row;
+}
+
+void
+j_backend_db_row_free(JBackendDBRow* row)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (row == NULL)
+	{
+		return;
+	}
+
+	g_byte_array_unref(row->data);
+	g_free(row->fixed);
+	g_hash_table_unref(row->columns);
+
+	g_slice_free(JBackendDBRow, row);
+}
+
+/**
+ * Looks up a column's index.
+ *
+ * \return The column's index, -1 if the column is not part of the row.
+ **/
+gint
+j_backend_db_row_get_index(JBackendDBRow* row, gchar const* name)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(row != NULL, -1);
+	g_return_val_if_fail(name != NULL, -1);
+
+	return (gint)GPOINTER_TO_UINT(g_hash_table_lookup(row->columns, name)) - 1;
+}
+
+void
+j_backend_db_row_set_int32(JBackendDBRow* row, guint index, gint32 value)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(row != NULL);
+	g_return_if_fail(index < row->column_count);
+
+	memcpy(j_backend_db_row_slot(row, index), &value, sizeof(value));
+}
+
+void
+j_backend_db_row_set_int64(JBackendDBRow* row, guint index, gint64 value)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(row != NULL);
+	g_return_if_fail(index < row->column_count);
+
+	memcpy(j_backend_db_row_slot(row, index), &value, sizeof(value));
+}
+
+void
+j_backend_db_row_set_double(JBackendDBRow* row, guint index, gdouble value)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(row != NULL);
+	g_return_if_fail(index < row->column_count);
+
+	memcpy(j_backend_db_row_slot(row, index), &value, sizeof(value));
+}
+
+/**
+ * Sets a string or blob.
+ * Strings have to include their terminating null byte.
+ **/
+void
+j_backend_db_row_set_data(JBackendDBRow* row, guint index, gconstpointer data, guint32 length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint8* slot;
+	guint32 offset;
+
+	g_return_if_fail(row != NULL);
+	g_return_if_fail(index < row->column_count);
+
+	slot = j_backend_db_row_slot(row, index);
+	offset = row->data->len;
+
+	memcpy(slot, &offset, sizeof(offset));
+	memcpy(slot + sizeof(offset), &length, sizeof(length));
+
+	g_byte_array_append(row->data, data, length);
+}
+
+/**
+ * Sets the columns contained in a BSON document as returned by backend_iterate.
+ * Fields that are not part of the row are skipped, null values are not set.
+ **/
+gboolean
+j_backend_db_row_set_bson(JBackendDBRow* row, bson_t const* metadata, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_iter_t iter;
+
+	g_return_val_if_fail(row != NULL, FALSE);
+	g_return_val_if_fail(metadata != NULL, FALSE);
+
+	if (!bson_iter_init(&iter, metadata))
+	{
+		g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_ITER_INIT, "bson iter init failed");
+		return FALSE;
+	}
+
+	while (bson_iter_next(&iter))
+	{
+		gint index;
+
+		if ((index = j_backend_db_row_get_index(row, bson_iter_key(&iter))) < 0)
+		{
+			continue;
+		}
+
+		switch (bson_iter_type(&iter))
+		{
+			case BSON_TYPE_INT32:
+				j_backend_db_row_set_int32(row, index, bson_iter_int32(&iter));
+				break;
+			case BSON_TYPE_INT64:
+				j_backend_db_row_set_int64(row, index, bson_iter_int64(&iter));
+				break;
+			case BSON_TYPE_DOUBLE:
+				j_backend_db_row_set_double(row, index, bson_iter_double(&iter));
+				break;
+			case BSON_TYPE_UTF8:
+			{
+				gchar const* value;
+				guint32 length;
+
+				value = bson_iter_utf8(&iter, &length);
+				j_backend_db_row_set_data(row, index, value, length + 1);
+				break;
+			}
+			case BSON_TYPE_BINARY:
+			{
+				guint8 const* value;
+				guint32 length;
+
+				bson_iter_binary(&iter, NULL, &length, &value);
+				j_backend_db_row_set_data(row, index, value, length);
+				break;
+			}
+			case BSON_TYPE_NULL:
+				break;
+			default:
+				g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_ITER_INVALID_TYPE, "bson iter invalid type");
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ * Appends the current row to a buffer and starts a new one.
+ **/
+void
+j_backend_db_row_append(JBackendDBRow* row, GByteArray* buffer)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint32 length;
+
+	g_return_if_fail(row != NULL);
+	g_return_if_fail(buffer != NULL);
+
+	length = sizeof(length) + row->fixed_size + row->data->len;
+
+	g_byte_array_append(buffer, (guint8 const*)&length, sizeof(length));
+	g_byte_array_append(buffer, row->fixed, row->fixed_size);
+	g_byte_array_append(buffer, row->data->data, row->data->len);
+
+	memset(row->fixed, 0, row->fixed_size);
+	g_byte_array_set_size(row->data, 0);
+}
+
+/**
+ * Checks a serialized row received from the network before it is accessed.
+ * The row has to contain at least its header, bitmap and slots and must not exceed the available bytes.
+ * The slots of strings and blobs are checked when they are accessed, see j_backend_db_row_get_data().
+ *
+ * \param available The number of bytes following data.
+ *
+ * \return TRUE if the row is valid, FALSE otherwise.
+ **/
+gboolean
+j_backend_db_row_check(gconstpointer data, guint32 available, guint column_count, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint32 length;
+	guint64 fixed_size;
+
+	g_return_val_if_fail(data != NULL, FALSE);
+
+	if (available < sizeof(length))
+	{
+		goto _error;
+	}
+
+	memcpy(&length, data, sizeof(length));
+	fixed_size = sizeof(length) + (guint64)j_backend_db_row_bitmap_size(column_count) + (8 * (guint64)column_count);
+
+	// This also rejects rows of length 0, which would never advance the iteration
+	if (length < fixed_size || length > available)
+	{
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_INVALID, "row invalid");
+
+	return FALSE;
+}
+
+/**
+ * Returns the length of a serialized row, including its header.
+ **/
+guint32
+j_backend_db_row_get_length(gconstpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint32 length;
+
+	g_return_val_if_fail(data != NULL, 0);
+
+	memcpy(&length, data, sizeof(length));
+
+	return length;
+}
+
+/**
+ * Returns a column's slot within a serialized row.
+ * The slot is not necessarily aligned.
+ *
+ * \return The slot, NULL if the column is not set.
+ **/
+gconstpointer
+j_backend_db_row_get(gconstpointer data, guint column_count, guint index)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint8 const* bitmap;
+
+	g_return_val_if_fail(data != NULL, NULL);
+	g_return_val_if_fail(index < column_count, NULL);
+
+	bitmap = (guint8 const*)data + sizeof(guint32);
+
+	if (!(bitmap[index / 8] & (1 << (index % 8))))
+	{
+		return NULL;
+	}
+
+	return bitmap + j_backend_db_row_bitmap_size(column_count) + (8 * index);
+}
+
+/**
+ * Returns a string or blob within a serialized row.
+ * The row has to have been checked using j_backend_db_row_check().
+ *
+ * \return The data, NULL if the column is not set or its data does not fit into the row.
+ **/
+gconstpointer
+j_backend_db_row_get_data(gconstpointer data, guint column_count, guint index, guint32* length)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint8 const* slot;
+	guint32 offset;
+	guint32 fixed_size;
+	guint32 data_size;
+
+	g_return_val_if_fail(length != NULL, NULL);
+
+	*length = 0;
+
+	if ((slot = j_backend_db_row_get(data, column_count, index)) == NULL)
+	{
+		return NULL;
+	}
+
+	fixed_size = sizeof(guint32) + j_backend_db_row_bitmap_size(column_count) + (8 * column_count);
+	data_size = j_backend_db_row_get_length(data) - fixed_size;
+
+	memcpy(&offset, slot, sizeof(offset));
+	memcpy(length, slot + sizeof(offset), sizeof(*length));
+
+	if (offset > data_size || *length > data_size - offset)
+	{
+		*length = 0;
+		return NULL;
+	}
+
+	return (guint8 const*)data + fixed_size + offset;
+}
+
 /**
  * @}
  **/
@@ -142,6 +142,7 @@ struct JConfiguration
 	guint64 max_operation_size;
 	guint32 max_connections;
 	guint64 stripe_size;
+	guint32 db_page_size;
 
 	/**
 	 * The reference count.
@@ -310,12 +311,14 @@ j_configuration_new_for_data(GKeyFile* key_file)
 	guint64 max_operation_size;
 	guint32 max_connections;
 	guint64 stripe_size;
+	guint32 db_page_size;
 
 	g_return_val_if_fail(key_file != NULL, FALSE);
 
 	max_operation_size = g_key_file_get_uint64(key_file, "core", "max-operation-size", NULL);
 	max_connections = g_key_file_get_integer(key_file, "clients", "max-connections", NULL);
 	stripe_size = g_key_file_get_uint64(key_file, "clients", "stripe-size", NULL);
+	db_page_size = g_key_file_get_integer(key_file, "clients", "db-page-size", NULL);
 	servers_object = g_key_file_get_string_list(key_file, "servers", "object", NULL, NULL);
 	servers_kv = g_key_file_get_string_list(key_file, "servers", "kv", NULL, NULL);
 	servers_db = g_key_file_get_string_list(key_file, "servers", "db", NULL, NULL);
@@ -377,6 +380,7 @@ j_configuration_new_for_data(GKeyFile* key_file)
 	configuration->max_operation_size = max_operation_size;
 	configuration->max_connections = max_connections;
 	configuration->stripe_size = stripe_size;
+	configuration->db_page_size = db_page_size;
 	configuration->ref_count = 1;
 
 	if (configuration->max_operation_size == 0)
@@ -394,6 +398,11 @@ j_configuration_new_for_data(GKeyFile* key_file)
 		configuration->stripe_size = 4 * 1024 * 1024;
 	}
 
+	if (configuration->db_page_size == 0)
+	{
+		configuration->db_page_size = 1000;
+	}
+
 	return configuration;
 }
 
@@ -603,6 +612,16 @@ j_configuration_get_stripe_size(JConfiguration* configuration)
 	return configuration->stripe_size;
 }
 
+guint32
+j_configuration_get_db_page_size(JConfiguration* configuration)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(configuration != NULL, 0);
+
+	return configuration->db_page_size;
+}
+
 /**
  * @}
  **/
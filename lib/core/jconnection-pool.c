@@ -270,6 +270,31 @@ j_connection_pool_push_internal(GAsyncQueue* queue, GSocketConnection* connectio
 	g_async_queue_push(queue, connection);
 }
 
+/**
+ * Closes a connection that cannot be used anymore.
+ * If other threads are waiting for a connection, a new one is established for them.
+ **/
+static void
+j_connection_pool_close_internal(GAsyncQueue* queue, guint* count, gchar const* server, GSocketConnection* connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(queue != NULL);
+	g_return_if_fail(count != NULL);
+	g_return_if_fail(connection != NULL);
+
+	g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+	g_object_unref(connection);
+
+	g_atomic_int_add(count, -1);
+
+	// A negative length means that threads are waiting in g_async_queue_pop()
+	if (g_async_queue_length(queue) < 0)
+	{
+		j_connection_pool_push_internal(queue, j_connection_pool_pop_internal(queue, count, server));
+	}
+}
+
 gpointer
 j_connection_pool_pop(JBackendType backend, guint index)
 {
@@ -322,6 +347,36 @@ j_connection_pool_push(JBackendType backend, guint index, gpointer connection)
 	}
 }
 
+/**
+ * Closes a connection instead of returning it to the pool, for example, because sending or receiving a message failed.
+ **/
+void
+j_connection_pool_close(JBackendType backend, guint index, gpointer connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(j_connection_pool != NULL);
+	g_return_if_fail(connection != NULL);
+
+	switch (backend)
+	{
+		case J_BACKEND_TYPE_OBJECT:
+			g_return_if_fail(index < j_connection_pool->object_len);
+			j_connection_pool_close_internal(j_connection_pool->object_queues[index].queue, &(j_connection_pool->object_queues[index].count), j_configuration_get_server(j_connection_pool->configuration, J_BACKEND_TYPE_OBJECT, index), connection);
+			break;
+		case J_BACKEND_TYPE_KV:
+			g_return_if_fail(index < j_connection_pool->kv_len);
+			j_connection_pool_close_internal(j_connection_pool->kv_queues[index].queue, &(j_connection_pool->kv_queues[index].count), j_configuration_get_server(j_connection_pool->configuration, J_BACKEND_TYPE_KV, index), connection);
+			break;
+		case J_BACKEND_TYPE_DB:
+			g_return_if_fail(index < j_connection_pool->db_len);
+			j_connection_pool_close_internal(j_connection_pool->db_queues[index].queue, &(j_connection_pool->db_queues[index].count), j_configuration_get_server(j_connection_pool->configuration, J_BACKEND_TYPE_DB, index), connection);
+			break;
+		default:
+			g_assert_not_reached();
+	}
+}
+
 /**
  * @}
  **/
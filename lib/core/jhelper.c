@@ -224,6 +224,119 @@ j_helper_alloc_aligned(gsize align, gsize len)
 	return buf;
 }
 
+/**
+ * Returns the number of bytes selected by a strided selection.
+ *
+ * \param length     The length of each block.
+ * \param dimensions The number of dimensions.
+ * \param count      The number of blocks per dimension.
+ *
+ * \return The number of bytes, 0 if the selection is empty or its length does not fit into 64 bits.
+ **/
+guint64
+j_helper_strided_length(guint64 length, guint32 dimensions, guint64 const* count)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint64 ret = length;
+
+	for (guint32 i = 0; i < dimensions; i++)
+	{
+		if (!g_uint64_checked_mul(&ret, ret, count[i]))
+		{
+			return 0;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * Iterates over a strided selection.
+ *
+ * The selection consists of blocks of length bytes starting at offset + i_0 * stride[0] + ... + i_(n-1) * stride[n-1] for 0 <= i_d < count[d].
+ * Blocks are visited in row-major order, that is, the last dimension varies fastest, and are packed densely.
+ * Adjacent blocks are merged into a single run.
+ *
+ * \param length     The length of each block.
+ * \param offset     The offset of the first block.
+ * \param dimensions The number of dimensions.
+ * \param count      The number of blocks per dimension.
+ * \param stride     The distance between blocks per dimension.
+ * \param func       The function to call for each run.
+ * \param data       User data to pass to func.
+ *
+ * \return FALSE if func returned FALSE, TRUE otherwise.
+ **/
+gboolean
+j_helper_strided_foreach(guint64 length, guint64 offset, guint32 dimensions, guint64 const* count, guint64 const* stride, JHelperStridedFunc func, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree guint64* index = NULL;
+	guint64 run_length = 0;
+	guint64 run_offset = 0;
+	guint64 run_position = 0;
+	guint64 position = 0;
+
+	g_return_val_if_fail(func != NULL, FALSE);
+	g_return_val_if_fail(dimensions == 0 || (count != NULL && stride != NULL), FALSE);
+
+	if (length == 0 || j_helper_strided_length(length, dimensions, count) == 0)
+	{
+		return TRUE;
+	}
+
+	index = g_new0(guint64, dimensions);
+
+	while (TRUE)
+	{
+		guint64 block_offset = offset;
+		gint d;
+
+		for (guint32 i = 0; i < dimensions; i++)
+		{
+			block_offset += index[i] * stride[i];
+		}
+
+		if (run_length > 0 && run_offset + run_length == block_offset)
+		{
+			run_length += length;
+		}
+		else
+		{
+			if (run_length > 0 && !func(run_length, run_offset, run_position, data))
+			{
+				return FALSE;
+			}
+
+			run_length = length;
+			run_offset = block_offset;
+			run_position = position;
+		}
+
+		position += length;
+
+		// Advance the index, the last dimension varies fastest
+		for (d = (gint)dimensions - 1; d >= 0; d--)
+		{
+			if (++index[d] < count[d])
+			{
+				break;
+			}
+
+			index[d] = 0;
+		}
+
+		if (d < 0)
+		{
+			break;
+		}
+	}
+
+	return func(run_length, run_offset, run_position, data);
+}
+
 gboolean
 j_helper_file_sync(gchar const* path)
 {
@@ -191,11 +191,46 @@ _error:
 	return FALSE;
 }
 
+gboolean
+j_db_entry_insert_many(JDBEntry** entries, guint count, JBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(entries != NULL, FALSE);
+	g_return_val_if_fail(count > 0, FALSE);
+	g_return_val_if_fail(batch != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	for (guint i = 0; i < count; i++)
+	{
+		g_return_val_if_fail(entries[i] != NULL, FALSE);
+		g_return_val_if_fail(entries[i]->schema == entries[0]->schema, FALSE);
+	}
+
+	if (G_UNLIKELY(!j_db_internal_insert_many(entries, count, batch, error)))
+	{
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
 gboolean
 j_db_entry_update(JDBEntry* entry, JDBSelector* selector, JBatch* batch, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	return j_db_entry_update_with_count(entry, selector, NULL, batch, error);
+}
+
+gboolean
+j_db_entry_update_with_count(JDBEntry* entry, JDBSelector* selector, guint64* count, JBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
 	bson_t* bson;
 
 	g_return_val_if_fail(entry != NULL, FALSE);
@@ -212,7 +247,7 @@ j_db_entry_update(JDBEntry* entry, JDBSelector* selector, JBatch* batch, GError*
 		goto _error;
 	}
 
-	if (G_UNLIKELY(!j_db_internal_update(entry, selector, batch, error)))
+	if (G_UNLIKELY(!j_db_internal_update(entry, selector, count, batch, error)))
 	{
 		goto _error;
 	}
@@ -228,12 +263,20 @@ j_db_entry_delete(JDBEntry* entry, JDBSelector* selector, JBatch* batch, GError*
 {
 	J_TRACE_FUNCTION(NULL);
 
+	return j_db_entry_delete_with_count(entry, selector, NULL, batch, error);
+}
+
+gboolean
+j_db_entry_delete_with_count(JDBEntry* entry, JDBSelector* selector, guint64* count, JBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
 	g_return_val_if_fail(entry != NULL, FALSE);
 	g_return_val_if_fail(batch != NULL, FALSE);
 	g_return_val_if_fail((selector == NULL) || (selector->schema == entry->schema), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	if (G_UNLIKELY(!j_db_internal_delete(entry, selector, batch, error)))
+	if (G_UNLIKELY(!j_db_internal_delete(entry, selector, count, batch, error)))
 	{
 		goto _error;
 	}
@@ -37,12 +37,71 @@
 struct JDBIteratorHelper
 {
 	bson_t bson;
-	bson_iter_t iter;
 	gboolean initialized;
+
+	// Entries of the current page in the binary row format, see JBackendDBRow
+	guint8 const* rows;
+	guint32 rows_length;
+	guint32 rows_offset;
+
+	// Connection the server-side cursor is bound to, NULL once all pages have been received
+	GSocketConnection* connection;
+	// Request for the next page, sent while the current page is being consumed
+	JMessage* next;
+
+	gchar* namespace;
+	guint32 cursor;
+	guint32 page_size;
 };
 
 typedef struct JDBIteratorHelper JDBIteratorHelper;
 
+struct JDBInsertManyHelper
+{
+	// Entries stored column by column, see backend_insert_many
+	bson_t entries_bson;
+	bson_t ids;
+
+	JDBEntry** entries;
+	guint count;
+};
+
+typedef struct JDBInsertManyHelper JDBInsertManyHelper;
+
+struct JDBSchemaGetHelper
+{
+	JDBSchema* schema;
+	bson_t bson;
+
+	// Cached schema and its version sent to the server, 0 if the schema is not cached
+	bson_t cached;
+	guint64 cached_version;
+	guint64 version;
+};
+
+typedef struct JDBSchemaGetHelper JDBSchemaGetHelper;
+
+/**
+ * A schema cached on the client.
+ * It is only used as long as the server reports the same version.
+ * Schemas are not cached for client-side backends, since other processes might change them without changing the version.
+ **/
+struct JDBSchemaCacheEntry
+{
+	bson_t bson;
+	guint64 version;
+};
+
+typedef struct JDBSchemaCacheEntry JDBSchemaCacheEntry;
+
+static GMutex j_db_schema_cache_mutex;
+static GHashTable* j_db_schema_cache = NULL;
+
+static const guint32 j_db_page_size_all = 0;
+
+// Number of connections kept by iterators whose server-side cursor is still open, see j_db_query_reserve()
+static gint j_db_query_pinned = 0;
+
 GQuark
 j_db_error_quark(void)
 {
@@ -51,6 +110,9 @@ j_db_error_quark(void)
 	return g_quark_from_static_string("j-db-error-quark");
 }
 
+static gboolean j_db_query_reserve(void);
+static gboolean j_db_query_pin(JBackendOperation*, GSocketConnection*);
+
 static gboolean
 j_backend_db_func_exec(JList* operations, JSemantics* semantics, JMessageType type)
 {
@@ -66,20 +128,34 @@ j_backend_db_func_exec(JList* operations, JSemantics* semantics, JMessageType ty
 	JBackend* db_backend = j_db_get_backend();
 	gpointer batch = NULL;
 	GError* error = NULL;
+	guint operations_count;
+	guint i = 0;
+	gboolean reserved = FALSE;
 
 	if (db_backend == NULL)
 	{
 		message = j_message_new(type, 0);
 	}
 
+	operations_count = j_list_length(operations);
 	iter_send = j_list_iterator_new(operations);
 
 	while (j_list_iterator_next(iter_send))
 	{
 		data = j_list_iterator_get(iter_send);
+		i++;
 
 		if (db_backend == NULL)
 		{
+			if (type == J_MESSAGE_DB_QUERY)
+			{
+				// Only the last query of a message may leave a cursor open, see j_db_query_pin()
+				if (i < operations_count || !(reserved = j_db_query_reserve()))
+				{
+					data->in_param[3].ptr_const = &j_db_page_size_all;
+				}
+			}
+
 			ret = j_backend_operation_to_message(message, data->in_param, data->in_param_count) && ret;
 		}
 		else
@@ -114,7 +190,16 @@ j_backend_db_func_exec(JList* operations, JSemantics* semantics, JMessageType ty
 			ret = j_backend_operation_from_message(reply, data->out_param, data->out_param_count) && ret;
 		}
 
-		j_connection_pool_push(J_BACKEND_TYPE_DB, 0, db_connection);
+		// The connection is returned to the pool once the query's cursor has been closed
+		if (!reserved || data == NULL || !j_db_query_pin(data, db_connection))
+		{
+			j_connection_pool_push(J_BACKEND_TYPE_DB, 0, db_connection);
+
+			if (reserved)
+			{
+				g_atomic_int_add(&j_db_query_pinned, -1);
+			}
+		}
 	}
 	else
 	{
@@ -155,6 +240,92 @@ j_backend_db_func_free(gpointer _data)
 	}
 }
 
+static gchar*
+j_db_schema_cache_key(JDBSchema* j_db_schema)
+{
+	return g_strdup_printf("%zu:%s:%s", strlen(j_db_schema->namespace), j_db_schema->namespace, j_db_schema->name);
+}
+
+static void
+j_db_schema_cache_entry_free(gpointer data)
+{
+	JDBSchemaCacheEntry* entry = data;
+
+	bson_destroy(&entry->bson);
+	g_slice_free(JDBSchemaCacheEntry, entry);
+}
+
+/**
+ * Looks up a cached schema and copies it to bson.
+ *
+ * \return The cached schema's version, 0 if the schema is not cached. In this case, bson is not initialized.
+ **/
+static guint64
+j_db_schema_cache_get(JDBSchema* j_db_schema, bson_t* bson)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree gchar* key = NULL;
+	JDBSchemaCacheEntry* entry;
+	guint64 version = 0;
+
+	key = j_db_schema_cache_key(j_db_schema);
+
+	g_mutex_lock(&j_db_schema_cache_mutex);
+
+	if (j_db_schema_cache != NULL && (entry = g_hash_table_lookup(j_db_schema_cache, key)) != NULL)
+	{
+		bson_copy_to(&entry->bson, bson);
+		version = entry->version;
+	}
+
+	g_mutex_unlock(&j_db_schema_cache_mutex);
+
+	return version;
+}
+
+static void
+j_db_schema_cache_set(JDBSchema* j_db_schema, bson_t const* bson, guint64 version)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSchemaCacheEntry* entry;
+
+	entry = g_slice_new(JDBSchemaCacheEntry);
+	bson_copy_to(bson, &entry->bson);
+	entry->version = version;
+
+	g_mutex_lock(&j_db_schema_cache_mutex);
+
+	if (j_db_schema_cache == NULL)
+	{
+		j_db_schema_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, j_db_schema_cache_entry_free);
+	}
+
+	g_hash_table_replace(j_db_schema_cache, j_db_schema_cache_key(j_db_schema), entry);
+
+	g_mutex_unlock(&j_db_schema_cache_mutex);
+}
+
+static void
+j_db_schema_cache_remove(JDBSchema* j_db_schema)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree gchar* key = NULL;
+
+	key = j_db_schema_cache_key(j_db_schema);
+
+	g_mutex_lock(&j_db_schema_cache_mutex);
+
+	if (j_db_schema_cache != NULL)
+	{
+		g_hash_table_remove(j_db_schema_cache, key);
+	}
+
+	g_mutex_unlock(&j_db_schema_cache_mutex);
+}
+
 static gboolean
 j_db_schema_create_exec(JList* operations, JSemantics* semantics)
 {
@@ -173,6 +344,9 @@ j_db_internal_schema_create(JDBSchema* j_db_schema, JBatch* batch, GError** erro
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+	// The server changes the schema's version, so this only saves checking it
+	j_db_schema_cache_remove(j_db_schema);
+
 	data = g_slice_new(JBackendOperation);
 	memcpy(data, &j_backend_operation_db_schema_create, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
@@ -195,12 +369,80 @@ j_db_internal_schema_create(JDBSchema* j_db_schema, JBatch* batch, GError** erro
 	return TRUE;
 }
 
+static void
+j_db_schema_get_helper_free(JDBSchemaGetHelper* helper)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_t zerobson;
+
+	memset(&zerobson, 0, sizeof(bson_t));
+
+	if (memcmp(&helper->bson, &zerobson, sizeof(bson_t)))
+	{
+		bson_destroy(&helper->bson);
+	}
+
+	if (helper->cached_version != 0)
+	{
+		bson_destroy(&helper->cached);
+	}
+
+	j_db_schema_unref(helper->schema);
+	g_slice_free(JDBSchemaGetHelper, helper);
+}
+
 static gboolean
 j_db_schema_get_exec(JList* operations, JSemantics* semantics)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	return j_backend_db_func_exec(operations, semantics, J_MESSAGE_DB_SCHEMA_GET);
+	g_autoptr(JListIterator) iter = NULL;
+	gboolean ret;
+
+	ret = j_backend_db_func_exec(operations, semantics, J_MESSAGE_DB_SCHEMA_GET);
+
+	iter = j_list_iterator_new(operations);
+
+	// Schemas are fetched into the helper first, since the server returns an empty document if the cached schema is still valid
+	while (j_list_iterator_next(iter))
+	{
+		JBackendOperation* data = j_list_iterator_get(iter);
+		JDBSchemaGetHelper* helper = data->unref_values[0];
+		JDBSchema* j_db_schema = helper->schema;
+		bson_t zerobson;
+
+		memset(&zerobson, 0, sizeof(bson_t));
+
+		if (helper->version == 0)
+		{
+			// The schema could not be fetched, for example, because it does not exist anymore
+			j_db_schema_cache_remove(j_db_schema);
+			continue;
+		}
+
+		bson_destroy(&j_db_schema->bson);
+
+		if (helper->version == helper->cached_version)
+		{
+			bson_copy_to(&helper->cached, &j_db_schema->bson);
+		}
+		else if (memcmp(&helper->bson, &zerobson, sizeof(bson_t)))
+		{
+			bson_copy_to(&helper->bson, &j_db_schema->bson);
+
+			if (j_db_get_backend() == NULL)
+			{
+				j_db_schema_cache_set(j_db_schema, &helper->bson, helper->version);
+			}
+		}
+		else
+		{
+			bson_init(&j_db_schema->bson);
+		}
+	}
+
+	return ret;
 }
 
 gboolean
@@ -208,21 +450,37 @@ j_db_internal_schema_get(JDBSchema* j_db_schema, JBatch* batch, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	JDBSchemaGetHelper* helper;
 	JOperation* op;
 	JBackendOperation* data;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+	helper = g_slice_new(JDBSchemaGetHelper);
+	helper->schema = j_db_schema_ref(j_db_schema);
+	memset(&helper->bson, 0, sizeof(bson_t));
+	helper->cached_version = 0;
+	helper->version = 0;
+
+	// Versions are only tracked per process, so client-side backends cannot detect schemas changed by other processes
+	if (j_db_get_backend() == NULL)
+	{
+		helper->cached_version = j_db_schema_cache_get(j_db_schema, &helper->cached);
+	}
+
 	data = g_slice_new(JBackendOperation);
 	memcpy(data, &j_backend_operation_db_schema_get, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
 	data->in_param[1].ptr_const = j_db_schema->name;
-	data->out_param[0].ptr_const = &j_db_schema->bson;
-	data->out_param[1].ptr_const = error;
+	data->in_param[2].ptr_const = &helper->cached_version;
+	data->in_param[2].len = sizeof(guint64);
+	data->out_param[0].ptr_const = &helper->bson;
+	data->out_param[1].ptr_const = &helper->version;
+	data->out_param[2].ptr_const = error;
 
 	data->unref_func_count = 1;
-	data->unref_funcs[0] = (GDestroyNotify)j_db_schema_unref;
-	data->unref_values[0] = j_db_schema_ref(j_db_schema);
+	data->unref_funcs[0] = (GDestroyNotify)j_db_schema_get_helper_free;
+	data->unref_values[0] = helper;
 
 	op = j_operation_new();
 	op->key = j_db_schema->namespace;
@@ -253,6 +511,8 @@ j_db_internal_schema_delete(JDBSchema* j_db_schema, JBatch* batch, GError** erro
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+	j_db_schema_cache_remove(j_db_schema);
+
 	data = g_slice_new(JBackendOperation);
 	memcpy(data, &j_backend_operation_db_schema_delete, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
@@ -315,6 +575,212 @@ j_db_internal_insert(JDBEntry* j_db_entry, JBatch* batch, GError** error)
 	return TRUE;
 }
 
+static void
+j_db_insert_many_helper_free(JDBInsertManyHelper* helper)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (guint i = 0; i < helper->count; i++)
+	{
+		j_db_entry_unref(helper->entries[i]);
+	}
+
+	g_free(helper->entries);
+	bson_destroy(&helper->entries_bson);
+	bson_destroy(&helper->ids);
+	g_slice_free(JDBInsertManyHelper, helper);
+}
+
+static gboolean
+j_db_insert_many_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JListIterator) iter = NULL;
+	gboolean ret;
+
+	ret = j_backend_db_func_exec(operations, semantics, J_MESSAGE_DB_INSERT_MANY);
+
+	iter = j_list_iterator_new(operations);
+
+	// All ids of an operation arrive in a single reply and are handed out to the entries here
+	while (j_list_iterator_next(iter))
+	{
+		JBackendOperation* data = j_list_iterator_get(iter);
+		JDBInsertManyHelper* helper = data->unref_values[0];
+		bson_iter_t type_iter;
+		bson_iter_t ids_iter;
+		bson_iter_t id_iter;
+
+		if (!bson_iter_init_find(&type_iter, &helper->ids, "_value_type")
+		    || !bson_iter_init_find(&ids_iter, &helper->ids, "_value")
+		    || !bson_iter_recurse(&ids_iter, &id_iter))
+		{
+			continue;
+		}
+
+		for (guint i = 0; i < helper->count && bson_iter_next(&id_iter); i++)
+		{
+			bson_t* id = &helper->entries[i]->id;
+
+			bson_reinit(id);
+			bson_append_iter(id, "_value", -1, &id_iter);
+			bson_append_iter(id, "_value_type", -1, &type_iter);
+		}
+	}
+
+	return ret;
+}
+
+static gboolean
+j_db_insert_many_append_column(bson_t* column, guint32* column_count, guint32 index, bson_iter_t* value)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gchar key_buf[16];
+	gchar const* key;
+
+	// Entries that do not set this field get a null value
+	for (; *column_count <= index; (*column_count)++)
+	{
+		bson_uint32_to_string(*column_count, &key, key_buf, sizeof(key_buf));
+
+		if (*column_count < index || value == NULL)
+		{
+			if (!bson_append_null(column, key, -1))
+			{
+				return FALSE;
+			}
+		}
+		else if (!bson_append_iter(column, key, -1, value))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+gboolean
+j_db_internal_insert_many(JDBEntry** j_db_entries, guint count, JBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JOperation* op;
+	JBackendOperation* data;
+	JDBInsertManyHelper* helper;
+	JDBSchema* schema;
+	JDBTypeValue value;
+	GHashTableIter columns_iter;
+	g_autoptr(GHashTable) columns = NULL;
+	g_autoptr(GHashTable) column_counts = NULL;
+	gpointer key;
+	gpointer column;
+
+	g_return_val_if_fail(j_db_entries != NULL, FALSE);
+	g_return_val_if_fail(count > 0, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	schema = j_db_entries[0]->schema;
+
+	// Every column is collected in its own document first, since BSON can only build one child at a time
+	columns = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)bson_destroy);
+	column_counts = g_hash_table_new(g_str_hash, g_str_equal);
+
+	for (guint i = 0; i < count; i++)
+	{
+		bson_iter_t iter;
+
+		if (G_UNLIKELY(!j_bson_iter_init(&iter, &j_db_entries[i]->bson, error)))
+		{
+			goto _error;
+		}
+
+		while (bson_iter_next(&iter))
+		{
+			gchar const* name = bson_iter_key(&iter);
+			guint32 column_count;
+
+			if (!g_hash_table_lookup_extended(columns, name, &key, &column))
+			{
+				key = g_strdup(name);
+				column = bson_new();
+				g_hash_table_insert(columns, key, column);
+			}
+
+			column_count = GPOINTER_TO_UINT(g_hash_table_lookup(column_counts, key));
+
+			if (G_UNLIKELY(!j_db_insert_many_append_column(column, &column_count, i, &iter)))
+			{
+				g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_BSON_APPEND_FAILED, "bson append failed");
+				goto _error;
+			}
+
+			g_hash_table_insert(column_counts, key, GUINT_TO_POINTER(column_count));
+		}
+	}
+
+	helper = g_slice_new(JDBInsertManyHelper);
+	bson_init(&helper->entries_bson);
+	bson_init(&helper->ids);
+	helper->entries = g_new(JDBEntry*, count);
+	helper->count = count;
+
+	for (guint i = 0; i < count; i++)
+	{
+		helper->entries[i] = j_db_entry_ref(j_db_entries[i]);
+	}
+
+	value.val_uint32 = count;
+
+	if (G_UNLIKELY(!j_bson_append_value(&helper->entries_bson, "_count", J_DB_TYPE_UINT32, &value, error)))
+	{
+		j_db_insert_many_helper_free(helper);
+		goto _error;
+	}
+
+	g_hash_table_iter_init(&columns_iter, columns);
+
+	while (g_hash_table_iter_next(&columns_iter, &key, &column))
+	{
+		guint32 column_count = GPOINTER_TO_UINT(g_hash_table_lookup(column_counts, key));
+
+		if (G_UNLIKELY(!j_db_insert_many_append_column(column, &column_count, count - 1, NULL)
+			       || !j_bson_append_array(&helper->entries_bson, key, column, error)))
+		{
+			j_db_insert_many_helper_free(helper);
+			goto _error;
+		}
+	}
+
+	data = g_slice_new(JBackendOperation);
+	memcpy(data, &j_backend_operation_db_insert_many, sizeof(JBackendOperation));
+	data->in_param[0].ptr_const = schema->namespace;
+	data->in_param[1].ptr_const = schema->name;
+	data->in_param[2].ptr_const = &helper->entries_bson;
+	data->out_param[0].ptr_const = &helper->ids;
+	data->out_param[1].ptr_const = error;
+
+	data->unref_func_count = 2;
+	data->unref_funcs[0] = (GDestroyNotify)j_db_insert_many_helper_free;
+	data->unref_values[0] = helper;
+	data->unref_funcs[1] = (GDestroyNotify)j_db_schema_unref;
+	data->unref_values[1] = j_db_schema_ref(schema);
+
+	op = j_operation_new();
+	op->key = schema->namespace;
+	op->data = data;
+	op->exec_func = j_db_insert_many_exec;
+	op->free_func = j_backend_db_func_free;
+
+	j_batch_add(batch, op);
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
 static gboolean
 j_db_update_exec(JList* operations, JSemantics* semantics)
 {
@@ -324,7 +790,7 @@ j_db_update_exec(JList* operations, JSemantics* semantics)
 }
 
 gboolean
-j_db_internal_update(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* batch, GError** error)
+j_db_internal_update(JDBEntry* j_db_entry, JDBSelector* j_db_selector, guint64* count, JBatch* batch, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
@@ -339,7 +805,8 @@ j_db_internal_update(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* b
 	data->in_param[1].ptr_const = j_db_entry->schema->name;
 	data->in_param[2].ptr_const = j_db_selector_get_bson(j_db_selector);
 	data->in_param[3].ptr_const = &j_db_entry->bson;
-	data->out_param[0].ptr_const = error;
+	data->out_param[0].ptr = count;
+	data->out_param[1].ptr_const = error;
 
 	data->unref_func_count = 2;
 	data->unref_funcs[0] = (GDestroyNotify)j_db_entry_unref;
@@ -367,7 +834,7 @@ j_db_delete_exec(JList* operations, JSemantics* semantics)
 }
 
 gboolean
-j_db_internal_delete(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* batch, GError** error)
+j_db_internal_delete(JDBEntry* j_db_entry, JDBSelector* j_db_selector, guint64* count, JBatch* batch, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
@@ -381,7 +848,8 @@ j_db_internal_delete(JDBEntry* j_db_entry, JDBSelector* j_db_selector, JBatch* b
 	data->in_param[0].ptr_const = j_db_entry->schema->namespace;
 	data->in_param[1].ptr_const = j_db_entry->schema->name;
 	data->in_param[2].ptr_const = j_db_selector_get_bson(j_db_selector);
-	data->out_param[0].ptr_const = error;
+	data->out_param[0].ptr = count;
+	data->out_param[1].ptr_const = error;
 
 	data->unref_func_count = 2;
 	data->unref_funcs[0] = (GDestroyNotify)j_db_entry_unref;
@@ -422,13 +890,24 @@ j_db_internal_query(JDBSchema* j_db_schema, JDBSelector* j_db_selector, JDBItera
 	helper = j_helper_alloc_aligned(128, sizeof(JDBIteratorHelper));
 	helper->initialized = FALSE;
 	memset(&helper->bson, 0, sizeof(bson_t));
+	helper->rows = NULL;
+	helper->rows_length = 0;
+	helper->rows_offset = 0;
+	helper->connection = NULL;
+	helper->next = NULL;
+	helper->namespace = g_strdup(j_db_schema->namespace);
+	helper->cursor = 0;
+	// Local backends do not need paging since the entries are not sent over the network
+	helper->page_size = (j_db_get_backend() == NULL) ? j_configuration_get_db_page_size(j_configuration()) : 0;
 	j_db_iterator->iterator = helper;
 
 	data = g_slice_new(JBackendOperation);
 	memcpy(data, &j_backend_operation_db_query, sizeof(JBackendOperation));
 	data->in_param[0].ptr_const = j_db_schema->namespace;
 	data->in_param[1].ptr_const = j_db_schema->name;
-	data->in_param[2].ptr_const = j_db_selector_get_bson(j_db_selector);
+	data->in_param[2].ptr_const = (j_db_iterator->query != NULL) ? j_db_iterator->query : j_db_selector_get_bson(j_db_selector);
+	data->in_param[3].ptr_const = &helper->page_size;
+	data->in_param[3].len = sizeof(guint32);
 	data->out_param[0].ptr_const = &helper->bson;
 	data->out_param[1].ptr_const = error;
 
@@ -451,14 +930,238 @@ j_db_internal_query(JDBSchema* j_db_schema, JDBSelector* j_db_selector, JDBItera
 	return TRUE;
 }
 
+static gboolean
+j_db_page_get_cursor(bson_t const* bson, guint32* cursor)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_iter_t iter;
+
+	if (bson->len == 0 || !bson_iter_init_find(&iter, bson, "_cursor"))
+	{
+		return FALSE;
+	}
+
+	*cursor = bson_iter_as_int64(&iter);
+
+	return TRUE;
+}
+
+/**
+ * Requests the next page without waiting for the reply.
+ * The server prepares it while the application consumes the current page.
+ **/
+static gboolean
+j_db_query_prefetch(JDBIteratorHelper* helper)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JBackendOperation data;
+
+	memcpy(&data, &j_backend_operation_db_query_next, sizeof(JBackendOperation));
+	data.in_param[0].ptr_const = helper->namespace;
+	data.in_param[1].ptr_const = &helper->cursor;
+	data.in_param[1].len = sizeof(guint32);
+	data.in_param[2].ptr_const = &helper->page_size;
+	data.in_param[2].len = sizeof(guint32);
+
+	helper->next = j_message_new(J_MESSAGE_DB_QUERY_NEXT, 0);
+	j_backend_operation_to_message(helper->next, data.in_param, data.in_param_count);
+
+	return j_message_send(helper->next, helper->connection);
+}
+
+/**
+ * Receives the prefetched page.
+ * broken is set if the reply could not be received, errors reported by the server leave the connection intact.
+ **/
+static gboolean
+j_db_query_receive(JDBIteratorHelper* helper, bson_t* bson, gboolean* broken, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JBackendOperation data;
+	g_autoptr(JMessage) reply = NULL;
+	gboolean ret;
+
+	memcpy(&data, &j_backend_operation_db_query_next, sizeof(JBackendOperation));
+	data.out_param[0].ptr = bson;
+	data.out_param[1].ptr = error;
+
+	reply = j_message_new_reply(helper->next);
+	ret = j_message_receive(reply, helper->connection);
+	*broken = !ret;
+	ret = ret && j_backend_operation_from_message(reply, data.out_param, data.out_param_count);
+
+	j_message_unref(helper->next);
+	helper->next = NULL;
+
+	return ret;
+}
+
+/**
+ * Reserves a connection for a query's cursor.
+ * One connection of the pool is never reserved, so other operations can make progress while iterators are open.
+ * Queries without a reserved connection return all entries at once.
+ **/
+static gboolean
+j_db_query_reserve(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint32 max_connections;
+
+	max_connections = j_configuration_get_max_connections(j_configuration());
+
+	if ((guint32)g_atomic_int_add(&j_db_query_pinned, 1) + 1 < max_connections)
+	{
+		return TRUE;
+	}
+
+	g_atomic_int_add(&j_db_query_pinned, -1);
+
+	return FALSE;
+}
+
+/**
+ * Gives up a query's connection once its cursor is not needed anymore.
+ * Broken connections are closed instead of being returned to the pool.
+ **/
+static void
+j_db_query_unpin(JDBIteratorHelper* helper, gboolean broken)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (broken)
+	{
+		j_connection_pool_close(J_BACKEND_TYPE_DB, 0, helper->connection);
+	}
+	else
+	{
+		j_connection_pool_push(J_BACKEND_TYPE_DB, 0, helper->connection);
+	}
+
+	helper->connection = NULL;
+	g_atomic_int_add(&j_db_query_pinned, -1);
+}
+
+static void
+j_db_query_close(JDBIteratorHelper* helper)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JBackendOperation data;
+	bson_t bson;
+	gboolean has_cursor = FALSE;
+	gboolean broken = FALSE;
+
+	if (helper->connection == NULL)
+	{
+		return;
+	}
+
+	// A prefetched page is not needed anymore but its reply still has to be received
+	if (helper->next != NULL)
+	{
+		memset(&bson, 0, sizeof(bson_t));
+
+		if (j_db_query_receive(helper, &bson, &broken, NULL))
+		{
+			has_cursor = j_db_page_get_cursor(&bson, &helper->cursor);
+		}
+
+		if (bson.len != 0)
+		{
+			j_bson_destroy(&bson);
+		}
+	}
+
+	if (has_cursor)
+	{
+		g_autoptr(JMessage) message = NULL;
+		g_autoptr(JMessage) reply = NULL;
+
+		memcpy(&data, &j_backend_operation_db_query_close, sizeof(JBackendOperation));
+		data.in_param[0].ptr_const = helper->namespace;
+		data.in_param[1].ptr_const = &helper->cursor;
+		data.in_param[1].len = sizeof(guint32);
+		data.out_param[0].ptr = NULL;
+
+		message = j_message_new(J_MESSAGE_DB_QUERY_CLOSE, 0);
+		j_backend_operation_to_message(message, data.in_param, data.in_param_count);
+
+		if (j_message_send(message, helper->connection))
+		{
+			reply = j_message_new_reply(message);
+			broken = !j_message_receive(reply, helper->connection);
+			broken = broken || !j_backend_operation_from_message(reply, data.out_param, data.out_param_count);
+		}
+		else
+		{
+			broken = TRUE;
+		}
+	}
+
+	j_db_query_unpin(helper, broken);
+}
+
+/**
+ * Keeps the connection of a query whose result did not fit into a single page.
+ * The server-side cursor is bound to this connection, so all following pages have to be requested through it.
+ **/
+static gboolean
+j_db_query_pin(JBackendOperation* data, GSocketConnection* connection)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBIterator* j_db_iterator = data->unref_values[2];
+	JDBIteratorHelper* helper = j_db_iterator->iterator;
+
+	if (!j_db_page_get_cursor(&helper->bson, &helper->cursor))
+	{
+		return FALSE;
+	}
+
+	helper->connection = connection;
+
+	if (!j_db_query_prefetch(helper))
+	{
+		// The reply will not arrive and the connection might be in an undefined state
+		g_clear_pointer(&helper->next, j_message_unref);
+		j_db_query_unpin(helper, TRUE);
+	}
+
+	return TRUE;
+}
+
+static gboolean
+j_db_page_get_rows(JDBIteratorHelper* helper, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	bson_iter_t iter;
+
+	if (G_UNLIKELY(!bson_iter_init_find(&iter, &helper->bson, "_rows") || !BSON_ITER_HOLDS_BINARY(&iter)))
+	{
+		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_INVALID, "iterator invalid");
+		return FALSE;
+	}
+
+	bson_iter_binary(&iter, NULL, &helper->rows_length, &helper->rows);
+	helper->rows_offset = 0;
+
+	return TRUE;
+}
+
 gboolean
 j_db_internal_iterate(JDBIterator* j_db_iterator, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	JDBIteratorHelper* helper = j_db_iterator->iterator;
-	gboolean has_next;
 	bson_t zerobson;
+	guint32 cursor;
+	gboolean broken;
 
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
@@ -469,10 +1172,10 @@ j_db_internal_iterate(JDBIterator* j_db_iterator, GError** error)
 		if (G_UNLIKELY(!memcmp(&helper->bson, &zerobson, sizeof(bson_t))))
 		{
 			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_INVALID, "iterator invalid");
-			goto error2;
+			goto _error;
 		}
 
-		if (G_UNLIKELY(!j_bson_iter_init(&helper->iter, &helper->bson, error)))
+		if (G_UNLIKELY(!j_db_page_get_rows(helper, error)))
 		{
 			goto _error;
 		}
@@ -480,31 +1183,98 @@ j_db_internal_iterate(JDBIterator* j_db_iterator, GError** error)
 		helper->initialized = TRUE;
 	}
 
-	if (G_UNLIKELY(!j_bson_iter_next(&helper->iter, &has_next, error)))
+	while (helper->rows_offset >= helper->rows_length)
 	{
-		goto _error;
-	}
+		if (G_UNLIKELY(!j_db_page_get_cursor(&helper->bson, &cursor)))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
+			goto _error;
+		}
 
-	if (G_UNLIKELY(!has_next))
-	{
-		g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS, "no more elements");
-		goto _error;
+		// The current page has been consumed, continue with the prefetched one
+		j_bson_destroy(&helper->bson);
+		memset(&helper->bson, 0, sizeof(bson_t));
+		helper->rows = NULL;
+		helper->rows_length = 0;
+
+		if (G_UNLIKELY(helper->next == NULL))
+		{
+			g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_INVALID, "iterator invalid");
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_db_query_receive(helper, &helper->bson, &broken, error)))
+		{
+			// The server has already freed the cursor if it reported an error
+			j_db_query_unpin(helper, broken);
+			goto _error;
+		}
+
+		if (j_db_page_get_cursor(&helper->bson, &helper->cursor))
+		{
+			if (G_UNLIKELY(!j_db_query_prefetch(helper)))
+			{
+				g_clear_pointer(&helper->next, j_message_unref);
+				j_db_query_unpin(helper, TRUE);
+				g_set_error_literal(error, J_BACKEND_DB_ERROR, J_BACKEND_DB_ERROR_ITERATOR_INVALID, "iterator invalid");
+				goto _error;
+			}
+		}
+		else
+		{
+			j_db_query_unpin(helper, FALSE);
+		}
+
+		if (G_UNLIKELY(!j_db_page_get_rows(helper, error)))
+		{
+			goto _error;
+		}
 	}
 
-	if (G_UNLIKELY(!j_bson_iter_copy_document(&helper->iter, &j_db_iterator->bson, error)))
+	// Rows are received from the network and have to be checked before they are accessed
+	if (G_UNLIKELY(!j_backend_db_row_check(helper->rows + helper->rows_offset, helper->rows_length - helper->rows_offset, j_db_iterator->column_count, error)))
 	{
 		goto _error;
 	}
 
+	// Rows are not copied, they stay valid until the page is replaced
+	j_db_iterator->row = helper->rows + helper->rows_offset;
+	helper->rows_offset += j_backend_db_row_get_length(j_db_iterator->row);
+
 	return TRUE;
 
 _error:
-	j_bson_destroy(&helper->bson);
+	j_db_internal_iterator_free(j_db_iterator);
+
+	return FALSE;
+}
+
+void
+j_db_internal_iterator_free(JDBIterator* j_db_iterator)
+{
+	J_TRACE_FUNCTION(NULL);
 
-error2:
+	JDBIteratorHelper* helper = j_db_iterator->iterator;
+	bson_t zerobson;
+
+	if (helper == NULL)
+	{
+		return;
+	}
+
+	memset(&zerobson, 0, sizeof(bson_t));
+
+	j_db_query_close(helper);
+
+	if (memcmp(&helper->bson, &zerobson, sizeof(bson_t)))
+	{
+		j_bson_destroy(&helper->bson);
+	}
+
+	g_free(helper->namespace);
 	g_free(helper);
 
-	return FALSE;
+	j_db_iterator->iterator = NULL;
 }
 
 bson_t*
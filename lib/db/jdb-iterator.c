@@ -33,11 +33,278 @@
 #include <julea-db.h>
 #include "../../backend/db/jbson.c"
 
+/**
+ * Adds a column to the binary row format requested from the backend.
+ **/
+static gboolean
+j_db_iterator_add_column(JDBIterator* iterator, bson_t* array, gchar const* name, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBTypeValue val;
+	gchar buf[16];
+
+	if (g_hash_table_contains(iterator->columns, name))
+	{
+		return TRUE;
+	}
+
+	snprintf(buf, sizeof(buf), "%u", iterator->column_count);
+	val.val_string = name;
+
+	if (G_UNLIKELY(!j_bson_append_value(array, buf, J_DB_TYPE_STRING, &val, error)))
+	{
+		return FALSE;
+	}
+
+	iterator->column_count++;
+	g_hash_table_insert(iterator->columns, g_strdup(name), GUINT_TO_POINTER(iterator->column_count));
+
+	return TRUE;
+}
+
+/**
+ * Determines the columns of the binary row format the entries are returned in.
+ * Aggregating queries return the grouped fields and the aggregates, all other queries return the ID and the requested fields.
+ **/
+static gboolean
+j_db_iterator_build_columns(JDBIterator* iterator, bson_t* query, gchar const* const* fields, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSelector* selector = iterator->selector;
+	bson_iter_t iter;
+	bson_t array;
+
+	if (G_UNLIKELY(!j_bson_append_array_begin(query, "_row", &array, error)))
+	{
+		goto _error;
+	}
+
+	if (selector != NULL && selector->aggregate_count > 0)
+	{
+		if (selector->group_by_count > 0)
+		{
+			if (G_UNLIKELY(!j_bson_iter_init(&iter, &selector->bson_group_by, error)))
+			{
+				goto _error;
+			}
+
+			while (bson_iter_next(&iter))
+			{
+				if (BSON_ITER_HOLDS_UTF8(&iter) && G_UNLIKELY(!j_db_iterator_add_column(iterator, &array, bson_iter_utf8(&iter, NULL), error)))
+				{
+					goto _error;
+				}
+			}
+		}
+
+		for (guint i = 0; i < selector->aggregate_count; i++)
+		{
+			gchar buf[32];
+
+			snprintf(buf, sizeof(buf), "_aggregate_%u", i);
+
+			if (G_UNLIKELY(!j_db_iterator_add_column(iterator, &array, buf, error)))
+			{
+				goto _error;
+			}
+		}
+	}
+	else
+	{
+		if (G_UNLIKELY(!j_db_iterator_add_column(iterator, &array, "_id", error)))
+		{
+			goto _error;
+		}
+
+		if (fields != NULL)
+		{
+			for (guint i = 0; fields[i] != NULL; i++)
+			{
+				if (G_UNLIKELY(!j_db_iterator_add_column(iterator, &array, fields[i], error)))
+				{
+					goto _error;
+				}
+			}
+		}
+		else if (iterator->schema->bson_initialized)
+		{
+			if (G_UNLIKELY(!j_bson_iter_init(&iter, &iterator->schema->bson, error)))
+			{
+				goto _error;
+			}
+
+			while (bson_iter_next(&iter))
+			{
+				if (g_strcmp0(bson_iter_key(&iter), "_index") == 0)
+				{
+					continue;
+				}
+
+				if (G_UNLIKELY(!j_db_iterator_add_column(iterator, &array, bson_iter_key(&iter), error)))
+				{
+					goto _error;
+				}
+			}
+		}
+	}
+
+	if (G_UNLIKELY(!j_bson_append_array_end(query, &array, error)))
+	{
+		goto _error;
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Builds the query sent to the backend.
+ * It consists of the selector's conditions, its modifiers such as sort keys and aggregates, the list of requested fields and the columns of the returned rows.
+ **/
+static bson_t*
+j_db_iterator_build_query(JDBIterator* iterator, gchar const* const* fields, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSchema* schema = iterator->schema;
+	JDBSelector* selector = iterator->selector;
+	JDBType type;
+	JDBTypeValue val;
+	bson_t* selector_bson;
+	bson_t* query;
+	bson_t array;
+	guint count = 0;
+
+	selector_bson = j_db_selector_get_bson(selector);
+
+	if (selector_bson != NULL)
+	{
+		query = bson_copy(selector_bson);
+	}
+	else
+	{
+		query = bson_new();
+		val.val_uint32 = J_DB_SELECTOR_MODE_AND;
+
+		if (G_UNLIKELY(!j_bson_append_value(query, "_mode", J_DB_TYPE_UINT32, &val, error)))
+		{
+			goto _error;
+		}
+	}
+
+	if (selector != NULL && selector->order_count > 0 && G_UNLIKELY(!j_bson_append_array(query, "_order", &selector->bson_order, error)))
+	{
+		goto _error;
+	}
+
+	if (selector != NULL && selector->aggregate_count > 0 && G_UNLIKELY(!j_bson_append_array(query, "_aggregate", &selector->bson_aggregate, error)))
+	{
+		goto _error;
+	}
+
+	if (selector != NULL && selector->group_by_count > 0 && G_UNLIKELY(!j_bson_append_array(query, "_group_by", &selector->bson_group_by, error)))
+	{
+		goto _error;
+	}
+
+	if (selector != NULL && (selector->limit > 0 || selector->offset > 0))
+	{
+		val.val_uint64 = selector->limit;
+
+		if (G_UNLIKELY(!j_bson_append_value(query, "_limit", J_DB_TYPE_UINT64, &val, error)))
+		{
+			goto _error;
+		}
+
+		val.val_uint64 = selector->offset;
+
+		if (G_UNLIKELY(!j_bson_append_value(query, "_offset", J_DB_TYPE_UINT64, &val, error)))
+		{
+			goto _error;
+		}
+	}
+
+	if (fields == NULL)
+	{
+		goto _columns;
+	}
+
+	if (G_UNLIKELY(!j_bson_append_array_begin(query, "_fields", &array, error)))
+	{
+		goto _error;
+	}
+
+	for (guint i = 0; fields[i] != NULL; i++)
+	{
+		gchar buf[16];
+		gboolean duplicate = FALSE;
+
+		if (G_UNLIKELY(!j_db_schema_get_field(schema, fields[i], &type, error)))
+		{
+			goto _error;
+		}
+
+		for (guint j = 0; j < i; j++)
+		{
+			if (g_strcmp0(fields[i], fields[j]) == 0)
+			{
+				duplicate = TRUE;
+				break;
+			}
+		}
+
+		if (duplicate)
+		{
+			continue;
+		}
+
+		snprintf(buf, sizeof(buf), "%u", count);
+		val.val_string = fields[i];
+
+		if (G_UNLIKELY(!j_bson_append_value(&array, buf, J_DB_TYPE_STRING, &val, error)))
+		{
+			goto _error;
+		}
+
+		count++;
+	}
+
+	if (G_UNLIKELY(!j_bson_append_array_end(query, &array, error)))
+	{
+		goto _error;
+	}
+
+_columns:
+	if (G_UNLIKELY(!j_db_iterator_build_columns(iterator, query, fields, error)))
+	{
+		goto _error;
+	}
+
+	return query;
+
+_error:
+	bson_destroy(query);
+
+	return NULL;
+}
+
 JDBIterator*
 j_db_iterator_new(JDBSchema* schema, JDBSelector* selector, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	return j_db_iterator_new_with_fields(schema, selector, NULL, error);
+}
+
+JDBIterator*
+j_db_iterator_new_with_fields(JDBSchema* schema, JDBSelector* selector, gchar const* const* fields, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
 	guint ret;
 	guint ret2 = FALSE;
 	JBatch* batch;
@@ -48,6 +315,10 @@ j_db_iterator_new(JDBSchema* schema, JDBSelector* selector, GError** error)
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	iterator = j_helper_alloc_aligned(128, sizeof(JDBIterator));
+	iterator->query = NULL;
+	iterator->row = NULL;
+	iterator->columns = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	iterator->column_count = 0;
 	iterator->schema = j_db_schema_ref(schema);
 
 	if (G_UNLIKELY(!iterator->schema))
@@ -72,7 +343,15 @@ j_db_iterator_new(JDBSchema* schema, JDBSelector* selector, GError** error)
 	iterator->iterator = NULL;
 	iterator->ref_count = 1;
 	iterator->valid = FALSE;
-	iterator->bson_valid = FALSE;
+	iterator->row_valid = FALSE;
+
+	iterator->query = j_db_iterator_build_query(iterator, fields, error);
+
+	if (G_UNLIKELY(!iterator->query))
+	{
+		goto _error;
+	}
+
 	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
 	ret2 = j_db_internal_query(schema, selector, iterator, batch, error);
 	ret = ret2 && j_batch_execute(batch);
@@ -88,14 +367,6 @@ j_db_iterator_new(JDBSchema* schema, JDBSelector* selector, GError** error)
 	return iterator;
 
 _error:
-	if (ret2)
-	{
-		while (j_db_internal_iterate(iterator, NULL))
-		{
-			/*do nothing*/
-		}
-	}
-
 	j_db_iterator_unref(iterator);
 
 	return NULL;
@@ -122,10 +393,8 @@ j_db_iterator_unref(JDBIterator* iterator)
 
 	if (g_atomic_int_dec_and_test(&iterator->ref_count))
 	{
-		while (iterator->valid)
-		{
-			j_db_iterator_next(iterator, NULL);
-		}
+		// Releases the remaining entries and closes the query's cursor, if any
+		j_db_internal_iterator_free(iterator);
 
 		j_db_schema_unref(iterator->schema);
 
@@ -134,9 +403,11 @@ j_db_iterator_unref(JDBIterator* iterator)
 			j_db_selector_unref(iterator->selector);
 		}
 
-		if (iterator->bson_valid)
+		g_hash_table_unref(iterator->columns);
+
+		if (iterator->query)
 		{
-			j_bson_destroy(&iterator->bson);
+			bson_destroy(iterator->query);
 		}
 
 		g_free(iterator);
@@ -152,105 +423,93 @@ j_db_iterator_next(JDBIterator* iterator, GError** error)
 	g_return_val_if_fail(iterator->valid, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	if (iterator->bson_valid)
-	{
-		j_bson_destroy(&iterator->bson);
-	}
+	iterator->row_valid = FALSE;
 
 	if (G_UNLIKELY(!j_db_internal_iterate(iterator, error)))
 	{
 		goto _error;
 	}
 
-	iterator->bson_valid = TRUE;
+	iterator->row_valid = TRUE;
 
 	return TRUE;
 
 _error:
 	iterator->valid = FALSE;
-	iterator->bson_valid = FALSE;
 
 	return FALSE;
 }
 
-gboolean
-j_db_iterator_get_field(JDBIterator* iterator, gchar const* name, JDBType* type, gpointer* value, guint64* length, GError** error)
+/**
+ * Looks up a column of the current row and reads its value.
+ * Values that are not set are returned as zero or NULL.
+ **/
+static gboolean
+j_db_iterator_get_value(JDBIterator* iterator, gchar const* name, JDBType type, JDBTypeValue* val, GError** error)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JDBTypeValue val;
-	bson_iter_t iter;
+	guint index;
 
-	g_return_val_if_fail(iterator != NULL, FALSE);
-	g_return_val_if_fail(iterator->bson_valid, FALSE);
-	g_return_val_if_fail(name != NULL, FALSE);
-	g_return_val_if_fail(type != NULL, FALSE);
-	g_return_val_if_fail(value != NULL, FALSE);
-	g_return_val_if_fail(length != NULL, FALSE);
-	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
-
-	if (G_UNLIKELY(!j_db_schema_get_field(iterator->schema, name, type, error)))
+	if (G_UNLIKELY((index = GPOINTER_TO_UINT(g_hash_table_lookup(iterator->columns, name))) == 0))
 	{
-		goto _error;
+		g_set_error_literal(error, J_BACKEND_BSON_ERROR, J_BACKEND_BSON_ERROR_ITER_KEY_NOT_FOUND, "bson iter can not find key");
+		return FALSE;
 	}
 
-	if (G_UNLIKELY(!j_bson_iter_init(&iter, &iterator->bson, error)))
-	{
-		goto _error;
-	}
-
-	if (G_UNLIKELY(!j_bson_iter_find(&iter, name, error)))
-	{
-		goto _error;
-	}
+	return j_row_get_value(iterator->row, iterator->column_count, index - 1, type, val, error);
+}
 
-	if (G_UNLIKELY(!j_bson_iter_value(&iter, *type, &val, error)))
-	{
-		goto _error;
-	}
+/**
+ * Copies a value read from the current row into newly allocated memory.
+ **/
+static void
+j_db_iterator_copy_value(JDBType type, JDBTypeValue const* val, gpointer* value, guint64* length)
+{
+	J_TRACE_FUNCTION(NULL);
 
-	switch (*type)
+	switch (type)
 	{
 		case J_DB_TYPE_SINT32:
 			*value = g_new(gint32, 1);
-			*((gint32*)*value) = val.val_sint32;
+			*((gint32*)*value) = val->val_sint32;
 			*length = sizeof(gint32);
 			break;
 		case J_DB_TYPE_UINT32:
 			*value = g_new(guint32, 1);
-			*((guint32*)*value) = val.val_uint32;
+			*((guint32*)*value) = val->val_uint32;
 			*length = sizeof(guint32);
 			break;
 		case J_DB_TYPE_FLOAT32:
 			*value = g_new(gfloat, 1);
-			*((gfloat*)*value) = val.val_float32;
+			*((gfloat*)*value) = val->val_float32;
 			*length = sizeof(gfloat);
 			break;
 		case J_DB_TYPE_SINT64:
 			*value = g_new(gint64, 1);
-			*((gint64*)*value) = val.val_sint64;
+			*((gint64*)*value) = val->val_sint64;
 			*length = sizeof(gint64);
 			break;
 		case J_DB_TYPE_UINT64:
 			*value = g_new(guint64, 1);
-			*((guint64*)*value) = val.val_uint64;
+			*((guint64*)*value) = val->val_uint64;
 			*length = sizeof(guint64);
 			break;
 		case J_DB_TYPE_FLOAT64:
 			*value = g_new(gdouble, 1);
-			*((gdouble*)*value) = val.val_float64;
+			*((gdouble*)*value) = val->val_float64;
 			*length = sizeof(gdouble);
 			break;
 		case J_DB_TYPE_STRING:
-			*value = g_strdup(val.val_string);
-			*length = strlen(val.val_string);
+			*value = g_strdup(val->val_string);
+			*length = (val->val_string != NULL) ? strlen(val->val_string) : 0;
 			break;
 		case J_DB_TYPE_BLOB:
-			if (val.val_blob && val.val_blob_length)
+			if (val->val_blob && val->val_blob_length)
 			{
-				*value = g_new(gchar, val.val_blob_length);
-				memcpy(*value, val.val_blob, val.val_blob_length);
-				*length = val.val_blob_length;
+				*value = g_new(gchar, val->val_blob_length);
+				memcpy(*value, val->val_blob, val->val_blob_length);
+				*length = val->val_blob_length;
 			}
 			else
 			{
@@ -262,6 +521,121 @@ j_db_iterator_get_field(JDBIterator* iterator, gchar const* name, JDBType* type,
 		default:
 			g_assert_not_reached();
 	}
+}
+
+gboolean
+j_db_iterator_get_field(JDBIterator* iterator, gchar const* name, JDBType* type, gpointer* value, guint64* length, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBTypeValue val;
+
+	g_return_val_if_fail(iterator != NULL, FALSE);
+	g_return_val_if_fail(iterator->row_valid, FALSE);
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(type != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(length != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (G_UNLIKELY(!j_db_schema_get_field(iterator->schema, name, type, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_db_iterator_get_value(iterator, name, *type, &val, error)))
+	{
+		goto _error;
+	}
+
+	j_db_iterator_copy_value(*type, &val, value, length);
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+gboolean
+j_db_iterator_get_aggregate(JDBIterator* iterator, guint index, JDBType* type, gpointer* value, guint64* length, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBTypeValue val;
+	JDBType field_type = J_DB_TYPE_UINT64;
+	bson_iter_t iter;
+	bson_iter_t iter_child;
+	char buf[32];
+
+	g_return_val_if_fail(iterator != NULL, FALSE);
+	g_return_val_if_fail(iterator->row_valid, FALSE);
+	g_return_val_if_fail(iterator->selector != NULL, FALSE);
+	g_return_val_if_fail(index < iterator->selector->aggregate_count, FALSE);
+	g_return_val_if_fail(type != NULL, FALSE);
+	g_return_val_if_fail(value != NULL, FALSE);
+	g_return_val_if_fail(length != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	snprintf(buf, sizeof(buf), "%u", index);
+
+	// The result's type depends on the aggregate and the type of the aggregated field
+	if (G_UNLIKELY(!j_bson_iter_init(&iter, &iterator->selector->bson_aggregate, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_find(&iter, buf, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter, &iter_child, error)))
+	{
+		goto _error;
+	}
+
+	if (j_bson_iter_find(&iter_child, "_name", NULL))
+	{
+		if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_STRING, &val, error)))
+		{
+			goto _error;
+		}
+
+		if (G_UNLIKELY(!j_db_schema_get_field(iterator->schema, val.val_string, &field_type, error)))
+		{
+			goto _error;
+		}
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_recurse_document(&iter, &iter_child, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_find(&iter_child, "_aggregate", error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_iter_value(&iter_child, J_DB_TYPE_UINT32, &val, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_aggregate_type(val.val_uint32, field_type, type, error)))
+	{
+		goto _error;
+	}
+
+	// Aggregates are returned as _aggregate_<index>
+	snprintf(buf, sizeof(buf), "_aggregate_%u", index);
+
+	if (G_UNLIKELY(!j_db_iterator_get_value(iterator, buf, *type, &val, error)))
+	{
+		goto _error;
+	}
+
+	j_db_iterator_copy_value(*type, &val, value, length);
 
 	return TRUE;
 
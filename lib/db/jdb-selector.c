@@ -47,7 +47,15 @@ j_db_selector_new(JDBSchema* schema, JDBSelectorMode mode, GError** error)
 	selector->ref_count = 1;
 	selector->mode = mode;
 	selector->bson_count = 0;
+	selector->order_count = 0;
+	selector->aggregate_count = 0;
+	selector->group_by_count = 0;
+	selector->limit = 0;
+	selector->offset = 0;
 	bson_init(&selector->bson);
+	bson_init(&selector->bson_order);
+	bson_init(&selector->bson_aggregate);
+	bson_init(&selector->bson_group_by);
 	selector->schema = j_db_schema_ref(schema);
 
 	if (G_UNLIKELY(!selector->schema))
@@ -92,6 +100,9 @@ j_db_selector_unref(JDBSelector* selector)
 	{
 		j_db_schema_unref(selector->schema);
 		bson_destroy(&selector->bson);
+		bson_destroy(&selector->bson_order);
+		bson_destroy(&selector->bson_aggregate);
+		bson_destroy(&selector->bson_group_by);
 		g_free(selector);
 	}
 }
@@ -230,3 +241,168 @@ j_db_selector_add_selector(JDBSelector* selector, JDBSelector* sub_selector, GEr
 _error:
 	return FALSE;
 }
+
+gboolean
+j_db_selector_add_order(JDBSelector* selector, gchar const* name, JDBSelectorOrder order, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	char buf[20];
+	bson_t bson;
+	JDBType type;
+	JDBTypeValue val;
+
+	g_return_val_if_fail(selector != NULL, FALSE);
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(order == J_DB_SELECTOR_ORDER_ASCENDING || order == J_DB_SELECTOR_ORDER_DESCENDING, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (G_UNLIKELY(!j_db_schema_get_field(selector->schema, name, &type, error)))
+	{
+		goto _error;
+	}
+
+	snprintf(buf, sizeof(buf), "%d", selector->order_count);
+
+	if (G_UNLIKELY(!j_bson_append_document_begin(&selector->bson_order, buf, &bson, error)))
+	{
+		goto _error;
+	}
+
+	val.val_string = name;
+
+	if (G_UNLIKELY(!j_bson_append_value(&bson, "_name", J_DB_TYPE_STRING, &val, error)))
+	{
+		goto _error;
+	}
+
+	val.val_uint32 = order;
+
+	if (G_UNLIKELY(!j_bson_append_value(&bson, "_order", J_DB_TYPE_UINT32, &val, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_append_document_end(&selector->bson_order, &bson, error)))
+	{
+		goto _error;
+	}
+
+	selector->order_count++;
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+gboolean
+j_db_selector_set_limit(JDBSelector* selector, guint64 limit, guint64 offset, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_val_if_fail(selector != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	selector->limit = limit;
+	selector->offset = offset;
+
+	return TRUE;
+}
+
+gboolean
+j_db_selector_add_aggregate(JDBSelector* selector, JDBAggregate aggregate, gchar const* name, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	char buf[20];
+	bson_t bson;
+	JDBType type = J_DB_TYPE_UINT64;
+	JDBType result_type;
+	JDBTypeValue val;
+
+	g_return_val_if_fail(selector != NULL, FALSE);
+	g_return_val_if_fail(name != NULL || aggregate == J_DB_AGGREGATE_COUNT, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (name != NULL && G_UNLIKELY(!j_db_schema_get_field(selector->schema, name, &type, error)))
+	{
+		goto _error;
+	}
+
+	// Reject aggregates that cannot be applied to the field's type early
+	if (G_UNLIKELY(!j_bson_aggregate_type(aggregate, type, &result_type, error)))
+	{
+		goto _error;
+	}
+
+	snprintf(buf, sizeof(buf), "%d", selector->aggregate_count);
+
+	if (G_UNLIKELY(!j_bson_append_document_begin(&selector->bson_aggregate, buf, &bson, error)))
+	{
+		goto _error;
+	}
+
+	if (name != NULL)
+	{
+		val.val_string = name;
+
+		if (G_UNLIKELY(!j_bson_append_value(&bson, "_name", J_DB_TYPE_STRING, &val, error)))
+		{
+			goto _error;
+		}
+	}
+
+	val.val_uint32 = aggregate;
+
+	if (G_UNLIKELY(!j_bson_append_value(&bson, "_aggregate", J_DB_TYPE_UINT32, &val, error)))
+	{
+		goto _error;
+	}
+
+	if (G_UNLIKELY(!j_bson_append_document_end(&selector->bson_aggregate, &bson, error)))
+	{
+		goto _error;
+	}
+
+	selector->aggregate_count++;
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+gboolean
+j_db_selector_add_group_by(JDBSelector* selector, gchar const* name, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	char buf[20];
+	JDBType type;
+	JDBTypeValue val;
+
+	g_return_val_if_fail(selector != NULL, FALSE);
+	g_return_val_if_fail(name != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (G_UNLIKELY(!j_db_schema_get_field(selector->schema, name, &type, error)))
+	{
+		goto _error;
+	}
+
+	snprintf(buf, sizeof(buf), "%d", selector->group_by_count);
+	val.val_string = name;
+
+	if (G_UNLIKELY(!j_bson_append_value(&selector->bson_group_by, buf, J_DB_TYPE_STRING, &val, error)))
+	{
+		goto _error;
+	}
+
+	selector->group_by_count++;
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
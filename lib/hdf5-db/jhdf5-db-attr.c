@@ -354,7 +354,7 @@ H5VL_julea_db_attr_create(void* obj, const H5VL_loc_params_t* loc_params, const
 		j_goto_error();
 	}
 
-	j_hdf5_log(file->file.name, "a", 'C', NULL, object, parent);
+	H5VL_julea_db_log('C', object, parent, 0);
 	return object;
 
 _error:
@@ -371,8 +371,7 @@ H5VL_julea_db_attr_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 
 	g_autoptr(GError) error = NULL;
 	g_autoptr(JBatch) batch = NULL;
-	g_autoptr(JDBIterator) iterator = NULL;
-	g_autoptr(JDBSelector) selector = NULL;
+	g_autoptr(GHashTable) row = NULL;
 	g_autofree void* space_id_buf = NULL;
 	g_autofree void* datatype_id_buf = NULL;
 	JHDF5Object_t* object = NULL;
@@ -437,49 +436,32 @@ H5VL_julea_db_attr_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 		j_goto_error();
 	}
 
-	if (!(selector = j_db_selector_new(julea_db_schema_attr, J_DB_SELECTOR_MODE_AND, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
-	{
-		j_goto_error();
-	}
-
-	if (!(iterator = j_db_iterator_new(julea_db_schema_attr, selector, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_iterator_next(iterator, &error))
+	if (!(row = H5VL_julea_db_metadata_get_row(file, J_HDF5_OBJECT_TYPE_ATTR, object->backend_id, object->backend_id_len, &error)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "space", &type, &space_id_buf, &space_id_buf_len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "space", &type, &space_id_buf, &space_id_buf_len, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(object->attr.space = H5VL_julea_db_space_decode(space_id_buf, space_id_buf_len)))
+	if (!(object->attr.space = H5VL_julea_db_space_decode(file, space_id_buf, space_id_buf_len)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "datatype", &type, &datatype_id_buf, &datatype_id_buf_len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "datatype", &type, &datatype_id_buf, &datatype_id_buf_len, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(object->attr.datatype = H5VL_julea_db_datatype_decode(datatype_id_buf, datatype_id_buf_len)))
+	if (!(object->attr.datatype = H5VL_julea_db_datatype_decode(file, datatype_id_buf, datatype_id_buf_len)))
 	{
 		j_goto_error();
 	}
 
-	g_assert(!j_db_iterator_next(iterator, NULL));
-
-	j_hdf5_log(file->file.name, "a", 'O', NULL, object, parent);
+	H5VL_julea_db_log('O', object, parent, 0);
 	return object;
 
 _error:
@@ -496,8 +478,7 @@ H5VL_julea_db_attr_read(void* obj, hid_t mem_type_id, void* buf, hid_t dxpl_id,
 	J_TRACE_FUNCTION(NULL);
 
 	g_autoptr(GError) error = NULL;
-	g_autoptr(JDBIterator) iterator = NULL;
-	g_autoptr(JDBSelector) selector = NULL;
+	g_autoptr(GHashTable) row = NULL;
 	guint64 bytes_read;
 	gsize data_size;
 	g_autofree gpointer tmp = NULL;
@@ -515,37 +496,21 @@ H5VL_julea_db_attr_read(void* obj, hid_t mem_type_id, void* buf, hid_t dxpl_id,
 	data_size = object->dataset.datatype->datatype.type_total_size;
 	data_size *= object->attr.space->space.dim_total_count;
 
-	if (!(selector = j_db_selector_new(julea_db_schema_attr, J_DB_SELECTOR_MODE_AND, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
-	{
-		j_goto_error();
-	}
-
-	if (!(iterator = j_db_iterator_new(julea_db_schema_attr, selector, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_iterator_next(iterator, &error))
+	if (!(row = H5VL_julea_db_metadata_get_row(object->attr.file, J_HDF5_OBJECT_TYPE_ATTR, object->backend_id, object->backend_id_len, &error)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "data", &type, &tmp, &bytes_read, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "data", &type, &tmp, &bytes_read, &error))
 	{
 		j_goto_error();
 	}
 
-	g_assert(!j_db_iterator_next(iterator, NULL));
 	g_assert_cmpuint(data_size, ==, bytes_read);
 
 	memcpy(buf, tmp, bytes_read);
 
-	j_hdf5_log(object->attr.file->file.name, "a", 'R', NULL, object, NULL);
+	H5VL_julea_db_log('R', object, NULL, bytes_read);
 	return 0;
 
 _error:
@@ -615,12 +580,14 @@ H5VL_julea_db_attr_write(void* obj, hid_t mem_type_id, const void* buf, hid_t dx
 		j_goto_error();
 	}
 
+	H5VL_julea_db_metadata_invalidate(object->attr.file);
+
 	if (!j_batch_execute(batch))
 	{
 		j_goto_error();
 	}
 
-	j_hdf5_log(object->attr.file->file.name, "a", 'W', NULL, object, NULL);
+	H5VL_julea_db_log('W', object, NULL, data_size);
 	return 0;
 
 _error:
@@ -655,7 +622,7 @@ H5VL_julea_db_attr_get(void* obj, H5VL_attr_get_t get_type, hid_t dxpl_id, void*
 			g_assert_not_reached();
 	}
 
-	j_hdf5_log(object->attr.file->file.name, "a", 'G', NULL, object, NULL);
+	H5VL_julea_db_log('G', object, NULL, 0);
 	return 0;
 }
 
@@ -708,7 +675,7 @@ H5VL_julea_db_attr_close(void* obj, hid_t dxpl_id, void** req)
 
 	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_ATTR, 1);
 
-	j_hdf5_log(object->attr.file->file.name, "a", 'S', NULL, object, NULL);
+	H5VL_julea_db_log('S', object, NULL, 0);
 	H5VL_julea_db_object_unref(object);
 
 	return 0;
@@ -27,6 +27,7 @@
 #include <hdf5.h>
 #include <H5PLextern.h>
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,6 +35,14 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 #include <hdf5/jhdf5.h>
 
 #include <julea.h>
@@ -42,7 +51,14 @@
 
 #include "jhdf5-db.h"
 
+// Filter identifiers registered with The HDF Group for the LZ4 and Zstandard filter plugins
+#define H5VL_JULEA_DB_FILTER_LZ4 32004
+#define H5VL_JULEA_DB_FILTER_ZSTD 32015
+
+#define H5VL_JULEA_DB_FILTER_COMPRESSION (J_HDF5_FILTER_LZ4 | J_HDF5_FILTER_ZSTD)
+
 static JDBSchema* julea_db_schema_dataset = NULL;
+static JDBSchema* julea_db_schema_chunk = NULL;
 
 static herr_t
 H5VL_julea_db_dataset_term(void)
@@ -55,9 +71,158 @@ H5VL_julea_db_dataset_term(void)
 		julea_db_schema_dataset = NULL;
 	}
 
+	if (julea_db_schema_chunk != NULL)
+	{
+		j_db_schema_unref(julea_db_schema_chunk);
+		julea_db_schema_chunk = NULL;
+	}
+
 	return 0;
 }
 
+/**
+ * Checks that an existing schema contains the fields of the current format.
+ * Schemas are only created if they do not exist yet, so schemas created by older versions might lack fields and have to be recreated.
+ **/
+static gboolean
+H5VL_julea_db_dataset_check_schema(JDBSchema* schema, gchar const* name, gchar const* const* fields, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (guint i = 0; fields[i] != NULL; i++)
+	{
+		JDBType type;
+
+		if (!j_db_schema_get_field(schema, fields[i], &type, NULL))
+		{
+			g_set_error(error, J_DB_ERROR, J_DB_ERROR_VARIABLE_NOT_FOUND, "The %s schema in namespace %s lacks the field %s because it was created by an older version, delete the schema to recreate it.", name, JULEA_HDF5_DB_NAMESPACE, fields[i]);
+			g_critical("%s", (*error)->message);
+
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ * Gets or creates the schema of the chunk index, which contains one entry per chunk of a chunked dataset that has been written.
+ **/
+static gboolean
+H5VL_julea_db_dataset_chunk_init(JBatch* batch, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (!(julea_db_schema_chunk = j_db_schema_new(JULEA_HDF5_DB_NAMESPACE, "chunk", NULL)))
+	{
+		j_goto_error();
+	}
+
+	if (j_db_schema_get(julea_db_schema_chunk, batch, error) && j_batch_execute(batch))
+	{
+		gchar const* fields[] = { "file", "dataset", "index", "size", "min_value_f", "max_value_f", "min_value_i", "max_value_i", NULL };
+
+		return H5VL_julea_db_dataset_check_schema(julea_db_schema_chunk, "chunk", fields, error);
+	}
+
+	if (*error == NULL || (*error)->code != J_BACKEND_DB_ERROR_SCHEMA_NOT_FOUND)
+	{
+		j_goto_error();
+	}
+
+	g_clear_error(error);
+	j_db_schema_unref(julea_db_schema_chunk);
+
+	if (!(julea_db_schema_chunk = j_db_schema_new(JULEA_HDF5_DB_NAMESPACE, "chunk", NULL)))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "file", J_DB_TYPE_ID, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "dataset", J_DB_TYPE_ID, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "index", J_DB_TYPE_UINT64, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "size", J_DB_TYPE_UINT64, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "min_value_f", J_DB_TYPE_FLOAT64, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "max_value_f", J_DB_TYPE_FLOAT64, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "min_value_i", J_DB_TYPE_SINT64, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_add_field(julea_db_schema_chunk, "max_value_i", J_DB_TYPE_SINT64, error))
+	{
+		j_goto_error();
+	}
+
+	{
+		const gchar* index[] = {
+			"dataset",
+			NULL,
+		};
+
+		if (!j_db_schema_add_index(julea_db_schema_chunk, index, error))
+		{
+			j_goto_error();
+		}
+	}
+
+	if (!j_db_schema_create(julea_db_schema_chunk, batch, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_batch_execute(batch))
+	{
+		j_goto_error();
+	}
+
+	j_db_schema_unref(julea_db_schema_chunk);
+
+	if (!(julea_db_schema_chunk = j_db_schema_new(JULEA_HDF5_DB_NAMESPACE, "chunk", NULL)))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_schema_get(julea_db_schema_chunk, batch, error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_batch_execute(batch))
+	{
+		j_goto_error();
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
 static herr_t
 H5VL_julea_db_dataset_init(hid_t vipl_id)
 {
@@ -132,6 +297,21 @@ H5VL_julea_db_dataset_init(hid_t vipl_id)
 					j_goto_error();
 				}
 
+				if (!j_db_schema_add_field(julea_db_schema_dataset, "chunk", J_DB_TYPE_BLOB, &error))
+				{
+					j_goto_error();
+				}
+
+				if (!j_db_schema_add_field(julea_db_schema_dataset, "filter", J_DB_TYPE_UINT32, &error))
+				{
+					j_goto_error();
+				}
+
+				if (!j_db_schema_add_field(julea_db_schema_dataset, "filter_level", J_DB_TYPE_SINT32, &error))
+				{
+					j_goto_error();
+				}
+
 				{
 					const gchar* index[] = {
 						"file",
@@ -186,6 +366,20 @@ H5VL_julea_db_dataset_init(hid_t vipl_id)
 			j_goto_error();
 		}
 	}
+	else
+	{
+		gchar const* fields[] = { "file", "datatype", "space", "min_value_f", "max_value_f", "min_value_i", "max_value_i", "chunk", "filter", "filter_level", NULL };
+
+		if (!H5VL_julea_db_dataset_check_schema(julea_db_schema_dataset, "dataset", fields, &error))
+		{
+			j_goto_error();
+		}
+	}
+
+	if (!H5VL_julea_db_dataset_chunk_init(batch, &error))
+	{
+		j_goto_error();
+	}
 
 	return 0;
 
@@ -242,6 +436,39 @@ H5VL_julea_db_dataset_truncate_file(void* obj)
 		}
 	}
 
+	g_clear_error(&error);
+	g_clear_pointer(&selector, j_db_selector_unref);
+	g_clear_pointer(&entry, j_db_entry_unref);
+
+	// The chunk index references the file as well, so all chunks of the file's datasets can be removed at once
+	if (!(selector = j_db_selector_new(julea_db_schema_chunk, J_DB_SELECTOR_MODE_AND, &error)))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_selector_add_field(selector, "file", J_DB_SELECTOR_OPERATOR_EQ, file->backend_id, file->backend_id_len, &error))
+	{
+		j_goto_error();
+	}
+
+	if (!(entry = j_db_entry_new(julea_db_schema_chunk, &error)))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_entry_delete(entry, selector, batch, &error))
+	{
+		j_goto_error();
+	}
+
+	if (!j_batch_execute(batch))
+	{
+		if (!error || error->code != J_BACKEND_DB_ERROR_ITERATOR_NO_MORE_ELEMENTS)
+		{
+			j_goto_error();
+		}
+	}
+
 	return 0;
 
 _error:
@@ -250,6 +477,145 @@ _error:
 	return 1;
 }
 
+/**
+ * Copies a fixed-size field of a row to value.
+ **/
+static gboolean
+H5VL_julea_db_dataset_get_field(GHashTable* row, gchar const* name, gpointer value, gsize size, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree gpointer tmp = NULL;
+	JDBType type;
+	guint64 len;
+
+	if (!H5VL_julea_db_metadata_get_field(row, name, &type, &tmp, &len, error))
+	{
+		return FALSE;
+	}
+
+	g_return_val_if_fail(len == size, FALSE);
+
+	memcpy(value, tmp, size);
+
+	return TRUE;
+}
+
+/**
+ * Loads the chunk index of a chunked dataset, that is, the stored sizes and zone maps of the chunks that have been written.
+ **/
+static gboolean
+H5VL_julea_db_dataset_chunk_load(JHDF5Object_t* object, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GPtrArray) rows = NULL;
+
+	if (!(rows = H5VL_julea_db_metadata_get_chunks(object->dataset.file, object, error)))
+	{
+		j_goto_error();
+	}
+
+	for (guint i = 0; i < rows->len; i++)
+	{
+		GHashTable* row = g_ptr_array_index(rows, i);
+		g_autofree guint64* index = NULL;
+		g_autofree JHDF5ChunkInfo* info = NULL;
+
+		index = g_new(guint64, 1);
+		info = g_new(JHDF5ChunkInfo, 1);
+
+		if (!H5VL_julea_db_dataset_get_field(row, "index", index, sizeof(*index), error))
+		{
+			j_goto_error();
+		}
+
+		if (!H5VL_julea_db_dataset_get_field(row, "size", &info->size, sizeof(info->size), error))
+		{
+			j_goto_error();
+		}
+
+		if (!H5VL_julea_db_dataset_get_field(row, "min_value_i", &info->statistics.min_value_i, sizeof(info->statistics.min_value_i), error))
+		{
+			j_goto_error();
+		}
+
+		if (!H5VL_julea_db_dataset_get_field(row, "max_value_i", &info->statistics.max_value_i, sizeof(info->statistics.max_value_i), error))
+		{
+			j_goto_error();
+		}
+
+		if (!H5VL_julea_db_dataset_get_field(row, "min_value_f", &info->statistics.min_value_f, sizeof(info->statistics.min_value_f), error))
+		{
+			j_goto_error();
+		}
+
+		if (!H5VL_julea_db_dataset_get_field(row, "max_value_f", &info->statistics.max_value_f, sizeof(info->statistics.max_value_f), error))
+		{
+			j_goto_error();
+		}
+
+		g_hash_table_insert(object->dataset.chunks, g_steal_pointer(&index), g_steal_pointer(&info));
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Determines the filters to apply to the chunks of a dataset from its creation property list.
+ * Unsupported filters are ignored, at most one compression filter is used.
+ **/
+static void
+H5VL_julea_db_dataset_filter_init(JHDF5Object_t* object, hid_t dcpl_id)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gint nfilters;
+
+	nfilters = H5Pget_nfilters(dcpl_id);
+
+	for (gint i = 0; i < nfilters; i++)
+	{
+		H5Z_filter_t filter;
+		unsigned int flags;
+		unsigned int cd_values[8];
+		size_t cd_nelmts = G_N_ELEMENTS(cd_values);
+		char filter_name[64];
+
+		filter = H5Pget_filter2(dcpl_id, i, &flags, &cd_nelmts, cd_values, sizeof(filter_name), filter_name, NULL);
+
+		switch (filter)
+		{
+			case H5Z_FILTER_SHUFFLE:
+				object->dataset.filters |= J_HDF5_FILTER_SHUFFLE;
+				break;
+#ifdef HAVE_LZ4
+			case H5VL_JULEA_DB_FILTER_LZ4:
+				if ((object->dataset.filters & H5VL_JULEA_DB_FILTER_COMPRESSION) == 0)
+				{
+					object->dataset.filters |= J_HDF5_FILTER_LZ4;
+				}
+				break;
+#endif
+#ifdef HAVE_ZSTD
+			case H5VL_JULEA_DB_FILTER_ZSTD:
+				if ((object->dataset.filters & H5VL_JULEA_DB_FILTER_COMPRESSION) == 0)
+				{
+					object->dataset.filters |= J_HDF5_FILTER_ZSTD;
+					// The first client data value of the Zstandard filter is the compression level
+					object->dataset.filter_level = (cd_nelmts > 0) ? (gint32)cd_values[0] : 3;
+				}
+				break;
+#endif
+			default:
+				break;
+		}
+	}
+}
+
 static void*
 H5VL_julea_db_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const char* name, hid_t lcpl_id, hid_t type_id, hid_t space_id, hid_t dcpl_id, hid_t dapl_id, hid_t dxpl_id, void** req)
 {
@@ -265,7 +631,6 @@ H5VL_julea_db_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, con
 
 	(void)loc_params;
 	(void)lcpl_id;
-	(void)dcpl_id;
 	(void)dapl_id;
 	(void)dxpl_id;
 	(void)req;
@@ -330,6 +695,22 @@ H5VL_julea_db_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, con
 		j_goto_error();
 	}
 
+	if (H5Pget_layout(dcpl_id) == H5D_CHUNKED)
+	{
+		gint ndims;
+
+		ndims = H5Sget_simple_extent_ndims(space_id);
+		object->dataset.chunk_dims = g_new(hsize_t, ndims);
+		object->dataset.chunks = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_free);
+
+		if (H5Pget_chunk(dcpl_id, ndims, object->dataset.chunk_dims) != ndims)
+		{
+			j_goto_error();
+		}
+
+		H5VL_julea_db_dataset_filter_init(object, dcpl_id);
+	}
+
 	if (!(entry = j_db_entry_new(julea_db_schema_dataset, &error)))
 	{
 		j_goto_error();
@@ -350,39 +731,63 @@ H5VL_julea_db_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, con
 		j_goto_error();
 	}
 
-	if (!j_db_entry_insert(entry, batch, &error))
+	if (object->dataset.chunk_dims != NULL)
 	{
-		j_goto_error();
+		gint ndims;
+
+		ndims = H5Sget_simple_extent_ndims(space_id);
+
+		if (!j_db_entry_set_field(entry, "chunk", object->dataset.chunk_dims, ndims * sizeof(hsize_t), &error))
+		{
+			j_goto_error();
+		}
 	}
 
-	if (!j_batch_execute(batch))
+	if (!j_db_entry_set_field(entry, "filter", &object->dataset.filters, sizeof(object->dataset.filters), &error))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_entry_get_id(entry, &object->backend_id, &object->backend_id_len, &error))
+	if (!j_db_entry_set_field(entry, "filter_level", &object->dataset.filter_level, sizeof(object->dataset.filter_level), &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(object->dataset.distribution = j_distribution_new(J_DISTRIBUTION_ROUND_ROBIN)))
+	if (!j_db_entry_insert(entry, batch, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(hex_buf = H5VL_julea_db_buf_to_hex("dataset", object->backend_id, object->backend_id_len)))
+	if (!j_batch_execute(batch))
 	{
 		j_goto_error();
 	}
 
-	if (!(object->dataset.object = j_distributed_object_new(JULEA_HDF5_DB_NAMESPACE, hex_buf, object->dataset.distribution)))
+	if (!j_db_entry_get_id(entry, &object->backend_id, &object->backend_id_len, &error))
 	{
 		j_goto_error();
 	}
 
-	j_distributed_object_create(object->dataset.object, batch);
-
+	// The objects of chunked datasets are created when their chunks are written for the first time
+	if (object->dataset.chunk_dims == NULL)
 	{
+		if (!(object->dataset.distribution = j_distribution_new(J_DISTRIBUTION_ROUND_ROBIN)))
+		{
+			j_goto_error();
+		}
+
+		if (!(hex_buf = H5VL_julea_db_buf_to_hex("dataset", object->backend_id, object->backend_id_len)))
+		{
+			j_goto_error();
+		}
+
+		if (!(object->dataset.object = j_distributed_object_new(JULEA_HDF5_DB_NAMESPACE, hex_buf, object->dataset.distribution)))
+		{
+			j_goto_error();
+		}
+
+		j_distributed_object_create(object->dataset.object, batch);
+
 		if (!j_batch_execute(batch))
 		{
 			j_goto_error();
@@ -394,7 +799,7 @@ H5VL_julea_db_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, con
 		j_goto_error();
 	}
 
-	j_hdf5_log(file->file.name, "a", 'C', NULL, object, parent);
+	H5VL_julea_db_log('C', object, parent, 0);
 	return object;
 
 _error:
@@ -411,11 +816,11 @@ H5VL_julea_db_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const
 
 	g_autoptr(GError) error = NULL;
 	g_autoptr(JBatch) batch = NULL;
-	g_autoptr(JDBIterator) iterator = NULL;
-	g_autoptr(JDBSelector) selector = NULL;
+	g_autoptr(GHashTable) row = NULL;
 	g_autofree char* hex_buf = NULL;
 	g_autofree void* space_id_buf = NULL;
 	g_autofree void* datatype_id_buf = NULL;
+	g_autofree void* chunk_buf = NULL;
 	JHDF5Object_t* object = NULL;
 	JHDF5Object_t* parent = obj;
 	JHDF5Object_t* file;
@@ -423,8 +828,11 @@ H5VL_julea_db_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const
 	guint64 len;
 	guint64 space_id_buf_len;
 	guint64 datatype_id_buf_len;
+	guint64 chunk_buf_len;
 	guint64* tmp_ptr_i;
 	gdouble* tmp_ptr_f;
+	guint32* tmp_ptr_u32;
+	gint32* tmp_ptr_s32;
 
 	(void)loc_params;
 	(void)dapl_id;
@@ -481,27 +889,12 @@ H5VL_julea_db_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const
 		j_goto_error();
 	}
 
-	if (!(selector = j_db_selector_new(julea_db_schema_dataset, J_DB_SELECTOR_MODE_AND, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
-	{
-		j_goto_error();
-	}
-
-	if (!(iterator = j_db_iterator_new(julea_db_schema_dataset, selector, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_iterator_next(iterator, &error))
+	if (!(row = H5VL_julea_db_metadata_get_row(file, J_HDF5_OBJECT_TYPE_DATASET, object->backend_id, object->backend_id_len, &error)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "min_value_i", &type, (gpointer*)&tmp_ptr_i, &len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "min_value_i", &type, (gpointer*)&tmp_ptr_i, &len, &error))
 	{
 		j_goto_error();
 	}
@@ -509,7 +902,7 @@ H5VL_julea_db_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const
 	object->dataset.statistics.min_value_i = *tmp_ptr_i;
 	g_free(tmp_ptr_i);
 
-	if (!j_db_iterator_get_field(iterator, "max_value_i", &type, (gpointer*)&tmp_ptr_i, &len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "max_value_i", &type, (gpointer*)&tmp_ptr_i, &len, &error))
 	{
 		j_goto_error();
 	}
@@ -517,7 +910,7 @@ H5VL_julea_db_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const
 	object->dataset.statistics.max_value_i = *tmp_ptr_i;
 	g_free(tmp_ptr_i);
 
-	if (!j_db_iterator_get_field(iterator, "min_value_f", &type, (gpointer*)&tmp_ptr_f, &len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "min_value_f", &type, (gpointer*)&tmp_ptr_f, &len, &error))
 	{
 		j_goto_error();
 	}
@@ -525,7 +918,7 @@ H5VL_julea_db_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const
 	object->dataset.statistics.min_value_f = *tmp_ptr_f;
 	g_free(tmp_ptr_f);
 
-	if (!j_db_iterator_get_field(iterator, "max_value_f", &type, (gpointer*)&tmp_ptr_f, &len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "max_value_f", &type, (gpointer*)&tmp_ptr_f, &len, &error))
 	{
 		j_goto_error();
 	}
@@ -533,44 +926,76 @@ H5VL_julea_db_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const
 	object->dataset.statistics.max_value_f = *tmp_ptr_f;
 	g_free(tmp_ptr_f);
 
-	if (!j_db_iterator_get_field(iterator, "space", &type, &space_id_buf, &space_id_buf_len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "space", &type, &space_id_buf, &space_id_buf_len, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(object->dataset.space = H5VL_julea_db_space_decode(space_id_buf, space_id_buf_len)))
+	if (!(object->dataset.space = H5VL_julea_db_space_decode(file, space_id_buf, space_id_buf_len)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "datatype", &type, &datatype_id_buf, &datatype_id_buf_len, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "datatype", &type, &datatype_id_buf, &datatype_id_buf_len, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(object->dataset.datatype = H5VL_julea_db_datatype_decode(datatype_id_buf, datatype_id_buf_len)))
+	if (!(object->dataset.datatype = H5VL_julea_db_datatype_decode(file, datatype_id_buf, datatype_id_buf_len)))
 	{
 		j_goto_error();
 	}
 
-	g_assert(!j_db_iterator_next(iterator, NULL));
-
-	if (!(object->dataset.distribution = j_distribution_new(J_DISTRIBUTION_ROUND_ROBIN)))
+	if (!H5VL_julea_db_metadata_get_field(row, "chunk", &type, &chunk_buf, &chunk_buf_len, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(hex_buf = H5VL_julea_db_buf_to_hex("dataset", object->backend_id, object->backend_id_len)))
+	if (!H5VL_julea_db_metadata_get_field(row, "filter", &type, (gpointer*)&tmp_ptr_u32, &len, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!(object->dataset.object = j_distributed_object_new(JULEA_HDF5_DB_NAMESPACE, hex_buf, object->dataset.distribution)))
+	object->dataset.filters = *tmp_ptr_u32;
+	g_free(tmp_ptr_u32);
+
+	if (!H5VL_julea_db_metadata_get_field(row, "filter_level", &type, (gpointer*)&tmp_ptr_s32, &len, &error))
 	{
 		j_goto_error();
 	}
 
-	j_hdf5_log(file->file.name, "a", 'O', NULL, object, NULL);
+	object->dataset.filter_level = *tmp_ptr_s32;
+	g_free(tmp_ptr_s32);
+
+	if (chunk_buf_len > 0)
+	{
+		object->dataset.chunk_dims = g_steal_pointer(&chunk_buf);
+		object->dataset.chunks = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_free);
+
+		if (!H5VL_julea_db_dataset_chunk_load(object, &error))
+		{
+			j_goto_error();
+		}
+	}
+	else
+	{
+		if (!(object->dataset.distribution = j_distribution_new(J_DISTRIBUTION_ROUND_ROBIN)))
+		{
+			j_goto_error();
+		}
+
+		if (!(hex_buf = H5VL_julea_db_buf_to_hex("dataset", object->backend_id, object->backend_id_len)))
+		{
+			j_goto_error();
+		}
+
+		if (!(object->dataset.object = j_distributed_object_new(JULEA_HDF5_DB_NAMESPACE, hex_buf, object->dataset.distribution)))
+		{
+			j_goto_error();
+		}
+	}
+
+	H5VL_julea_db_log('O', object, NULL, 0);
 	return object;
 
 _error:
@@ -601,9 +1026,13 @@ H5VL_julea_db_space_hdf5_to_range(hid_t mem_space_id, hid_t stored_space_id)
 	gint stored_ndims;
 	guint i;
 	H5S_sel_type sel_type;
-	stored_ndims = H5Sget_simple_extent_ndims(stored_space_id);
+	hid_t extent_space_id;
+
+	// Selections are linearized using the extent of their own dataspace, which might differ from the stored one for memory
+	extent_space_id = (mem_space_id == H5S_ALL) ? stored_space_id : mem_space_id;
+	stored_ndims = H5Sget_simple_extent_ndims(extent_space_id);
 	stored_dims = g_new(hsize_t, stored_ndims);
-	H5Sget_simple_extent_dims(stored_space_id, stored_dims, NULL);
+	H5Sget_simple_extent_dims(extent_space_id, stored_dims, NULL);
 	range_arr = g_array_new(FALSE, FALSE, sizeof(JHDF5IndexRange));
 	// FIXME G_DEBUG_HERE();
 
@@ -823,220 +1252,1514 @@ _error:
 	return NULL;
 }
 
-#define calculate_statistics_helper(_buf, _target_extension) \
-	do \
+/**
+ * Describes a regular hyperslab selection as a strided byte selection for j_distributed_object_read_strided() and j_distributed_object_write_strided().
+ * count and stride have to hold twice as many elements as the space has dimensions.
+ * Returns FALSE if the selection can not be described this way.
+ **/
+static gboolean
+H5VL_julea_db_space_hdf5_to_strided(hid_t file_space_id, hid_t stored_space_id, gsize data_size, guint64* length, guint64* offset, guint32* dimensions, guint64* count, guint64* stride)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree hsize_t* stored_dims = NULL;
+	g_autofree hsize_t* hyperslab_start = NULL;
+	g_autofree hsize_t* hyperslab_stride = NULL;
+	g_autofree hsize_t* hyperslab_count = NULL;
+	g_autofree hsize_t* hyperslab_block = NULL;
+	guint64 row_size;
+	guint32 levels;
+	gint stored_ndims;
+
+	if (file_space_id == H5S_ALL || H5Sget_select_type(file_space_id) != H5S_SEL_HYPERSLABS || H5Sis_regular_hyperslab(file_space_id) <= 0)
+	{
+		return FALSE;
+	}
+
+	if ((stored_ndims = H5Sget_simple_extent_ndims(stored_space_id)) <= 0)
+	{
+		return FALSE;
+	}
+
+	stored_dims = g_new(hsize_t, stored_ndims);
+	hyperslab_start = g_new(hsize_t, stored_ndims);
+	hyperslab_stride = g_new(hsize_t, stored_ndims);
+	hyperslab_count = g_new(hsize_t, stored_ndims);
+	hyperslab_block = g_new(hsize_t, stored_ndims);
+
+	H5Sget_simple_extent_dims(stored_space_id, stored_dims, NULL);
+
+	if (H5Sget_regular_hyperslab(file_space_id, hyperslab_start, hyperslab_stride, hyperslab_count, hyperslab_block) < 0)
+	{
+		return FALSE;
+	}
+
+	*offset = 0;
+	levels = 0;
+	row_size = data_size;
+
+	// Every dimension contributes a level for its blocks and one for the elements within a block, outermost first
+	for (gint i = stored_ndims - 1; i >= 0; i--)
+	{
+		*offset += hyperslab_start[i] * row_size;
+
+		count[2 * i] = hyperslab_count[i];
+		stride[2 * i] = hyperslab_stride[i] * row_size;
+		count[2 * i + 1] = hyperslab_block[i];
+		stride[2 * i + 1] = row_size;
+
+		row_size *= stored_dims[i];
+	}
+
+	for (gint i = 0; i < 2 * stored_ndims; i++)
+	{
+		if (count[i] == 0)
+		{
+			return FALSE;
+		}
+
+		// Levels with a single element do not contribute anything
+		if (count[i] == 1)
+		{
+			continue;
+		}
+
+		// Merge levels that describe one regular sequence, for example, consecutive rows
+		if (levels > 0 && stride[levels - 1] == count[i] * stride[i])
+		{
+			count[levels - 1] *= count[i];
+			stride[levels - 1] = stride[i];
+			continue;
+		}
+
+		count[levels] = count[i];
+		stride[levels] = stride[i];
+		levels++;
+	}
+
+	*length = data_size;
+
+	// Innermost levels whose elements are adjacent form the contiguous blocks
+	while (levels > 0 && stride[levels - 1] == *length)
+	{
+		*length *= count[levels - 1];
+		levels--;
+	}
+
+	*dimensions = levels;
+
+	return TRUE;
+}
+
+// Kernels are built for AVX2 and the baseline instruction set, the best one is chosen at runtime
+#ifdef HAVE_TARGET_CLONES
+#define J_STATISTICS_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define J_STATISTICS_TARGET_CLONES
+#endif
+
+// Number of independent minima and maxima, this allows the compiler to vectorize the kernels
+#define J_STATISTICS_LANES 32
+
+/**
+ * Defines a kernel that updates statistics with n elements of the given type.
+ * Minima and maxima are determined in the element type and only widened once at the end.
+ * NaNs are ignored because they never compare less or greater than any value.
+ **/
+#define calculate_statistics_kernel(_name, _type, _type_min, _type_max, _target_type, _target_extension, _widen) \
+	static J_STATISTICS_TARGET_CLONES void \
+	_name(JHDF5Statistics* statistics, _type const* restrict buf, guint64 n) \
 	{ \
-		for (i = 0; i < n; i++) \
+		_type min[J_STATISTICS_LANES]; \
+		_type max[J_STATISTICS_LANES]; \
+		_target_type min_value; \
+		_target_type max_value; \
+		guint64 i = 0; \
+\
+		for (guint l = 0; l < J_STATISTICS_LANES; l++) \
+		{ \
+			min[l] = _type_max; \
+			max[l] = _type_min; \
+		} \
+\
+		for (; i + J_STATISTICS_LANES <= n; i += J_STATISTICS_LANES) \
+		{ \
+			for (guint l = 0; l < J_STATISTICS_LANES; l++) \
+			{ \
+				min[l] = (buf[i + l] < min[l]) ? buf[i + l] : min[l]; \
+				max[l] = (buf[i + l] > max[l]) ? buf[i + l] : max[l]; \
+			} \
+		} \
+\
+		for (; i < n; i++) \
+		{ \
+			min[0] = (buf[i] < min[0]) ? buf[i] : min[0]; \
+			max[0] = (buf[i] > max[0]) ? buf[i] : max[0]; \
+		} \
+\
+		for (guint l = 1; l < J_STATISTICS_LANES; l++) \
 		{ \
-			if (_buf < object->dataset.statistics.min_value##_target_extension) \
-				object->dataset.statistics.min_value##_target_extension = _buf; \
-			if (_buf > object->dataset.statistics.max_value##_target_extension) \
-				object->dataset.statistics.max_value##_target_extension = _buf; \
+			min[0] = (min[l] < min[0]) ? min[l] : min[0]; \
+			max[0] = (max[l] > max[0]) ? max[l] : max[0]; \
 		} \
-	} while (0)
+\
+		min_value = _widen(min[0]); \
+		max_value = _widen(max[0]); \
+\
+		if (min_value < statistics->min_value##_target_extension) \
+		{ \
+			statistics->min_value##_target_extension = min_value; \
+		} \
+\
+		if (max_value > statistics->max_value##_target_extension) \
+		{ \
+			statistics->max_value##_target_extension = max_value; \
+		} \
+	}
+
+#define calculate_statistics_widen_f(_value) ((gdouble)(_value))
+#define calculate_statistics_widen_i(_value) ((gint64)(_value))
+// Values that do not fit into gint64 are clamped
+#define calculate_statistics_widen_u64(_value) ((gint64)MIN((_value), (guint64)G_MAXINT64))
 
+calculate_statistics_kernel(calculate_statistics_float, gfloat, -INFINITY, INFINITY, gdouble, _f, calculate_statistics_widen_f)
+calculate_statistics_kernel(calculate_statistics_double, gdouble, -INFINITY, INFINITY, gdouble, _f, calculate_statistics_widen_f)
+calculate_statistics_kernel(calculate_statistics_int8, gint8, G_MININT8, G_MAXINT8, gint64, _i, calculate_statistics_widen_i)
+calculate_statistics_kernel(calculate_statistics_int16, gint16, G_MININT16, G_MAXINT16, gint64, _i, calculate_statistics_widen_i)
+calculate_statistics_kernel(calculate_statistics_int32, gint32, G_MININT32, G_MAXINT32, gint64, _i, calculate_statistics_widen_i)
+calculate_statistics_kernel(calculate_statistics_int64, gint64, G_MININT64, G_MAXINT64, gint64, _i, calculate_statistics_widen_i)
+calculate_statistics_kernel(calculate_statistics_uint8, guint8, 0, G_MAXUINT8, gint64, _i, calculate_statistics_widen_i)
+calculate_statistics_kernel(calculate_statistics_uint16, guint16, 0, G_MAXUINT16, gint64, _i, calculate_statistics_widen_i)
+calculate_statistics_kernel(calculate_statistics_uint32, guint32, 0, G_MAXUINT32, gint64, _i, calculate_statistics_widen_i)
+calculate_statistics_kernel(calculate_statistics_uint64, guint64, 0, G_MAXUINT64, gint64, _i, calculate_statistics_widen_u64)
+
+/**
+ * Updates statistics with n elements of buf.
+ * This does not call into HDF5 and can therefore be used from background operations.
+ **/
 static void
-calculate_statistics(JHDF5Object_t* object, const void* buf, gsize bytes, hid_t memory_type)
+calculate_statistics_type(JHDF5Statistics* statistics, const void* buf, guint64 n, H5T_class_t type_class, H5T_sign_t type_sign, gsize element_size)
 {
-	guint i;
-	guint n;
-	guint element_size = H5Tget_size(memory_type);
-	n = bytes / element_size;
+	if (n == 0)
+	{
+		return;
+	}
 
-	if (H5Tget_class(memory_type) == H5T_FLOAT)
+	if (type_class == H5T_FLOAT)
 	{
 		if (element_size == 4)
 		{
-			calculate_statistics_helper(((gdouble)((const gfloat*)buf)[i]), _f);
+			calculate_statistics_float(statistics, buf, n);
 		}
 		else if (element_size == 8)
 		{
-			calculate_statistics_helper(((const gdouble*)buf)[i], _f);
+			calculate_statistics_double(statistics, buf, n);
 		}
 	}
-	else if (H5Tget_class(memory_type) == H5T_INTEGER)
+	else if (type_class == H5T_INTEGER)
 	{
-		if (H5Tget_sign(memory_type) == H5T_SGN_NONE)
+		if (type_sign == H5T_SGN_NONE)
 		{
 			if (element_size == 1)
 			{
-				calculate_statistics_helper(((gint8)((const guint8*)buf)[i]), _i);
+				calculate_statistics_uint8(statistics, buf, n);
 			}
 			else if (element_size == 2)
 			{
-				calculate_statistics_helper(((gint16)((const guint16*)buf)[i]), _i);
+				calculate_statistics_uint16(statistics, buf, n);
 			}
 			else if (element_size == 4)
 			{
-				calculate_statistics_helper(((gint32)((const guint32*)buf)[i]), _i);
+				calculate_statistics_uint32(statistics, buf, n);
 			}
 			else if (element_size == 8)
 			{
-				calculate_statistics_helper(((gint64)((const guint64*)buf)[i]), _i);
+				calculate_statistics_uint64(statistics, buf, n);
 			}
 		}
 		else
 		{
 			if (element_size == 1)
 			{
-				calculate_statistics_helper(((const gint8*)buf)[i], _i);
+				calculate_statistics_int8(statistics, buf, n);
 			}
 			else if (element_size == 2)
 			{
-				calculate_statistics_helper(((const gint16*)buf)[i], _i);
+				calculate_statistics_int16(statistics, buf, n);
 			}
 			else if (element_size == 4)
 			{
-				calculate_statistics_helper(((const gint32*)buf)[i], _i);
+				calculate_statistics_int32(statistics, buf, n);
 			}
 			else if (element_size == 8)
 			{
-				calculate_statistics_helper(((const gint64*)buf)[i], _i);
+				calculate_statistics_int64(statistics, buf, n);
 			}
 		}
 	}
 }
 
-static herr_t
-H5VL_julea_db_dataset_write(void* obj, hid_t mem_type_id, hid_t mem_space_id, hid_t file_space_id, hid_t xfer_plist_id, const void* buf, void** req)
+static void
+calculate_statistics(JHDF5Object_t* object, const void* buf, gsize bytes, hid_t memory_type)
 {
-	J_TRACE_FUNCTION(NULL);
-
-	g_autofree void* local_buf_org = NULL;
-	g_autoptr(JBatch) batch = NULL;
-	g_autoptr(GArray) mem_space_arr = NULL;
-	g_autoptr(GArray) file_space_arr = NULL;
-	const void* local_buf;
-	guint64 bytes_written;
-	gsize data_size;
-	gsize data_count;
-	JHDF5Object_t* object = obj;
-	guint mem_space_idx;
-	guint file_space_idx;
-	JHDF5IndexRange* mem_space_range = NULL;
-	JHDF5IndexRange* file_space_range = NULL;
-	guint64 current_count1;
-	guint64 current_count2;
-	guint i;
-
-	(void)xfer_plist_id;
-	(void)req;
+	guint element_size = H5Tget_size(memory_type);
 
-	g_return_val_if_fail(buf != NULL, 1);
-	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+	object->dataset.statistics_changed = TRUE;
+	calculate_statistics_type(&object->dataset.statistics, buf, bytes / element_size, H5Tget_class(memory_type), H5Tget_sign(memory_type), element_size);
+}
 
-	data_size = object->dataset.datatype->datatype.type_total_size;
+/**
+ * Initializes statistics so that any value updates them.
+ **/
+static void
+calculate_statistics_init(JHDF5Statistics* statistics)
+{
+	statistics->min_value_i = G_MAXINT64;
+	statistics->max_value_i = G_MININT64;
+	statistics->min_value_f = G_MAXDOUBLE;
+	statistics->max_value_f = -G_MAXDOUBLE;
+}
 
-	if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
-	{
-		j_goto_error();
-	}
+struct JHDF5Sequence
+{
+	guint64 offset;
+	guint64 length;
+};
 
-	if (!(mem_space_arr = H5VL_julea_db_space_hdf5_to_range(mem_space_id, object->dataset.space->space.hdf5_id)))
-	{
-		j_goto_error();
-	}
+typedef struct JHDF5Sequence JHDF5Sequence;
 
-	if (!(file_space_arr = H5VL_julea_db_space_hdf5_to_range(file_space_id, object->dataset.space->space.hdf5_id)))
-	{
-		j_goto_error();
-	}
+struct JHDF5ChunkLayout
+{
+	gint ndims;
+	hsize_t* dims;
+	hsize_t* chunk_dims;
+	// The number of chunks in each dimension
+	hsize_t* chunk_counts;
+	// The number of elements per chunk
+	guint64 chunk_size;
+	// The size of an unfiltered chunk in bytes
+	guint64 chunk_bytes;
+	gsize type_size;
+	// The stored datatype's properties, HDF5 must not be called from background operations
+	H5T_class_t type_class;
+	H5T_sign_t type_sign;
+	guint32 filters;
+	gint32 filter_level;
+	hsize_t* coords;
+};
 
-	data_count = 0;
+typedef struct JHDF5ChunkLayout JHDF5ChunkLayout;
 
-	for (i = 0; i < mem_space_arr->len; i++)
-	{
-		mem_space_range = &g_array_index(mem_space_arr, JHDF5IndexRange, i);
-		data_count += mem_space_range->stop - mem_space_range->start;
-	}
+/**
+ * A run of consecutive elements that lies within a single row of a chunk.
+ * All offsets are counted in elements.
+ **/
+struct JHDF5ChunkSegment
+{
+	guint64 chunk;
+	guint64 chunk_offset;
+	guint64 mem_offset;
+	guint64 length;
+};
 
-	local_buf_org = g_new(char, data_size* data_count);
+typedef struct JHDF5ChunkSegment JHDF5ChunkSegment;
 
-	local_buf = H5VL_julea_db_datatype_convert_type(mem_type_id, object->dataset.datatype->datatype.hdf5_id, buf, local_buf_org, data_count);
-	mem_space_idx = 0;
-	file_space_idx = 0;
+struct JHDF5Chunk
+{
+	guint64 index;
+	JObject* object;
+	JBatch* batch;
+	JBackgroundOperation* operation;
+	JHDF5ChunkLayout const* layout;
+	// The chunk's elements
+	gchar* buf;
+	// The chunk as it is stored, data equals buf if no filters have been applied
+	gchar* data;
+	guint64 size;
+	JHDF5Statistics statistics;
+	// The number of elements covered by the current operation
+	guint64 covered;
+	guint64 bytes;
+	gboolean exists;
+};
 
-	while ((mem_space_idx < mem_space_arr->len) && (file_space_idx < file_space_arr->len))
-	{
-		if (mem_space_range == NULL)
-		{
-			mem_space_range = &g_array_index(mem_space_arr, JHDF5IndexRange, mem_space_idx++);
-		}
+typedef struct JHDF5Chunk JHDF5Chunk;
 
-		if (file_space_range == NULL)
-		{
-			file_space_range = &g_array_index(file_space_arr, JHDF5IndexRange, file_space_idx++);
-		}
+static void
+H5VL_julea_db_dataset_chunk_layout_init(JHDF5Object_t* object, JHDF5ChunkLayout* layout)
+{
+	J_TRACE_FUNCTION(NULL);
 
-		current_count1 = mem_space_range->stop - mem_space_range->start;
-		current_count2 = file_space_range->stop - file_space_range->start;
-		current_count1 = current_count1 < current_count2 ? current_count1 : current_count2;
-		calculate_statistics(object, ((const char*)local_buf) + mem_space_range->start * data_size, data_size * current_count1, mem_type_id);
-		j_distributed_object_write(object->dataset.object, ((const char*)local_buf) + mem_space_range->start * data_size, data_size * current_count1, file_space_range->start * data_size, &bytes_written, batch);
+	hid_t space_id = object->dataset.space->space.hdf5_id;
 
-		if (mem_space_range->start + current_count1 == mem_space_range->stop)
-		{
-			mem_space_range = NULL;
-		}
+	layout->ndims = H5Sget_simple_extent_ndims(space_id);
+	layout->dims = g_new(hsize_t, layout->ndims);
+	layout->chunk_dims = object->dataset.chunk_dims;
+	layout->chunk_counts = g_new(hsize_t, layout->ndims);
+	layout->chunk_size = 1;
+	layout->type_size = object->dataset.datatype->datatype.type_total_size;
+	layout->type_class = H5Tget_class(object->dataset.datatype->datatype.hdf5_id);
+	layout->type_sign = (layout->type_class == H5T_INTEGER) ? H5Tget_sign(object->dataset.datatype->datatype.hdf5_id) : H5T_SGN_ERROR;
+	layout->filters = object->dataset.filters;
+	layout->filter_level = object->dataset.filter_level;
+	layout->coords = g_new(hsize_t, layout->ndims);
 
-		if (file_space_range->start + current_count1 == file_space_range->stop)
-		{
-			file_space_range = NULL;
-		}
-	}
+	H5Sget_simple_extent_dims(space_id, layout->dims, NULL);
 
-	if (!j_batch_execute(batch))
+	for (gint d = 0; d < layout->ndims; d++)
 	{
-		j_goto_error();
+		layout->chunk_counts[d] = (layout->dims[d] + layout->chunk_dims[d] - 1) / layout->chunk_dims[d];
+		layout->chunk_size *= layout->chunk_dims[d];
 	}
 
-	j_hdf5_log(object->dataset.file->file.name, "a", 'W', NULL, object, NULL);
-	return 0;
-
-_error:
-	return 1;
+	layout->chunk_bytes = layout->chunk_size * layout->type_size;
 }
 
-static herr_t
-H5VL_julea_db_dataset_read(void* obj, hid_t mem_type_id, hid_t mem_space_id, hid_t file_space_id, hid_t xfer_plist_id, void* buf, void** req)
+static void
+H5VL_julea_db_dataset_chunk_layout_clear(JHDF5ChunkLayout* layout)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	g_autofree void* local_buf_org = NULL;
-	g_autoptr(JBatch) batch = NULL;
-	g_autoptr(GArray) mem_space_arr = NULL;
-	g_autoptr(GArray) file_space_arr = NULL;
-	const void* local_buf;
-	guint64 bytes_read;
-	gsize data_size;
-	gsize data_count;
-	JHDF5Object_t* object = obj;
-	guint mem_space_idx;
-	guint file_space_idx;
-	JHDF5IndexRange* mem_space_range = NULL;
-	JHDF5IndexRange* file_space_range = NULL;
-	guint64 current_count1;
-	guint64 current_count2;
-	guint i;
+	g_free(layout->dims);
+	g_free(layout->chunk_counts);
+	g_free(layout->coords);
+}
 
-	(void)xfer_plist_id;
-	(void)req;
+/**
+ * Returns the selected elements of a dataspace as sequences of consecutive elements in selection order.
+ **/
+static GArray*
+H5VL_julea_db_dataset_chunk_sequences(hid_t space_id)
+{
+	J_TRACE_FUNCTION(NULL);
 
-	g_return_val_if_fail(buf != NULL, 1);
-	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+	GArray* sequences;
+	hid_t iter_id;
+	hsize_t offsets[64];
+	size_t lengths[64];
+	size_t nseq;
+	size_t nelem;
 
-	data_size = object->dataset.datatype->datatype.type_total_size;
+	sequences = g_array_new(FALSE, FALSE, sizeof(JHDF5Sequence));
 
-	if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
+	// With an element size of 1, offsets and lengths are counted in elements
+	if ((iter_id = H5Ssel_iter_create(space_id, 1, 0)) < 0)
 	{
 		j_goto_error();
 	}
 
-	if (!(mem_space_arr = H5VL_julea_db_space_hdf5_to_range(mem_space_id, object->dataset.space->space.hdf5_id)))
+	do
 	{
-		j_goto_error();
-	}
-
+		if (H5Ssel_iter_get_seq_list(iter_id, G_N_ELEMENTS(offsets), SIZE_MAX, &nseq, &nelem, offsets, lengths) < 0)
+		{
+			H5Ssel_iter_close(iter_id);
+			j_goto_error();
+		}
+
+		for (guint i = 0; i < nseq; i++)
+		{
+			JHDF5Sequence sequence = { offsets[i], lengths[i] };
+
+			g_array_append_val(sequences, sequence);
+		}
+	} while (nseq > 0);
+
+	H5Ssel_iter_close(iter_id);
+
+	return sequences;
+
+_error:
+	g_array_free(sequences, TRUE);
+
+	return NULL;
+}
+
+/**
+ * Splits a run of consecutive elements of the dataset into segments that do not cross the rows of chunks.
+ **/
+static void
+H5VL_julea_db_dataset_chunk_map(JHDF5ChunkLayout* layout, guint64 file_offset, guint64 mem_offset, guint64 length, GArray* segments)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gint last = layout->ndims - 1;
+
+	while (length > 0)
+	{
+		JHDF5ChunkSegment segment;
+		guint64 rest = file_offset;
+
+		for (gint d = last; d >= 0; d--)
+		{
+			layout->coords[d] = rest % layout->dims[d];
+			rest /= layout->dims[d];
+		}
+
+		segment.chunk = 0;
+		segment.chunk_offset = 0;
+		segment.mem_offset = mem_offset;
+
+		for (gint d = 0; d <= last; d++)
+		{
+			segment.chunk = segment.chunk * layout->chunk_counts[d] + layout->coords[d] / layout->chunk_dims[d];
+			segment.chunk_offset = segment.chunk_offset * layout->chunk_dims[d] + layout->coords[d] % layout->chunk_dims[d];
+		}
+
+		// A segment ends with the dataset's row or the chunk's row, whichever comes first
+		segment.length = MIN(length, layout->dims[last] - layout->coords[last]);
+		segment.length = MIN(segment.length, layout->chunk_dims[last] - layout->coords[last] % layout->chunk_dims[last]);
+
+		g_array_append_val(segments, segment);
+
+		file_offset += segment.length;
+		mem_offset += segment.length;
+		length -= segment.length;
+	}
+}
+
+/**
+ * Maps the elements selected in memory to the chunks of the dataset.
+ * H5S_ALL selects the elements of the file selection in memory and all elements of the dataset in the file.
+ * mem_count returns the number of elements of the memory buffer.
+ **/
+static GArray*
+H5VL_julea_db_dataset_chunk_segments(JHDF5Object_t* object, JHDF5ChunkLayout* layout, hid_t mem_space_id, hid_t file_space_id, guint64* mem_count)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GArray) mem_sequences = NULL;
+	g_autoptr(GArray) file_sequences = NULL;
+	GArray* segments;
+	guint64 mem_done = 0;
+	guint64 file_done = 0;
+	guint i = 0;
+	guint j = 0;
+
+	if (file_space_id == H5S_ALL)
+	{
+		file_space_id = object->dataset.space->space.hdf5_id;
+	}
+
+	if (mem_space_id == H5S_ALL)
+	{
+		mem_space_id = file_space_id;
+	}
+
+	if (!(mem_sequences = H5VL_julea_db_dataset_chunk_sequences(mem_space_id)))
+	{
+		return NULL;
+	}
+
+	if (!(file_sequences = H5VL_julea_db_dataset_chunk_sequences(file_space_id)))
+	{
+		return NULL;
+	}
+
+	*mem_count = H5Sget_simple_extent_npoints(mem_space_id);
+	segments = g_array_new(FALSE, FALSE, sizeof(JHDF5ChunkSegment));
+
+	while (i < mem_sequences->len && j < file_sequences->len)
+	{
+		JHDF5Sequence* mem_sequence = &g_array_index(mem_sequences, JHDF5Sequence, i);
+		JHDF5Sequence* file_sequence = &g_array_index(file_sequences, JHDF5Sequence, j);
+		guint64 count;
+
+		count = MIN(mem_sequence->length - mem_done, file_sequence->length - file_done);
+		H5VL_julea_db_dataset_chunk_map(layout, file_sequence->offset + file_done, mem_sequence->offset + mem_done, count, segments);
+
+		mem_done += count;
+		file_done += count;
+
+		if (mem_done == mem_sequence->length)
+		{
+			mem_done = 0;
+			i++;
+		}
+
+		if (file_done == file_sequence->length)
+		{
+			file_done = 0;
+			j++;
+		}
+	}
+
+	return segments;
+}
+
+static void
+H5VL_julea_db_dataset_chunk_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Chunk* chunk = data;
+
+	if (chunk->batch != NULL)
+	{
+		j_batch_unref(chunk->batch);
+	}
+
+	if (chunk->data != chunk->buf)
+	{
+		g_free(chunk->data);
+	}
+
+	j_object_unref(chunk->object);
+	g_free(chunk->buf);
+	g_free(chunk);
+}
+
+/**
+ * Returns the chunks touched by segments, indexed by their chunk index.
+ **/
+static GHashTable*
+H5VL_julea_db_dataset_chunk_table(JHDF5Object_t* object, JHDF5ChunkLayout const* layout, GArray* segments)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree char* hex_buf = NULL;
+	GHashTable* chunks;
+
+	hex_buf = H5VL_julea_db_buf_to_hex("dataset", object->backend_id, object->backend_id_len);
+	chunks = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, H5VL_julea_db_dataset_chunk_free);
+
+	for (guint i = 0; i < segments->len; i++)
+	{
+		JHDF5ChunkSegment* segment = &g_array_index(segments, JHDF5ChunkSegment, i);
+		JHDF5Chunk* chunk;
+
+		if ((chunk = g_hash_table_lookup(chunks, &segment->chunk)) == NULL)
+		{
+			g_autofree gchar* name = NULL;
+			JHDF5ChunkInfo* info;
+
+			name = g_strdup_printf("%s_%" G_GUINT64_FORMAT, hex_buf, segment->chunk);
+
+			chunk = g_new0(JHDF5Chunk, 1);
+			chunk->index = segment->chunk;
+			chunk->object = j_object_new(JULEA_HDF5_DB_NAMESPACE, name);
+			chunk->layout = layout;
+
+			if ((info = g_hash_table_lookup(object->dataset.chunks, &chunk->index)) != NULL)
+			{
+				chunk->exists = TRUE;
+				chunk->size = info->size;
+			}
+
+			g_hash_table_insert(chunks, &chunk->index, chunk);
+		}
+
+		chunk->covered += segment->length;
+	}
+
+	return chunks;
+}
+
+static void
+H5VL_julea_db_dataset_chunk_completed(JBatch* batch, gboolean ret, gpointer user_data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gint* failed = user_data;
+
+	(void)batch;
+
+	if (!ret)
+	{
+		g_atomic_int_set(failed, TRUE);
+	}
+}
+
+/**
+ * Executes the batches of all chunks in parallel.
+ **/
+static gboolean
+H5VL_julea_db_dataset_chunk_execute(GHashTable* chunks)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GHashTableIter iter;
+	JHDF5Chunk* chunk;
+	gint failed = FALSE;
+
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		if (chunk->batch != NULL)
+		{
+			j_batch_execute_async(chunk->batch, H5VL_julea_db_dataset_chunk_completed, &failed);
+		}
+	}
+
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		if (chunk->batch != NULL)
+		{
+			j_batch_wait(chunk->batch);
+			g_clear_pointer(&chunk->batch, j_batch_unref);
+		}
+	}
+
+	return !g_atomic_int_get(&failed);
+}
+
+/**
+ * Groups the bytes of all elements by their significance, which usually makes data more compressible.
+ **/
+static void
+H5VL_julea_db_dataset_chunk_shuffle(gchar* dst, gchar const* src, guint64 count, gsize type_size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (gsize b = 0; b < type_size; b++)
+	{
+		for (guint64 e = 0; e < count; e++)
+		{
+			dst[b * count + e] = src[e * type_size + b];
+		}
+	}
+}
+
+static void
+H5VL_julea_db_dataset_chunk_unshuffle(gchar* dst, gchar const* src, guint64 count, gsize type_size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (gsize b = 0; b < type_size; b++)
+	{
+		for (guint64 e = 0; e < count; e++)
+		{
+			dst[e * type_size + b] = src[b * count + e];
+		}
+	}
+}
+
+/**
+ * Computes a chunk's zone map and applies the dataset's filters to its elements.
+ * Chunks that do not compress are stored unfiltered, which can be recognised by their size being equal to that of an unfiltered chunk.
+ **/
+static gpointer
+H5VL_julea_db_dataset_chunk_encode(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Chunk* chunk = data;
+	JHDF5ChunkLayout const* layout = chunk->layout;
+	g_autofree gchar* shuffled = NULL;
+	gchar* compressed = NULL;
+	gchar const* src = chunk->buf;
+	gsize size = 0;
+
+	// Elements outside of the dataset or not written yet are zero and included in the zone map
+	calculate_statistics_init(&chunk->statistics);
+	calculate_statistics_type(&chunk->statistics, chunk->buf, layout->chunk_size, layout->type_class, layout->type_sign, layout->type_size);
+
+	chunk->data = chunk->buf;
+	chunk->size = layout->chunk_bytes;
+
+	if (layout->filters == 0)
+	{
+		return GINT_TO_POINTER(TRUE);
+	}
+
+	if ((layout->filters & J_HDF5_FILTER_SHUFFLE) && layout->type_size > 1)
+	{
+		shuffled = g_malloc(layout->chunk_bytes);
+		H5VL_julea_db_dataset_chunk_shuffle(shuffled, chunk->buf, layout->chunk_size, layout->type_size);
+		src = shuffled;
+	}
+
+#ifdef HAVE_LZ4
+	if ((layout->filters & J_HDF5_FILTER_LZ4) && layout->chunk_bytes <= LZ4_MAX_INPUT_SIZE)
+	{
+		gint bound;
+
+		bound = LZ4_compressBound(layout->chunk_bytes);
+		compressed = g_malloc(bound);
+		size = LZ4_compress_default(src, compressed, layout->chunk_bytes, bound);
+	}
+#endif
+
+#ifdef HAVE_ZSTD
+	if (layout->filters & J_HDF5_FILTER_ZSTD)
+	{
+		gsize bound;
+
+		bound = ZSTD_compressBound(layout->chunk_bytes);
+		compressed = g_malloc(bound);
+		size = ZSTD_compress(compressed, bound, src, layout->chunk_bytes, layout->filter_level);
+
+		if (ZSTD_isError(size))
+		{
+			size = 0;
+		}
+	}
+#endif
+
+	if (size > 0 && size < layout->chunk_bytes)
+	{
+		chunk->data = compressed;
+		chunk->size = size;
+	}
+	else if (!(layout->filters & H5VL_JULEA_DB_FILTER_COMPRESSION) && src != chunk->buf)
+	{
+		g_free(compressed);
+		chunk->data = g_steal_pointer(&shuffled);
+	}
+	else
+	{
+		g_free(compressed);
+	}
+
+	return GINT_TO_POINTER(TRUE);
+}
+
+/**
+ * Reverses the dataset's filters, restoring a chunk's elements from its stored data.
+ **/
+static gpointer
+H5VL_julea_db_dataset_chunk_decode(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Chunk* chunk = data;
+	JHDF5ChunkLayout const* layout = chunk->layout;
+	g_autofree gchar* decompressed = NULL;
+	gchar const* src = chunk->data;
+
+	if (chunk->data == NULL || chunk->data == chunk->buf)
+	{
+		return GINT_TO_POINTER(TRUE);
+	}
+
+	if (layout->filters & H5VL_JULEA_DB_FILTER_COMPRESSION)
+	{
+		if (chunk->size == layout->chunk_bytes)
+		{
+			// The chunk did not compress and has been stored unfiltered
+			memcpy(chunk->buf, chunk->data, layout->chunk_bytes);
+			g_clear_pointer(&chunk->data, g_free);
+
+			return GINT_TO_POINTER(TRUE);
+		}
+
+		decompressed = g_malloc(layout->chunk_bytes);
+
+		// Datasets might have been written by a client that supports more compression filters
+		if (layout->filters & J_HDF5_FILTER_LZ4)
+		{
+#ifdef HAVE_LZ4
+			if (LZ4_decompress_safe(src, decompressed, chunk->size, layout->chunk_bytes) != (gint)layout->chunk_bytes)
+			{
+				j_goto_error();
+			}
+#else
+			j_goto_error();
+#endif
+		}
+
+		if (layout->filters & J_HDF5_FILTER_ZSTD)
+		{
+#ifdef HAVE_ZSTD
+			if (ZSTD_decompress(decompressed, layout->chunk_bytes, src, chunk->size) != layout->chunk_bytes)
+			{
+				j_goto_error();
+			}
+#else
+			j_goto_error();
+#endif
+		}
+
+		src = decompressed;
+	}
+
+	if ((layout->filters & J_HDF5_FILTER_SHUFFLE) && layout->type_size > 1)
+	{
+		H5VL_julea_db_dataset_chunk_unshuffle(chunk->buf, src, layout->chunk_size, layout->type_size);
+	}
+	else
+	{
+		memcpy(chunk->buf, src, layout->chunk_bytes);
+	}
+
+	g_clear_pointer(&chunk->data, g_free);
+
+	return GINT_TO_POINTER(TRUE);
+
+_error:
+	return GINT_TO_POINTER(FALSE);
+}
+
+/**
+ * Runs func for all chunks.
+ * Multiple chunks are processed in parallel using background operations.
+ **/
+static gboolean
+H5VL_julea_db_dataset_chunk_filter(GHashTable* chunks, JBackgroundOperationFunc func)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GHashTableIter iter;
+	JHDF5Chunk* chunk;
+	gboolean ret = TRUE;
+
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		if (g_hash_table_size(chunks) == 1)
+		{
+			ret = GPOINTER_TO_INT(func(chunk)) && ret;
+		}
+		else
+		{
+			chunk->operation = j_background_operation_new(func, chunk);
+		}
+	}
+
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		if (chunk->operation != NULL)
+		{
+			ret = GPOINTER_TO_INT(j_background_operation_wait(chunk->operation)) && ret;
+			g_clear_pointer(&chunk->operation, j_background_operation_unref);
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * Checks whether a chunk's index entry has to be updated.
+ **/
+static gboolean
+H5VL_julea_db_dataset_chunk_changed(JHDF5ChunkInfo const* info, JHDF5Chunk const* chunk)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return (info->size != chunk->size || memcmp(&info->statistics, &chunk->statistics, sizeof(info->statistics)) != 0);
+}
+
+/**
+ * Writes to a chunked dataset.
+ * Every touched chunk is written as a whole, chunks that are only partially covered by the selection are read first.
+ **/
+static gboolean
+H5VL_julea_db_dataset_chunk_write(JHDF5Object_t* object, hid_t mem_type_id, hid_t mem_space_id, hid_t file_space_id, const void* buf)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(GArray) segments = NULL;
+	g_autoptr(GHashTable) chunks = NULL;
+	g_autoptr(GPtrArray) entries = NULL;
+	g_autoptr(GPtrArray) updates = NULL;
+	g_autoptr(GPtrArray) selectors = NULL;
+	g_autofree void* local_buf_org = NULL;
+	const void* local_buf;
+	JHDF5ChunkLayout layout;
+	GHashTableIter iter;
+	JHDF5Chunk* chunk;
+	gsize data_size;
+	guint64 mem_count;
+
+	H5VL_julea_db_dataset_chunk_layout_init(object, &layout);
+	data_size = layout.type_size;
+
+	if (!(segments = H5VL_julea_db_dataset_chunk_segments(object, &layout, mem_space_id, file_space_id, &mem_count)))
+	{
+		j_goto_error();
+	}
+
+	local_buf_org = g_new(char, data_size * mem_count);
+	local_buf = H5VL_julea_db_datatype_convert_type(mem_type_id, object->dataset.datatype->datatype.hdf5_id, buf, local_buf_org, mem_count);
+
+	chunks = H5VL_julea_db_dataset_chunk_table(object, &layout, segments);
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		chunk->buf = g_malloc0(layout.chunk_bytes);
+
+		if (chunk->exists && chunk->covered < layout.chunk_size)
+		{
+			chunk->data = (layout.filters == 0) ? chunk->buf : g_malloc(chunk->size);
+			chunk->batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+			j_object_read(chunk->object, chunk->data, chunk->size, 0, &chunk->bytes, chunk->batch);
+		}
+	}
+
+	if (!H5VL_julea_db_dataset_chunk_execute(chunks))
+	{
+		j_goto_error();
+	}
+
+	if (layout.filters != 0 && !H5VL_julea_db_dataset_chunk_filter(chunks, H5VL_julea_db_dataset_chunk_decode))
+	{
+		j_goto_error();
+	}
+
+	for (guint i = 0; i < segments->len; i++)
+	{
+		JHDF5ChunkSegment* segment = &g_array_index(segments, JHDF5ChunkSegment, i);
+		const char* data = (const char*)local_buf + segment->mem_offset * data_size;
+
+		chunk = g_hash_table_lookup(chunks, &segment->chunk);
+		memcpy(chunk->buf + segment->chunk_offset * data_size, data, segment->length * data_size);
+		calculate_statistics(object, data, segment->length * data_size, mem_type_id);
+	}
+
+	if (!H5VL_julea_db_dataset_chunk_filter(chunks, H5VL_julea_db_dataset_chunk_encode))
+	{
+		j_goto_error();
+	}
+
+	entries = g_ptr_array_new_with_free_func((GDestroyNotify)j_db_entry_unref);
+	updates = g_ptr_array_new_with_free_func((GDestroyNotify)j_db_entry_unref);
+	selectors = g_ptr_array_new_with_free_func((GDestroyNotify)j_db_selector_unref);
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		chunk->batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+
+		if (!chunk->exists)
+		{
+			JDBEntry* entry;
+
+			j_object_create(chunk->object, chunk->batch);
+
+			if (!(entry = j_db_entry_new(julea_db_schema_chunk, &error)))
+			{
+				j_goto_error();
+			}
+
+			g_ptr_array_add(entries, entry);
+
+			if (!j_db_entry_set_field(entry, "file", object->dataset.file->backend_id, object->dataset.file->backend_id_len, &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "dataset", object->backend_id, object->backend_id_len, &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "index", &chunk->index, sizeof(chunk->index), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "size", &chunk->size, sizeof(chunk->size), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "min_value_i", &chunk->statistics.min_value_i, sizeof(chunk->statistics.min_value_i), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "max_value_i", &chunk->statistics.max_value_i, sizeof(chunk->statistics.max_value_i), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "min_value_f", &chunk->statistics.min_value_f, sizeof(chunk->statistics.min_value_f), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "max_value_f", &chunk->statistics.max_value_f, sizeof(chunk->statistics.max_value_f), &error))
+			{
+				j_goto_error();
+			}
+		}
+		else if (H5VL_julea_db_dataset_chunk_changed(g_hash_table_lookup(object->dataset.chunks, &chunk->index), chunk))
+		{
+			JDBEntry* entry;
+			JDBSelector* selector;
+
+			if (!(entry = j_db_entry_new(julea_db_schema_chunk, &error)))
+			{
+				j_goto_error();
+			}
+
+			g_ptr_array_add(updates, entry);
+
+			if (!j_db_entry_set_field(entry, "size", &chunk->size, sizeof(chunk->size), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "min_value_i", &chunk->statistics.min_value_i, sizeof(chunk->statistics.min_value_i), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "max_value_i", &chunk->statistics.max_value_i, sizeof(chunk->statistics.max_value_i), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "min_value_f", &chunk->statistics.min_value_f, sizeof(chunk->statistics.min_value_f), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_entry_set_field(entry, "max_value_f", &chunk->statistics.max_value_f, sizeof(chunk->statistics.max_value_f), &error))
+			{
+				j_goto_error();
+			}
+
+			if (!(selector = j_db_selector_new(julea_db_schema_chunk, J_DB_SELECTOR_MODE_AND, &error)))
+			{
+				j_goto_error();
+			}
+
+			g_ptr_array_add(selectors, selector);
+
+			if (!j_db_selector_add_field(selector, "dataset", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
+			{
+				j_goto_error();
+			}
+
+			if (!j_db_selector_add_field(selector, "index", J_DB_SELECTOR_OPERATOR_EQ, &chunk->index, sizeof(chunk->index), &error))
+			{
+				j_goto_error();
+			}
+		}
+
+		j_object_write(chunk->object, chunk->data, chunk->size, 0, &chunk->bytes, chunk->batch);
+	}
+
+	if (!H5VL_julea_db_dataset_chunk_execute(chunks))
+	{
+		j_goto_error();
+	}
+
+	// The chunk index is updated once the chunks' data has been written
+	if (entries->len > 0 || updates->len > 0)
+	{
+		if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
+		{
+			j_goto_error();
+		}
+
+		if (entries->len > 0 && !j_db_entry_insert_many((JDBEntry**)entries->pdata, entries->len, batch, &error))
+		{
+			j_goto_error();
+		}
+
+		for (guint i = 0; i < updates->len; i++)
+		{
+			if (!j_db_entry_update(g_ptr_array_index(updates, i), g_ptr_array_index(selectors, i), batch, &error))
+			{
+				j_goto_error();
+			}
+		}
+
+		H5VL_julea_db_metadata_invalidate(object->dataset.file);
+
+		if (!j_batch_execute(batch))
+		{
+			j_goto_error();
+		}
+	}
+
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		guint64* index;
+		JHDF5ChunkInfo* info;
+
+		index = g_new(guint64, 1);
+		*index = chunk->index;
+		info = g_new(JHDF5ChunkInfo, 1);
+		info->size = chunk->size;
+		info->statistics = chunk->statistics;
+		g_hash_table_replace(object->dataset.chunks, index, info);
+	}
+
+	H5VL_julea_db_dataset_chunk_layout_clear(&layout);
+
+	H5VL_julea_db_log('W', object, NULL, data_size * mem_count);
+	return TRUE;
+
+_error:
+	H5VL_julea_db_error_handler(error);
+	H5VL_julea_db_dataset_chunk_layout_clear(&layout);
+
+	return FALSE;
+}
+
+/**
+ * Reads from a chunked dataset.
+ * Every touched chunk is read as a whole, chunks that have not been written yet are filled with zeros.
+ **/
+static gboolean
+H5VL_julea_db_dataset_chunk_read(JHDF5Object_t* object, hid_t mem_type_id, hid_t mem_space_id, hid_t file_space_id, void* buf)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GArray) segments = NULL;
+	g_autoptr(GHashTable) chunks = NULL;
+	g_autofree void* local_buf_org = NULL;
+	const void* local_buf;
+	JHDF5ChunkLayout layout;
+	GHashTableIter iter;
+	JHDF5Chunk* chunk;
+	gsize data_size;
+	guint64 mem_count;
+
+	H5VL_julea_db_dataset_chunk_layout_init(object, &layout);
+	data_size = layout.type_size;
+
+	if (!(segments = H5VL_julea_db_dataset_chunk_segments(object, &layout, mem_space_id, file_space_id, &mem_count)))
+	{
+		j_goto_error();
+	}
+
+	chunks = H5VL_julea_db_dataset_chunk_table(object, &layout, segments);
+	g_hash_table_iter_init(&iter, chunks);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&chunk))
+	{
+		if (chunk->exists)
+		{
+			chunk->buf = g_malloc(layout.chunk_bytes);
+			chunk->data = (layout.filters == 0) ? chunk->buf : g_malloc(chunk->size);
+			chunk->batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+			j_object_read(chunk->object, chunk->data, chunk->size, 0, &chunk->bytes, chunk->batch);
+		}
+	}
+
+	if (!H5VL_julea_db_dataset_chunk_execute(chunks))
+	{
+		j_goto_error();
+	}
+
+	if (layout.filters != 0 && !H5VL_julea_db_dataset_chunk_filter(chunks, H5VL_julea_db_dataset_chunk_decode))
+	{
+		j_goto_error();
+	}
+
+	for (guint i = 0; i < segments->len; i++)
+	{
+		JHDF5ChunkSegment* segment = &g_array_index(segments, JHDF5ChunkSegment, i);
+		char* data = (char*)buf + segment->mem_offset * data_size;
+
+		chunk = g_hash_table_lookup(chunks, &segment->chunk);
+
+		if (chunk->buf != NULL)
+		{
+			memcpy(data, chunk->buf + segment->chunk_offset * data_size, segment->length * data_size);
+		}
+		else
+		{
+			memset(data, 0, segment->length * data_size);
+		}
+	}
+
+	local_buf_org = g_new(char, data_size * mem_count);
+	local_buf = H5VL_julea_db_datatype_convert_type(mem_type_id, object->dataset.datatype->datatype.hdf5_id, buf, local_buf_org, mem_count);
+
+	if (local_buf != buf)
+	{
+		memcpy(buf, local_buf, data_size * mem_count);
+	}
+
+	H5VL_julea_db_dataset_chunk_layout_clear(&layout);
+
+	H5VL_julea_db_log('R', object, NULL, data_size * mem_count);
+	return TRUE;
+
+_error:
+	H5VL_julea_db_dataset_chunk_layout_clear(&layout);
+
+	return FALSE;
+}
+
+/**
+ * The state of a read from or write to a contiguous dataset, which has to be kept until the operation has completed.
+ **/
+struct JHDF5DatasetIO
+{
+	JHDF5Object_t* object;
+	void* buf;
+	gchar* local_buf;
+	gsize data_count;
+	hid_t mem_type_id;
+	guint64 bytes;
+};
+
+typedef struct JHDF5DatasetIO JHDF5DatasetIO;
+
+static JHDF5DatasetIO*
+H5VL_julea_db_dataset_io_new(JHDF5Object_t* object, hid_t mem_type_id, void* buf, gsize data_count)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5DatasetIO* io;
+
+	io = g_new(JHDF5DatasetIO, 1);
+	io->object = H5VL_julea_db_object_ref(object);
+	io->buf = buf;
+	io->local_buf = g_new(char, object->dataset.datatype->datatype.type_total_size * data_count);
+	io->data_count = data_count;
+	// The application may close its datatype before an asynchronous operation has completed
+	io->mem_type_id = H5Tcopy(mem_type_id);
+	io->bytes = 0;
+
+	return io;
+}
+
+static void
+H5VL_julea_db_dataset_io_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5DatasetIO* io = data;
+
+	H5Tclose(io->mem_type_id);
+	H5VL_julea_db_object_unref(io->object);
+	g_free(io->local_buf);
+	g_free(io);
+}
+
+static gboolean
+H5VL_julea_db_dataset_write_complete(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5DatasetIO* io = data;
+
+	H5VL_julea_db_log('W', io->object, NULL, io->bytes);
+
+	return TRUE;
+}
+
+static gboolean
+H5VL_julea_db_dataset_read_complete(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5DatasetIO* io = data;
+	JHDF5Object_t* object = io->object;
+	const void* local_buf;
+
+	local_buf = H5VL_julea_db_datatype_convert_type(io->mem_type_id, object->dataset.datatype->datatype.hdf5_id, io->buf, io->local_buf, io->data_count);
+
+	if (local_buf != io->buf)
+	{
+		memcpy(io->buf, local_buf, object->dataset.datatype->datatype.type_total_size * io->data_count);
+	}
+
+	H5VL_julea_db_log('R', object, NULL, io->bytes);
+
+	return TRUE;
+}
+
+static herr_t
+H5VL_julea_db_dataset_write(void* obj, hid_t mem_type_id, hid_t mem_space_id, hid_t file_space_id, hid_t xfer_plist_id, const void* buf, void** req)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(GArray) mem_space_arr = NULL;
+	g_autoptr(GArray) file_space_arr = NULL;
+	g_autofree guint64* strided_count = NULL;
+	g_autofree guint64* strided_stride = NULL;
+	JHDF5DatasetIO* io = NULL;
+	const void* local_buf;
+	gsize data_size;
+	gsize data_count;
+	JHDF5Object_t* object = obj;
+	guint64 strided_length;
+	guint64 strided_offset;
+	guint32 strided_dimensions;
+	guint mem_space_idx;
+	guint file_space_idx;
+	JHDF5IndexRange* mem_space_range = NULL;
+	JHDF5IndexRange* file_space_range = NULL;
+	guint64 current_count1;
+	guint64 current_count2;
+	guint i;
+
+	(void)xfer_plist_id;
+
+	g_return_val_if_fail(buf != NULL, 1);
+	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+
+	// Chunked datasets already process their chunks in parallel and complete synchronously, leaving req unset tells HDF5 so
+	if (object->dataset.chunk_dims != NULL)
+	{
+		if (!H5VL_julea_db_dataset_chunk_write(object, mem_type_id, mem_space_id, file_space_id, buf))
+		{
+			j_goto_error();
+		}
+
+		return 0;
+	}
+
+	data_size = object->dataset.datatype->datatype.type_total_size;
+
+	if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
+	{
+		j_goto_error();
+	}
+
+	if (!(mem_space_arr = H5VL_julea_db_space_hdf5_to_range(mem_space_id, object->dataset.space->space.hdf5_id)))
+	{
+		j_goto_error();
+	}
+
+	if (!(file_space_arr = H5VL_julea_db_space_hdf5_to_range(file_space_id, object->dataset.space->space.hdf5_id)))
+	{
+		j_goto_error();
+	}
+
+	data_count = 0;
+
+	for (i = 0; i < mem_space_arr->len; i++)
+	{
+		mem_space_range = &g_array_index(mem_space_arr, JHDF5IndexRange, i);
+		data_count += mem_space_range->stop - mem_space_range->start;
+	}
+
+	io = H5VL_julea_db_dataset_io_new(object, mem_type_id, (void*)buf, data_count);
+	local_buf = H5VL_julea_db_datatype_convert_type(mem_type_id, object->dataset.datatype->datatype.hdf5_id, buf, io->local_buf, data_count);
+	mem_space_idx = 0;
+	file_space_idx = 0;
+
+	strided_count = g_new(guint64, 2 * H5Sget_simple_extent_ndims(object->dataset.space->space.hdf5_id));
+	strided_stride = g_new(guint64, 2 * H5Sget_simple_extent_ndims(object->dataset.space->space.hdf5_id));
+
+	// A regular hyperslab written from a contiguous buffer is sent as a single strided operation instead of one operation per range
+	if (mem_space_arr->len == 1 && H5Sget_select_npoints(file_space_id) == (hssize_t)data_count
+	    && H5VL_julea_db_space_hdf5_to_strided(file_space_id, object->dataset.space->space.hdf5_id, data_size, &strided_length, &strided_offset, &strided_dimensions, strided_count, strided_stride))
+	{
+		mem_space_range = &g_array_index(mem_space_arr, JHDF5IndexRange, 0);
+		calculate_statistics(object, ((const char*)local_buf) + mem_space_range->start * data_size, data_size * data_count, mem_type_id);
+		j_distributed_object_write_strided(object->dataset.object, ((const char*)local_buf) + mem_space_range->start * data_size, strided_length, strided_offset, strided_dimensions, strided_count, strided_stride, &io->bytes, batch);
+
+		// Skip the range-based loop below
+		mem_space_idx = mem_space_arr->len;
+	}
+
+	while ((mem_space_idx < mem_space_arr->len) && (file_space_idx < file_space_arr->len))
+	{
+		if (mem_space_range == NULL)
+		{
+			mem_space_range = &g_array_index(mem_space_arr, JHDF5IndexRange, mem_space_idx++);
+		}
+
+		if (file_space_range == NULL)
+		{
+			file_space_range = &g_array_index(file_space_arr, JHDF5IndexRange, file_space_idx++);
+		}
+
+		current_count1 = mem_space_range->stop - mem_space_range->start;
+		current_count2 = file_space_range->stop - file_space_range->start;
+		current_count1 = current_count1 < current_count2 ? current_count1 : current_count2;
+		calculate_statistics(object, ((const char*)local_buf) + mem_space_range->start * data_size, data_size * current_count1, mem_type_id);
+		j_distributed_object_write(object->dataset.object, ((const char*)local_buf) + mem_space_range->start * data_size, data_size * current_count1, file_space_range->start * data_size, &io->bytes, batch);
+
+		if (mem_space_range->start + current_count1 == mem_space_range->stop)
+		{
+			mem_space_range = NULL;
+		}
+
+		if (file_space_range->start + current_count1 == file_space_range->stop)
+		{
+			file_space_range = NULL;
+		}
+	}
+
+	if (req != NULL)
+	{
+		*req = H5VL_julea_request_new(batch, H5VL_julea_db_dataset_write_complete, io, H5VL_julea_db_dataset_io_free);
+		return 0;
+	}
+
+	if (!j_batch_execute(batch))
+	{
+		j_goto_error();
+	}
+
+	H5VL_julea_db_dataset_write_complete(io);
+	H5VL_julea_db_dataset_io_free(io);
+	return 0;
+
+_error:
+	if (io != NULL)
+	{
+		H5VL_julea_db_dataset_io_free(io);
+	}
+
+	return 1;
+}
+
+static herr_t
+H5VL_julea_db_dataset_read(void* obj, hid_t mem_type_id, hid_t mem_space_id, hid_t file_space_id, hid_t xfer_plist_id, void* buf, void** req)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(GArray) mem_space_arr = NULL;
+	g_autoptr(GArray) file_space_arr = NULL;
+	g_autofree guint64* strided_count = NULL;
+	g_autofree guint64* strided_stride = NULL;
+	JHDF5DatasetIO* io = NULL;
+	gsize data_size;
+	gsize data_count;
+	JHDF5Object_t* object = obj;
+	guint64 strided_length;
+	guint64 strided_offset;
+	guint32 strided_dimensions;
+	guint mem_space_idx;
+	guint file_space_idx;
+	JHDF5IndexRange* mem_space_range = NULL;
+	JHDF5IndexRange* file_space_range = NULL;
+	guint64 current_count1;
+	guint64 current_count2;
+	guint i;
+
+	(void)xfer_plist_id;
+
+	g_return_val_if_fail(buf != NULL, 1);
+	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+
+	// Chunked datasets already process their chunks in parallel and complete synchronously, leaving req unset tells HDF5 so
+	if (object->dataset.chunk_dims != NULL)
+	{
+		if (!H5VL_julea_db_dataset_chunk_read(object, mem_type_id, mem_space_id, file_space_id, buf))
+		{
+			j_goto_error();
+		}
+
+		return 0;
+	}
+
+	data_size = object->dataset.datatype->datatype.type_total_size;
+
+	if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
+	{
+		j_goto_error();
+	}
+
+	if (!(mem_space_arr = H5VL_julea_db_space_hdf5_to_range(mem_space_id, object->dataset.space->space.hdf5_id)))
+	{
+		j_goto_error();
+	}
+
 	if (!(file_space_arr = H5VL_julea_db_space_hdf5_to_range(file_space_id, object->dataset.space->space.hdf5_id)))
 	{
 		j_goto_error();
@@ -1050,11 +2773,24 @@ H5VL_julea_db_dataset_read(void* obj, hid_t mem_type_id, hid_t mem_space_id, hid
 		data_count += mem_space_range->stop - mem_space_range->start;
 	}
 
-	local_buf_org = g_new(char, data_size* data_count);
-
+	io = H5VL_julea_db_dataset_io_new(object, mem_type_id, buf, data_count);
 	mem_space_idx = 0;
 	file_space_idx = 0;
 
+	strided_count = g_new(guint64, 2 * H5Sget_simple_extent_ndims(object->dataset.space->space.hdf5_id));
+	strided_stride = g_new(guint64, 2 * H5Sget_simple_extent_ndims(object->dataset.space->space.hdf5_id));
+
+	// A regular hyperslab read into a contiguous buffer is requested as a single strided operation instead of one operation per range
+	if (mem_space_arr->len == 1 && H5Sget_select_npoints(file_space_id) == (hssize_t)data_count
+	    && H5VL_julea_db_space_hdf5_to_strided(file_space_id, object->dataset.space->space.hdf5_id, data_size, &strided_length, &strided_offset, &strided_dimensions, strided_count, strided_stride))
+	{
+		mem_space_range = &g_array_index(mem_space_arr, JHDF5IndexRange, 0);
+		j_distributed_object_read_strided(object->dataset.object, ((char*)buf) + mem_space_range->start * data_size, strided_length, strided_offset, strided_dimensions, strided_count, strided_stride, &io->bytes, batch);
+
+		// Skip the range-based loop below
+		mem_space_idx = mem_space_arr->len;
+	}
+
 	while ((mem_space_idx < mem_space_arr->len) && (file_space_idx < file_space_arr->len))
 	{
 		if (mem_space_range == NULL)
@@ -1070,7 +2806,7 @@ H5VL_julea_db_dataset_read(void* obj, hid_t mem_type_id, hid_t mem_space_id, hid
 		current_count1 = mem_space_range->stop - mem_space_range->start;
 		current_count2 = file_space_range->stop - file_space_range->start;
 		current_count1 = current_count1 < current_count2 ? current_count1 : current_count2;
-		j_distributed_object_read(object->dataset.object, ((char*)buf) + mem_space_range->start * data_size, data_size * current_count1, file_space_range->start * data_size, &bytes_read, batch);
+		j_distributed_object_read(object->dataset.object, ((char*)buf) + mem_space_range->start * data_size, data_size * current_count1, file_space_range->start * data_size, &io->bytes, batch);
 
 		if (mem_space_range->start + current_count1 == mem_space_range->stop)
 		{
@@ -1083,25 +2819,31 @@ H5VL_julea_db_dataset_read(void* obj, hid_t mem_type_id, hid_t mem_space_id, hid
 		}
 	}
 
-	if (!j_batch_execute(batch))
+	if (req != NULL)
 	{
-		j_goto_error();
+		*req = H5VL_julea_request_new(batch, H5VL_julea_db_dataset_read_complete, io, H5VL_julea_db_dataset_io_free);
+		return 0;
 	}
 
-	local_buf = H5VL_julea_db_datatype_convert_type(mem_type_id, object->dataset.datatype->datatype.hdf5_id, buf, local_buf_org, data_count);
-
-	if (local_buf != buf)
+	if (!j_batch_execute(batch))
 	{
-		memcpy(buf, local_buf, data_size * data_count);
+		j_goto_error();
 	}
 
-	j_hdf5_log(object->dataset.file->file.name, "a", 'R', NULL, object, NULL);
+	H5VL_julea_db_dataset_read_complete(io);
+	H5VL_julea_db_dataset_io_free(io);
 	return 0;
 
 _error:
+	if (io != NULL)
+	{
+		H5VL_julea_db_dataset_io_free(io);
+	}
+
 	return 1;
 }
 
+
 static herr_t
 H5VL_julea_db_dataset_get(void* obj, H5VL_dataset_get_t get_type, hid_t dxpl_id, void** req, va_list arguments)
 {
@@ -1130,7 +2872,7 @@ H5VL_julea_db_dataset_get(void* obj, H5VL_dataset_get_t get_type, hid_t dxpl_id,
 			g_assert_not_reached();
 	}
 
-	j_hdf5_log(object->dataset.file->file.name, "a", 'G', NULL, object, NULL);
+	H5VL_julea_db_log('G', object, NULL, 0);
 	return 0;
 }
 
@@ -1152,91 +2894,269 @@ H5VL_julea_db_dataset_specific(void* obj, H5VL_dataset_specific_t specific_type,
 	g_assert_not_reached();
 }
 
-static herr_t
-H5VL_julea_db_dataset_optional(void* obj, H5VL_dataset_optional_t opt_type, hid_t dxpl_id, void** req, va_list arguments)
+/**
+ * Adds the chunks of a chunked dataset whose zone maps overlap [min, max] to the selection of space_id.
+ * Only the chunk index is queried, no chunk data is read.
+ **/
+static gboolean
+H5VL_julea_db_dataset_query_range_chunks(JHDF5Object_t* object, hid_t space_id, gdouble min, gdouble max)
 {
 	J_TRACE_FUNCTION(NULL);
 
-	JHDF5Object_t* object = obj;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) rows = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+	JHDF5ChunkLayout layout;
+	hsize_t* start;
+	hsize_t* count;
 
-	(void)opt_type;
-	(void)dxpl_id;
-	(void)req;
-	(void)arguments;
+	H5VL_julea_db_dataset_chunk_layout_init(object, &layout);
+	start = g_new(hsize_t, layout.ndims);
+	count = g_new(hsize_t, layout.ndims);
 
-	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+	if (!(selector = j_db_selector_new(julea_db_schema_chunk, J_DB_SELECTOR_MODE_AND, &error)))
+	{
+		j_goto_error();
+	}
 
-	g_critical("%s NOT implemented !!", G_STRLOC);
-	g_assert_not_reached();
-}
+	if (!j_db_selector_add_field(selector, "dataset", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
+	{
+		j_goto_error();
+	}
 
-static herr_t
-H5VL_julea_db_dataset_close(void* obj, hid_t dxpl_id, void** req)
-{
-	J_TRACE_FUNCTION(NULL);
+	if (layout.type_class == H5T_FLOAT)
+	{
+		if (!j_db_selector_add_field(selector, "max_value_f", J_DB_SELECTOR_OPERATOR_GE, &min, sizeof(min), &error))
+		{
+			j_goto_error();
+		}
 
-	g_autoptr(GError) error = NULL;
-	g_autoptr(JBatch) batch = NULL;
-	JHDF5Object_t* object = obj;
-	g_autoptr(JDBEntry) entry = NULL;
-	g_autoptr(JDBSelector) selector = NULL;
+		if (!j_db_selector_add_field(selector, "min_value_f", J_DB_SELECTOR_OPERATOR_LE, &max, sizeof(max), &error))
+		{
+			j_goto_error();
+		}
+	}
+	else
+	{
+		gint64 min_i;
+		gint64 max_i;
 
-	(void)dxpl_id;
-	(void)req;
+		// Integer zone maps can only contain whole numbers
+		min_i = (ceil(min) <= (gdouble)G_MININT64) ? G_MININT64 : ((ceil(min) >= (gdouble)G_MAXINT64) ? G_MAXINT64 : (gint64)ceil(min));
+		max_i = (floor(max) <= (gdouble)G_MININT64) ? G_MININT64 : ((floor(max) >= (gdouble)G_MAXINT64) ? G_MAXINT64 : (gint64)floor(max));
 
-	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+		if (!j_db_selector_add_field(selector, "max_value_i", J_DB_SELECTOR_OPERATOR_GE, &min_i, sizeof(min_i), &error))
+		{
+			j_goto_error();
+		}
 
-	if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
-	{
-		j_goto_error();
+		if (!j_db_selector_add_field(selector, "min_value_i", J_DB_SELECTOR_OPERATOR_LE, &max_i, sizeof(max_i), &error))
+		{
+			j_goto_error();
+		}
 	}
 
-	if (!(selector = j_db_selector_new(julea_db_schema_dataset, J_DB_SELECTOR_MODE_AND, &error)))
+	if (!(rows = H5VL_julea_db_metadata_query(julea_db_schema_chunk, selector, &error)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
+	for (guint i = 0; i < rows->len; i++)
 	{
-		j_goto_error();
+		guint64 index;
+
+		if (!H5VL_julea_db_dataset_get_field(g_ptr_array_index(rows, i), "index", &index, sizeof(index), &error))
+		{
+			j_goto_error();
+		}
+
+		// Chunk indices are row-major, the last dimension varies fastest
+		for (gint d = layout.ndims - 1; d >= 0; d--)
+		{
+			start[d] = (index % layout.chunk_counts[d]) * layout.chunk_dims[d];
+			count[d] = MIN(layout.chunk_dims[d], layout.dims[d] - start[d]);
+			index /= layout.chunk_counts[d];
+		}
+
+		if (H5Sselect_hyperslab(space_id, H5S_SELECT_OR, start, NULL, count, NULL) < 0)
+		{
+			j_goto_error();
+		}
 	}
 
-	if (!(entry = j_db_entry_new(julea_db_schema_dataset, &error)))
+	g_free(start);
+	g_free(count);
+	H5VL_julea_db_dataset_chunk_layout_clear(&layout);
+
+	return TRUE;
+
+_error:
+	H5VL_julea_db_error_handler(error);
+	g_free(start);
+	g_free(count);
+	H5VL_julea_db_dataset_chunk_layout_clear(&layout);
+
+	return FALSE;
+}
+
+/**
+ * Returns a copy of the dataset's dataspace with all elements selected that might be within [min, max].
+ * Chunked datasets are pruned using the chunks' zone maps, contiguous datasets only using the dataset's statistics.
+ **/
+static hid_t
+H5VL_julea_db_dataset_query_range(JHDF5Object_t* object, gdouble min, gdouble max)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	hid_t space_id;
+	gboolean overlaps;
+
+	if ((space_id = H5Scopy(object->dataset.space->space.hdf5_id)) < 0)
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_entry_set_field(entry, "min_value_i", &object->dataset.statistics.min_value_i, sizeof(object->dataset.statistics.min_value_i), &error))
+	if (object->dataset.chunk_dims != NULL)
 	{
-		j_goto_error();
+		if (H5Sselect_none(space_id) < 0 || !H5VL_julea_db_dataset_query_range_chunks(object, space_id, min, max))
+		{
+			j_goto_error();
+		}
+
+		return space_id;
 	}
 
-	if (!j_db_entry_set_field(entry, "max_value_i", &object->dataset.statistics.max_value_i, sizeof(object->dataset.statistics.max_value_i), &error))
+	if (H5Tget_class(object->dataset.datatype->datatype.hdf5_id) == H5T_FLOAT)
 	{
-		j_goto_error();
+		overlaps = (object->dataset.statistics.max_value_f >= min && object->dataset.statistics.min_value_f <= max);
+	}
+	else
+	{
+		overlaps = ((gdouble)object->dataset.statistics.max_value_i >= min && (gdouble)object->dataset.statistics.min_value_i <= max);
 	}
 
-	if (!j_db_entry_set_field(entry, "min_value_f", &object->dataset.statistics.min_value_f, sizeof(object->dataset.statistics.min_value_f), &error))
+	if ((overlaps ? H5Sselect_all(space_id) : H5Sselect_none(space_id)) < 0)
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_entry_set_field(entry, "max_value_f", &object->dataset.statistics.max_value_f, sizeof(object->dataset.statistics.max_value_f), &error))
+	return space_id;
+
+_error:
+	if (space_id >= 0)
 	{
-		j_goto_error();
+		H5Sclose(space_id);
 	}
 
-	if (!j_db_entry_update(entry, selector, batch, &error))
+	return H5I_INVALID_HID;
+}
+
+static herr_t
+H5VL_julea_db_dataset_optional(void* obj, H5VL_dataset_optional_t opt_type, hid_t dxpl_id, void** req, va_list arguments)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Object_t* object = obj;
+
+	(void)dxpl_id;
+	(void)req;
+
+	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+
+	switch (opt_type)
 	{
-		j_goto_error();
+		case J_HDF5_DATASET_OPTIONAL_QUERY_RANGE:
+		{
+			gdouble min = va_arg(arguments, gdouble);
+			gdouble max = va_arg(arguments, gdouble);
+			hid_t* ret_id = va_arg(arguments, hid_t*);
+
+			if ((*ret_id = H5VL_julea_db_dataset_query_range(object, min, max)) < 0)
+			{
+				return -1;
+			}
+
+			return 0;
+		}
+		default:
+			g_critical("%s NOT implemented !!", G_STRLOC);
+			g_assert_not_reached();
 	}
+}
 
-	if (!j_batch_execute(batch))
+static herr_t
+H5VL_julea_db_dataset_close(void* obj, hid_t dxpl_id, void** req)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JBatch) batch = NULL;
+	JHDF5Object_t* object = obj;
+	g_autoptr(JDBEntry) entry = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+
+	(void)dxpl_id;
+	(void)req;
+
+	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_DATASET, 1);
+
+	// Statistics only change when writing, there is nothing to store for datasets that have only been read
+	if (object->dataset.statistics_changed)
 	{
-		j_goto_error();
+		if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
+		{
+			j_goto_error();
+		}
+
+		if (!(selector = j_db_selector_new(julea_db_schema_dataset, J_DB_SELECTOR_MODE_AND, &error)))
+		{
+			j_goto_error();
+		}
+
+		if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
+		{
+			j_goto_error();
+		}
+
+		if (!(entry = j_db_entry_new(julea_db_schema_dataset, &error)))
+		{
+			j_goto_error();
+		}
+
+		if (!j_db_entry_set_field(entry, "min_value_i", &object->dataset.statistics.min_value_i, sizeof(object->dataset.statistics.min_value_i), &error))
+		{
+			j_goto_error();
+		}
+
+		if (!j_db_entry_set_field(entry, "max_value_i", &object->dataset.statistics.max_value_i, sizeof(object->dataset.statistics.max_value_i), &error))
+		{
+			j_goto_error();
+		}
+
+		if (!j_db_entry_set_field(entry, "min_value_f", &object->dataset.statistics.min_value_f, sizeof(object->dataset.statistics.min_value_f), &error))
+		{
+			j_goto_error();
+		}
+
+		if (!j_db_entry_set_field(entry, "max_value_f", &object->dataset.statistics.max_value_f, sizeof(object->dataset.statistics.max_value_f), &error))
+		{
+			j_goto_error();
+		}
+
+		if (!j_db_entry_update(entry, selector, batch, &error))
+		{
+			j_goto_error();
+		}
+
+		H5VL_julea_db_metadata_invalidate(object->dataset.file);
+
+		if (!j_batch_execute(batch))
+		{
+			j_goto_error();
+		}
 	}
 
-	j_hdf5_log(object->dataset.file->file.name, "a", 'S', NULL, object, NULL);
+	H5VL_julea_db_log('S', object, NULL, 0);
 	H5VL_julea_db_object_unref(object);
 
 	return 0;
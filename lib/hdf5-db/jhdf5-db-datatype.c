@@ -44,6 +44,9 @@
 
 static JDBSchema* julea_db_schema_datatype_header = NULL;
 
+// Maps encoded datatypes to the IDs of their entries
+static GHashTable* julea_db_datatype_cache = NULL;
+
 static const void*
 H5VL_julea_db_datatype_convert_type_change(hid_t type_id_from, hid_t type_id_to, const char* from_buf, char* target_buf, guint count)
 {
@@ -100,6 +103,12 @@ H5VL_julea_db_datatype_term(void)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	if (julea_db_datatype_cache != NULL)
+	{
+		g_hash_table_unref(julea_db_datatype_cache);
+		julea_db_datatype_cache = NULL;
+	}
+
 	if (julea_db_schema_datatype_header != NULL)
 	{
 		j_db_schema_unref(julea_db_schema_datatype_header);
@@ -119,6 +128,8 @@ H5VL_julea_db_datatype_init(hid_t vipl_id)
 
 	(void)vipl_id;
 
+	julea_db_datatype_cache = H5VL_julea_db_id_cache_new();
+
 	if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
 	{
 		j_goto_error();
@@ -241,14 +252,13 @@ _error:
 }
 
 static JHDF5Object_t*
-H5VL_julea_db_datatype_decode(void* backend_id, guint64 backend_id_len)
+H5VL_julea_db_datatype_decode(JHDF5Object_t* file, void* backend_id, guint64 backend_id_len)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_autofree guint32* tmp_uint32 = NULL;
-	g_autoptr(JDBIterator) iterator = NULL;
+	g_autoptr(GHashTable) row = NULL;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(JDBSelector) selector = NULL;
 	JHDF5Object_t* object = NULL;
 	JDBType type;
 	guint64 length;
@@ -266,32 +276,17 @@ H5VL_julea_db_datatype_decode(void* backend_id, guint64 backend_id_len)
 	memcpy(object->backend_id, backend_id, backend_id_len);
 	object->backend_id_len = backend_id_len;
 
-	if (!(selector = j_db_selector_new(julea_db_schema_datatype_header, J_DB_SELECTOR_MODE_AND, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
-	{
-		j_goto_error();
-	}
-
-	if (!(iterator = j_db_iterator_new(julea_db_schema_datatype_header, selector, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_iterator_next(iterator, NULL))
+	if (!(row = H5VL_julea_db_metadata_get_row(file, J_HDF5_OBJECT_TYPE_DATATYPE, object->backend_id, object->backend_id_len, &error)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "type_cache", &type, &object->datatype.data, &object->datatype.data_size, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "type_cache", &type, &object->datatype.data, &object->datatype.data_size, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "type_size", &type, (gpointer*)&tmp_uint32, &length, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "type_size", &type, (gpointer*)&tmp_uint32, &length, &error))
 	{
 		j_goto_error();
 	}
@@ -303,6 +298,9 @@ H5VL_julea_db_datatype_decode(void* backend_id, guint64 backend_id_len)
 		j_goto_error();
 	}
 
+	// Known entries can be reused when encoding equal datatypes
+	H5VL_julea_db_id_cache_insert(julea_db_datatype_cache, object->datatype.data, object->datatype.data_size, object->backend_id, object->backend_id_len);
+
 	return object;
 
 _error:
@@ -353,6 +351,11 @@ H5VL_julea_db_datatype_encode(hid_t* type_id)
 	H5Tencode(*type_id, object->datatype.data, &size);
 	object->datatype.hdf5_id = *type_id;
 
+	if (H5VL_julea_db_id_cache_lookup(julea_db_datatype_cache, object->datatype.data, size, &object->backend_id, &object->backend_id_len))
+	{
+		goto _done;
+	}
+
 	//check if this datatype exists
 	if (!(selector = j_db_selector_new(julea_db_schema_datatype_header, J_DB_SELECTOR_MODE_AND, &error)))
 	{
@@ -376,6 +379,8 @@ H5VL_julea_db_datatype_encode(hid_t* type_id)
 			j_goto_error();
 		}
 
+		H5VL_julea_db_id_cache_insert(julea_db_datatype_cache, object->datatype.data, size, object->backend_id, object->backend_id_len);
+
 		goto _done;
 	}
 
@@ -498,6 +503,8 @@ H5VL_julea_db_datatype_encode(hid_t* type_id)
 		j_goto_error();
 	}
 
+	H5VL_julea_db_id_cache_insert(julea_db_datatype_cache, object->datatype.data, size, object->backend_id, object->backend_id_len);
+
 _done:
 	return object;
 
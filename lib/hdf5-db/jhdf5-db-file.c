@@ -281,7 +281,7 @@ H5VL_julea_db_file_create(const char* name, unsigned flags, hid_t fcpl_id, hid_t
 		}
 	}
 
-	j_hdf5_log(object->file.name, "w", 'C', exist ? "truncated" : NULL, object, NULL);
+	H5VL_julea_db_log('C', object, NULL, 0);
 	return object;
 
 _error:
@@ -352,7 +352,10 @@ H5VL_julea_db_file_open(const char* name, unsigned flags, hid_t fapl_id, hid_t d
 
 	g_assert(!j_db_iterator_next(iterator, NULL));
 
-        j_hdf5_log(object->file.name, "a", 'O', NULL, object, NULL);
+	// Metadata is prefetched when the first object is opened
+	object->file.prefetch = TRUE;
+
+	H5VL_julea_db_log('O', object, NULL, 0);
 	return object;
 
 _error:
@@ -376,7 +379,7 @@ H5VL_julea_db_file_get(void* obj, H5VL_file_get_t get_type, hid_t dxpl_id, void*
 
 	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_FILE, 1);
 
-	j_hdf5_log(object->file.name, "a", 'G', NULL, object, NULL);
+	H5VL_julea_db_log('G', object, NULL, 0);
 	g_critical("%s NOT implemented !!", G_STRLOC);
 	g_assert_not_reached();
 }
@@ -429,7 +432,7 @@ H5VL_julea_db_file_close(void* obj, hid_t dxpl_id, void** req)
 
 	g_return_val_if_fail(object->type == J_HDF5_OBJECT_TYPE_FILE, 1);
 
-	j_hdf5_log(object->file.name, "a", 'S', "file closed", object, NULL);
+	H5VL_julea_db_log('S', object, NULL, 0);
 	H5VL_julea_db_object_unref(object);
 
 	return 0;
@@ -316,6 +316,12 @@ H5VL_julea_db_link_get_helper(JHDF5Object_t* parent, JHDF5Object_t* child, const
 			j_goto_error();
 	}
 
+	// Links that are not part of the prefetched metadata might have been created in the meantime
+	if (H5VL_julea_db_metadata_get_link(file, parent, name, child))
+	{
+		return TRUE;
+	}
+
 	if (!(selector = j_db_selector_new(julea_db_schema_link, J_DB_SELECTOR_MODE_AND, &error)))
 	{
 		j_goto_error();
@@ -497,6 +503,8 @@ H5VL_julea_db_link_create_helper(JHDF5Object_t* parent, JHDF5Object_t* child, co
 		j_goto_error();
 	}
 
+	H5VL_julea_db_metadata_invalidate(file);
+
 	if (!j_batch_execute(batch))
 	{
 		j_goto_error();
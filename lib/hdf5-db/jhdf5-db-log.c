@@ -0,0 +1,530 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2021 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ **/
+
+#include <julea-config.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <hdf5/jhdf5-log.h>
+
+#include "jhdf5-db.h"
+
+/**
+ * The size of each thread's ring, has to be a power of two.
+ **/
+#define J_HDF5_LOG_RING_SIZE (256 * 1024)
+
+/**
+ * How often the flusher writes the rings to the log file, in microseconds.
+ **/
+#define J_HDF5_LOG_FLUSH_INTERVAL (100 * G_TIME_SPAN_MILLISECOND)
+
+enum JHDF5LogRingState
+{
+	J_HDF5_LOG_RING_ACTIVE,
+	// The owning thread has exited, the log frees the ring after draining it
+	J_HDF5_LOG_RING_FINISHED,
+	// The log has been stopped, the owning thread frees or reuses the ring
+	J_HDF5_LOG_RING_ORPHANED
+};
+
+/**
+ * A single-producer single-consumer ring of log records.
+ * The owning thread only advances head and the flusher only advances tail, so neither has to take a lock.
+ **/
+struct JHDF5LogRing
+{
+	gchar* data;
+	gsize head;
+	gsize tail;
+	gint state;
+};
+
+typedef struct JHDF5LogRing JHDF5LogRing;
+
+struct JHDF5Log
+{
+	FILE* file;
+	gint64 start_time;
+	GThread* flusher;
+	gboolean stop;
+	// Protects rings, stop, file and error
+	GMutex mutex[1];
+	GCond cond[1];
+	GPtrArray* rings;
+	// Number of records that were dropped because a ring was full
+	gint dropped;
+	// Whether writing to file failed
+	gboolean error;
+
+	// Operations and object types to log, all are logged if NULL
+	gchar* operations;
+	gchar* types;
+};
+
+typedef struct JHDF5Log JHDF5Log;
+
+static JHDF5Log* julea_db_log = NULL;
+
+/**
+ * Protects julea_db_log, loggers hold a reader lock while using the log so that it cannot be freed underneath them.
+ **/
+static GRWLock julea_db_log_lock;
+
+static void
+H5VL_julea_db_log_ring_free(JHDF5LogRing* ring)
+{
+	g_free(ring->data);
+	g_free(ring);
+}
+
+static void
+H5VL_julea_db_log_ring_finish(gpointer data)
+{
+	JHDF5LogRing* ring = data;
+
+	// Exactly one of the owning thread and the log frees the ring
+	if (!g_atomic_int_compare_and_exchange(&ring->state, J_HDF5_LOG_RING_ACTIVE, J_HDF5_LOG_RING_FINISHED))
+	{
+		H5VL_julea_db_log_ring_free(ring);
+	}
+}
+
+static GPrivate julea_db_log_ring = G_PRIVATE_INIT(H5VL_julea_db_log_ring_finish);
+
+/**
+ * Writes the records in ring to the log file and returns whether the ring can be freed.
+ * Write errors are remembered in the log's error field.
+ * Has to be called with the log's mutex held.
+ **/
+static gboolean
+H5VL_julea_db_log_ring_drain(JHDF5Log* log, JHDF5LogRing* ring)
+{
+	gboolean finished;
+	gsize head;
+	gsize tail;
+
+	// Check before reading head, records written before the thread exited are drained below
+	finished = (g_atomic_int_get(&ring->state) == J_HDF5_LOG_RING_FINISHED);
+	head = (gsize)g_atomic_pointer_get(&ring->head);
+	tail = ring->tail;
+
+	while (tail != head)
+	{
+		gsize index;
+		gsize length;
+
+		index = tail & (J_HDF5_LOG_RING_SIZE - 1);
+		length = MIN(head - tail, J_HDF5_LOG_RING_SIZE - index);
+
+		if (fwrite(ring->data + index, 1, length, log->file) != length)
+		{
+			log->error = TRUE;
+		}
+
+		tail += length;
+	}
+
+	g_atomic_pointer_set(&ring->tail, tail);
+
+	return finished;
+}
+
+/**
+ * Has to be called with the log's mutex held.
+ **/
+static void
+H5VL_julea_db_log_drain(JHDF5Log* log)
+{
+	for (guint i = 0; i < log->rings->len;)
+	{
+		JHDF5LogRing* ring = g_ptr_array_index(log->rings, i);
+
+		if (H5VL_julea_db_log_ring_drain(log, ring))
+		{
+			g_ptr_array_remove_index_fast(log->rings, i);
+			H5VL_julea_db_log_ring_free(ring);
+			continue;
+		}
+
+		i++;
+	}
+
+	if (fflush(log->file) != 0)
+	{
+		log->error = TRUE;
+	}
+}
+
+static gpointer
+H5VL_julea_db_log_flusher(gpointer data)
+{
+	JHDF5Log* log = data;
+
+	g_mutex_lock(log->mutex);
+
+	while (!log->stop)
+	{
+		g_cond_wait_until(log->cond, log->mutex, g_get_monotonic_time() + J_HDF5_LOG_FLUSH_INTERVAL);
+		H5VL_julea_db_log_drain(log);
+	}
+
+	g_mutex_unlock(log->mutex);
+
+	return NULL;
+}
+
+static JHDF5LogRing*
+H5VL_julea_db_log_get_ring(JHDF5Log* log)
+{
+	JHDF5LogRing* ring;
+
+	if ((ring = g_private_get(&julea_db_log_ring)) != NULL)
+	{
+		if (G_LIKELY(g_atomic_int_get(&ring->state) == J_HDF5_LOG_RING_ACTIVE))
+		{
+			return ring;
+		}
+
+		// The ring belonged to a log that has been stopped in the meantime
+		ring->head = 0;
+		ring->tail = 0;
+		g_atomic_int_set(&ring->state, J_HDF5_LOG_RING_ACTIVE);
+	}
+	else
+	{
+		ring = g_new0(JHDF5LogRing, 1);
+		ring->data = g_malloc(J_HDF5_LOG_RING_SIZE);
+		ring->state = J_HDF5_LOG_RING_ACTIVE;
+
+		g_private_set(&julea_db_log_ring, ring);
+	}
+
+	// Only happens once per thread and log
+	g_mutex_lock(log->mutex);
+	g_ptr_array_add(log->rings, ring);
+	g_mutex_unlock(log->mutex);
+
+	return ring;
+}
+
+/**
+ * Copies length bytes to the ring starting at position head.
+ **/
+static void
+H5VL_julea_db_log_ring_copy(JHDF5LogRing* ring, gsize head, gconstpointer data, gsize length)
+{
+	gsize index;
+	gsize first;
+
+	index = head & (J_HDF5_LOG_RING_SIZE - 1);
+	first = MIN(length, J_HDF5_LOG_RING_SIZE - index);
+
+	memcpy(ring->data + index, data, first);
+	memcpy(ring->data, (gchar const*)data + first, length - first);
+}
+
+static gchar
+H5VL_julea_db_log_object_type(JHDF5Object_t* object)
+{
+	switch (object->type)
+	{
+		case J_HDF5_OBJECT_TYPE_FILE:
+			return 'F';
+		case J_HDF5_OBJECT_TYPE_DATASET:
+			return 'D';
+		case J_HDF5_OBJECT_TYPE_ATTR:
+			return 'A';
+		case J_HDF5_OBJECT_TYPE_GROUP:
+			return 'G';
+		case J_HDF5_OBJECT_TYPE_DATATYPE:
+			return 'T';
+		case J_HDF5_OBJECT_TYPE_SPACE:
+			return 'S';
+		case _J_HDF5_OBJECT_TYPE_COUNT:
+		default:
+			g_assert_not_reached();
+	}
+
+	return ' ';
+}
+
+static gchar const*
+H5VL_julea_db_log_object_name(JHDF5Object_t* object)
+{
+	switch (object->type)
+	{
+		case J_HDF5_OBJECT_TYPE_FILE:
+			return object->file.name;
+		case J_HDF5_OBJECT_TYPE_DATASET:
+			return object->dataset.name;
+		case J_HDF5_OBJECT_TYPE_ATTR:
+			return object->attr.name;
+		case J_HDF5_OBJECT_TYPE_GROUP:
+			return object->group.name;
+		case J_HDF5_OBJECT_TYPE_DATATYPE:
+		case J_HDF5_OBJECT_TYPE_SPACE:
+		case _J_HDF5_OBJECT_TYPE_COUNT:
+		default:
+			return NULL;
+	}
+}
+
+static guint64
+H5VL_julea_db_log_id(JHDF5Object_t* object)
+{
+	guint64 id = 0;
+
+	if (object != NULL && object->backend_id != NULL)
+	{
+		memcpy(&id, object->backend_id, MIN(object->backend_id_len, sizeof(id)));
+	}
+
+	return id;
+}
+
+/**
+ * Starts logging if JULEA_HDF5_LOG_DIRECTORY is set.
+ * JULEA_HDF5_LOG_OPERATIONS and JULEA_HDF5_LOG_TYPES restrict the logged operations and object types, "All" or unset logs everything.
+ **/
+static void
+H5VL_julea_db_log_init(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autofree gchar* path = NULL;
+	g_autofree gchar* file_name = NULL;
+	JHDF5LogHeader header;
+	JHDF5Log* log;
+	gchar const* directory;
+	gchar const* operations;
+	gchar const* types;
+	FILE* file;
+
+	if ((directory = g_getenv("JULEA_HDF5_LOG_DIRECTORY")) == NULL)
+	{
+		return;
+	}
+
+	g_rw_lock_writer_lock(&julea_db_log_lock);
+
+	if (julea_db_log != NULL)
+	{
+		g_rw_lock_writer_unlock(&julea_db_log_lock);
+		return;
+	}
+
+	file_name = g_strdup_printf("julea-hdf5-%s-%d.log", g_get_host_name(), getpid());
+	path = g_build_filename(directory, file_name, NULL);
+
+	if ((file = g_fopen(path, "wb")) == NULL)
+	{
+		g_rw_lock_writer_unlock(&julea_db_log_lock);
+		g_warning("Could not open JULEA HDF5 log %s.", path);
+		return;
+	}
+
+	log = g_new0(JHDF5Log, 1);
+	log->file = file;
+	log->start_time = g_get_monotonic_time();
+	log->stop = FALSE;
+	log->error = FALSE;
+	g_mutex_init(log->mutex);
+	g_cond_init(log->cond);
+	log->rings = g_ptr_array_new();
+
+	operations = g_getenv("JULEA_HDF5_LOG_OPERATIONS");
+	types = g_getenv("JULEA_HDF5_LOG_TYPES");
+
+	log->operations = (operations == NULL || g_strcmp0(operations, "All") == 0) ? NULL : g_strdup(operations);
+	log->types = (types == NULL || g_strcmp0(types, "All") == 0) ? NULL : g_strdup(types);
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, J_HDF5_LOG_MAGIC, sizeof(header.magic));
+	header.version = J_HDF5_LOG_VERSION;
+	header.pid = getpid();
+	header.start_time = g_get_real_time();
+	log->error = (fwrite(&header, sizeof(header), 1, log->file) != 1);
+
+	log->flusher = g_thread_new("julea-hdf5-log", H5VL_julea_db_log_flusher, log);
+
+	g_atomic_pointer_set(&julea_db_log, log);
+
+	g_rw_lock_writer_unlock(&julea_db_log_lock);
+}
+
+/**
+ * Stops logging and writes all remaining records to the log file.
+ * Records of threads that log after this point are discarded.
+ **/
+static void
+H5VL_julea_db_log_term(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Log* log;
+
+	// Wait for threads that are currently logging, later ones do not see the log anymore
+	g_rw_lock_writer_lock(&julea_db_log_lock);
+	log = g_atomic_pointer_get(&julea_db_log);
+	g_atomic_pointer_set(&julea_db_log, NULL);
+	g_rw_lock_writer_unlock(&julea_db_log_lock);
+
+	if (log == NULL)
+	{
+		return;
+	}
+
+	g_mutex_lock(log->mutex);
+	log->stop = TRUE;
+	g_cond_signal(log->cond);
+	g_mutex_unlock(log->mutex);
+
+	g_thread_join(log->flusher);
+
+	// The flusher has drained the rings before exiting, only rings of threads that are still running remain
+	H5VL_julea_db_log_drain(log);
+
+	if (g_atomic_int_get(&log->dropped) > 0)
+	{
+		g_warning("JULEA HDF5 log dropped %d records.", g_atomic_int_get(&log->dropped));
+	}
+
+	if (fclose(log->file) != 0)
+	{
+		log->error = TRUE;
+	}
+
+	if (log->error)
+	{
+		g_warning("JULEA HDF5 log could not be written completely.");
+	}
+
+	// Threads that are still running keep their rings and reuse them if logging is started again
+	for (guint i = 0; i < log->rings->len; i++)
+	{
+		JHDF5LogRing* ring = g_ptr_array_index(log->rings, i);
+
+		if (!g_atomic_int_compare_and_exchange(&ring->state, J_HDF5_LOG_RING_ACTIVE, J_HDF5_LOG_RING_ORPHANED))
+		{
+			H5VL_julea_db_log_ring_free(ring);
+		}
+	}
+
+	g_ptr_array_unref(log->rings);
+	g_cond_clear(log->cond);
+	g_mutex_clear(log->mutex);
+	g_free(log->operations);
+	g_free(log->types);
+	g_free(log);
+}
+
+/**
+ * Logs an operation on object.
+ * parent is only used for create operations, bytes is the amount of data read or written.
+ *
+ * The record is appended to the calling thread's ring, it is dropped if the ring is full.
+ * Only a reader lock is taken to keep the log from being stopped concurrently.
+ **/
+static void
+H5VL_julea_db_log(gchar operation, JHDF5Object_t* object, JHDF5Object_t* parent, guint64 bytes)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Log* log;
+	JHDF5LogRecord record;
+	JHDF5LogRing* ring;
+	gchar const* name = NULL;
+	gsize head;
+	gsize length;
+
+	// Avoid taking the lock if logging is disabled
+	if (G_LIKELY(g_atomic_pointer_get(&julea_db_log) == NULL) || object == NULL)
+	{
+		return;
+	}
+
+	g_rw_lock_reader_lock(&julea_db_log_lock);
+
+	if ((log = julea_db_log) == NULL)
+	{
+		goto end;
+	}
+
+	record.object_type = H5VL_julea_db_log_object_type(object);
+
+	if ((log->operations != NULL && strchr(log->operations, operation) == NULL) || (log->types != NULL && strchr(log->types, record.object_type) == NULL))
+	{
+		goto end;
+	}
+
+	record.timestamp = g_get_monotonic_time() - log->start_time;
+	record.bytes = bytes;
+	record.backend_id = H5VL_julea_db_log_id(object);
+	record.parent_id = H5VL_julea_db_log_id(parent);
+	record.operation = operation;
+	record.parent_type = (parent != NULL) ? H5VL_julea_db_log_object_type(parent) : ' ';
+	record.padding = 0;
+	record.name_length = 0;
+
+	// Names are only logged once per object so that the converter can resolve IDs
+	if (operation == 'C' || operation == 'O')
+	{
+		name = H5VL_julea_db_log_object_name(object);
+		record.name_length = (name != NULL) ? MIN(strlen(name), 1024) : 0;
+	}
+
+	ring = H5VL_julea_db_log_get_ring(log);
+	length = sizeof(record) + record.name_length;
+	head = ring->head;
+
+	if (head + length - (gsize)g_atomic_pointer_get(&ring->tail) > J_HDF5_LOG_RING_SIZE)
+	{
+		g_atomic_int_inc(&log->dropped);
+		g_cond_signal(log->cond);
+		goto end;
+	}
+
+	H5VL_julea_db_log_ring_copy(ring, head, &record, sizeof(record));
+
+	if (record.name_length > 0)
+	{
+		H5VL_julea_db_log_ring_copy(ring, head + sizeof(record), name, record.name_length);
+	}
+
+	// Publish the record only after it has been copied completely
+	g_atomic_pointer_set(&ring->head, head + length);
+
+	// Wake up the flusher early if the ring is getting full
+	if (head + length - (gsize)g_atomic_pointer_get(&ring->tail) > J_HDF5_LOG_RING_SIZE / 2)
+	{
+		g_cond_signal(log->cond);
+	}
+
+end:
+	g_rw_lock_reader_unlock(&julea_db_log_lock);
+}
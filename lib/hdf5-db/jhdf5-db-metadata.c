@@ -0,0 +1,642 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2021 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ **/
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <hdf5.h>
+#include <H5PLextern.h>
+
+#include <string.h>
+
+#include <julea.h>
+#include <julea-db.h>
+
+#include "jhdf5-db.h"
+
+// The number of IDs per query when fetching spaces and datatypes, selectors are limited to 500 conditions
+#define J_HDF5_METADATA_PAGE_SIZE 256
+
+/**
+ * A field of a cached DB entry.
+ * Rows map field names to JHDF5MetadataField.
+ **/
+struct JHDF5MetadataField
+{
+	JDBType type;
+	gpointer value;
+	guint64 length;
+};
+
+typedef struct JHDF5MetadataField JHDF5MetadataField;
+
+/**
+ * The metadata of a file as it was stored when the file was opened.
+ * All IDs are stored as GBytes.
+ **/
+struct JHDF5Metadata
+{
+	// Maps parent ID, parent type and name to the child's ID
+	GHashTable* links;
+	// Maps IDs to rows, separately for each object type
+	GHashTable* rows[_J_HDF5_OBJECT_TYPE_COUNT];
+	// Maps dataset IDs to arrays of chunk rows
+	GHashTable* chunks;
+};
+
+static void
+H5VL_julea_db_metadata_field_free(gpointer data)
+{
+	JHDF5MetadataField* field = data;
+
+	g_free(field->value);
+	g_free(field);
+}
+
+static JDBSchema*
+H5VL_julea_db_metadata_schema(JHDF5ObjectType type)
+{
+	switch (type)
+	{
+		case J_HDF5_OBJECT_TYPE_DATASET:
+			return julea_db_schema_dataset;
+		case J_HDF5_OBJECT_TYPE_ATTR:
+			return julea_db_schema_attr;
+		case J_HDF5_OBJECT_TYPE_DATATYPE:
+			return julea_db_schema_datatype_header;
+		case J_HDF5_OBJECT_TYPE_SPACE:
+			return julea_db_schema_space_header;
+		case J_HDF5_OBJECT_TYPE_FILE:
+		case J_HDF5_OBJECT_TYPE_GROUP:
+		case _J_HDF5_OBJECT_TYPE_COUNT:
+		default:
+			g_assert_not_reached();
+	}
+
+	return NULL;
+}
+
+static JHDF5MetadataField const*
+H5VL_julea_db_metadata_peek_field(GHashTable* row, gchar const* name)
+{
+	return g_hash_table_lookup(row, name);
+}
+
+static GBytes*
+H5VL_julea_db_metadata_field_to_bytes(GHashTable* row, gchar const* name)
+{
+	JHDF5MetadataField const* field;
+
+	if ((field = H5VL_julea_db_metadata_peek_field(row, name)) == NULL)
+	{
+		return NULL;
+	}
+
+	return g_bytes_new(field->value, field->length);
+}
+
+/**
+ * Returns the entries matching selector as rows, that is, hash tables mapping field names to JHDF5MetadataField.
+ * Each row also contains the entry's ID as _id.
+ **/
+static GPtrArray*
+H5VL_julea_db_metadata_query(JDBSchema* schema, JDBSelector* selector, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JDBIterator) iterator = NULL;
+	GPtrArray* rows;
+	gchar** names = NULL;
+	JDBType* types = NULL;
+	guint32 count;
+
+	rows = g_ptr_array_new_with_free_func((GDestroyNotify)g_hash_table_unref);
+
+	if ((count = j_db_schema_get_all_fields(schema, &names, &types, error)) == 0)
+	{
+		j_goto_error();
+	}
+
+	if (!(iterator = j_db_iterator_new(schema, selector, error)))
+	{
+		j_goto_error();
+	}
+
+	while (j_db_iterator_next(iterator, NULL))
+	{
+		GHashTable* row;
+		JHDF5MetadataField* field;
+
+		row = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, H5VL_julea_db_metadata_field_free);
+		g_ptr_array_add(rows, row);
+
+		field = g_new0(JHDF5MetadataField, 1);
+		g_hash_table_insert(row, g_strdup("_id"), field);
+
+		if (!j_db_iterator_get_field(iterator, "_id", &field->type, &field->value, &field->length, error))
+		{
+			j_goto_error();
+		}
+
+		// The field array might contain fewer names than count
+		for (guint32 i = 0; i < count && names[i] != NULL; i++)
+		{
+			field = g_new0(JHDF5MetadataField, 1);
+			g_hash_table_insert(row, g_strdup(names[i]), field);
+
+			if (!j_db_iterator_get_field(iterator, names[i], &field->type, &field->value, &field->length, error))
+			{
+				j_goto_error();
+			}
+		}
+	}
+
+	for (guint32 i = 0; i < count; i++)
+	{
+		g_free(names[i]);
+	}
+
+	g_free(names);
+	g_free(types);
+
+	return rows;
+
+_error:
+	if (names != NULL)
+	{
+		for (guint32 i = 0; i < count; i++)
+		{
+			g_free(names[i]);
+		}
+	}
+
+	g_free(names);
+	g_free(types);
+	g_ptr_array_unref(rows);
+
+	return NULL;
+}
+
+/**
+ * Queries all entries of schema that belong to file.
+ **/
+static GPtrArray*
+H5VL_julea_db_metadata_query_file(JHDF5Object_t* file, JDBSchema* schema, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JDBSelector) selector = NULL;
+
+	if (!(selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, error)))
+	{
+		return NULL;
+	}
+
+	if (!j_db_selector_add_field(selector, "file", J_DB_SELECTOR_OPERATOR_EQ, file->backend_id, file->backend_id_len, error))
+	{
+		return NULL;
+	}
+
+	return H5VL_julea_db_metadata_query(schema, selector, error);
+}
+
+/**
+ * Fetches the entries with the given IDs, multiple IDs are combined into one query.
+ **/
+static gboolean
+H5VL_julea_db_metadata_query_ids(JHDF5Metadata* metadata, JHDF5ObjectType type, GHashTable* ids, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDBSchema* schema = H5VL_julea_db_metadata_schema(type);
+	GHashTableIter iter;
+	GBytes* id;
+	guint remaining;
+
+	g_hash_table_iter_init(&iter, ids);
+	remaining = g_hash_table_size(ids);
+
+	while (remaining > 0)
+	{
+		g_autoptr(JDBSelector) selector = NULL;
+		g_autoptr(GPtrArray) rows = NULL;
+
+		if (!(selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_OR, error)))
+		{
+			j_goto_error();
+		}
+
+		for (guint i = 0; i < J_HDF5_METADATA_PAGE_SIZE && g_hash_table_iter_next(&iter, (gpointer*)&id, NULL); i++)
+		{
+			gsize id_len;
+			gconstpointer id_data;
+
+			id_data = g_bytes_get_data(id, &id_len);
+			remaining--;
+
+			if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, id_data, id_len, error))
+			{
+				j_goto_error();
+			}
+		}
+
+		if (!(rows = H5VL_julea_db_metadata_query(schema, selector, error)))
+		{
+			j_goto_error();
+		}
+
+		for (guint i = 0; i < rows->len; i++)
+		{
+			GHashTable* row = g_ptr_array_index(rows, i);
+
+			g_hash_table_replace(metadata->rows[type], H5VL_julea_db_metadata_field_to_bytes(row, "_id"), g_hash_table_ref(row));
+		}
+	}
+
+	return TRUE;
+
+_error:
+	return FALSE;
+}
+
+/**
+ * Adds rows to the metadata and collects the IDs of the spaces and datatypes they reference.
+ **/
+static void
+H5VL_julea_db_metadata_add_rows(JHDF5Metadata* metadata, JHDF5ObjectType type, GPtrArray* rows, GHashTable* space_ids, GHashTable* datatype_ids)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	for (guint i = 0; i < rows->len; i++)
+	{
+		GHashTable* row = g_ptr_array_index(rows, i);
+		GBytes* id;
+
+		g_hash_table_replace(metadata->rows[type], H5VL_julea_db_metadata_field_to_bytes(row, "_id"), g_hash_table_ref(row));
+
+		if ((id = H5VL_julea_db_metadata_field_to_bytes(row, "space")) != NULL)
+		{
+			g_hash_table_add(space_ids, id);
+		}
+
+		if ((id = H5VL_julea_db_metadata_field_to_bytes(row, "datatype")) != NULL)
+		{
+			g_hash_table_add(datatype_ids, id);
+		}
+	}
+}
+
+static GBytes*
+H5VL_julea_db_metadata_link_key(gconstpointer parent_id, guint64 parent_id_len, gconstpointer parent_type, guint64 parent_type_len, gconstpointer name, guint64 name_len)
+{
+	GByteArray* key;
+
+	key = g_byte_array_sized_new(parent_id_len + parent_type_len + name_len);
+	g_byte_array_append(key, parent_id, parent_id_len);
+	g_byte_array_append(key, parent_type, parent_type_len);
+	g_byte_array_append(key, name, name_len);
+
+	return g_byte_array_free_to_bytes(key);
+}
+
+/**
+ * Fetches the links, datasets, chunks, attributes, spaces and datatypes of a file.
+ * Links, datasets, chunks and attributes are fetched with one query each, spaces and datatypes with one query per J_HDF5_METADATA_PAGE_SIZE IDs.
+ **/
+static JHDF5Metadata*
+H5VL_julea_db_metadata_prefetch(JHDF5Object_t* file, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GHashTable) space_ids = NULL;
+	g_autoptr(GHashTable) datatype_ids = NULL;
+	g_autoptr(GPtrArray) links = NULL;
+	g_autoptr(GPtrArray) datasets = NULL;
+	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(GPtrArray) attrs = NULL;
+	JHDF5Metadata* metadata;
+
+	metadata = g_new0(JHDF5Metadata, 1);
+	metadata->links = g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify)g_bytes_unref, (GDestroyNotify)g_bytes_unref);
+	metadata->chunks = g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify)g_bytes_unref, (GDestroyNotify)g_ptr_array_unref);
+
+	for (guint i = 0; i < _J_HDF5_OBJECT_TYPE_COUNT; i++)
+	{
+		metadata->rows[i] = g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify)g_bytes_unref, (GDestroyNotify)g_hash_table_unref);
+	}
+
+	space_ids = g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify)g_bytes_unref, NULL);
+	datatype_ids = g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify)g_bytes_unref, NULL);
+
+	if (!(links = H5VL_julea_db_metadata_query_file(file, julea_db_schema_link, error)))
+	{
+		j_goto_error();
+	}
+
+	for (guint i = 0; i < links->len; i++)
+	{
+		GHashTable* row = g_ptr_array_index(links, i);
+		JHDF5MetadataField const* parent;
+		JHDF5MetadataField const* parent_type;
+		JHDF5MetadataField const* name;
+
+		parent = H5VL_julea_db_metadata_peek_field(row, "parent");
+		parent_type = H5VL_julea_db_metadata_peek_field(row, "parent_type");
+		name = H5VL_julea_db_metadata_peek_field(row, "name");
+
+		g_hash_table_replace(metadata->links,
+				     H5VL_julea_db_metadata_link_key(parent->value, parent->length, parent_type->value, parent_type->length, name->value, strlen(name->value)),
+				     H5VL_julea_db_metadata_field_to_bytes(row, "child"));
+	}
+
+	if (!(datasets = H5VL_julea_db_metadata_query_file(file, julea_db_schema_dataset, error)))
+	{
+		j_goto_error();
+	}
+
+	H5VL_julea_db_metadata_add_rows(metadata, J_HDF5_OBJECT_TYPE_DATASET, datasets, space_ids, datatype_ids);
+
+	if (!(attrs = H5VL_julea_db_metadata_query_file(file, julea_db_schema_attr, error)))
+	{
+		j_goto_error();
+	}
+
+	H5VL_julea_db_metadata_add_rows(metadata, J_HDF5_OBJECT_TYPE_ATTR, attrs, space_ids, datatype_ids);
+
+	if (!(chunks = H5VL_julea_db_metadata_query_file(file, julea_db_schema_chunk, error)))
+	{
+		j_goto_error();
+	}
+
+	for (guint i = 0; i < chunks->len; i++)
+	{
+		GHashTable* row = g_ptr_array_index(chunks, i);
+		g_autoptr(GBytes) dataset = NULL;
+		GPtrArray* dataset_chunks;
+
+		dataset = H5VL_julea_db_metadata_field_to_bytes(row, "dataset");
+
+		if ((dataset_chunks = g_hash_table_lookup(metadata->chunks, dataset)) == NULL)
+		{
+			dataset_chunks = g_ptr_array_new_with_free_func((GDestroyNotify)g_hash_table_unref);
+			g_hash_table_insert(metadata->chunks, g_bytes_ref(dataset), dataset_chunks);
+		}
+
+		g_ptr_array_add(dataset_chunks, g_hash_table_ref(row));
+	}
+
+	if (!H5VL_julea_db_metadata_query_ids(metadata, J_HDF5_OBJECT_TYPE_SPACE, space_ids, error))
+	{
+		j_goto_error();
+	}
+
+	if (!H5VL_julea_db_metadata_query_ids(metadata, J_HDF5_OBJECT_TYPE_DATATYPE, datatype_ids, error))
+	{
+		j_goto_error();
+	}
+
+	return metadata;
+
+_error:
+	H5VL_julea_db_metadata_free(metadata);
+
+	return NULL;
+}
+
+/**
+ * Returns the file's metadata, prefetching it if necessary.
+ * Returns NULL if the metadata is not available, in which case the DB has to be queried directly.
+ **/
+static JHDF5Metadata*
+H5VL_julea_db_metadata_get(JHDF5Object_t* file)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GError) error = NULL;
+
+	g_return_val_if_fail(file->type == J_HDF5_OBJECT_TYPE_FILE, NULL);
+
+	if (file->file.metadata == NULL && file->file.prefetch)
+	{
+		// Only try once, failures fall back to querying the DB
+		file->file.prefetch = FALSE;
+
+		if (!(file->file.metadata = H5VL_julea_db_metadata_prefetch(file, &error)))
+		{
+			H5VL_julea_db_error_handler(error);
+		}
+	}
+
+	return file->file.metadata;
+}
+
+/**
+ * Looks up a link in the file's metadata and sets the child's ID.
+ * Returns FALSE if the link is not known, in which case the DB has to be queried.
+ **/
+static gboolean
+H5VL_julea_db_metadata_get_link(JHDF5Object_t* file, JHDF5Object_t* parent, const char* name, JHDF5Object_t* child)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GBytes) key = NULL;
+	JHDF5Metadata* metadata;
+	GBytes* child_id;
+	gsize child_id_len;
+	gconstpointer child_id_data;
+
+	if ((metadata = H5VL_julea_db_metadata_get(file)) == NULL)
+	{
+		return FALSE;
+	}
+
+	key = H5VL_julea_db_metadata_link_key(parent->backend_id, parent->backend_id_len, &parent->type, sizeof(parent->type), name, strlen(name));
+
+	if ((child_id = g_hash_table_lookup(metadata->links, key)) == NULL)
+	{
+		return FALSE;
+	}
+
+	child_id_data = g_bytes_get_data(child_id, &child_id_len);
+	child->backend_id = g_memdup2(child_id_data, child_id_len);
+	child->backend_id_len = child_id_len;
+
+	return TRUE;
+}
+
+/**
+ * Returns the row of the object with the given ID.
+ * The row is taken from the file's metadata if possible, otherwise the DB is queried.
+ * file may be NULL.
+ **/
+static GHashTable*
+H5VL_julea_db_metadata_get_row(JHDF5Object_t* file, JHDF5ObjectType type, gconstpointer id, guint64 id_len, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JDBSelector) selector = NULL;
+	g_autoptr(GPtrArray) rows = NULL;
+	JHDF5Metadata* metadata;
+	JDBSchema* schema;
+
+	if (file != NULL && (metadata = H5VL_julea_db_metadata_get(file)) != NULL)
+	{
+		g_autoptr(GBytes) key = NULL;
+		GHashTable* row;
+
+		key = g_bytes_new_static(id, id_len);
+
+		if ((row = g_hash_table_lookup(metadata->rows[type], key)) != NULL)
+		{
+			return g_hash_table_ref(row);
+		}
+	}
+
+	schema = H5VL_julea_db_metadata_schema(type);
+
+	if (!(selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, error)))
+	{
+		j_goto_error();
+	}
+
+	if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, id, id_len, error))
+	{
+		j_goto_error();
+	}
+
+	if (!(rows = H5VL_julea_db_metadata_query(schema, selector, error)))
+	{
+		j_goto_error();
+	}
+
+	if (rows->len != 1)
+	{
+		j_goto_error();
+	}
+
+	return g_hash_table_ref(g_ptr_array_index(rows, 0));
+
+_error:
+	return NULL;
+}
+
+/**
+ * Returns the chunk rows of a chunked dataset.
+ * The rows are taken from the file's metadata if possible, otherwise the DB is queried.
+ **/
+static GPtrArray*
+H5VL_julea_db_metadata_get_chunks(JHDF5Object_t* file, JHDF5Object_t* dataset, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(JDBSelector) selector = NULL;
+	JHDF5Metadata* metadata;
+
+	if ((metadata = H5VL_julea_db_metadata_get(file)) != NULL)
+	{
+		g_autoptr(GBytes) key = NULL;
+		GPtrArray* rows;
+
+		key = g_bytes_new_static(dataset->backend_id, dataset->backend_id_len);
+
+		// Datasets without written chunks do not have an entry
+		if ((rows = g_hash_table_lookup(metadata->chunks, key)) != NULL)
+		{
+			return g_ptr_array_ref(rows);
+		}
+
+		return g_ptr_array_new();
+	}
+
+	if (!(selector = j_db_selector_new(julea_db_schema_chunk, J_DB_SELECTOR_MODE_AND, error)))
+	{
+		return NULL;
+	}
+
+	if (!j_db_selector_add_field(selector, "dataset", J_DB_SELECTOR_OPERATOR_EQ, dataset->backend_id, dataset->backend_id_len, error))
+	{
+		return NULL;
+	}
+
+	return H5VL_julea_db_metadata_query(julea_db_schema_chunk, selector, error);
+}
+
+/**
+ * Copies a field of a row, similar to j_db_iterator_get_field().
+ **/
+static gboolean
+H5VL_julea_db_metadata_get_field(GHashTable* row, gchar const* name, JDBType* type, gpointer* value, guint64* length, GError** error)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5MetadataField const* field;
+
+	(void)error;
+
+	if ((field = H5VL_julea_db_metadata_peek_field(row, name)) == NULL)
+	{
+		return FALSE;
+	}
+
+	*type = field->type;
+	*value = g_memdup2(field->value, field->length);
+	*length = field->length;
+
+	return TRUE;
+}
+
+/**
+ * Discards the file's metadata after it has been modified.
+ * Metadata is not prefetched again for this file handle.
+ **/
+static void
+H5VL_julea_db_metadata_invalidate(JHDF5Object_t* file)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(file->type == J_HDF5_OBJECT_TYPE_FILE);
+
+	file->file.prefetch = FALSE;
+	g_clear_pointer(&file->file.metadata, H5VL_julea_db_metadata_free);
+}
+
+static void
+H5VL_julea_db_metadata_free(JHDF5Metadata* metadata)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (metadata == NULL)
+	{
+		return;
+	}
+
+	g_hash_table_unref(metadata->links);
+	g_hash_table_unref(metadata->chunks);
+
+	for (guint i = 0; i < _J_HDF5_OBJECT_TYPE_COUNT; i++)
+	{
+		g_hash_table_unref(metadata->rows[i]);
+	}
+
+	g_free(metadata);
+}
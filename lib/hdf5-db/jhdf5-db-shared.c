@@ -42,6 +42,9 @@
 
 #include "jhdf5-db.h"
 
+// Protects all ID caches, see H5VL_julea_db_id_cache_lookup()
+static GMutex julea_db_id_cache_mutex;
+
 static char*
 H5VL_julea_db_buf_to_hex(const char* prefix, const char* buf, guint buf_len)
 {
@@ -120,6 +123,7 @@ H5VL_julea_db_object_unref(JHDF5Object_t* object)
 		{
 			case J_HDF5_OBJECT_TYPE_FILE:
 				g_free(object->file.name);
+				H5VL_julea_db_metadata_free(object->file.metadata);
 				break;
 			case J_HDF5_OBJECT_TYPE_DATASET:
 				H5VL_julea_db_object_unref(object->dataset.file);
@@ -138,6 +142,13 @@ H5VL_julea_db_object_unref(JHDF5Object_t* object)
 					j_distributed_object_unref(object->dataset.object);
 				}
 
+				g_free(object->dataset.chunk_dims);
+
+				if (object->dataset.chunks)
+				{
+					g_hash_table_destroy(object->dataset.chunks);
+				}
+
 				break;
 			case J_HDF5_OBJECT_TYPE_ATTR:
 				H5VL_julea_db_object_unref(object->attr.file);
@@ -166,3 +177,65 @@ H5VL_julea_db_object_unref(JHDF5Object_t* object)
 		g_free(object);
 	}
 }
+
+/**
+ * Creates a cache that maps the encoding of a datatype or dataspace to the ID of its DB entry.
+ * The encoding's content is used as the key, equal datatypes and dataspaces share one entry.
+ **/
+static GHashTable*
+H5VL_julea_db_id_cache_new(void)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify)g_bytes_unref, (GDestroyNotify)g_bytes_unref);
+}
+
+/**
+ * Looks up the ID of an encoded datatype or dataspace and stores a copy in id.
+ * The caches are shared by all files of the process.
+ **/
+static gboolean
+H5VL_julea_db_id_cache_lookup(GHashTable* cache, gconstpointer data, gsize data_len, void** id, guint64* id_len)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GBytes) key = NULL;
+	GBytes* value;
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail(cache != NULL, FALSE);
+
+	key = g_bytes_new_static(data, data_len);
+
+	g_mutex_lock(&julea_db_id_cache_mutex);
+
+	if ((value = g_hash_table_lookup(cache, key)) != NULL)
+	{
+		gconstpointer value_data;
+		gsize value_len;
+
+		value_data = g_bytes_get_data(value, &value_len);
+		*id = g_memdup2(value_data, value_len);
+		*id_len = value_len;
+		ret = TRUE;
+	}
+
+	g_mutex_unlock(&julea_db_id_cache_mutex);
+
+	return ret;
+}
+
+/**
+ * Remembers the ID of an encoded datatype or dataspace once its entry is known to exist in the DB.
+ **/
+static void
+H5VL_julea_db_id_cache_insert(GHashTable* cache, gconstpointer data, gsize data_len, gconstpointer id, guint64 id_len)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_return_if_fail(cache != NULL);
+
+	g_mutex_lock(&julea_db_id_cache_mutex);
+	g_hash_table_replace(cache, g_bytes_new(data, data_len), g_bytes_new(id, id_len));
+	g_mutex_unlock(&julea_db_id_cache_mutex);
+}
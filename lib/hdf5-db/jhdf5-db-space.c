@@ -45,11 +45,20 @@
 static JDBSchema* julea_db_schema_space_header = NULL;
 static JDBSchema* julea_db_schema_space = NULL;
 
+// Maps encoded dataspaces to the IDs of their entries
+static GHashTable* julea_db_space_cache = NULL;
+
 static herr_t
 H5VL_julea_db_space_term(void)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	if (julea_db_space_cache != NULL)
+	{
+		g_hash_table_unref(julea_db_space_cache);
+		julea_db_space_cache = NULL;
+	}
+
 	if (julea_db_schema_space_header != NULL)
 	{
 		j_db_schema_unref(julea_db_schema_space_header);
@@ -75,6 +84,8 @@ H5VL_julea_db_space_init(hid_t vipl_id)
 
 	(void)vipl_id;
 
+	julea_db_space_cache = H5VL_julea_db_id_cache_new();
+
 	if (!(batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT)))
 	{
 		j_goto_error();
@@ -214,14 +225,13 @@ _error:
 }
 
 static JHDF5Object_t*
-H5VL_julea_db_space_decode(void* backend_id, guint64 backend_id_len)
+H5VL_julea_db_space_decode(JHDF5Object_t* file, void* backend_id, guint64 backend_id_len)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_autofree guint32* tmp_uint32 = NULL;
-	g_autoptr(JDBIterator) iterator = NULL;
+	g_autoptr(GHashTable) row = NULL;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(JDBSelector) selector = NULL;
 	JHDF5Object_t* object = NULL;
 	JDBType type;
 	guint64 length;
@@ -239,32 +249,17 @@ H5VL_julea_db_space_decode(void* backend_id, guint64 backend_id_len)
 	memcpy(object->backend_id, backend_id, backend_id_len);
 	object->backend_id_len = backend_id_len;
 
-	if (!(selector = j_db_selector_new(julea_db_schema_space_header, J_DB_SELECTOR_MODE_AND, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_selector_add_field(selector, "_id", J_DB_SELECTOR_OPERATOR_EQ, object->backend_id, object->backend_id_len, &error))
-	{
-		j_goto_error();
-	}
-
-	if (!(iterator = j_db_iterator_new(julea_db_schema_space_header, selector, &error)))
-	{
-		j_goto_error();
-	}
-
-	if (!j_db_iterator_next(iterator, NULL))
+	if (!(row = H5VL_julea_db_metadata_get_row(file, J_HDF5_OBJECT_TYPE_SPACE, object->backend_id, object->backend_id_len, &error)))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "dim_cache", &type, &object->space.data, &object->space.data_size, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "dim_cache", &type, &object->space.data, &object->space.data_size, &error))
 	{
 		j_goto_error();
 	}
 
-	if (!j_db_iterator_get_field(iterator, "dim_total_count", &type, (gpointer*)&tmp_uint32, &length, &error))
+	if (!H5VL_julea_db_metadata_get_field(row, "dim_total_count", &type, (gpointer*)&tmp_uint32, &length, &error))
 	{
 		j_goto_error();
 	}
@@ -272,6 +267,9 @@ H5VL_julea_db_space_decode(void* backend_id, guint64 backend_id_len)
 	object->space.dim_total_count = *tmp_uint32;
 	object->space.hdf5_id = H5Sdecode(object->space.data);
 
+	// Known entries can be reused when encoding equal dataspaces
+	H5VL_julea_db_id_cache_insert(julea_db_space_cache, object->space.data, object->space.data_size, object->backend_id, object->backend_id_len);
+
 	return object;
 
 _error:
@@ -351,6 +349,11 @@ H5VL_julea_db_space_encode(hid_t* type_id)
 	object->space.hdf5_id = *type_id;
 	object->space.dim_total_count = element_count;
 
+	if (H5VL_julea_db_id_cache_lookup(julea_db_space_cache, object->space.data, size, &object->backend_id, &object->backend_id_len))
+	{
+		goto _done;
+	}
+
 	//check if this space exists
 	if (!(selector = j_db_selector_new(julea_db_schema_space_header, J_DB_SELECTOR_MODE_AND, &error)))
 	{
@@ -374,6 +377,8 @@ H5VL_julea_db_space_encode(hid_t* type_id)
 			j_goto_error();
 		}
 
+		H5VL_julea_db_id_cache_insert(julea_db_space_cache, object->space.data, size, object->backend_id, object->backend_id_len);
+
 		goto _done;
 	}
 
@@ -448,13 +453,16 @@ H5VL_julea_db_space_encode(hid_t* type_id)
 		{
 			j_goto_error();
 		}
+	}
 
-		if (!j_batch_execute(batch))
-		{
-			j_goto_error();
-		}
+	// The dimensions are inserted using one batch
+	if (stored_ndims > 0 && !j_batch_execute(batch))
+	{
+		j_goto_error();
 	}
 
+	H5VL_julea_db_id_cache_insert(julea_db_space_cache, object->space.data, size, object->backend_id, object->backend_id_len);
+
 _done:
 	return object;
 
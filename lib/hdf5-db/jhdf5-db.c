@@ -63,7 +63,9 @@ static herr_t H5VL_julea_db_link_term(void);
 #include "jhdf5-db.h"
 
 // FIXME order is important
+#include "jhdf5-db-log.c"
 #include "jhdf5-db-shared.c"
+#include "../hdf5/jhdf5-request.c"
 #include "jhdf5-db-link.c"
 #include "jhdf5-db-group.c"
 #include "jhdf5-db-datatype.c"
@@ -71,6 +73,8 @@ static herr_t H5VL_julea_db_link_term(void);
 #include "jhdf5-db-attr.c"
 #include "jhdf5-db-dataset.c"
 #include "jhdf5-db-file.c"
+// Needs the schemas of all other parts
+#include "jhdf5-db-metadata.c"
 
 #define _GNU_SOURCE
 
@@ -123,6 +127,8 @@ H5VL_julea_db_init(hid_t vipl_id)
 		goto _error_link;
 	}
 
+	H5VL_julea_db_log_init();
+
 	return 0;
 
 _error_link:
@@ -154,6 +160,8 @@ H5VL_julea_db_term(void)
 {
 	J_TRACE_FUNCTION(NULL);
 
+	H5VL_julea_db_log_term();
+
 	if (H5VL_julea_db_link_term())
 	{
 		j_goto_error();
@@ -212,10 +220,8 @@ static herr_t
 H5VL_julea_db_introspect_opt_query(void* obj, H5VL_subclass_t cls, int opt_type, hbool_t* supported)
 {
 	(void)obj;
-	(void)cls;
-	(void)opt_type;
 
-	*supported = FALSE;
+	*supported = (cls == H5VL_SUBCLS_DATASET && opt_type == J_HDF5_DATASET_OPTIONAL_QUERY_RANGE);
 
 	return 0;
 }
@@ -309,12 +315,12 @@ static const H5VL_class_t H5VL_julea_db_g = {
 		.opt_query = H5VL_julea_db_introspect_opt_query,
 	},
 	.request_cls = {
-		.wait = NULL,
-		.notify = NULL,
-		.cancel = NULL,
+		.wait = H5VL_julea_request_wait,
+		.notify = H5VL_julea_request_notify,
+		.cancel = H5VL_julea_request_cancel,
 		.specific = NULL,
 		.optional = NULL,
-		.free = NULL,
+		.free = H5VL_julea_request_free,
 	},
 	.blob_cls = {
 		.put = NULL,
@@ -360,6 +366,8 @@ j_hdf5_init(void)
 static void
 j_hdf5_fini(void)
 {
+	// Applications might exit without terminating the plugin
+	H5VL_julea_db_log_term();
 }
 
 void
@@ -370,165 +378,47 @@ j_hdf5_set_semantics(JSemantics* semantics)
 	//FIXME implement this
 }
 
+static herr_t
+j_hdf5_dataset_optional(hid_t dataset, H5VL_dataset_optional_t opt_type, ...)
+{
+	va_list arguments;
+	hid_t connector_id;
+	herr_t ret;
 
-#define JULEA_LOGFILE_ENDING "_JULEA_LOG.log"
-char* j_get_logname(const char *filename){
-	//filename = replacestring(replacestring(filename, "\\", "/"), "//", "/");
-	filename = j_helper_str_replace(j_helper_str_replace(filename, "\\", "/"), "//", "/");
-	char *name = malloc(strlen(filename)*sizeof(char));
-	if(strcmp(filename+strlen(filename)-1, "/") == 0){
-		sprintf(name, "%d%s", rand(), JULEA_LOGFILE_ENDING);
-		strcat(filename, name);
-	} else {
-		char *oldname = strrchr(filename, '/');
-		//printf("%s\n", oldname == NULL ? "filename" : "oldname");
-		char *last = strrchr(oldname == NULL ? filename : oldname+1, '.');
-		if(last){
-			//filename = replacestring(filename, last, JULEA_LOGFILE_ENDING);
-			filename = j_helper_str_replace(filename, last, JULEA_LOGFILE_ENDING);
-		} else {
-			strcat(filename, JULEA_LOGFILE_ENDING);
-		}
+	if ((connector_id = H5VLget_connector_id(dataset)) < 0)
+	{
+		return -1;
 	}
-	free(name);
-	return filename;
-}
 
-static void j_hdf5_log(char* _filename, char *mode, char operation, const char *message, JHDF5Object_t *object, JHDF5Object_t *parent){
-	const char *logtypes = getenv("JULEA_HDF5_LOG_TYPES");
-	const char *logoperations = getenv("JULEA_HDF5_LOG_OPERATIONS");
-	const char *logvariant = getenv("JULEA_HDF5_LOG_VARIANT");
+	va_start(arguments, opt_type);
+	ret = H5VLdataset_optional(H5VLobject(dataset), connector_id, opt_type, H5P_DATASET_XFER_DEFAULT, NULL, arguments);
+	va_end(arguments);
 
-	//printf("logtypes: %s, logoperations: %s, logvariant: %s\n", logtypes, logoperations, logvariant);
-	if(logtypes == NULL || logoperations == NULL || logvariant == NULL){
-		//printf("environment variables not set\n");
-		return;
-	}
+	H5VLclose(connector_id);
 
-	char *filename = strdup(_filename);
-
-	//printf("oldname: %s\n", filename);
-	filename = j_get_logname(filename);
-	//printf("newname: %s\n", filename);
-	if(!object)
-		return;
-
-	char objecttype = ' ';
-	char *name = NULL;
-	char *parentname = NULL;
-	if(parent != NULL){
-		switch(parent->type)
-		{
-			case J_HDF5_OBJECT_TYPE_FILE:
-				parentname = strdup(parent->file.name);
-				break;
-			case J_HDF5_OBJECT_TYPE_DATASET:
-				parentname = strdup(parent->dataset.name);
-				break;
-			case J_HDF5_OBJECT_TYPE_ATTR:
-				parentname = strdup(parent->attr.name);
-				break;
-			case J_HDF5_OBJECT_TYPE_GROUP:
-				parentname = strdup(parent->group.name);
-				break;
-		}
-	}
+	return ret;
+}
+
+/**
+ * Returns a copy of the dataset's dataspace with all elements selected that might be within [min, max].
+ * Connectors without support for range queries select the whole dataspace.
+ **/
+hid_t
+j_hdf5_dataset_query_range(hid_t dataset, gdouble min, gdouble max)
+{
+	hid_t space_id = H5I_INVALID_HID;
+	herr_t ret;
 
-	switch(object->type)
+	H5E_BEGIN_TRY
 	{
-		case J_HDF5_OBJECT_TYPE_FILE:
-			objecttype = 'F';
-			name = strdup(object->file.name);
-			break;
-		case J_HDF5_OBJECT_TYPE_DATASET:
-			objecttype = 'D';
-			name = strdup(object->dataset.name);
-			break;
-		case J_HDF5_OBJECT_TYPE_ATTR:
-			objecttype = 'A';
-			name = strdup(object->attr.name);
-			break;
-		case J_HDF5_OBJECT_TYPE_GROUP:
-			objecttype = 'G';
-			name = strdup(object->group.name);
-			break;
-		case J_HDF5_OBJECT_TYPE_DATATYPE:
-			objecttype = 'T';
-			name = "A datatype has no name";
-			break;
-		case J_HDF5_OBJECT_TYPE_SPACE:
-			objecttype = 'S';
-			name = "A space has no name";
-			break;
-		case _J_HDF5_OBJECT_TYPE_COUNT:
-			objecttype = 'C';
-			name = "A count has no name";
-			break;
-		default:
-			printf("J_HDF5_OBJECT_TYPE '%i' not definded\n", object->type);
-			g_assert_not_reached();
-			j_goto_error();
+		ret = j_hdf5_dataset_optional(dataset, J_HDF5_DATASET_OPTIONAL_QUERY_RANGE, min, max, &space_id);
 	}
+	H5E_END_TRY;
 
-	if(((strcmp(logtypes, "All") == 0 || strchr(logtypes, objecttype)) && (strcmp(logoperations, "All") == 0 || strchr(logoperations, operation))) || (strcmp(logvariant, "G") == 0 && objecttype == 'F' && operation == 'C' || operation == 'S')){
-		if(strcmp(logvariant, "F") == 0){
-			FILE *fp = fopen(filename, mode);
-			if(fp == NULL){
-				g_debug("JULEA logfile \"%s\" could not be opened\n", filename);
-			} else{
-				 if(operation == 'C' && objecttype != 'F')
-					fprintf(fp, "[%c]\t[%c - %s(%i) -> %s(%i)]\t%s\n", operation, objecttype, parentname, *(const gint32*) parent->backend_id, name, *(const gint32*) object->backend_id, message ? message : "");
-				else
-					fprintf(fp, "[%c]\t[%c - %s(%i)]\t%s\n", operation, objecttype, name,*(const gint32*) object->backend_id, message ? message : "");
-				fclose(fp);
-			}
-		}
-		if(strcmp(logvariant, "G") == 0){
-			FILE *fp = fopen(filename, mode);
-			if(fp == NULL){
-				g_debug("JULEA logfile \"%s\" could not be opened\n", filename);
-			} else {
-				switch(operation)
-				{
-					case 'C':
-						if(objecttype == 'F'){
-							fprintf(fp, "digraph g { \"%s%i\" [label=\"/\"];\n", name, *(const gint32*) object->backend_id);
-						} else{
-							const char *linkformat =  "\"%s%i\" -> \"%s%i\" [label=\"%s\"%s];\n";
-							const char *labelformat = "\"%s%i\" [label=\"%s\"%s];\n";
-							char *linkstyle = NULL;
-							char *labelstyle = NULL;
-							if(objecttype == 'A'){
-								linkstyle = ", style=dotted";
-							} else if(objecttype == 'D'){
-								labelstyle = ", shape=box";
-							}
-							fprintf(fp, labelformat, name, *(const gint32*) object->backend_id, "", labelstyle ? labelstyle : ""); 
-							fprintf(fp, linkformat, parentname,*(const gint32*) parent->backend_id, name, *(const gint32*) object->backend_id, name, linkstyle ? linkstyle : "");
-						}
-						break;
-					case 'W':
-						fprintf(fp, "\"%s%i\" [style=filled];\n", name, *(const gint32*) object->backend_id);
-						break;
-					case 'S':
-						if(objecttype == 'F')
-							fprintf(fp, "}");
-						break;
-				}
-				fclose(fp);
-			}
-		}
-		if(strcmp(logvariant, "D") == 0){
-			g_debug("[%c]\t[%c - %s]\t%s\n", operation, objecttype, name, message ? message : "");
-		}
+	if (ret < 0)
+	{
+		return H5Dget_space(dataset);
 	}
 
-	free(name);
-	free(filename);
-	if(parentname)
-		free(parentname);
-	return;
-_error:
-	g_debug("j_hdf5_log HDF5_OBJECTTYPE '%i' not defined", object->type);
-	return;
+	return space_id;
 }
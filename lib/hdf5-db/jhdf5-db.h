@@ -43,6 +43,48 @@ enum JHDF5ObjectType
 
 typedef enum JHDF5ObjectType JHDF5ObjectType;
 
+/**
+ * Filters that can be applied to the chunks of a chunked dataset.
+ * They are derived from the dataset creation property list's filter pipeline.
+ **/
+enum JHDF5Filter
+{
+	J_HDF5_FILTER_SHUFFLE = 1 << 0,
+	J_HDF5_FILTER_LZ4 = 1 << 1,
+	J_HDF5_FILTER_ZSTD = 1 << 2
+};
+
+typedef enum JHDF5Filter JHDF5Filter;
+
+/**
+ * Minimum and maximum values of a dataset or chunk.
+ * Integer types use the _i fields, floating point types use the _f fields.
+ **/
+struct JHDF5Statistics
+{
+	gint64 min_value_i;
+	gdouble min_value_f;
+	gint64 max_value_i;
+	gdouble max_value_f;
+};
+
+typedef struct JHDF5Statistics JHDF5Statistics;
+
+/**
+ * An entry of the chunk index, see H5VL_julea_db_dataset_chunk_write().
+ **/
+struct JHDF5ChunkInfo
+{
+	// The size of the stored chunk in bytes
+	guint64 size;
+	// The zone map of the chunk
+	JHDF5Statistics statistics;
+};
+
+typedef struct JHDF5ChunkInfo JHDF5ChunkInfo;
+
+typedef struct JHDF5Metadata JHDF5Metadata;
+
 typedef struct JHDF5Object_t JHDF5Object_t;
 struct JHDF5Object_t
 {
@@ -55,6 +97,10 @@ struct JHDF5Object_t
 		struct
 		{
 			char* name;
+			// Metadata of the whole file, see H5VL_julea_db_metadata_prefetch()
+			JHDF5Metadata* metadata;
+			// Whether metadata should be prefetched, this is disabled once the file has been modified
+			gboolean prefetch;
 		} file;
 		struct
 		{
@@ -64,13 +110,16 @@ struct JHDF5Object_t
 			JHDF5Object_t* space;
 			JDistribution* distribution;
 			JDistributedObject* object;
-			struct
-			{
-				gint64 min_value_i;
-				gdouble min_value_f;
-				gint64 max_value_i;
-				gdouble max_value_f;
-			} statistics;
+			// Chunked datasets store each chunk as a separate object, chunk_dims is NULL for contiguous datasets
+			hsize_t* chunk_dims;
+			// Indices of the chunks that have been written mapped to their JHDF5ChunkInfo
+			GHashTable* chunks;
+			// Filters applied to each chunk, see JHDF5Filter
+			guint32 filters;
+			gint32 filter_level;
+			JHDF5Statistics statistics;
+			// Whether the statistics have to be stored when closing the dataset
+			gboolean statistics_changed;
 		} dataset;
 		struct
 		{
@@ -115,6 +164,31 @@ H5VL_julea_db_object_ref(JHDF5Object_t* object);
 static void
 H5VL_julea_db_object_unref(JHDF5Object_t* object);
 
+static GHashTable*
+H5VL_julea_db_id_cache_new(void);
+static gboolean
+H5VL_julea_db_id_cache_lookup(GHashTable* cache, gconstpointer data, gsize data_len, void** id, guint64* id_len);
+static void
+H5VL_julea_db_id_cache_insert(GHashTable* cache, gconstpointer data, gsize data_len, gconstpointer id, guint64 id_len);
+
+static gboolean
+H5VL_julea_db_metadata_get_link(JHDF5Object_t* file, JHDF5Object_t* parent, const char* name, JHDF5Object_t* child);
+static GPtrArray*
+H5VL_julea_db_metadata_query(JDBSchema* schema, JDBSelector* selector, GError** error);
+static GHashTable*
+H5VL_julea_db_metadata_get_row(JHDF5Object_t* file, JHDF5ObjectType type, gconstpointer id, guint64 id_len, GError** error);
+static GPtrArray*
+H5VL_julea_db_metadata_get_chunks(JHDF5Object_t* file, JHDF5Object_t* dataset, GError** error);
+static gboolean
+H5VL_julea_db_metadata_get_field(GHashTable* row, gchar const* name, JDBType* type, gpointer* value, guint64* length, GError** error);
+static void
+H5VL_julea_db_metadata_invalidate(JHDF5Object_t* file);
+static void
+H5VL_julea_db_metadata_free(JHDF5Metadata* metadata);
+
+static void
+H5VL_julea_db_log(gchar operation, JHDF5Object_t* object, JHDF5Object_t* parent, guint64 bytes);
+
 #define j_goto_error() \
 	do \
 	{ \
@@ -125,4 +199,3 @@ H5VL_julea_db_object_unref(JHDF5Object_t* object);
 
 #endif
 
-static void j_hdf5_log(char *_filename, char *mode, char operation, const char *message, JHDF5Object_t *object, JHDF5Object_t *parent);
@@ -0,0 +1,254 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2021 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ **/
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <hdf5.h>
+#include <H5PLextern.h>
+
+#include <julea.h>
+
+// HDF5 1.12.1 replaced H5ES_status_t with H5VL_request_status_t for requests
+#if H5_VERSION_GE(1, 12, 1)
+typedef H5VL_request_status_t JHDF5RequestStatus;
+#define J_HDF5_REQUEST_IN_PROGRESS H5VL_REQUEST_STATUS_IN_PROGRESS
+#define J_HDF5_REQUEST_SUCCEED H5VL_REQUEST_STATUS_SUCCEED
+#define J_HDF5_REQUEST_FAIL H5VL_REQUEST_STATUS_FAIL
+#else
+typedef H5ES_status_t JHDF5RequestStatus;
+#define J_HDF5_REQUEST_IN_PROGRESS H5ES_STATUS_IN_PROGRESS
+#define J_HDF5_REQUEST_SUCCEED H5ES_STATUS_SUCCEED
+#define J_HDF5_REQUEST_FAIL H5ES_STATUS_FAIL
+#endif
+
+/**
+ * Runs on the application's thread once the batch of a request has completed, for instance to convert data.
+ **/
+typedef gboolean (*JHDF5RequestFunc)(gpointer data);
+
+/**
+ * An asynchronous operation that has been handed to HDF5 via the req argument.
+ * The batch is executed in the background, everything that involves HDF5 happens on the application's thread when the request is waited for.
+ **/
+struct JHDF5Request_t
+{
+	JBatch* batch;
+	JHDF5RequestFunc func;
+	gpointer data;
+	GDestroyNotify free_func;
+	H5VL_request_notify_t notify;
+	void* notify_ctx;
+	GMutex mutex[1];
+	GCond cond[1];
+	// Set by the background operation once the batch has been executed
+	gboolean executed;
+	// Set once func and notify have run
+	gboolean completed;
+	gboolean ret;
+};
+
+typedef struct JHDF5Request_t JHDF5Request_t;
+
+static void
+H5VL_julea_request_executed(JBatch* batch, gboolean ret, gpointer user_data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Request_t* request = user_data;
+
+	(void)batch;
+
+	g_mutex_lock(request->mutex);
+	request->executed = TRUE;
+	request->ret = ret;
+	g_cond_broadcast(request->cond);
+	g_mutex_unlock(request->mutex);
+}
+
+/**
+ * Finishes an executed request on the application's thread.
+ **/
+static JHDF5RequestStatus
+H5VL_julea_request_complete(JHDF5Request_t* request)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	if (!request->completed)
+	{
+		request->completed = TRUE;
+		j_batch_wait(request->batch);
+
+		if (request->ret && request->func != NULL)
+		{
+			request->ret = request->func(request->data);
+		}
+
+		if (request->notify != NULL)
+		{
+			request->notify(request->notify_ctx, request->ret ? J_HDF5_REQUEST_SUCCEED : J_HDF5_REQUEST_FAIL);
+		}
+	}
+
+	return request->ret ? J_HDF5_REQUEST_SUCCEED : J_HDF5_REQUEST_FAIL;
+}
+
+/**
+ * Executes batch asynchronously and returns a request for HDF5.
+ * func is called with data once the batch has been executed successfully, free_func frees data when the request is freed.
+ **/
+static JHDF5Request_t*
+H5VL_julea_request_new(JBatch* batch, JHDF5RequestFunc func, gpointer data, GDestroyNotify free_func)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Request_t* request;
+
+	request = g_new0(JHDF5Request_t, 1);
+	request->batch = j_batch_ref(batch);
+	request->func = func;
+	request->data = data;
+	request->free_func = free_func;
+	g_mutex_init(request->mutex);
+	g_cond_init(request->cond);
+
+	j_batch_execute_async(batch, H5VL_julea_request_executed, request);
+
+	return request;
+}
+
+/**
+ * Waits for a request, timeout is given in nanoseconds.
+ **/
+static herr_t
+H5VL_julea_request_wait(void* req, uint64_t timeout, JHDF5RequestStatus* status)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Request_t* request = req;
+	gboolean executed;
+
+	g_mutex_lock(request->mutex);
+
+	if (timeout == G_MAXUINT64)
+	{
+		while (!request->executed)
+		{
+			g_cond_wait(request->cond, request->mutex);
+		}
+	}
+	else
+	{
+		gint64 end_time;
+
+		end_time = g_get_monotonic_time() + timeout / 1000;
+
+		while (!request->executed && g_cond_wait_until(request->cond, request->mutex, end_time))
+		{
+		}
+	}
+
+	executed = request->executed;
+	g_mutex_unlock(request->mutex);
+
+	*status = (executed) ? H5VL_julea_request_complete(request) : J_HDF5_REQUEST_IN_PROGRESS;
+
+	return 0;
+}
+
+/**
+ * Registers a callback for a request.
+ * Because HDF5 is not thread-safe, the callback is invoked on the application's thread when the request is waited for.
+ **/
+static herr_t
+H5VL_julea_request_notify(void* req, H5VL_request_notify_t cb, void* ctx)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Request_t* request = req;
+	gboolean executed;
+
+	request->notify = cb;
+	request->notify_ctx = ctx;
+
+	g_mutex_lock(request->mutex);
+	executed = request->executed;
+	g_mutex_unlock(request->mutex);
+
+	if (executed)
+	{
+		H5VL_julea_request_complete(request);
+	}
+
+	return 0;
+}
+
+/**
+ * Batches can not be cancelled once they have been started.
+ **/
+#if H5_VERSION_GE(1, 12, 1)
+static herr_t
+H5VL_julea_request_cancel(void* req, JHDF5RequestStatus* status)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	(void)req;
+
+	*status = H5VL_REQUEST_STATUS_CANT_CANCEL;
+
+	return 0;
+}
+#else
+static herr_t
+H5VL_julea_request_cancel(void* req)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	(void)req;
+
+	return -1;
+}
+#endif
+
+static herr_t
+H5VL_julea_request_free(void* req)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JHDF5Request_t* request = req;
+
+	// The batch might still reference the request and its data
+	j_batch_wait(request->batch);
+	j_batch_unref(request->batch);
+
+	if (request->free_func != NULL)
+	{
+		request->free_func(request->data);
+	}
+
+	g_cond_clear(request->cond);
+	g_mutex_clear(request->mutex);
+	g_free(request);
+
+	return 0;
+}
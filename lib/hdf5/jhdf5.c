@@ -47,6 +47,8 @@
 #include <julea-kv.h>
 #include <julea-object.h>
 
+#include "jhdf5-request.c"
+
 #define _GNU_SOURCE
 
 #define JULEA 520
@@ -84,6 +86,9 @@ struct JHD_t
 	char* location;
 	char* name;
 	size_t data_size;
+	// The dataset's dataspace with everything selected and the size of its elements, used to map selections to the object
+	hid_t space_id;
+	size_t type_size;
 	JDistribution* distribution;
 	JDistributedObject* object;
 	JKV* kv;
@@ -1196,6 +1201,9 @@ H5VL_julea_dataset_create(void* obj, const H5VL_loc_params_t* loc_params, const
 	g_free(dims);
 
 	dset->data_size = data_size;
+	dset->type_size = H5Tget_size(type_id);
+	dset->space_id = H5Scopy(space_id);
+	H5Sselect_all(dset->space_id);
 
 	batch = j_batch_new(j_hdf5_semantics);
 
@@ -1281,6 +1289,8 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 
 	dset = g_new(JHD_t, 1);
 	dset->name = g_strdup(name);
+	dset->space_id = H5I_INVALID_HID;
+	dset->type_size = 0;
 
 	switch (loc_params->obj_type)
 	{
@@ -1328,9 +1338,24 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 	if (j_batch_execute(batch))
 	{
 		bson_t kvdata[1];
+		void* space;
+		void* type;
+		hid_t type_id;
 
 		bson_init_static(kvdata, value, len);
 		j_hdf5_deserialize_dataset(kvdata, dset, &(dset->data_size));
+
+		space = j_hdf5_deserialize_space(kvdata);
+		dset->space_id = H5Sdecode(space);
+		H5Sselect_all(dset->space_id);
+		free(space);
+
+		type = j_hdf5_deserialize_type(kvdata);
+		type_id = H5Tdecode(type);
+		dset->type_size = H5Tget_size(type_id);
+		H5Tclose(type_id);
+		free(type);
+
 		g_free(value);
 	}
 
@@ -1339,17 +1364,184 @@ H5VL_julea_dataset_open(void* obj, const H5VL_loc_params_t* loc_params, const ch
 	return dset;
 }
 
+/**
+ * A contiguous part of a selection, offset and length are given in bytes
+ **/
+struct JHDF5Extent
+{
+	guint64 offset;
+	guint64 length;
+};
+
+typedef struct JHDF5Extent JHDF5Extent;
+
+/**
+ * Returns the selection of a dataspace as extents in selection order
+ **/
+static GArray*
+j_hdf5_selection_extents(hid_t space_id, size_t type_size)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	GArray* extents;
+	hid_t iter_id;
+	hsize_t offsets[64];
+	size_t lengths[64];
+	size_t nseq;
+	size_t nbytes;
+
+	extents = g_array_new(FALSE, FALSE, sizeof(JHDF5Extent));
+
+	if ((iter_id = H5Ssel_iter_create(space_id, type_size, 0)) < 0)
+	{
+		g_array_free(extents, TRUE);
+		return NULL;
+	}
+
+	do
+	{
+		if (H5Ssel_iter_get_seq_list(iter_id, G_N_ELEMENTS(offsets), SIZE_MAX, &nseq, &nbytes, offsets, lengths) < 0)
+		{
+			H5Ssel_iter_close(iter_id);
+			g_array_free(extents, TRUE);
+			return NULL;
+		}
+
+		for (guint i = 0; i < nseq; i++)
+		{
+			JHDF5Extent extent = { offsets[i], lengths[i] };
+
+			g_array_append_val(extents, extent);
+		}
+	} while (nseq > 0);
+
+	H5Ssel_iter_close(iter_id);
+
+	return extents;
+}
+
+/**
+ * Adds the reads or writes needed to transfer the selected elements to batch
+ *
+ * The memory and file selections are mapped to pairs of extents, pairs that are contiguous in memory and in the object are coalesced.
+ * All operations are added to the same batch, which sends one message per server and contacts the servers in parallel.
+ *
+ * \return TRUE if the selections could be mapped, FALSE otherwise
+ **/
+static gboolean
+j_hdf5_dataset_transfer(JHD_t* d, hid_t mem_space_id, hid_t file_space_id, gpointer buf, gboolean write, guint64* bytes, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	g_autoptr(GArray) mem_extents = NULL;
+	g_autoptr(GArray) file_extents = NULL;
+	guint mem_index = 0;
+	guint file_index = 0;
+	guint64 mem_done = 0;
+	guint64 file_done = 0;
+	guint64 pending_mem_offset = 0;
+	guint64 pending_file_offset = 0;
+	guint64 pending_length = 0;
+
+	// H5S_ALL selects the whole dataset in the file and uses the file selection for memory
+	if (file_space_id == H5S_ALL)
+	{
+		file_space_id = d->space_id;
+	}
+
+	if (mem_space_id == H5S_ALL)
+	{
+		mem_space_id = file_space_id;
+	}
+
+	if (file_space_id < 0 || H5Sget_select_npoints(mem_space_id) != H5Sget_select_npoints(file_space_id))
+	{
+		return FALSE;
+	}
+
+	if ((mem_extents = j_hdf5_selection_extents(mem_space_id, d->type_size)) == NULL || (file_extents = j_hdf5_selection_extents(file_space_id, d->type_size)) == NULL)
+	{
+		return FALSE;
+	}
+
+	while (mem_index < mem_extents->len && file_index < file_extents->len)
+	{
+		JHDF5Extent* mem_extent = &g_array_index(mem_extents, JHDF5Extent, mem_index);
+		JHDF5Extent* file_extent = &g_array_index(file_extents, JHDF5Extent, file_index);
+		guint64 mem_offset;
+		guint64 file_offset;
+		guint64 length;
+
+		mem_offset = mem_extent->offset + mem_done;
+		file_offset = file_extent->offset + file_done;
+		length = MIN(mem_extent->length - mem_done, file_extent->length - file_done);
+
+		if (pending_length > 0 && pending_mem_offset + pending_length == mem_offset && pending_file_offset + pending_length == file_offset)
+		{
+			pending_length += length;
+		}
+		else
+		{
+			if (pending_length > 0)
+			{
+				if (write)
+				{
+					j_distributed_object_write(d->object, (gchar const*)buf + pending_mem_offset, pending_length, pending_file_offset, bytes, batch);
+				}
+				else
+				{
+					j_distributed_object_read(d->object, (gchar*)buf + pending_mem_offset, pending_length, pending_file_offset, bytes, batch);
+				}
+			}
+
+			pending_mem_offset = mem_offset;
+			pending_file_offset = file_offset;
+			pending_length = length;
+		}
+
+		mem_done += length;
+		file_done += length;
+
+		if (mem_done == mem_extent->length)
+		{
+			mem_index++;
+			mem_done = 0;
+		}
+
+		if (file_done == file_extent->length)
+		{
+			file_index++;
+			file_done = 0;
+		}
+	}
+
+	if (pending_length > 0)
+	{
+		if (write)
+		{
+			j_distributed_object_write(d->object, (gchar const*)buf + pending_mem_offset, pending_length, pending_file_offset, bytes, batch);
+		}
+		else
+		{
+			j_distributed_object_read(d->object, (gchar*)buf + pending_mem_offset, pending_length, pending_file_offset, bytes, batch);
+		}
+	}
+
+	return TRUE;
+}
+
 /**
  * Reads the data from the dataset
  **/
 static herr_t
-H5VL_julea_dataset_read(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id __attribute__((unused)), hid_t file_space_id __attribute__((unused)), hid_t plist_id __attribute__((unused)), void* buf, void** req __attribute__((unused)))
+H5VL_julea_dataset_read(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id, hid_t file_space_id, hid_t plist_id __attribute__((unused)), void* buf, void** req)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_autoptr(JBatch) batch = NULL;
 	JHD_t* d;
 	guint64 bytes_read;
+	guint64* bytes = &bytes_read;
 
 	d = (JHD_t*)dset;
 
@@ -1361,7 +1553,28 @@ H5VL_julea_dataset_read(void* dset, hid_t mem_type_id __attribute__((unused)), h
 
 	g_assert(d->object != NULL);
 
-	j_distributed_object_read(d->object, buf, d->data_size, 0, &bytes_read, batch);
+	// The number of bytes is written when the request is executed, it has to outlive this function
+	if (req != NULL)
+	{
+		bytes = g_new0(guint64, 1);
+	}
+
+	if (!j_hdf5_dataset_transfer(d, mem_space_id, file_space_id, buf, FALSE, bytes, batch))
+	{
+		if (req != NULL)
+		{
+			g_free(bytes);
+		}
+
+		return -1;
+	}
+
+	if (req != NULL)
+	{
+		*req = H5VL_julea_request_new(batch, NULL, bytes, g_free);
+
+		return 1;
+	}
 
 	if (!j_batch_execute(batch))
 	{
@@ -1450,13 +1663,14 @@ H5VL_julea_dataset_get(void* dset, H5VL_dataset_get_t get_type, hid_t dxpl_id __
  * Writes the data to the dataset
  **/
 static herr_t
-H5VL_julea_dataset_write(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id __attribute__((unused)), hid_t file_space_id __attribute__((unused)), hid_t plist_id __attribute__((unused)), const void* buf, void** req __attribute__((unused)))
+H5VL_julea_dataset_write(void* dset, hid_t mem_type_id __attribute__((unused)), hid_t mem_space_id, hid_t file_space_id, hid_t plist_id __attribute__((unused)), const void* buf, void** req)
 {
 	J_TRACE_FUNCTION(NULL);
 
 	g_autoptr(JBatch) batch = NULL;
 	JHD_t* d;
 	guint64 bytes_written;
+	guint64* bytes = &bytes_written;
 
 	d = (JHD_t*)dset;
 
@@ -1464,7 +1678,29 @@ H5VL_julea_dataset_write(void* dset, hid_t mem_type_id __attribute__((unused)),
 
 	bytes_written = 0;
 
-	j_distributed_object_write(d->object, buf, d->data_size, 0, &bytes_written, batch);
+	// The number of bytes is written when the request is executed, it has to outlive this function
+	if (req != NULL)
+	{
+		bytes = g_new0(guint64, 1);
+	}
+
+	// The buffer is only read from
+	if (!j_hdf5_dataset_transfer(d, mem_space_id, file_space_id, (gpointer)buf, TRUE, bytes, batch))
+	{
+		if (req != NULL)
+		{
+			g_free(bytes);
+		}
+
+		return -1;
+	}
+
+	if (req != NULL)
+	{
+		*req = H5VL_julea_request_new(batch, NULL, bytes, g_free);
+
+		return 1;
+	}
 
 	if (!j_batch_execute(batch))
 	{
@@ -1496,6 +1732,11 @@ H5VL_julea_dataset_close(void* dset, hid_t dxpl_id __attribute__((unused)), void
 		j_distributed_object_unref(d->object);
 	}
 
+	if (d->space_id >= 0)
+	{
+		H5Sclose(d->space_id);
+	}
+
 	g_free(d->name);
 	free(d->location);
 	free(d);
@@ -1616,12 +1857,12 @@ static const H5VL_class_t H5VL_julea_g = {
 		.opt_query = H5VL_julea_introspect_opt_query,
 	},
 	.request_cls = {
-		.wait = NULL,
-		.notify = NULL,
-		.cancel = NULL,
+		.wait = H5VL_julea_request_wait,
+		.notify = H5VL_julea_request_notify,
+		.cancel = H5VL_julea_request_cancel,
 		.specific = NULL,
 		.optional = NULL,
-		.free = NULL,
+		.free = H5VL_julea_request_free,
 	},
 	.blob_cls = {
 		.put = NULL,
@@ -1704,3 +1945,48 @@ j_hdf5_set_semantics(JSemantics* semantics)
 
 	j_hdf5_semantics = j_semantics_ref(semantics);
 }
+
+static herr_t
+j_hdf5_dataset_optional(hid_t dataset, H5VL_dataset_optional_t opt_type, ...)
+{
+	va_list arguments;
+	hid_t connector_id;
+	herr_t ret;
+
+	if ((connector_id = H5VLget_connector_id(dataset)) < 0)
+	{
+		return -1;
+	}
+
+	va_start(arguments, opt_type);
+	ret = H5VLdataset_optional(H5VLobject(dataset), connector_id, opt_type, H5P_DATASET_XFER_DEFAULT, NULL, arguments);
+	va_end(arguments);
+
+	H5VLclose(connector_id);
+
+	return ret;
+}
+
+/**
+ * Returns a copy of the dataset's dataspace with all elements selected that might be within [min, max].
+ * Connectors without support for range queries select the whole dataspace.
+ **/
+hid_t
+j_hdf5_dataset_query_range(hid_t dataset, gdouble min, gdouble max)
+{
+	hid_t space_id = H5I_INVALID_HID;
+	herr_t ret;
+
+	H5E_BEGIN_TRY
+	{
+		ret = j_hdf5_dataset_optional(dataset, J_HDF5_DATASET_OPTIONAL_QUERY_RANGE, min, max, &space_id);
+	}
+	H5E_END_TRY;
+
+	if (ret < 0)
+	{
+		return H5Dget_space(dataset);
+	}
+
+	return space_id;
+}
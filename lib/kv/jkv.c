@@ -59,6 +59,31 @@ struct JKVOperation
 			guint32 value_len;
 			GDestroyNotify value_destroy;
 		} put;
+
+		struct
+		{
+			JKV* kv;
+			gpointer buffer;
+			guint64 offset;
+			guint64 length;
+			guint64* bytes_read;
+		} get_range;
+
+		struct
+		{
+			JKV* kv;
+			gconstpointer expected;
+			guint32 expected_len;
+			gpointer value;
+			guint32 value_len;
+			GDestroyNotify value_destroy;
+			gint64 delta;
+			gboolean* result;
+			gint64* previous;
+			// Backends might only fill in results when the batch is executed
+			gboolean result_value;
+			gint64 previous_value;
+		} atomic;
 	};
 };
 
@@ -188,6 +213,35 @@ j_kv_get_free(gpointer data)
 	g_slice_free(JKVOperation, operation);
 }
 
+static void
+j_kv_get_range_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JKVOperation* operation = data;
+
+	j_kv_unref(operation->get_range.kv);
+
+	g_slice_free(JKVOperation, operation);
+}
+
+static void
+j_kv_atomic_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JKVOperation* operation = data;
+
+	j_kv_unref(operation->atomic.kv);
+
+	if (operation->atomic.value_destroy != NULL)
+	{
+		operation->atomic.value_destroy(operation->atomic.value);
+	}
+
+	g_slice_free(JKVOperation, operation);
+}
+
 static gboolean
 j_kv_put_exec(JList* operations, JSemantics* semantics)
 {
@@ -251,10 +305,21 @@ j_kv_put_exec(JList* operations, JSemantics* semantics)
 
 			key_len = strlen(kop->put.kv->key) + 1;
 
-			j_message_add_operation(message, key_len + 4 + kop->put.value_len);
-			j_message_append_n(message, kop->put.kv->key, key_len);
-			j_message_append_4(message, &(kop->put.value_len));
-			j_message_append_n(message, kop->put.value, kop->put.value_len);
+			if (kop->put.value_len <= J_MESSAGE_INLINE_MAX)
+			{
+				j_message_add_operation(message, key_len + 4 + kop->put.value_len);
+				j_message_append_n(message, kop->put.kv->key, key_len);
+				j_message_append_4(message, &(kop->put.value_len));
+				j_message_append_n(message, kop->put.value, kop->put.value_len);
+			}
+			else
+			{
+				// Large values are sent separately to avoid copying them into the message
+				j_message_add_operation(message, key_len + 4);
+				j_message_append_n(message, kop->put.kv->key, key_len);
+				j_message_append_4(message, &(kop->put.value_len));
+				j_message_add_send(message, kop->put.value, kop->put.value_len);
+			}
 		}
 		else
 		{
@@ -272,11 +337,17 @@ j_kv_put_exec(JList* operations, JSemantics* semantics)
 		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 		{
 			g_autoptr(JMessage) reply = NULL;
+			guint32 reply_operation_count;
 
 			reply = j_message_new_reply(message);
 			j_message_receive(reply, kv_connection);
 
-			/* FIXME do something with reply */
+			reply_operation_count = j_message_get_count(reply);
+
+			for (guint i = 0; i < reply_operation_count; i++)
+			{
+				ret = (j_message_get_4(reply) != 0) && ret;
+			}
 		}
 
 		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
@@ -363,11 +434,17 @@ j_kv_delete_exec(JList* operations, JSemantics* semantics)
 		if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 		{
 			g_autoptr(JMessage) reply = NULL;
+			guint32 reply_operation_count;
 
 			reply = j_message_new_reply(message);
 			j_message_receive(reply, kv_connection);
 
-			/* FIXME do something with reply */
+			reply_operation_count = j_message_get_count(reply);
+
+			for (guint i = 0; i < reply_operation_count; i++)
+			{
+				ret = (j_message_get_4(reply) != 0) && ret;
+			}
 		}
 
 		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
@@ -471,51 +548,357 @@ j_kv_get_exec(JList* operations, JSemantics* semantics)
 		g_autoptr(JListIterator) iter = NULL;
 		g_autoptr(JMessage) reply = NULL;
 		gpointer kv_connection;
+		guint32 operations_done;
+		guint32 operation_count;
 
 		kv_connection = j_connection_pool_pop(J_BACKEND_TYPE_KV, index);
 		j_message_send(message, kv_connection);
 
 		reply = j_message_new_reply(message);
-		j_message_receive(reply, kv_connection);
+
+		operations_done = 0;
+		operation_count = j_message_get_count(message);
 
 		iter = j_list_iterator_new(operations);
 
-		while (j_list_iterator_next(iter))
+		// The server might send multiple replies to bound its memory usage
+		while (operations_done < operation_count)
 		{
-			JKVOperation* kop = j_list_iterator_get(iter);
-			guint32 len;
+			guint32 reply_operation_count;
+
+			j_message_receive(reply, kv_connection);
 
-			len = j_message_get_4(reply);
-			ret = (len > 0) && ret;
+			reply_operation_count = j_message_get_count(reply);
 
-			if (len > 0)
+			for (guint i = 0; i < reply_operation_count && j_list_iterator_next(iter); i++)
 			{
-				gconstpointer data;
+				JKVOperation* kop = j_list_iterator_get(iter);
+				gpointer value;
+				guint32 len;
 
-				data = j_message_get_n(reply, len);
+				len = j_message_get_4(reply);
+				ret = (len > 0) && ret;
 
-				if (kop->get.func != NULL)
+				if (len == 0)
 				{
-					gpointer value;
+					continue;
+				}
 
-					// data belongs to the message, create a copy for the callback
+				if (len <= J_MESSAGE_INLINE_MAX)
+				{
+					// The data belongs to the message, create a copy
 #if GLIB_CHECK_VERSION(2, 68, 0)
-					value = g_memdup2(data, len);
+					value = g_memdup2(j_message_get_n(reply, len), len);
 #else
-					value = g_memdup(data, len);
+					value = g_memdup(j_message_get_n(reply, len), len);
 #endif
+				}
+				else
+				{
+					GInputStream* input;
+
+					// Large values follow the reply, read them directly into their final buffer
+					value = g_malloc(len);
+					input = g_io_stream_get_input_stream(G_IO_STREAM(kv_connection));
+					g_input_stream_read_all(input, value, len, NULL, NULL, NULL);
+				}
+
+				if (kop->get.func != NULL)
+				{
 					kop->get.func(value, len, kop->get.data);
 				}
 				else
 				{
-#if GLIB_CHECK_VERSION(2, 68, 0)
-					*(kop->get.value) = g_memdup2(data, len);
-#else
-					*(kop->get.value) = g_memdup(data, len);
-#endif
+					*(kop->get.value) = value;
 					*(kop->get.value_len) = len;
 				}
 			}
+
+			operations_done += reply_operation_count;
+		}
+
+		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
+	}
+	else
+	{
+		ret = j_backend_kv_batch_execute(kv_backend, kv_batch) && ret;
+	}
+
+	return ret;
+}
+
+static gboolean
+j_kv_get_range_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = TRUE;
+
+	JBackend* kv_backend;
+	g_autoptr(JListIterator) it = NULL;
+	g_autoptr(JMessage) message = NULL;
+	gchar const* namespace;
+	gpointer kv_batch = NULL;
+	gsize namespace_len;
+	guint32 index;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	{
+		JKVOperation* kop;
+
+		kop = j_list_get_first(operations);
+		g_assert(kop != NULL);
+
+		namespace = kop->get_range.kv->namespace;
+		namespace_len = strlen(namespace) + 1;
+		index = kop->get_range.kv->index;
+	}
+
+	it = j_list_iterator_new(operations);
+	kv_backend = j_kv_get_backend();
+
+	if (kv_backend == NULL)
+	{
+		message = j_message_new(J_MESSAGE_KV_GET_RANGE, namespace_len);
+		j_message_set_semantics(message, semantics);
+		j_message_append_n(message, namespace, namespace_len);
+	}
+	else
+	{
+		ret = j_backend_kv_batch_start(kv_backend, namespace, semantics, &kv_batch);
+	}
+
+	while (j_list_iterator_next(it))
+	{
+		JKVOperation* kop = j_list_iterator_get(it);
+
+		if (kv_backend == NULL)
+		{
+			gsize key_len;
+
+			key_len = strlen(kop->get_range.kv->key) + 1;
+
+			j_message_add_operation(message, key_len + 8 + 8);
+			j_message_append_n(message, kop->get_range.kv->key, key_len);
+			j_message_append_8(message, &(kop->get_range.offset));
+			j_message_append_8(message, &(kop->get_range.length));
+		}
+		else
+		{
+			g_autofree gpointer value = NULL;
+			guint32 len;
+
+			if (j_backend_kv_get_range(kv_backend, kv_batch, kop->get_range.kv->key, kop->get_range.offset, kop->get_range.length, &value, &len))
+			{
+				if (len > 0)
+				{
+					memcpy(kop->get_range.buffer, value, len);
+				}
+
+				j_helper_atomic_add(kop->get_range.bytes_read, len);
+			}
+			else
+			{
+				ret = FALSE;
+			}
+		}
+	}
+
+	if (kv_backend == NULL)
+	{
+		g_autoptr(JListIterator) iter = NULL;
+		g_autoptr(JMessage) reply = NULL;
+		gpointer kv_connection;
+		guint32 operations_done;
+		guint32 operation_count;
+
+		kv_connection = j_connection_pool_pop(J_BACKEND_TYPE_KV, index);
+		j_message_send(message, kv_connection);
+
+		reply = j_message_new_reply(message);
+
+		operations_done = 0;
+		operation_count = j_message_get_count(message);
+
+		iter = j_list_iterator_new(operations);
+
+		// The server might send multiple replies to bound its memory usage
+		while (operations_done < operation_count)
+		{
+			guint32 reply_operation_count;
+
+			j_message_receive(reply, kv_connection);
+
+			reply_operation_count = j_message_get_count(reply);
+
+			for (guint i = 0; i < reply_operation_count && j_list_iterator_next(iter); i++)
+			{
+				JKVOperation* kop = j_list_iterator_get(iter);
+				guint64 bytes_read;
+				guint32 status;
+
+				status = j_message_get_4(reply);
+				bytes_read = j_message_get_8(reply);
+				ret = (status != 0) && ret;
+
+				if (bytes_read > 0)
+				{
+					GInputStream* input;
+
+					// The data follows the reply, read it directly into the caller's buffer
+					input = g_io_stream_get_input_stream(G_IO_STREAM(kv_connection));
+					g_input_stream_read_all(input, kop->get_range.buffer, bytes_read, NULL, NULL, NULL);
+				}
+
+				j_helper_atomic_add(kop->get_range.bytes_read, bytes_read);
+			}
+
+			operations_done += reply_operation_count;
+		}
+
+		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
+	}
+	else
+	{
+		ret = j_backend_kv_batch_execute(kv_backend, kv_batch) && ret;
+	}
+
+	return ret;
+}
+
+static gboolean
+j_kv_atomic_exec(JList* operations, JSemantics* semantics, JMessageType type)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = TRUE;
+
+	JBackend* kv_backend;
+	g_autoptr(JListIterator) it = NULL;
+	g_autoptr(JMessage) message = NULL;
+	gchar const* namespace;
+	gpointer kv_batch = NULL;
+	gsize namespace_len;
+	guint32 index;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	{
+		JKVOperation* kop;
+
+		kop = j_list_get_first(operations);
+		g_assert(kop != NULL);
+
+		namespace = kop->atomic.kv->namespace;
+		namespace_len = strlen(namespace) + 1;
+		index = kop->atomic.kv->index;
+	}
+
+	it = j_list_iterator_new(operations);
+	kv_backend = j_kv_get_backend();
+
+	if (kv_backend == NULL)
+	{
+		// The server always replies to atomic operations since their results are needed
+		message = j_message_new(type, namespace_len);
+		j_message_set_semantics(message, semantics);
+		j_message_append_n(message, namespace, namespace_len);
+	}
+	else
+	{
+		ret = j_backend_kv_batch_start(kv_backend, namespace, semantics, &kv_batch);
+	}
+
+	while (j_list_iterator_next(it))
+	{
+		JKVOperation* kop = j_list_iterator_get(it);
+
+		kop->atomic.result_value = FALSE;
+		kop->atomic.previous_value = 0;
+
+		if (kv_backend == NULL)
+		{
+			gsize key_len;
+
+			key_len = strlen(kop->atomic.kv->key) + 1;
+
+			switch (type)
+			{
+				case J_MESSAGE_KV_PUT_IF_ABSENT:
+					j_message_add_operation(message, key_len + 4 + kop->atomic.value_len);
+					j_message_append_n(message, kop->atomic.kv->key, key_len);
+					j_message_append_4(message, &(kop->atomic.value_len));
+					j_message_append_n(message, kop->atomic.value, kop->atomic.value_len);
+					break;
+				case J_MESSAGE_KV_COMPARE_AND_SWAP:
+					j_message_add_operation(message, key_len + 4 + kop->atomic.expected_len + 4 + kop->atomic.value_len);
+					j_message_append_n(message, kop->atomic.kv->key, key_len);
+					j_message_append_4(message, &(kop->atomic.expected_len));
+					j_message_append_n(message, kop->atomic.expected, kop->atomic.expected_len);
+					j_message_append_4(message, &(kop->atomic.value_len));
+					j_message_append_n(message, kop->atomic.value, kop->atomic.value_len);
+					break;
+				case J_MESSAGE_KV_FETCH_ADD:
+					j_message_add_operation(message, key_len + 8);
+					j_message_append_n(message, kop->atomic.kv->key, key_len);
+					j_message_append_8(message, &(kop->atomic.delta));
+					break;
+				default:
+					g_assert_not_reached();
+			}
+		}
+		else
+		{
+			switch (type)
+			{
+				case J_MESSAGE_KV_PUT_IF_ABSENT:
+					ret = j_backend_kv_put_if_absent(kv_backend, kv_batch, kop->atomic.kv->key, kop->atomic.value, kop->atomic.value_len, &(kop->atomic.result_value)) && ret;
+					break;
+				case J_MESSAGE_KV_COMPARE_AND_SWAP:
+					ret = j_backend_kv_compare_and_swap(kv_backend, kv_batch, kop->atomic.kv->key, kop->atomic.expected, kop->atomic.expected_len, kop->atomic.value, kop->atomic.value_len, &(kop->atomic.result_value)) && ret;
+					break;
+				case J_MESSAGE_KV_FETCH_ADD:
+					ret = j_backend_kv_fetch_add(kv_backend, kv_batch, kop->atomic.kv->key, kop->atomic.delta, &(kop->atomic.previous_value)) && ret;
+					break;
+				default:
+					g_assert_not_reached();
+			}
+		}
+	}
+
+	if (kv_backend == NULL)
+	{
+		g_autoptr(JListIterator) iter = NULL;
+		g_autoptr(JMessage) reply = NULL;
+		gpointer kv_connection;
+
+		kv_connection = j_connection_pool_pop(J_BACKEND_TYPE_KV, index);
+		j_message_send(message, kv_connection);
+
+		reply = j_message_new_reply(message);
+		j_message_receive(reply, kv_connection);
+
+		iter = j_list_iterator_new(operations);
+
+		while (j_list_iterator_next(iter))
+		{
+			JKVOperation* kop = j_list_iterator_get(iter);
+			guint32 status;
+
+			status = j_message_get_4(reply);
+			ret = (status != 0) && ret;
+
+			if (type == J_MESSAGE_KV_FETCH_ADD)
+			{
+				kop->atomic.previous_value = j_message_get_8(reply);
+			}
+			else
+			{
+				kop->atomic.result_value = (j_message_get_4(reply) != 0);
+			}
 		}
 
 		j_connection_pool_push(J_BACKEND_TYPE_KV, index, kv_connection);
@@ -525,9 +908,54 @@ j_kv_get_exec(JList* operations, JSemantics* semantics)
 		ret = j_backend_kv_batch_execute(kv_backend, kv_batch) && ret;
 	}
 
+	{
+		g_autoptr(JListIterator) iter = NULL;
+
+		iter = j_list_iterator_new(operations);
+
+		while (j_list_iterator_next(iter))
+		{
+			JKVOperation* kop = j_list_iterator_get(iter);
+
+			if (kop->atomic.result != NULL)
+			{
+				*(kop->atomic.result) = ret && kop->atomic.result_value;
+			}
+
+			if (kop->atomic.previous != NULL)
+			{
+				*(kop->atomic.previous) = kop->atomic.previous_value;
+			}
+		}
+	}
+
 	return ret;
 }
 
+static gboolean
+j_kv_put_if_absent_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return j_kv_atomic_exec(operations, semantics, J_MESSAGE_KV_PUT_IF_ABSENT);
+}
+
+static gboolean
+j_kv_compare_and_swap_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return j_kv_atomic_exec(operations, semantics, J_MESSAGE_KV_COMPARE_AND_SWAP);
+}
+
+static gboolean
+j_kv_fetch_add_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	return j_kv_atomic_exec(operations, semantics, J_MESSAGE_KV_FETCH_ADD);
+}
+
 /**
  * Creates a new key-value pair.
  *
@@ -781,6 +1209,192 @@ j_kv_get_callback(JKV* kv, JKVGetFunc func, gpointer data, JBatch* batch)
 	j_batch_add(batch, operation);
 }
 
+/**
+ * Reads a range of a key-value pair's value.
+ *
+ * The data is received directly into the provided buffer, which makes this suitable for large values.
+ *
+ * \code
+ * \endcode
+ *
+ * \param kv         A key-value pair.
+ * \param buffer     A buffer of at least \p length bytes.
+ * \param offset     The offset within the value.
+ * \param length     The number of bytes to read.
+ * \param bytes_read The number of bytes read. Will be incremented, so it should be initialized to 0.
+ * \param batch      A batch.
+ **/
+void
+j_kv_get_range(JKV* kv, gpointer buffer, guint64 offset, guint64 length, guint64* bytes_read, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JKVOperation* kop;
+	JOperation* operation;
+
+	g_return_if_fail(kv != NULL);
+	g_return_if_fail(buffer != NULL);
+	g_return_if_fail(bytes_read != NULL);
+
+	kop = g_slice_new(JKVOperation);
+	kop->get_range.kv = j_kv_ref(kv);
+	kop->get_range.buffer = buffer;
+	kop->get_range.offset = offset;
+	kop->get_range.length = length;
+	kop->get_range.bytes_read = bytes_read;
+
+	operation = j_operation_new();
+	operation->key = kv;
+	operation->data = kop;
+	operation->exec_func = j_kv_get_range_exec;
+	operation->free_func = j_kv_get_range_free;
+
+	j_batch_add(batch, operation);
+}
+
+static JKVOperation*
+j_kv_atomic_new(JKV* kv)
+{
+	JKVOperation* kop;
+
+	kop = g_slice_new(JKVOperation);
+	kop->atomic.kv = j_kv_ref(kv);
+	kop->atomic.expected = NULL;
+	kop->atomic.expected_len = 0;
+	kop->atomic.value = NULL;
+	kop->atomic.value_len = 0;
+	kop->atomic.value_destroy = NULL;
+	kop->atomic.delta = 0;
+	kop->atomic.result = NULL;
+	kop->atomic.previous = NULL;
+	kop->atomic.result_value = FALSE;
+	kop->atomic.previous_value = 0;
+
+	return kop;
+}
+
+/**
+ * Creates a key-value pair if the key does not exist yet.
+ *
+ * The check and the insertion are performed atomically by the backend.
+ *
+ * \code
+ * \endcode
+ *
+ * \param kv            A KV.
+ * \param value         A value.
+ * \param value_len     The value's length.
+ * \param value_destroy A function to free the value, or NULL.
+ * \param inserted      Returns whether the value has been inserted, or NULL.
+ * \param batch         A batch.
+ **/
+void
+j_kv_put_if_absent(JKV* kv, gpointer value, guint32 value_len, GDestroyNotify value_destroy, gboolean* inserted, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JKVOperation* kop;
+	JOperation* operation;
+
+	g_return_if_fail(kv != NULL);
+
+	kop = j_kv_atomic_new(kv);
+	kop->atomic.value = value;
+	kop->atomic.value_len = value_len;
+	kop->atomic.value_destroy = value_destroy;
+	kop->atomic.result = inserted;
+
+	operation = j_operation_new();
+	operation->key = kv;
+	operation->data = kop;
+	operation->exec_func = j_kv_put_if_absent_exec;
+	operation->free_func = j_kv_atomic_free;
+
+	j_batch_add(batch, operation);
+}
+
+/**
+ * Replaces a key-value pair's value if it currently matches an expected value.
+ *
+ * The comparison and the replacement are performed atomically by the backend.
+ * A failed comparison is not an error, it is reported via \p swapped.
+ *
+ * \code
+ * \endcode
+ *
+ * \param kv            A KV.
+ * \param expected      The expected value. Must stay valid until the batch has been executed.
+ * \param expected_len  The expected value's length.
+ * \param value         A new value.
+ * \param value_len     The new value's length.
+ * \param value_destroy A function to free the new value, or NULL.
+ * \param swapped       Returns whether the value has been replaced, or NULL.
+ * \param batch         A batch.
+ **/
+void
+j_kv_compare_and_swap(JKV* kv, gconstpointer expected, guint32 expected_len, gpointer value, guint32 value_len, GDestroyNotify value_destroy, gboolean* swapped, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JKVOperation* kop;
+	JOperation* operation;
+
+	g_return_if_fail(kv != NULL);
+	g_return_if_fail(expected != NULL);
+
+	kop = j_kv_atomic_new(kv);
+	kop->atomic.expected = expected;
+	kop->atomic.expected_len = expected_len;
+	kop->atomic.value = value;
+	kop->atomic.value_len = value_len;
+	kop->atomic.value_destroy = value_destroy;
+	kop->atomic.result = swapped;
+
+	operation = j_operation_new();
+	operation->key = kv;
+	operation->data = kop;
+	operation->exec_func = j_kv_compare_and_swap_exec;
+	operation->free_func = j_kv_atomic_free;
+
+	j_batch_add(batch, operation);
+}
+
+/**
+ * Atomically adds a delta to a counter.
+ *
+ * Counters are stored as 8-byte little-endian integers, a missing key is treated as 0.
+ *
+ * \code
+ * \endcode
+ *
+ * \param kv       A KV.
+ * \param delta    The value to add.
+ * \param previous Returns the counter's value before the addition, or NULL.
+ * \param batch    A batch.
+ **/
+void
+j_kv_fetch_add(JKV* kv, gint64 delta, gint64* previous, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JKVOperation* kop;
+	JOperation* operation;
+
+	g_return_if_fail(kv != NULL);
+
+	kop = j_kv_atomic_new(kv);
+	kop->atomic.delta = delta;
+	kop->atomic.previous = previous;
+
+	operation = j_operation_new();
+	operation->key = kv;
+	operation->data = kop;
+	operation->exec_func = j_kv_fetch_add_exec;
+	operation->free_func = j_kv_atomic_free;
+
+	j_batch_add(batch, operation);
+}
+
 /**
  * Returns the kv backend.
  *
@@ -121,11 +121,84 @@ struct JDistributedObjectOperation
 			guint64 offset;
 			guint64* bytes_written;
 		} write;
+
+		struct
+		{
+			JDistributedObject* object;
+			gpointer data;
+			guint64 length;
+			guint64 offset;
+			guint32 dimensions;
+			guint64* count;
+			guint64* stride;
+			guint64* bytes_read;
+		} read_strided;
+
+		struct
+		{
+			JDistributedObject* object;
+			gconstpointer data;
+			guint64 length;
+			guint64 offset;
+			guint32 dimensions;
+			guint64* count;
+			guint64* stride;
+			guint64* bytes_written;
+		} write_strided;
 	};
 };
 
 typedef struct JDistributedObjectOperation JDistributedObjectOperation;
 
+/**
+ * Called for each part of a strided selection that is stored contiguously on one server.
+ * The part's offset is relative to the server's part of the object, position is the part's position within the densely packed buffer.
+ */
+typedef void (*JDistributedObjectStridedFunc)(guint32 index, guint64 length, guint64 offset, guint32 dimensions, guint64 const* count, guint64 const* stride, guint64 position, gpointer data);
+
+/**
+ * Data for building the messages of strided operations.
+ */
+struct JDistributedObjectStridedData
+{
+	JDistributedObject* object;
+	JSemantics* semantics;
+	JMessage** messages;
+	JList** lists;
+	gsize namespace_len;
+	gsize name_len;
+
+	union
+	{
+		struct
+		{
+			gchar* data;
+			guint64* bytes_read;
+		} read;
+
+		struct
+		{
+			gchar const* data;
+			guint64* bytes_written;
+		} write;
+	};
+};
+
+typedef struct JDistributedObjectStridedData JDistributedObjectStridedData;
+
+/**
+ * Data for executing strided operations using a local backend.
+ */
+struct JDistributedObjectStridedBackendData
+{
+	JBackend* backend;
+	gpointer handle;
+	gchar* data;
+	guint64 bytes;
+};
+
+typedef struct JDistributedObjectStridedBackendData JDistributedObjectStridedBackendData;
+
 /**
  * A JDistributedObject.
  **/
@@ -217,6 +290,34 @@ j_distributed_object_write_free(gpointer data)
 	g_slice_free(JDistributedObjectOperation, operation);
 }
 
+static void
+j_distributed_object_read_strided_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectOperation* operation = data;
+
+	j_distributed_object_unref(operation->read_strided.object);
+	g_free(operation->read_strided.count);
+	g_free(operation->read_strided.stride);
+
+	g_slice_free(JDistributedObjectOperation, operation);
+}
+
+static void
+j_distributed_object_write_strided_free(gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectOperation* operation = data;
+
+	j_distributed_object_unref(operation->write_strided.object);
+	g_free(operation->write_strided.count);
+	g_free(operation->write_strided.stride);
+
+	g_slice_free(JDistributedObjectOperation, operation);
+}
+
 /**
  * Executes create operations in a background operation.
  *
@@ -1107,6 +1208,473 @@ j_distributed_object_write_exec(JList* operations, JSemantics* semantics)
 	return ret;
 }
 
+/**
+ * Splits a strided selection into parts that are stored contiguously on one server and are at most max_length bytes large.
+ * Parts keep the selection's strides, so their descriptions only grow with the number of dimensions.
+ * Dimensions are only split if the selection crosses a distribution block or would exceed max_length.
+ *
+ * \private
+ *
+ * \param count Is modified temporarily.
+ **/
+static void
+j_distributed_object_strided_split(JDistribution* distribution, guint64 length, guint64 offset, guint32 dimensions, guint64* count, guint64 const* stride, guint64 position, guint64 max_length, JDistributedObjectStridedFunc func, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	guint32 index;
+	guint64 block_id;
+	guint64 new_length;
+	guint64 new_offset;
+	guint64 inner_extent;
+	guint64 inner_length;
+	guint64 outer_count;
+
+	if (dimensions == 0)
+	{
+		// A single block might still be distributed across multiple servers
+		j_distribution_reset(distribution, length, offset);
+
+		while (j_distribution_distribute(distribution, &index, &new_length, &new_offset, &block_id))
+		{
+			for (guint64 done = 0; done < new_length;)
+			{
+				guint64 part_length;
+
+				part_length = MIN(new_length - done, max_length);
+				func(index, part_length, new_offset + done, 0, NULL, NULL, position, data);
+
+				done += part_length;
+				position += part_length;
+			}
+		}
+
+		return;
+	}
+
+	// The extent and size of one element of the outermost dimension
+	inner_extent = length;
+
+	for (guint32 i = 1; i < dimensions; i++)
+	{
+		inner_extent += (count[i] - 1) * stride[i];
+	}
+
+	inner_length = j_helper_strided_length(length, dimensions - 1, count + 1);
+	outer_count = count[0];
+
+	for (guint64 i = 0; i < outer_count;)
+	{
+		guint64 element_offset;
+		guint64 group;
+
+		element_offset = offset + i * stride[0];
+
+		// Determine how many bytes starting at element_offset are stored contiguously on one server
+		j_distribution_reset(distribution, (outer_count - i - 1) * stride[0] + inner_extent, element_offset);
+		j_distribution_distribute(distribution, &index, &new_length, &new_offset, &block_id);
+
+		if (new_length >= inner_extent && inner_length <= max_length)
+		{
+			group = MIN(outer_count - i, (new_length - inner_extent) / stride[0] + 1);
+			group = MIN(group, max_length / inner_length);
+
+			count[0] = group;
+			func(index, length, new_offset, dimensions, count, stride, position, data);
+			count[0] = outer_count;
+		}
+		else
+		{
+			group = 1;
+			j_distributed_object_strided_split(distribution, length, element_offset, dimensions - 1, count + 1, stride + 1, position, max_length, func, data);
+		}
+
+		i += group;
+		position += group * inner_length;
+	}
+}
+
+/**
+ * Appends the description of a strided selection to a message.
+ *
+ * \private
+ **/
+static void
+j_distributed_object_strided_append(JDistributedObjectStridedData* strided_data, JMessageType type, guint32 index, guint64 length, guint64 offset, guint32 dimensions, guint64 const* count, guint64 const* stride)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JMessage** messages = strided_data->messages;
+
+	if (messages[index] == NULL)
+	{
+		messages[index] = j_message_new(type, strided_data->namespace_len + strided_data->name_len);
+		j_message_set_semantics(messages[index], strided_data->semantics);
+		j_message_append_n(messages[index], strided_data->object->namespace, strided_data->namespace_len);
+		j_message_append_n(messages[index], strided_data->object->name, strided_data->name_len);
+
+		strided_data->lists[index] = j_list_new(NULL);
+	}
+
+	j_message_add_operation(messages[index], sizeof(guint64) + sizeof(guint64) + sizeof(guint32) + dimensions * (sizeof(guint64) + sizeof(guint64)));
+	j_message_append_8(messages[index], &length);
+	j_message_append_8(messages[index], &offset);
+	j_message_append_4(messages[index], &dimensions);
+
+	for (guint32 i = 0; i < dimensions; i++)
+	{
+		j_message_append_8(messages[index], &count[i]);
+		j_message_append_8(messages[index], &stride[i]);
+	}
+}
+
+static void
+j_distributed_object_read_strided_part(guint32 index, guint64 length, guint64 offset, guint32 dimensions, guint64 const* count, guint64 const* stride, guint64 position, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectStridedData* strided_data = data;
+	JDistributedObjectReadBuffer* buffer;
+
+	j_distributed_object_strided_append(strided_data, J_MESSAGE_OBJECT_READ_STRIDED, index, length, offset, dimensions, count, stride);
+
+	buffer = g_slice_new(JDistributedObjectReadBuffer);
+	buffer->data = strided_data->read.data + position;
+	buffer->bytes_read = strided_data->read.bytes_read;
+
+	j_list_append(strided_data->lists[index], buffer);
+}
+
+static void
+j_distributed_object_write_strided_part(guint32 index, guint64 length, guint64 offset, guint32 dimensions, guint64 const* count, guint64 const* stride, guint64 position, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectStridedData* strided_data = data;
+	guint64 part_length;
+
+	part_length = j_helper_strided_length(length, dimensions, count);
+
+	j_distributed_object_strided_append(strided_data, J_MESSAGE_OBJECT_WRITE_STRIDED, index, length, offset, dimensions, count, stride);
+	j_message_add_send(strided_data->messages[index], strided_data->write.data + position, part_length);
+
+	j_list_append(strided_data->lists[index], strided_data->write.bytes_written);
+
+	// Fake bytes_written here instead of doing another loop further down
+	if (j_semantics_get(strided_data->semantics, J_SEMANTICS_SAFETY) == J_SEMANTICS_SAFETY_NONE)
+	{
+		j_helper_atomic_add(strided_data->write.bytes_written, part_length);
+	}
+}
+
+static gboolean
+j_distributed_object_read_strided_backend(guint64 length, guint64 offset, guint64 position, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectStridedBackendData* backend_data = data;
+	guint64 nbytes = 0;
+
+	if (!j_backend_object_read(backend_data->backend, backend_data->handle, backend_data->data + position, length, offset, &nbytes))
+	{
+		return FALSE;
+	}
+
+	backend_data->bytes += nbytes;
+
+	return (nbytes == length);
+}
+
+static gboolean
+j_distributed_object_write_strided_backend(guint64 length, guint64 offset, guint64 position, gpointer data)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectStridedBackendData* backend_data = data;
+	guint64 nbytes = 0;
+
+	if (!j_backend_object_write(backend_data->backend, backend_data->handle, backend_data->data + position, length, offset, &nbytes))
+	{
+		return FALSE;
+	}
+
+	backend_data->bytes += nbytes;
+
+	return (nbytes == length);
+}
+
+static gboolean
+j_distributed_object_read_strided_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	// Short reads are reported via bytes_read and are not errors, like for regular reads
+	gboolean ret = TRUE;
+
+	JBackend* object_backend;
+	g_autofree JList** br_lists = NULL;
+	g_autoptr(JListIterator) it = NULL;
+	g_autofree JMessage** messages = NULL;
+	JDistributedObject* object = NULL;
+	JDistributedObjectStridedData strided_data;
+	gpointer object_handle;
+	gboolean opened = FALSE;
+	guint32 server_count = 0;
+	guint64 max_operation_size;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	{
+		JDistributedObjectOperation* operation = j_list_get_first(operations);
+		g_assert(operation != NULL);
+
+		object = operation->read_strided.object;
+		g_assert(object != NULL);
+	}
+
+	it = j_list_iterator_new(operations);
+	object_backend = j_object_get_backend();
+	max_operation_size = j_configuration_get_max_operation_size(j_configuration());
+
+	if (object_backend == NULL)
+	{
+		server_count = j_configuration_get_server_count(j_configuration(), J_BACKEND_TYPE_OBJECT);
+		messages = g_new0(JMessage*, server_count);
+		br_lists = g_new0(JList*, server_count);
+
+		strided_data.object = object;
+		strided_data.semantics = semantics;
+		strided_data.messages = messages;
+		strided_data.lists = br_lists;
+		strided_data.namespace_len = strlen(object->namespace) + 1;
+		strided_data.name_len = strlen(object->name) + 1;
+	}
+	else
+	{
+		opened = j_backend_object_open(object_backend, object->namespace, object->name, &object_handle);
+		ret = opened && ret;
+	}
+
+	while (j_list_iterator_next(it))
+	{
+		JDistributedObjectOperation* operation = j_list_iterator_get(it);
+		guint64 length = operation->read_strided.length;
+		guint64 offset = operation->read_strided.offset;
+		guint32 dimensions = operation->read_strided.dimensions;
+		guint64* count = operation->read_strided.count;
+		guint64 const* stride = operation->read_strided.stride;
+		guint64* bytes_read = operation->read_strided.bytes_read;
+
+		j_trace_file_begin(object->name, J_TRACE_FILE_READ);
+
+		if (object_backend == NULL)
+		{
+			strided_data.read.data = operation->read_strided.data;
+			strided_data.read.bytes_read = bytes_read;
+
+			j_distributed_object_strided_split(object->distribution, length, offset, dimensions, count, stride, 0, max_operation_size, j_distributed_object_read_strided_part, &strided_data);
+		}
+		else if (opened)
+		{
+			JDistributedObjectStridedBackendData backend_data;
+
+			backend_data.backend = object_backend;
+			backend_data.handle = object_handle;
+			backend_data.data = operation->read_strided.data;
+			backend_data.bytes = 0;
+
+			j_helper_strided_foreach(length, offset, dimensions, count, stride, j_distributed_object_read_strided_backend, &backend_data);
+			j_helper_atomic_add(bytes_read, backend_data.bytes);
+		}
+
+		j_trace_file_end(object->name, J_TRACE_FILE_READ, j_helper_strided_length(length, dimensions, count), offset);
+	}
+
+	if (object_backend == NULL)
+	{
+		g_autofree gpointer* background_data = NULL;
+
+		background_data = g_new(gpointer, server_count);
+
+		for (guint i = 0; i < server_count; i++)
+		{
+			JDistributedObjectBackgroundData* data;
+
+			if (messages[i] == NULL)
+			{
+				background_data[i] = NULL;
+				continue;
+			}
+
+			data = g_slice_new(JDistributedObjectBackgroundData);
+			data->index = i;
+			data->message = messages[i];
+			data->operations = NULL;
+			data->semantics = semantics;
+			data->read.buffers = br_lists[i];
+
+			background_data[i] = data;
+		}
+
+		// The replies have the same format as those of regular reads
+		j_helper_execute_parallel(j_distributed_object_read_background_operation, background_data, server_count);
+	}
+	else if (opened)
+	{
+		ret = j_backend_object_close(object_backend, object_handle) && ret;
+	}
+
+	return ret;
+}
+
+static gboolean
+j_distributed_object_write_strided_exec(JList* operations, JSemantics* semantics)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	gboolean ret = TRUE;
+
+	JBackend* object_backend;
+	JSemanticsSafety safety;
+	g_autofree JList** bw_lists = NULL;
+	g_autofree guint64* operation_bytes = NULL;
+	g_autoptr(JListIterator) it = NULL;
+	g_autofree JMessage** messages = NULL;
+	JDistributedObject* object = NULL;
+	JDistributedObjectStridedData strided_data;
+	gpointer object_handle;
+	gboolean opened = FALSE;
+	guint32 server_count = 0;
+	guint64 max_operation_size;
+
+	g_return_val_if_fail(operations != NULL, FALSE);
+	g_return_val_if_fail(semantics != NULL, FALSE);
+
+	{
+		JDistributedObjectOperation* operation = j_list_get_first(operations);
+		g_assert(operation != NULL);
+
+		object = operation->write_strided.object;
+		g_assert(object != NULL);
+	}
+
+	it = j_list_iterator_new(operations);
+	object_backend = j_object_get_backend();
+	safety = j_semantics_get(semantics, J_SEMANTICS_SAFETY);
+	max_operation_size = j_configuration_get_max_operation_size(j_configuration());
+
+	if (object_backend == NULL)
+	{
+		server_count = j_configuration_get_server_count(j_configuration(), J_BACKEND_TYPE_OBJECT);
+		messages = g_new0(JMessage*, server_count);
+		bw_lists = g_new0(JList*, server_count);
+		// Count the bytes per operation to be able to detect incomplete writes
+		operation_bytes = g_new0(guint64, j_list_length(operations));
+
+		strided_data.object = object;
+		strided_data.semantics = semantics;
+		strided_data.messages = messages;
+		strided_data.lists = bw_lists;
+		strided_data.namespace_len = strlen(object->namespace) + 1;
+		strided_data.name_len = strlen(object->name) + 1;
+	}
+	else
+	{
+		opened = j_backend_object_open(object_backend, object->namespace, object->name, &object_handle);
+		ret = opened && ret;
+	}
+
+	for (guint j = 0; j_list_iterator_next(it); j++)
+	{
+		JDistributedObjectOperation* operation = j_list_iterator_get(it);
+		guint64 length = operation->write_strided.length;
+		guint64 offset = operation->write_strided.offset;
+		guint32 dimensions = operation->write_strided.dimensions;
+		guint64* count = operation->write_strided.count;
+		guint64 const* stride = operation->write_strided.stride;
+		guint64* bytes_written = operation->write_strided.bytes_written;
+
+		j_trace_file_begin(object->name, J_TRACE_FILE_WRITE);
+
+		if (object_backend == NULL)
+		{
+			strided_data.write.data = operation->write_strided.data;
+			strided_data.write.bytes_written = &operation_bytes[j];
+
+			j_distributed_object_strided_split(object->distribution, length, offset, dimensions, count, stride, 0, max_operation_size, j_distributed_object_write_strided_part, &strided_data);
+		}
+		else if (opened)
+		{
+			JDistributedObjectStridedBackendData backend_data;
+
+			backend_data.backend = object_backend;
+			backend_data.handle = object_handle;
+			// The local backend does not modify the data
+			backend_data.data = (gchar*)operation->write_strided.data;
+			backend_data.bytes = 0;
+
+			ret = j_helper_strided_foreach(length, offset, dimensions, count, stride, j_distributed_object_write_strided_backend, &backend_data) && ret;
+			j_helper_atomic_add(bytes_written, backend_data.bytes);
+		}
+
+		j_trace_file_end(object->name, J_TRACE_FILE_WRITE, j_helper_strided_length(length, dimensions, count), offset);
+	}
+
+	if (object_backend == NULL)
+	{
+		g_autofree gpointer* background_data = NULL;
+
+		background_data = g_new(gpointer, server_count);
+
+		for (guint i = 0; i < server_count; i++)
+		{
+			JDistributedObjectBackgroundData* data;
+
+			if (messages[i] == NULL)
+			{
+				background_data[i] = NULL;
+				continue;
+			}
+
+			data = g_slice_new(JDistributedObjectBackgroundData);
+			data->index = i;
+			data->message = messages[i];
+			data->operations = NULL;
+			data->semantics = semantics;
+			data->write.bytes_written = bw_lists[i];
+
+			background_data[i] = data;
+		}
+
+		j_helper_execute_parallel(j_distributed_object_write_background_operation, background_data, server_count);
+
+		j_list_iterator_free(it);
+		it = j_list_iterator_new(operations);
+
+		for (guint j = 0; j_list_iterator_next(it); j++)
+		{
+			JDistributedObjectOperation* operation = j_list_iterator_get(it);
+			guint64 length;
+
+			length = j_helper_strided_length(operation->write_strided.length, operation->write_strided.dimensions, operation->write_strided.count);
+			j_helper_atomic_add(operation->write_strided.bytes_written, operation_bytes[j]);
+
+			// Servers report how many bytes have been written unless the safety is none
+			if (safety != J_SEMANTICS_SAFETY_NONE && operation_bytes[j] != length)
+			{
+				ret = FALSE;
+			}
+		}
+	}
+	else if (opened)
+	{
+		ret = j_backend_object_close(object_backend, object_handle) && ret;
+	}
+
+	return ret;
+}
+
 static gboolean
 j_distributed_object_status_exec(JList* operations, JSemantics* semantics)
 {
@@ -1586,6 +2154,132 @@ j_distributed_object_write(JDistributedObject* object, gconstpointer data, guint
 	*bytes_written = 0;
 }
 
+/**
+ * Reads a strided selection of an object.
+ *
+ * The selection consists of blocks of length bytes that start at offset + i_0 * stride[0] + ... + i_(n-1) * stride[n-1] for 0 <= i_d < count[d].
+ * The blocks are stored densely in data in row-major order, that is, the last dimension varies fastest.
+ * The selection is described to the servers instead of sending one operation per block.
+ *
+ * \note
+ * j_distributed_object_read_strided() modifies bytes_read even if j_batch_execute() is not called.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object     An object.
+ * \param data       A buffer to hold the read data.
+ * \param length     Number of bytes per block.
+ * \param offset     The offset of the first block within #object.
+ * \param dimensions Number of dimensions.
+ * \param count      Number of blocks per dimension.
+ * \param stride     Distance between blocks in bytes per dimension.
+ * \param bytes_read Number of bytes read.
+ * \param batch      A batch.
+ **/
+void
+j_distributed_object_read_strided(JDistributedObject* object, gpointer data, guint64 length, guint64 offset, guint32 dimensions, guint64 const* count, guint64 const* stride, guint64* bytes_read, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectOperation* iop;
+	JOperation* operation;
+
+	g_return_if_fail(object != NULL);
+	g_return_if_fail(data != NULL);
+	g_return_if_fail(dimensions <= J_HELPER_STRIDED_DIMENSIONS_MAX);
+	g_return_if_fail(j_helper_strided_length(length, dimensions, count) > 0);
+	g_return_if_fail(bytes_read != NULL);
+
+	for (guint32 i = 0; i < dimensions; i++)
+	{
+		g_return_if_fail(count[i] > 0);
+		g_return_if_fail(stride[i] > 0);
+	}
+
+	iop = g_slice_new(JDistributedObjectOperation);
+	iop->read_strided.object = j_distributed_object_ref(object);
+	iop->read_strided.data = data;
+	iop->read_strided.length = length;
+	iop->read_strided.offset = offset;
+	iop->read_strided.dimensions = dimensions;
+	iop->read_strided.count = g_memdup2(count, dimensions * sizeof(guint64));
+	iop->read_strided.stride = g_memdup2(stride, dimensions * sizeof(guint64));
+	iop->read_strided.bytes_read = bytes_read;
+
+	operation = j_operation_new();
+	operation->key = object;
+	operation->data = iop;
+	operation->exec_func = j_distributed_object_read_strided_exec;
+	operation->free_func = j_distributed_object_read_strided_free;
+
+	j_batch_add(batch, operation);
+
+	*bytes_read = 0;
+}
+
+/**
+ * Writes a strided selection of an object.
+ *
+ * The selection is described as for j_distributed_object_read_strided(), data contains the blocks densely packed.
+ *
+ * \note
+ * j_distributed_object_write_strided() modifies bytes_written even if j_batch_execute() is not called.
+ *
+ * \code
+ * \endcode
+ *
+ * \param object        An object.
+ * \param data          A buffer holding the data to write.
+ * \param length        Number of bytes per block.
+ * \param offset        The offset of the first block within #object.
+ * \param dimensions    Number of dimensions.
+ * \param count         Number of blocks per dimension.
+ * \param stride        Distance between blocks in bytes per dimension.
+ * \param bytes_written Number of bytes written.
+ * \param batch         A batch.
+ **/
+void
+j_distributed_object_write_strided(JDistributedObject* object, gconstpointer data, guint64 length, guint64 offset, guint32 dimensions, guint64 const* count, guint64 const* stride, guint64* bytes_written, JBatch* batch)
+{
+	J_TRACE_FUNCTION(NULL);
+
+	JDistributedObjectOperation* iop;
+	JOperation* operation;
+
+	g_return_if_fail(object != NULL);
+	g_return_if_fail(data != NULL);
+	g_return_if_fail(dimensions <= J_HELPER_STRIDED_DIMENSIONS_MAX);
+	g_return_if_fail(j_helper_strided_length(length, dimensions, count) > 0);
+	g_return_if_fail(bytes_written != NULL);
+
+	for (guint32 i = 0; i < dimensions; i++)
+	{
+		g_return_if_fail(count[i] > 0);
+		g_return_if_fail(stride[i] > 0);
+	}
+
+	iop = g_slice_new(JDistributedObjectOperation);
+	iop->write_strided.object = j_distributed_object_ref(object);
+	iop->write_strided.data = data;
+	iop->write_strided.length = length;
+	iop->write_strided.offset = offset;
+	iop->write_strided.dimensions = dimensions;
+	iop->write_strided.count = g_memdup2(count, dimensions * sizeof(guint64));
+	iop->write_strided.stride = g_memdup2(stride, dimensions * sizeof(guint64));
+	iop->write_strided.bytes_written = bytes_written;
+
+	operation = j_operation_new();
+	operation->key = object;
+	operation->data = iop;
+	operation->exec_func = j_distributed_object_write_strided_exec;
+	operation->free_func = j_distributed_object_write_strided_free;
+
+	j_batch_add(batch, operation);
+
+	*bytes_written = 0;
+}
+
 /**
  * Get the status of an object.
  *
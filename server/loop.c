@@ -28,6 +28,103 @@
 
 static guint jd_thread_num = 0;
 
+/**
+ * State for transferring the runs of a strided selection, see j_helper_strided_foreach().
+ **/
+struct JdStridedData
+{
+	gpointer object;
+	gchar* buf;
+	guint64 bytes;
+};
+
+typedef struct JdStridedData JdStridedData;
+
+static gboolean
+jd_object_read_strided_run(guint64 length, guint64 offset, guint64 position, gpointer data)
+{
+	JdStridedData* strided_data = data;
+	guint64 bytes_read = 0;
+
+	j_backend_object_read(jd_object_backend, strided_data->object, strided_data->buf + position, length, offset, &bytes_read);
+	strided_data->bytes += bytes_read;
+
+	// The reply contains the densely packed data up to the first short read
+	return (bytes_read == length);
+}
+
+static gboolean
+jd_object_write_strided_run(guint64 length, guint64 offset, guint64 position, gpointer data)
+{
+	JdStridedData* strided_data = data;
+	guint64 bytes_written = 0;
+
+	j_backend_object_write(jd_object_backend, strided_data->object, strided_data->buf + position, length, offset, &bytes_written);
+	strided_data->bytes += bytes_written;
+
+	return (bytes_written == length);
+}
+
+/**
+ * Skips length bytes of a message's payload that are not going to be processed.
+ * This keeps the connection usable since the client sends the payload regardless of errors.
+ **/
+static void
+jd_skip_input(GInputStream* input, guint64 length)
+{
+	while (length > 0)
+	{
+		gssize skipped;
+
+		skipped = g_input_stream_skip(input, MIN(length, G_MAXSSIZE), NULL, NULL);
+
+		if (skipped <= 0)
+		{
+			break;
+		}
+
+		length -= skipped;
+	}
+}
+
+/**
+ * Reads the description of a strided selection from message.
+ * count and stride have to be freed by the caller.
+ *
+ * \return FALSE if the description is invalid, the rest of the message cannot be parsed in this case.
+ **/
+static gboolean
+jd_object_get_strided(JMessage* message, guint64* length, guint64* offset, guint32* dimensions, guint64** count, guint64** stride, guint64* total_length)
+{
+	gboolean empty;
+
+	*length = j_message_get_8(message);
+	*offset = j_message_get_8(message);
+	*dimensions = j_message_get_4(message);
+	*total_length = 0;
+
+	if (*dimensions > J_HELPER_STRIDED_DIMENSIONS_MAX)
+	{
+		return FALSE;
+	}
+
+	*count = g_new(guint64, *dimensions);
+	*stride = g_new(guint64, *dimensions);
+	empty = (*length == 0);
+
+	for (guint32 i = 0; i < *dimensions; i++)
+	{
+		(*count)[i] = j_message_get_8(message);
+		(*stride)[i] = j_message_get_8(message);
+		empty = empty || (*count)[i] == 0;
+	}
+
+	*total_length = j_helper_strided_length(*length, *dimensions, *count);
+
+	// A total length of 0 is only valid for empty selections, otherwise the length has overflowed
+	return (*total_length > 0 || empty);
+}
+
 gboolean
 jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk* memory_chunk, guint64 memory_chunk_size, JStatistics* statistics)
 {
@@ -326,6 +423,180 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			j_memory_chunk_reset(memory_chunk);
 		}
 		break;
+		case J_MESSAGE_OBJECT_READ_STRIDED:
+		{
+			JMessage* reply;
+			gpointer object = NULL;
+			gboolean opened;
+
+			namespace = j_message_get_string(message);
+			path = j_message_get_string(message);
+
+			reply = j_message_new_reply(message);
+
+			opened = j_backend_object_open(jd_object_backend, namespace, path, &object);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				g_autofree guint64* count = NULL;
+				g_autofree guint64* stride = NULL;
+				JdStridedData strided_data;
+				guint64 length;
+				guint64 offset;
+				guint64 total_length;
+				guint32 dimensions;
+
+				if (!jd_object_get_strided(message, &length, &offset, &dimensions, &count, &stride, &total_length))
+				{
+					// The following operations cannot be parsed, the client notices the error because the connection is closed
+					g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+					break;
+				}
+
+				strided_data.object = object;
+				strided_data.bytes = 0;
+
+				if (!opened || total_length > memory_chunk_size)
+				{
+					// The client notices the error because no data is returned
+					j_message_add_operation(reply, sizeof(guint64));
+					j_message_append_8(reply, &strided_data.bytes);
+					continue;
+				}
+
+				strided_data.buf = j_memory_chunk_get(memory_chunk, total_length);
+
+				if (strided_data.buf == NULL)
+				{
+					// The memory chunk is full, so the data gathered so far is sent in a separate reply
+					// The client keeps receiving replies until all operations have been answered
+					j_message_send(reply, connection);
+					j_message_unref(reply);
+
+					reply = j_message_new_reply(message);
+
+					j_memory_chunk_reset(memory_chunk);
+					strided_data.buf = j_memory_chunk_get(memory_chunk, total_length);
+				}
+
+				// The selection is gathered into a dense buffer, so the reply only contains the selected data
+				j_helper_strided_foreach(length, offset, dimensions, count, stride, jd_object_read_strided_run, &strided_data);
+				j_statistics_add(statistics, J_STATISTICS_BYTES_READ, strided_data.bytes);
+
+				j_message_add_operation(reply, sizeof(guint64));
+				j_message_append_8(reply, &strided_data.bytes);
+
+				if (strided_data.bytes > 0)
+				{
+					j_message_add_send(reply, strided_data.buf, strided_data.bytes);
+				}
+
+				j_statistics_add(statistics, J_STATISTICS_BYTES_SENT, strided_data.bytes);
+			}
+
+			if (opened)
+			{
+				j_backend_object_close(jd_object_backend, object);
+			}
+
+			j_message_send(reply, connection);
+			j_message_unref(reply);
+
+			j_memory_chunk_reset(memory_chunk);
+		}
+		break;
+		case J_MESSAGE_OBJECT_WRITE_STRIDED:
+		{
+			g_autoptr(JMessage) reply = NULL;
+			GInputStream* input;
+			gpointer object = NULL;
+			gboolean opened;
+
+			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
+			{
+				reply = j_message_new_reply(message);
+			}
+
+			namespace = j_message_get_string(message);
+			path = j_message_get_string(message);
+
+			input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
+			opened = j_backend_object_open(jd_object_backend, namespace, path, &object);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				g_autofree guint64* count = NULL;
+				g_autofree guint64* stride = NULL;
+				JdStridedData strided_data;
+				guint64 length;
+				guint64 offset;
+				guint64 total_length;
+				guint32 dimensions;
+
+				if (!jd_object_get_strided(message, &length, &offset, &dimensions, &count, &stride, &total_length))
+				{
+					// The size of the following data is unknown, so it cannot be skipped and the connection is closed instead
+					g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+					break;
+				}
+
+				strided_data.object = object;
+				strided_data.bytes = 0;
+
+				if (!opened || total_length > memory_chunk_size)
+				{
+					// The data cannot be written, skip it and report that no bytes have been written
+					jd_skip_input(input, total_length);
+					j_statistics_add(statistics, J_STATISTICS_BYTES_RECEIVED, total_length);
+
+					if (reply != NULL)
+					{
+						j_message_add_operation(reply, sizeof(guint64));
+						j_message_append_8(reply, &strided_data.bytes);
+					}
+
+					continue;
+				}
+
+				// Guaranteed to work because memory_chunk is reset below
+				strided_data.buf = j_memory_chunk_get(memory_chunk, total_length);
+				g_assert(strided_data.buf != NULL);
+
+				g_input_stream_read_all(input, strided_data.buf, total_length, NULL, NULL, NULL);
+				j_statistics_add(statistics, J_STATISTICS_BYTES_RECEIVED, total_length);
+
+				// The densely packed data is scattered according to the selection
+				j_helper_strided_foreach(length, offset, dimensions, count, stride, jd_object_write_strided_run, &strided_data);
+				j_statistics_add(statistics, J_STATISTICS_BYTES_WRITTEN, strided_data.bytes);
+
+				if (reply != NULL)
+				{
+					j_message_add_operation(reply, sizeof(guint64));
+					j_message_append_8(reply, &strided_data.bytes);
+				}
+
+				j_memory_chunk_reset(memory_chunk);
+			}
+
+			if (opened)
+			{
+				if (safety == J_SEMANTICS_SAFETY_STORAGE)
+				{
+					j_backend_object_sync(jd_object_backend, object);
+					j_statistics_add(statistics, J_STATISTICS_SYNC, 1);
+				}
+
+				j_backend_object_close(jd_object_backend, object);
+			}
+
+			if (reply != NULL)
+			{
+				j_message_send(reply, connection);
+			}
+
+			j_memory_chunk_reset(memory_chunk);
+		}
+		break;
 		case J_MESSAGE_OBJECT_STATUS:
 		{
 			g_autoptr(JMessage) reply = NULL;
@@ -475,7 +746,10 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 		case J_MESSAGE_KV_PUT:
 		{
 			g_autoptr(JMessage) reply = NULL;
+			g_autoptr(GPtrArray) buffers = NULL;
+			g_autofree gboolean* rets = NULL;
 			gpointer batch;
+			gboolean ret;
 
 			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 			{
@@ -485,32 +759,61 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			namespace = j_message_get_string(message);
 			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
 
+			buffers = g_ptr_array_new_with_free_func(g_free);
+			rets = g_new0(gboolean, operation_count);
+
 			for (i = 0; i < operation_count; i++)
 			{
 				gconstpointer data;
 				guint32 len;
-				gboolean ret;
 
 				key = j_message_get_string(message);
 				len = j_message_get_4(message);
-				data = j_message_get_n(message, len);
-
-				ret = j_backend_kv_put(jd_kv_backend, batch, key, data, len);
 
-				if (reply != NULL)
+				if (len <= J_MESSAGE_INLINE_MAX)
 				{
-					guint32 dummy;
+					data = j_message_get_n(message, len);
+				}
+				else
+				{
+					GInputStream* input;
+					gchar* buf;
 
-					dummy = (ret) ? 1 : 0;
-					j_message_add_operation(reply, 4);
-					j_message_append_4(reply, &dummy);
+					input = g_io_stream_get_input_stream(G_IO_STREAM(connection));
+
+					// The values have to be kept until the batch is executed, use the memory chunk as long as possible
+					buf = j_memory_chunk_get(memory_chunk, len);
+
+					if (buf == NULL)
+					{
+						buf = g_malloc(len);
+						g_ptr_array_add(buffers, buf);
+					}
+
+					g_input_stream_read_all(input, buf, len, NULL, NULL, NULL);
+					j_statistics_add(statistics, J_STATISTICS_BYTES_RECEIVED, len);
+
+					data = buf;
 				}
+
+				rets[i] = j_backend_kv_put(jd_kv_backend, batch, key, data, len);
 			}
 
-			j_backend_kv_batch_execute(jd_kv_backend, batch);
+			// The puts are only applied when the batch is executed, which might fail
+			ret = j_backend_kv_batch_execute(jd_kv_backend, batch);
+			j_memory_chunk_reset(memory_chunk);
 
 			if (reply != NULL)
 			{
+				for (i = 0; i < operation_count; i++)
+				{
+					guint32 status;
+
+					status = (ret && rets[i]) ? 1 : 0;
+					j_message_add_operation(reply, 4);
+					j_message_append_4(reply, &status);
+				}
+
 				j_message_send(reply, connection);
 			}
 		}
@@ -518,7 +821,9 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 		case J_MESSAGE_KV_DELETE:
 		{
 			g_autoptr(JMessage) reply = NULL;
+			g_autofree gboolean* rets = NULL;
 			gpointer batch;
+			gboolean ret;
 
 			if (safety == J_SEMANTICS_SAFETY_NETWORK || safety == J_SEMANTICS_SAFETY_STORAGE)
 			{
@@ -528,28 +833,29 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			namespace = j_message_get_string(message);
 			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
 
+			rets = g_new(gboolean, operation_count);
+
 			for (i = 0; i < operation_count; i++)
 			{
-				gboolean ret;
-
 				key = j_message_get_string(message);
 
-				ret = j_backend_kv_delete(jd_kv_backend, batch, key);
+				rets[i] = j_backend_kv_delete(jd_kv_backend, batch, key);
+			}
+
+			// The deletes are only applied when the batch is executed, which might fail
+			ret = j_backend_kv_batch_execute(jd_kv_backend, batch);
 
-				if (reply != NULL)
+			if (reply != NULL)
+			{
+				for (i = 0; i < operation_count; i++)
 				{
-					guint32 dummy;
+					guint32 status;
 
-					dummy = (ret) ? 1 : 0;
+					status = (ret && rets[i]) ? 1 : 0;
 					j_message_add_operation(reply, 4);
-					j_message_append_4(reply, &dummy);
+					j_message_append_4(reply, &status);
 				}
-			}
-
-			j_backend_kv_batch_execute(jd_kv_backend, batch);
 
-			if (reply != NULL)
-			{
 				j_message_send(reply, connection);
 			}
 		}
@@ -559,10 +865,16 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			g_autoptr(JMessage) reply = NULL;
 			gpointer batch;
 
+			g_autoptr(GPtrArray) values = NULL;
+			guint64 values_len = 0;
+
 			reply = j_message_new_reply(message);
 			namespace = j_message_get_string(message);
 			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
 
+			// Large values are sent without copying them, so they have to be kept until the reply has been sent
+			values = g_ptr_array_new_with_free_func(g_free);
+
 			for (i = 0; i < operation_count; i++)
 			{
 				gpointer value;
@@ -572,11 +884,36 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 
 				if (j_backend_kv_get(jd_kv_backend, batch, key, &value, &len))
 				{
-					j_message_add_operation(reply, 4 + len);
-					j_message_append_4(reply, &len);
-					j_message_append_n(reply, value, len);
+					if (len <= J_MESSAGE_INLINE_MAX)
+					{
+						j_message_add_operation(reply, 4 + len);
+						j_message_append_4(reply, &len);
+						j_message_append_n(reply, value, len);
 
-					g_free(value);
+						g_free(value);
+					}
+					else
+					{
+						if (values_len > 0 && values_len + len > memory_chunk_size)
+						{
+							// Bound the memory usage by sending multiple replies
+							j_message_send(reply, connection);
+							j_message_unref(reply);
+							reply = j_message_new_reply(message);
+
+							g_ptr_array_set_size(values, 0);
+							values_len = 0;
+						}
+
+						j_message_add_operation(reply, 4);
+						j_message_append_4(reply, &len);
+						j_message_add_send(reply, value, len);
+
+						g_ptr_array_add(values, value);
+						values_len += len;
+
+						j_statistics_add(statistics, J_STATISTICS_BYTES_SENT, len);
+					}
 				}
 				else
 				{
@@ -592,6 +929,75 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			j_message_send(reply, connection);
 		}
 		break;
+		case J_MESSAGE_KV_GET_RANGE:
+		{
+			g_autoptr(JMessage) reply = NULL;
+			g_autoptr(GPtrArray) values = NULL;
+			guint64 values_len = 0;
+			gpointer batch;
+
+			reply = j_message_new_reply(message);
+			namespace = j_message_get_string(message);
+			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
+
+			values = g_ptr_array_new_with_free_func(g_free);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				gpointer value;
+				guint64 offset;
+				guint64 length;
+				guint64 bytes_read = 0;
+				guint32 len;
+				guint32 status = 0;
+
+				key = j_message_get_string(message);
+				offset = j_message_get_8(message);
+				length = j_message_get_8(message);
+
+				// Only the requested range is read from the backend
+				if (j_backend_kv_get_range(jd_kv_backend, batch, key, offset, length, &value, &len))
+				{
+					status = 1;
+					bytes_read = len;
+				}
+
+				if (bytes_read > 0)
+				{
+					if (values_len > 0 && values_len + bytes_read > memory_chunk_size)
+					{
+						// Bound the memory usage by sending multiple replies
+						j_message_send(reply, connection);
+						j_message_unref(reply);
+						reply = j_message_new_reply(message);
+
+						g_ptr_array_set_size(values, 0);
+						values_len = 0;
+					}
+
+					// The range is sent directly from the backend's copy
+					j_message_add_send(reply, value, bytes_read);
+
+					g_ptr_array_add(values, value);
+					values_len += bytes_read;
+
+					j_statistics_add(statistics, J_STATISTICS_BYTES_SENT, bytes_read);
+				}
+				else if (status)
+				{
+					g_free(value);
+				}
+
+				j_message_add_operation(reply, 4 + 8);
+				j_message_append_4(reply, &status);
+				j_message_append_8(reply, &bytes_read);
+			}
+
+			j_backend_kv_batch_execute(jd_kv_backend, batch);
+
+			j_message_send(reply, connection);
+		}
+		break;
 		case J_MESSAGE_KV_GET_ALL:
 		{
 			g_autoptr(JMessage) reply = NULL;
@@ -656,6 +1062,144 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 			j_message_send(reply, connection);
 		}
 		break;
+		case J_MESSAGE_KV_PUT_IF_ABSENT:
+		{
+			g_autoptr(JMessage) reply = NULL;
+			g_autofree gboolean* rets = NULL;
+			g_autofree gboolean* inserted = NULL;
+			gpointer batch;
+			gboolean ret;
+
+			reply = j_message_new_reply(message);
+			namespace = j_message_get_string(message);
+			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
+
+			rets = g_new(gboolean, operation_count);
+			inserted = g_new(gboolean, operation_count);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				gconstpointer data;
+				guint32 len;
+
+				key = j_message_get_string(message);
+				len = j_message_get_4(message);
+				data = j_message_get_n(message, len);
+
+				rets[i] = j_backend_kv_put_if_absent(jd_kv_backend, batch, key, data, len, &(inserted[i]));
+			}
+
+			// Results are only guaranteed to be available after the batch has been executed
+			ret = j_backend_kv_batch_execute(jd_kv_backend, batch);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				guint32 status;
+				guint32 result;
+
+				status = (ret && rets[i]) ? 1 : 0;
+				result = (status && inserted[i]) ? 1 : 0;
+
+				j_message_add_operation(reply, 4 + 4);
+				j_message_append_4(reply, &status);
+				j_message_append_4(reply, &result);
+			}
+
+			j_message_send(reply, connection);
+		}
+		break;
+		case J_MESSAGE_KV_COMPARE_AND_SWAP:
+		{
+			g_autoptr(JMessage) reply = NULL;
+			g_autofree gboolean* rets = NULL;
+			g_autofree gboolean* swapped = NULL;
+			gpointer batch;
+			gboolean ret;
+
+			reply = j_message_new_reply(message);
+			namespace = j_message_get_string(message);
+			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
+
+			rets = g_new(gboolean, operation_count);
+			swapped = g_new(gboolean, operation_count);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				gconstpointer expected;
+				gconstpointer data;
+				guint32 expected_len;
+				guint32 len;
+
+				key = j_message_get_string(message);
+				expected_len = j_message_get_4(message);
+				expected = j_message_get_n(message, expected_len);
+				len = j_message_get_4(message);
+				data = j_message_get_n(message, len);
+
+				rets[i] = j_backend_kv_compare_and_swap(jd_kv_backend, batch, key, expected, expected_len, data, len, &(swapped[i]));
+			}
+
+			// Results are only guaranteed to be available after the batch has been executed
+			ret = j_backend_kv_batch_execute(jd_kv_backend, batch);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				guint32 status;
+				guint32 result;
+
+				status = (ret && rets[i]) ? 1 : 0;
+				result = (status && swapped[i]) ? 1 : 0;
+
+				j_message_add_operation(reply, 4 + 4);
+				j_message_append_4(reply, &status);
+				j_message_append_4(reply, &result);
+			}
+
+			j_message_send(reply, connection);
+		}
+		break;
+		case J_MESSAGE_KV_FETCH_ADD:
+		{
+			g_autoptr(JMessage) reply = NULL;
+			g_autofree gboolean* rets = NULL;
+			g_autofree gint64* previous = NULL;
+			gpointer batch;
+			gboolean ret;
+
+			reply = j_message_new_reply(message);
+			namespace = j_message_get_string(message);
+			j_backend_kv_batch_start(jd_kv_backend, namespace, semantics, &batch);
+
+			rets = g_new(gboolean, operation_count);
+			previous = g_new(gint64, operation_count);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				gint64 delta;
+
+				key = j_message_get_string(message);
+				delta = j_message_get_8(message);
+
+				rets[i] = j_backend_kv_fetch_add(jd_kv_backend, batch, key, delta, &(previous[i]));
+			}
+
+			// Results are only guaranteed to be available after the batch has been executed
+			ret = j_backend_kv_batch_execute(jd_kv_backend, batch);
+
+			for (i = 0; i < operation_count; i++)
+			{
+				guint32 status;
+
+				status = (ret && rets[i]) ? 1 : 0;
+
+				j_message_add_operation(reply, 4 + 8);
+				j_message_append_4(reply, &status);
+				j_message_append_8(reply, &(previous[i]));
+			}
+
+			j_message_send(reply, connection);
+		}
+		break;
 		case J_MESSAGE_DB_SCHEMA_CREATE:
 			if (!message_matched)
 			{
@@ -684,6 +1228,13 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				message_matched = TRUE;
 			}
 			// fallthrough
+		case J_MESSAGE_DB_INSERT_MANY:
+			if (!message_matched)
+			{
+				memcpy(&backend_operation, &j_backend_operation_db_insert_many, sizeof(JBackendOperation));
+				message_matched = TRUE;
+			}
+			// fallthrough
 		case J_MESSAGE_DB_UPDATE:
 			if (!message_matched)
 			{
@@ -704,6 +1255,20 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 				memcpy(&backend_operation, &j_backend_operation_db_query, sizeof(JBackendOperation));
 				message_matched = TRUE;
 			}
+			// fallthrough
+		case J_MESSAGE_DB_QUERY_NEXT:
+			if (!message_matched)
+			{
+				memcpy(&backend_operation, &j_backend_operation_db_query_next, sizeof(JBackendOperation));
+				message_matched = TRUE;
+			}
+			// fallthrough
+		case J_MESSAGE_DB_QUERY_CLOSE:
+			if (!message_matched)
+			{
+				memcpy(&backend_operation, &j_backend_operation_db_query_close, sizeof(JBackendOperation));
+				message_matched = TRUE;
+			}
 			{
 				g_autoptr(JMessage) reply = NULL;
 				GError* error = NULL;
@@ -724,6 +1289,11 @@ jd_handle_message(JMessage* message, GSocketConnection* connection, JMemoryChunk
 						backend_operation.out_param[j].bson_initialized = FALSE;
 						backend_operation.out_param[j].ptr = &backend_operation.out_param[j].bson;
 					}
+					else if (backend_operation.out_param[j].type == J_BACKEND_OPERATION_PARAM_TYPE_BLOB)
+					{
+						backend_operation.out_param[j].value = 0;
+						backend_operation.out_param[j].ptr = &backend_operation.out_param[j].value;
+					}
 				}
 
 				if (operation_count)
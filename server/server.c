@@ -84,6 +84,12 @@ jd_on_run(GThreadedSocketService* service, GSocketConnection* connection, GObjec
 		jd_handle_message(message, connection, memory_chunk, memory_chunk_size, statistics);
 	}
 
+	if (jd_db_backend != NULL)
+	{
+		// Query cursors are bound to the connection's thread and have to be released before it is reused
+		j_backend_operation_db_cursors_free();
+	}
+
 	{
 		guint64 value;
 
@@ -0,0 +1,218 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2010-2021 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <string.h>
+
+#include <bson.h>
+
+#include <julea.h>
+
+#include <jbackend.h>
+
+#include "test.h"
+
+static JBackendDBRow*
+test_backend_row_new(void)
+{
+	JBackendDBRow* row;
+	bson_t selector[1];
+	bson_t array[1];
+
+	bson_init(selector);
+	bson_append_array_begin(selector, "_row", -1, array);
+	bson_append_utf8(array, "0", -1, "_id", -1);
+	bson_append_utf8(array, "1", -1, "count", -1);
+	bson_append_utf8(array, "2", -1, "value", -1);
+	bson_append_utf8(array, "3", -1, "name", -1);
+	bson_append_utf8(array, "4", -1, "data", -1);
+	bson_append_array_end(selector, array);
+
+	row = j_backend_db_row_new(selector);
+
+	bson_destroy(selector);
+
+	return row;
+}
+
+static void
+test_backend_row_new_free(void)
+{
+	JBackendDBRow* row;
+	bson_t selector[1];
+
+	bson_init(selector);
+	row = j_backend_db_row_new(selector);
+	g_assert_null(row);
+	bson_destroy(selector);
+
+	row = test_backend_row_new();
+	g_assert_nonnull(row);
+
+	g_assert_cmpint(j_backend_db_row_get_index(row, "_id"), ==, 0);
+	g_assert_cmpint(j_backend_db_row_get_index(row, "data"), ==, 4);
+	g_assert_cmpint(j_backend_db_row_get_index(row, "unknown"), ==, -1);
+
+	j_backend_db_row_free(row);
+}
+
+static void
+test_backend_row_append(void)
+{
+	g_autoptr(GByteArray) buffer = NULL;
+	JBackendDBRow* row;
+	gconstpointer data;
+	gconstpointer value;
+	guint8 blob[3] = { 1, 2, 3 };
+	gint32 val_int32;
+	gint64 val_int64;
+	gdouble val_double;
+	guint32 length;
+
+	buffer = g_byte_array_new();
+	row = test_backend_row_new();
+
+	j_backend_db_row_set_int32(row, 0, 42);
+	j_backend_db_row_set_int64(row, 1, G_GINT64_CONSTANT(1099511627776));
+	j_backend_db_row_set_double(row, 2, 23.5);
+	j_backend_db_row_set_data(row, 3, "julea", 6);
+	j_backend_db_row_set_data(row, 4, blob, sizeof(blob));
+	j_backend_db_row_append(row, buffer);
+
+	// The second row only has an ID
+	j_backend_db_row_set_int32(row, 0, 43);
+	j_backend_db_row_append(row, buffer);
+
+	j_backend_db_row_free(row);
+
+	data = buffer->data;
+
+	memcpy(&val_int32, j_backend_db_row_get(data, 5, 0), sizeof(val_int32));
+	g_assert_cmpint(val_int32, ==, 42);
+	memcpy(&val_int64, j_backend_db_row_get(data, 5, 1), sizeof(val_int64));
+	g_assert_cmpint(val_int64, ==, G_GINT64_CONSTANT(1099511627776));
+	memcpy(&val_double, j_backend_db_row_get(data, 5, 2), sizeof(val_double));
+	g_assert_cmpfloat(val_double, ==, 23.5);
+
+	value = j_backend_db_row_get_data(data, 5, 3, &length);
+	g_assert_cmpuint(length, ==, 6);
+	g_assert_cmpstr(value, ==, "julea");
+
+	value = j_backend_db_row_get_data(data, 5, 4, &length);
+	g_assert_cmpmem(value, length, blob, sizeof(blob));
+
+	data = (guint8 const*)data + j_backend_db_row_get_length(data);
+
+	memcpy(&val_int32, j_backend_db_row_get(data, 5, 0), sizeof(val_int32));
+	g_assert_cmpint(val_int32, ==, 43);
+	g_assert_null(j_backend_db_row_get(data, 5, 1));
+
+	value = j_backend_db_row_get_data(data, 5, 3, &length);
+	g_assert_null(value);
+	g_assert_cmpuint(length, ==, 0);
+
+	data = (guint8 const*)data + j_backend_db_row_get_length(data);
+	g_assert_true(data == buffer->data + buffer->len);
+}
+
+static void
+test_backend_row_set_bson(void)
+{
+	g_autoptr(GByteArray) buffer = NULL;
+	JBackendDBRow* row;
+	bson_t metadata[1];
+	gint64 val_int64;
+	guint32 length;
+	gboolean ret;
+
+	buffer = g_byte_array_new();
+	row = test_backend_row_new();
+
+	bson_init(metadata);
+	bson_append_int64(metadata, "count", -1, 7);
+	bson_append_utf8(metadata, "name", -1, "julea", -1);
+	bson_append_null(metadata, "data", -1);
+	bson_append_int32(metadata, "unknown", -1, 1);
+
+	ret = j_backend_db_row_set_bson(row, metadata, NULL);
+	g_assert_true(ret);
+	j_backend_db_row_append(row, buffer);
+
+	bson_destroy(metadata);
+	j_backend_db_row_free(row);
+
+	g_assert_null(j_backend_db_row_get(buffer->data, 5, 0));
+	memcpy(&val_int64, j_backend_db_row_get(buffer->data, 5, 1), sizeof(val_int64));
+	g_assert_cmpint(val_int64, ==, 7);
+	g_assert_cmpstr(j_backend_db_row_get_data(buffer->data, 5, 3, &length), ==, "julea");
+	g_assert_null(j_backend_db_row_get(buffer->data, 5, 4));
+}
+
+static void
+test_backend_row_check(void)
+{
+	g_autoptr(GByteArray) buffer = NULL;
+	JBackendDBRow* row;
+	guint32 length;
+	guint32 offset;
+	gboolean ret;
+
+	buffer = g_byte_array_new();
+	row = test_backend_row_new();
+
+	j_backend_db_row_set_int32(row, 0, 42);
+	j_backend_db_row_set_data(row, 3, "julea", 6);
+	j_backend_db_row_append(row, buffer);
+
+	j_backend_db_row_free(row);
+
+	ret = j_backend_db_row_check(buffer->data, buffer->len, 5, NULL);
+	g_assert_true(ret);
+
+	// The row exceeds the available bytes
+	ret = j_backend_db_row_check(buffer->data, buffer->len - 1, 5, NULL);
+	g_assert_false(ret);
+
+	// The row is too short to contain the slots of all columns
+	ret = j_backend_db_row_check(buffer->data, buffer->len, 1000, NULL);
+	g_assert_false(ret);
+
+	// The string's offset points behind the row, its slot follows the header, the bitmap and three other slots
+	offset = buffer->len;
+	memcpy(buffer->data + sizeof(guint32) + 8 + (8 * 3), &offset, sizeof(offset));
+	g_assert_null(j_backend_db_row_get_data(buffer->data, 5, 3, &length));
+	g_assert_cmpuint(length, ==, 0);
+
+	// Rows of length 0 are rejected
+	length = 0;
+	memcpy(buffer->data, &length, sizeof(length));
+	ret = j_backend_db_row_check(buffer->data, buffer->len, 5, NULL);
+	g_assert_false(ret);
+}
+
+void
+test_core_backend_row(void)
+{
+	g_test_add_func("/core/backend-row/new_free", test_backend_row_new_free);
+	g_test_add_func("/core/backend-row/append", test_backend_row_append);
+	g_test_add_func("/core/backend-row/set_bson", test_backend_row_set_bson);
+	g_test_add_func("/core/backend-row/check", test_backend_row_check);
+}
@@ -107,6 +107,81 @@ test_db_schema_create_delete(void)
 	g_assert_true(ret);
 }
 
+static JDBSchema*
+test_db_schema_get_cached_get(gchar const* name)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	JDBSchema* schema;
+	gboolean ret;
+
+	schema = j_db_schema_new("test-ns", name, &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_get(schema, batch, &error);
+	g_assert_true(ret);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	return schema;
+}
+
+static void
+test_db_schema_get_cached(void)
+{
+	gchar const* name = "test-schema-cached";
+	gchar const* fields[] = { "field-0", "field-1" };
+
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	JDBType type;
+	gboolean ret;
+
+	// The schema is recreated with a different field, so a cached schema must not be used anymore
+	for (guint i = 0; i < G_N_ELEMENTS(fields); i++)
+	{
+		g_autoptr(GError) error = NULL;
+		g_autoptr(JDBSchema) schema = NULL;
+
+		schema = j_db_schema_new("test-ns", name, &error);
+		g_assert_nonnull(schema);
+		g_assert_no_error(error);
+
+		ret = j_db_schema_add_field(schema, fields[i], J_DB_TYPE_UINT64, &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		ret = j_db_schema_create(schema, batch, NULL);
+		g_assert_true(ret);
+		ret = j_batch_execute(batch);
+		g_assert_true(ret);
+
+		// The second get is answered from the cache
+		for (guint j = 0; j < 2; j++)
+		{
+			g_autoptr(JDBSchema) schema_get = NULL;
+
+			schema_get = test_db_schema_get_cached_get(name);
+
+			ret = j_db_schema_get_field(schema_get, fields[i], &type, &error);
+			g_assert_true(ret);
+			g_assert_no_error(error);
+			g_assert_cmpuint(type, ==, J_DB_TYPE_UINT64);
+
+			ret = j_db_schema_get_field(schema_get, fields[(i + 1) % G_N_ELEMENTS(fields)], &type, &error);
+			g_assert_false(ret);
+			g_assert_nonnull(error);
+			g_clear_error(&error);
+		}
+
+		ret = j_db_schema_delete(schema, batch, NULL);
+		g_assert_true(ret);
+		ret = j_batch_execute(batch);
+		g_assert_true(ret);
+	}
+}
+
 static void
 test_db_entry_new_free(void)
 {
@@ -233,6 +308,123 @@ test_db_entry_insert_update_delete(void)
 	g_assert_true(ret);
 }
 
+static void
+test_db_entry_update_delete_with_count(void)
+{
+	guint const n = 1000;
+
+	gchar const* file = "demo.bp";
+	guint64 dim = 4;
+	guint64 count = 0;
+
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	g_autoptr(JDBEntry) delete_entry = NULL;
+	g_autoptr(JDBEntry) update_entry = NULL;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+	gboolean ret;
+
+	schema = j_db_schema_new("test-ns", "test-schema", &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_add_field(schema, "string-0", J_DB_TYPE_STRING, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_add_field(schema, "uint-0", J_DB_TYPE_UINT64, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_create(schema, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_set_field(entry, "string-0", file, strlen(file), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_set_field(entry, "uint-0", &dim, sizeof(dim), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		// FIXME Do not pass error, will not exist anymore when batch is executed
+		ret = j_db_entry_insert(entry, batch, NULL);
+		g_assert_true(ret);
+	}
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+	g_assert_nonnull(selector);
+	g_assert_no_error(error);
+
+	ret = j_db_selector_add_field(selector, "string-0", J_DB_SELECTOR_OPERATOR_EQ, file, strlen(file), &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	update_entry = j_db_entry_new(schema, &error);
+	g_assert_nonnull(update_entry);
+	g_assert_no_error(error);
+
+	dim = 3;
+	ret = j_db_entry_set_field(update_entry, "uint-0", &dim, sizeof(dim), &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_db_entry_update_with_count(update_entry, selector, &count, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+	g_assert_cmpuint(count, ==, n);
+
+	delete_entry = j_db_entry_new(schema, &error);
+	g_assert_nonnull(delete_entry);
+	g_assert_no_error(error);
+
+	ret = j_db_entry_delete_with_count(delete_entry, selector, &count, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+	g_assert_cmpuint(count, ==, n);
+
+	// Nothing matches anymore, which is not an error.
+	ret = j_db_entry_delete_with_count(delete_entry, selector, &count, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(count, ==, 0);
+
+	ret = j_db_schema_delete(schema, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
 static void
 schema_create(void)
 {
@@ -532,13 +724,595 @@ test_db_all(void)
 	schema_delete();
 }
 
+static void
+test_db_entry_insert_many(void)
+{
+	// Large enough to require several multi-row statements
+	guint const n = 2500;
+
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JDBIterator) iterator = NULL;
+	g_autofree JDBEntry** entries = NULL;
+	guint64 previous_id = 0;
+	guint64 count = 0;
+	guint64 sum = 0;
+	gboolean ret;
+
+	schema = j_db_schema_new("test", "insert-many", &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_add_field(schema, "value", J_DB_TYPE_UINT64, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_add_field(schema, "name", J_DB_TYPE_STRING, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_db_schema_create(schema, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	entries = g_new(JDBEntry*, n);
+
+	for (guint64 i = 0; i < n; i++)
+	{
+		entries[i] = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entries[i]);
+		g_assert_no_error(error);
+
+		ret = j_db_entry_set_field(entries[i], "value", &i, sizeof(i), &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		// Leave some fields unset, they have to be inserted as NULL
+		if (i % 2 == 0)
+		{
+			ret = j_db_entry_set_field(entries[i], "name", "even", strlen("even"), &error);
+			g_assert_true(ret);
+			g_assert_no_error(error);
+		}
+	}
+
+	ret = j_db_entry_insert_many(entries, n, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	for (guint i = 0; i < n; i++)
+	{
+		g_autofree guint32* id = NULL;
+		guint64 len;
+
+		ret = j_db_entry_get_id(entries[i], (gpointer*)&id, &len, &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+		g_assert_cmpuint(len, ==, sizeof(guint32));
+
+		// Ids are returned in insertion order
+		g_assert_cmpuint(*id, >, previous_id);
+		previous_id = *id;
+
+		j_db_entry_unref(entries[i]);
+	}
+
+	iterator = j_db_iterator_new(schema, NULL, &error);
+	g_assert_nonnull(iterator);
+	g_assert_no_error(error);
+
+	while (j_db_iterator_next(iterator, NULL))
+	{
+		JDBType type;
+		guint64 len;
+		g_autofree guint64* value = NULL;
+
+		ret = j_db_iterator_get_field(iterator, "value", &type, (gpointer*)&value, &len, &error);
+		g_assert_true(ret);
+		g_assert_no_error(error);
+
+		count++;
+		sum += *value;
+	}
+
+	g_assert_cmpuint(count, ==, n);
+	g_assert_cmpuint(sum, ==, (guint64)n * (n - 1) / 2);
+
+	ret = j_db_schema_delete(schema, batch, &error);
+	g_assert_true(ret);
+	g_assert_no_error(error);
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+test_db_iterator_paged(void)
+{
+	g_autoptr(GError) error = NULL;
+
+	gboolean success;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+
+	guint32 page_size;
+	guint64 entry_count;
+	guint64 entries;
+	guint64 sum;
+
+	page_size = j_configuration_get_db_page_size(j_configuration());
+	// Make sure that the result spans several pages and that the last page is not full
+	entry_count = 2 * (guint64)page_size + 7;
+
+	schema = j_db_schema_new("test", "iterator-paged", &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+	success = j_db_schema_add_field(schema, "value", J_DB_TYPE_UINT64, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_create(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	for (guint64 i = 0; i < entry_count; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+		success = j_db_entry_set_field(entry, "value", &i, sizeof(i), &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_entry_insert(entry, batch, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+	}
+
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	// Iterate over all pages
+	{
+		g_autoptr(JDBIterator) iterator = NULL;
+
+		entries = 0;
+		sum = 0;
+
+		iterator = j_db_iterator_new(schema, NULL, &error);
+		g_assert_nonnull(iterator);
+		g_assert_no_error(error);
+
+		while (j_db_iterator_next(iterator, NULL))
+		{
+			JDBType type;
+			guint64 len;
+			g_autofree guint64* value = NULL;
+
+			success = j_db_iterator_get_field(iterator, "value", &type, (gpointer*)&value, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+
+			entries++;
+			sum += *value;
+		}
+
+		g_assert_cmpuint(entries, ==, entry_count);
+		g_assert_cmpuint(sum, ==, entry_count * (entry_count - 1) / 2);
+	}
+
+	// Stop in the middle of the first page, which has to close the cursor
+	for (guint i = 0; i < 4; i++)
+	{
+		g_autoptr(JDBIterator) iterator = NULL;
+
+		iterator = j_db_iterator_new(schema, NULL, &error);
+		g_assert_nonnull(iterator);
+		g_assert_no_error(error);
+
+		success = j_db_iterator_next(iterator, NULL);
+		g_assert_true(success);
+	}
+
+	success = j_db_schema_delete(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+}
+
+static void
+test_db_iterator_fields(void)
+{
+	g_autoptr(GError) error = NULL;
+
+	gboolean success;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+
+	gchar const* fields[] = { "value", "value", NULL };
+	gchar const* fields_invalid[] = { "invalid", NULL };
+	guint64 const entry_count = 10;
+	guint64 limit = 5;
+	guint64 entries;
+
+	schema = j_db_schema_new("test", "iterator-fields", &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+	success = j_db_schema_add_field(schema, "value", J_DB_TYPE_UINT64, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_add_field(schema, "name", J_DB_TYPE_STRING, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_create(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	for (guint64 i = 0; i < entry_count; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+		success = j_db_entry_set_field(entry, "value", &i, sizeof(i), &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_entry_set_field(entry, "name", "name", 0, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_entry_insert(entry, batch, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+	}
+
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+	g_assert_nonnull(selector);
+	g_assert_no_error(error);
+	success = j_db_selector_add_field(selector, "value", J_DB_SELECTOR_OPERATOR_LT, &limit, sizeof(limit), &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+
+	// Only the requested field is returned, both with and without a selector
+	for (guint i = 0; i < 2; i++)
+	{
+		g_autoptr(JDBIterator) iterator = NULL;
+
+		entries = 0;
+
+		iterator = j_db_iterator_new_with_fields(schema, (i == 0) ? NULL : selector, fields, &error);
+		g_assert_nonnull(iterator);
+		g_assert_no_error(error);
+
+		while (j_db_iterator_next(iterator, NULL))
+		{
+			JDBType type;
+			guint64 len;
+			g_autofree guint64* value = NULL;
+			g_autofree gchar* name = NULL;
+
+			success = j_db_iterator_get_field(iterator, "value", &type, (gpointer*)&value, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+			g_assert_cmpuint(type, ==, J_DB_TYPE_UINT64);
+
+			success = j_db_iterator_get_field(iterator, "name", &type, (gpointer*)&name, &len, &error);
+			g_assert_false(success);
+			g_assert_nonnull(error);
+			g_clear_error(&error);
+
+			entries++;
+		}
+
+		g_assert_cmpuint(entries, ==, (i == 0) ? entry_count : limit);
+	}
+
+	{
+		g_autoptr(JDBIterator) iterator = NULL;
+
+		iterator = j_db_iterator_new_with_fields(schema, NULL, fields_invalid, &error);
+		g_assert_null(iterator);
+		g_assert_nonnull(error);
+		g_clear_error(&error);
+	}
+
+	success = j_db_schema_delete(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+}
+
+static void
+test_db_iterator_order_limit(void)
+{
+	g_autoptr(GError) error = NULL;
+
+	gboolean success;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JDBSelector) selector = NULL;
+	g_autoptr(JDBIterator) iterator = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+
+	guint64 const entry_count = 20;
+	guint64 expected = entry_count - 3;
+
+	schema = j_db_schema_new("test", "iterator-order-limit", &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+	success = j_db_schema_add_field(schema, "value", J_DB_TYPE_UINT64, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_create(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	for (guint64 i = 0; i < entry_count; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+		success = j_db_entry_set_field(entry, "value", &i, sizeof(i), &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_entry_insert(entry, batch, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+	}
+
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	// Skip the two largest values and return the next five in descending order
+	selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+	g_assert_nonnull(selector);
+	g_assert_no_error(error);
+	success = j_db_selector_add_order(selector, "value", J_DB_SELECTOR_ORDER_DESCENDING, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_selector_set_limit(selector, 5, 2, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+
+	iterator = j_db_iterator_new(schema, selector, &error);
+	g_assert_nonnull(iterator);
+	g_assert_no_error(error);
+
+	while (j_db_iterator_next(iterator, NULL))
+	{
+		JDBType type;
+		guint64 len;
+		g_autofree guint64* value = NULL;
+
+		success = j_db_iterator_get_field(iterator, "value", &type, (gpointer*)&value, &len, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		g_assert_cmpuint(*value, ==, expected);
+
+		expected--;
+	}
+
+	g_assert_cmpuint(expected, ==, entry_count - 3 - 5);
+
+	success = j_db_schema_delete(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+}
+
+static void
+test_db_iterator_aggregate(void)
+{
+	g_autoptr(GError) error = NULL;
+
+	gboolean success;
+	g_autoptr(JDBSchema) schema = NULL;
+	g_autoptr(JBatch) batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+
+	guint64 const entry_count = 20;
+	guint32 const class_count = 4;
+	guint64 limit = 10;
+	guint32 expected_class = 0;
+
+	schema = j_db_schema_new("test", "iterator-aggregate", &error);
+	g_assert_nonnull(schema);
+	g_assert_no_error(error);
+	success = j_db_schema_add_field(schema, "value", J_DB_TYPE_UINT64, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_add_field(schema, "class", J_DB_TYPE_UINT32, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_db_schema_create(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	for (guint64 i = 0; i < entry_count; i++)
+	{
+		g_autoptr(JDBEntry) entry = NULL;
+		guint32 group = i % class_count;
+
+		entry = j_db_entry_new(schema, &error);
+		g_assert_nonnull(entry);
+		g_assert_no_error(error);
+		success = j_db_entry_set_field(entry, "value", &i, sizeof(i), &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_entry_set_field(entry, "class", &group, sizeof(group), &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_entry_insert(entry, batch, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+	}
+
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+
+	// Count the matching entries without fetching them
+	{
+		g_autoptr(JDBSelector) selector = NULL;
+		g_autoptr(JDBIterator) iterator = NULL;
+		JDBType type;
+		guint64 len;
+		g_autofree guint64* count = NULL;
+
+		selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+		g_assert_nonnull(selector);
+		g_assert_no_error(error);
+		success = j_db_selector_add_field(selector, "value", J_DB_SELECTOR_OPERATOR_GE, &limit, sizeof(limit), &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_selector_add_aggregate(selector, J_DB_AGGREGATE_COUNT, NULL, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+
+		iterator = j_db_iterator_new(schema, selector, &error);
+		g_assert_nonnull(iterator);
+		g_assert_no_error(error);
+
+		success = j_db_iterator_next(iterator, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+
+		success = j_db_iterator_get_aggregate(iterator, 0, &type, (gpointer*)&count, &len, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		g_assert_cmpuint(type, ==, J_DB_TYPE_UINT64);
+		g_assert_cmpuint(*count, ==, entry_count - limit);
+
+		success = j_db_iterator_next(iterator, NULL);
+		g_assert_false(success);
+	}
+
+	// Aggregate each class, the values of class c are c, c + 4, ..., c + 16
+	{
+		g_autoptr(JDBSelector) selector = NULL;
+		g_autoptr(JDBIterator) iterator = NULL;
+
+		selector = j_db_selector_new(schema, J_DB_SELECTOR_MODE_AND, &error);
+		g_assert_nonnull(selector);
+		g_assert_no_error(error);
+		success = j_db_selector_add_group_by(selector, "class", &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_selector_add_order(selector, "class", J_DB_SELECTOR_ORDER_ASCENDING, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_selector_add_aggregate(selector, J_DB_AGGREGATE_COUNT, NULL, &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_selector_add_aggregate(selector, J_DB_AGGREGATE_MIN, "value", &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_selector_add_aggregate(selector, J_DB_AGGREGATE_MAX, "value", &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_selector_add_aggregate(selector, J_DB_AGGREGATE_SUM, "value", &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+		success = j_db_selector_add_aggregate(selector, J_DB_AGGREGATE_AVG, "value", &error);
+		g_assert_true(success);
+		g_assert_no_error(error);
+
+		iterator = j_db_iterator_new(schema, selector, &error);
+		g_assert_nonnull(iterator);
+		g_assert_no_error(error);
+
+		while (j_db_iterator_next(iterator, NULL))
+		{
+			JDBType type;
+			guint64 len;
+			g_autofree guint32* group = NULL;
+			g_autofree guint64* count = NULL;
+			g_autofree guint64* min = NULL;
+			g_autofree guint64* max = NULL;
+			g_autofree guint64* sum = NULL;
+			g_autofree gdouble* avg = NULL;
+
+			success = j_db_iterator_get_field(iterator, "class", &type, (gpointer*)&group, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+			g_assert_cmpuint(*group, ==, expected_class);
+
+			success = j_db_iterator_get_aggregate(iterator, 0, &type, (gpointer*)&count, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+			g_assert_cmpuint(*count, ==, entry_count / class_count);
+
+			success = j_db_iterator_get_aggregate(iterator, 1, &type, (gpointer*)&min, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+			g_assert_cmpuint(type, ==, J_DB_TYPE_UINT64);
+			g_assert_cmpuint(*min, ==, expected_class);
+
+			success = j_db_iterator_get_aggregate(iterator, 2, &type, (gpointer*)&max, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+			g_assert_cmpuint(*max, ==, expected_class + 16);
+
+			success = j_db_iterator_get_aggregate(iterator, 3, &type, (gpointer*)&sum, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+			g_assert_cmpuint(*sum, ==, 5 * expected_class + 40);
+
+			success = j_db_iterator_get_aggregate(iterator, 4, &type, (gpointer*)&avg, &len, &error);
+			g_assert_true(success);
+			g_assert_no_error(error);
+			g_assert_cmpuint(type, ==, J_DB_TYPE_FLOAT64);
+			g_assert_cmpfloat(*avg, ==, expected_class + 8);
+
+			expected_class++;
+		}
+
+		g_assert_cmpuint(expected_class, ==, class_count);
+	}
+
+	success = j_db_schema_delete(schema, batch, &error);
+	g_assert_true(success);
+	g_assert_no_error(error);
+	success = j_batch_execute(batch);
+	g_assert_true(success);
+}
+
 void
 test_db_db(void)
 {
 	// FIXME add more tests
 	g_test_add_func("/db/schema/new_free", test_db_schema_new_free);
 	g_test_add_func("/db/schema/create_delete", test_db_schema_create_delete);
+	g_test_add_func("/db/schema/get_cached", test_db_schema_get_cached);
 	g_test_add_func("/db/entry/new_free", test_db_entry_new_free);
 	g_test_add_func("/db/entry/insert_update_delete", test_db_entry_insert_update_delete);
+	g_test_add_func("/db/entry/update_delete_with_count", test_db_entry_update_delete_with_count);
+	g_test_add_func("/db/entry/insert_many", test_db_entry_insert_many);
+	g_test_add_func("/db/iterator/paged", test_db_iterator_paged);
+	g_test_add_func("/db/iterator/fields", test_db_iterator_fields);
+	g_test_add_func("/db/iterator/order_limit", test_db_iterator_order_limit);
+	g_test_add_func("/db/iterator/aggregate", test_db_iterator_aggregate);
 	g_test_add_func("/db/all", test_db_all);
 }
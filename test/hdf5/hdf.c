@@ -25,6 +25,8 @@
 
 #include <glib.h>
 
+#include <string.h>
+
 #include <julea.h>
 
 #include "test.h"
@@ -34,6 +36,8 @@
 #include <julea-hdf5.h>
 
 #include <hdf5.h>
+#include <H5VLconnector.h>
+#include <H5VLconnector_passthru.h>
 
 static void
 write_dataset(hid_t file)
@@ -145,6 +149,547 @@ test_hdf_read_write(void)
 	H5Fclose(file);
 }
 
+static void
+test_hdf_reopen(void)
+{
+	hid_t dataset;
+	hid_t dataspace_ds;
+	hid_t file;
+	hid_t group;
+
+	hsize_t dims_ds[1];
+
+	int data_ds[8];
+
+	file = H5Fcreate("JULEA.h5", H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+	write_dataset(file);
+
+	dims_ds[0] = 8;
+	dataspace_ds = H5Screate_simple(1, dims_ds, NULL);
+	group = H5Gcreate2(file, "TestGroup", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	dataset = H5Dcreate2(group, "TestGroupDataset", H5T_NATIVE_INT, dataspace_ds, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+	for (guint i = 0; i < 8; i++)
+	{
+		data_ds[i] = i * 2;
+	}
+
+	H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+	H5Dclose(dataset);
+	H5Gclose(group);
+	H5Fclose(file);
+
+	// Opening objects of an existing file uses the file's prefetched metadata
+	file = H5Fopen("JULEA.h5", H5F_ACC_RDWR, H5P_DEFAULT);
+
+	read_dataset(file);
+
+	group = H5Gopen2(file, "TestGroup", H5P_DEFAULT);
+	dataset = H5Dopen2(group, "TestGroupDataset", H5P_DEFAULT);
+
+	memset(data_ds, 0, sizeof(data_ds));
+	H5Dread(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+	for (guint i = 0; i < 8; i++)
+	{
+		g_assert_cmpint(data_ds[i], ==, i * 2);
+	}
+
+	H5Dclose(dataset);
+
+	// Objects created after opening the file have to be found as well
+	dataset = H5Dcreate2(group, "TestGroupDataset2", H5T_NATIVE_INT, dataspace_ds, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+	H5Dclose(dataset);
+
+	dataset = H5Dopen2(group, "TestGroupDataset2", H5P_DEFAULT);
+
+	memset(data_ds, 0, sizeof(data_ds));
+	H5Dread(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+	for (guint i = 0; i < 8; i++)
+	{
+		g_assert_cmpint(data_ds[i], ==, i * 2);
+	}
+
+	H5Sclose(dataspace_ds);
+	H5Dclose(dataset);
+	H5Gclose(group);
+	H5Fclose(file);
+}
+
+static void
+test_hdf_read_write_selection(void)
+{
+	hid_t dataset;
+	hid_t dataspace_ds;
+	hid_t dataspace_mem;
+	hid_t file;
+
+	hsize_t dims_ds[2];
+	hsize_t dims_mem[1];
+	hsize_t start[2];
+	hsize_t count[2];
+
+	int data_ds[6][7];
+	int data_row[7];
+	int data_column[6];
+
+	file = H5Fcreate("JULEA.h5", H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+	dims_ds[0] = 6;
+	dims_ds[1] = 7;
+	dataspace_ds = H5Screate_simple(2, dims_ds, NULL);
+	dataset = H5Dcreate2(file, "TestDatasetSelection", H5T_NATIVE_INT, dataspace_ds, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+	for (guint i = 0; i < 6; i++)
+	{
+		for (guint j = 0; j < 7; j++)
+		{
+			data_ds[i][j] = i * 7 + j;
+		}
+	}
+
+	H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+	// Read a single row
+	dims_mem[0] = 7;
+	start[0] = 4;
+	start[1] = 0;
+	count[0] = 1;
+	count[1] = 7;
+
+	dataspace_mem = H5Screate_simple(1, dims_mem, NULL);
+	H5Sselect_hyperslab(dataspace_ds, H5S_SELECT_SET, start, NULL, count, NULL);
+	memset(data_row, 0, sizeof(data_row));
+	H5Dread(dataset, H5T_NATIVE_INT, dataspace_mem, dataspace_ds, H5P_DEFAULT, data_row);
+	H5Sclose(dataspace_mem);
+
+	for (guint j = 0; j < 7; j++)
+	{
+		g_assert_cmpint(data_row[j], ==, 4 * 7 + j);
+	}
+
+	// Read and overwrite a single column
+	dims_mem[0] = 6;
+	start[0] = 0;
+	start[1] = 2;
+	count[0] = 6;
+	count[1] = 1;
+
+	dataspace_mem = H5Screate_simple(1, dims_mem, NULL);
+	H5Sselect_hyperslab(dataspace_ds, H5S_SELECT_SET, start, NULL, count, NULL);
+	memset(data_column, 0, sizeof(data_column));
+	H5Dread(dataset, H5T_NATIVE_INT, dataspace_mem, dataspace_ds, H5P_DEFAULT, data_column);
+
+	for (guint i = 0; i < 6; i++)
+	{
+		g_assert_cmpint(data_column[i], ==, i * 7 + 2);
+		data_column[i] = -1 - (gint)i;
+	}
+
+	H5Dwrite(dataset, H5T_NATIVE_INT, dataspace_mem, dataspace_ds, H5P_DEFAULT, data_column);
+	H5Sclose(dataspace_mem);
+
+	memset(data_ds, 0, sizeof(data_ds));
+	H5Dread(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+	for (guint i = 0; i < 6; i++)
+	{
+		for (guint j = 0; j < 7; j++)
+		{
+			if (j == 2)
+			{
+				g_assert_cmpint(data_ds[i][j], ==, -1 - (gint)i);
+			}
+			else
+			{
+				g_assert_cmpint(data_ds[i][j], ==, i * 7 + j);
+			}
+		}
+	}
+
+	H5Sclose(dataspace_ds);
+	H5Dclose(dataset);
+
+	H5Fclose(file);
+}
+
+static void
+test_hdf_read_write_chunked(void)
+{
+	hid_t dataset;
+	hid_t dataspace_ds;
+	hid_t dataspace_mem;
+	hid_t dcpl;
+	hid_t file;
+
+	hsize_t chunk_dims[2];
+	hsize_t dims_ds[2];
+	hsize_t dims_mem[2];
+	hsize_t start[2];
+	hsize_t count[2];
+
+	int data_ds[6][7];
+	int data_slab[4][4];
+
+	file = H5Fcreate("JULEA.h5", H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+	dims_ds[0] = 6;
+	dims_ds[1] = 7;
+	// The chunks do not divide the dataset evenly
+	chunk_dims[0] = 4;
+	chunk_dims[1] = 3;
+
+	dataspace_ds = H5Screate_simple(2, dims_ds, NULL);
+	dcpl = H5Pcreate(H5P_DATASET_CREATE);
+	H5Pset_chunk(dcpl, 2, chunk_dims);
+	dataset = H5Dcreate2(file, "TestDatasetChunked", H5T_NATIVE_INT, dataspace_ds, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+
+	for (guint i = 0; i < 6; i++)
+	{
+		for (guint j = 0; j < 7; j++)
+		{
+			data_ds[i][j] = i + j;
+		}
+	}
+
+	H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+	// Overwrite a slab that covers parts of four chunks
+	for (guint i = 0; i < 4; i++)
+	{
+		for (guint j = 0; j < 4; j++)
+		{
+			data_slab[i][j] = -1 - (gint)(i * 4 + j);
+		}
+	}
+
+	dims_mem[0] = 4;
+	dims_mem[1] = 4;
+	start[0] = 1;
+	start[1] = 2;
+	count[0] = 4;
+	count[1] = 4;
+
+	dataspace_mem = H5Screate_simple(2, dims_mem, NULL);
+	H5Sselect_hyperslab(dataspace_ds, H5S_SELECT_SET, start, NULL, count, NULL);
+	H5Dwrite(dataset, H5T_NATIVE_INT, dataspace_mem, dataspace_ds, H5P_DEFAULT, data_slab);
+
+	H5Dclose(dataset);
+
+	dataset = H5Dopen2(file, "TestDatasetChunked", H5P_DEFAULT);
+	H5Dread(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+	for (guint i = 0; i < 6; i++)
+	{
+		for (guint j = 0; j < 7; j++)
+		{
+			if (i >= 1 && i < 5 && j >= 2 && j < 6)
+			{
+				g_assert_cmpint(data_ds[i][j], ==, -1 - (gint)((i - 1) * 4 + (j - 2)));
+			}
+			else
+			{
+				g_assert_cmpint(data_ds[i][j], ==, i + j);
+			}
+		}
+	}
+
+	memset(data_slab, 0, sizeof(data_slab));
+	H5Dread(dataset, H5T_NATIVE_INT, dataspace_mem, dataspace_ds, H5P_DEFAULT, data_slab);
+
+	for (guint i = 0; i < 4; i++)
+	{
+		for (guint j = 0; j < 4; j++)
+		{
+			g_assert_cmpint(data_slab[i][j], ==, -1 - (gint)(i * 4 + j));
+		}
+	}
+
+	H5Sclose(dataspace_mem);
+	H5Sclose(dataspace_ds);
+	H5Pclose(dcpl);
+	H5Dclose(dataset);
+
+	H5Fclose(file);
+}
+
+static void
+test_hdf_read_write_compressed(void)
+{
+	// Filter identifiers registered with The HDF Group for the LZ4 and Zstandard filter plugins
+	H5Z_filter_t const filters[] = { 32004, 32015 };
+
+	hid_t file;
+
+	file = H5Fcreate("JULEA.h5", H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+	for (guint f = 0; f < G_N_ELEMENTS(filters); f++)
+	{
+		hid_t dataset;
+		hid_t dataspace_ds;
+		hid_t dataspace_mem;
+		hid_t dcpl;
+
+		hsize_t chunk_dims[2];
+		hsize_t dims_ds[2];
+		hsize_t dims_mem[2];
+		hsize_t start[2];
+		hsize_t count[2];
+
+		g_autofree gchar* name = NULL;
+		int data_ds[64][64];
+		int data_slab[10][10];
+
+		name = g_strdup_printf("TestDatasetCompressed%u", f);
+
+		dims_ds[0] = 64;
+		dims_ds[1] = 64;
+		chunk_dims[0] = 16;
+		chunk_dims[1] = 16;
+
+		dataspace_ds = H5Screate_simple(2, dims_ds, NULL);
+		dcpl = H5Pcreate(H5P_DATASET_CREATE);
+		H5Pset_chunk(dcpl, 2, chunk_dims);
+		H5Pset_shuffle(dcpl);
+		H5Pset_filter(dcpl, filters[f], H5Z_FLAG_OPTIONAL, 0, NULL);
+		dataset = H5Dcreate2(file, name, H5T_NATIVE_INT, dataspace_ds, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+
+		// Compressible data
+		for (guint i = 0; i < 64; i++)
+		{
+			for (guint j = 0; j < 64; j++)
+			{
+				data_ds[i][j] = i * 64 + j;
+			}
+		}
+
+		H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+		// Incompressible data that partially covers four chunks
+		for (guint i = 0; i < 10; i++)
+		{
+			for (guint j = 0; j < 10; j++)
+			{
+				data_slab[i][j] = g_random_int();
+			}
+		}
+
+		dims_mem[0] = 10;
+		dims_mem[1] = 10;
+		start[0] = 11;
+		start[1] = 11;
+		count[0] = 10;
+		count[1] = 10;
+
+		dataspace_mem = H5Screate_simple(2, dims_mem, NULL);
+		H5Sselect_hyperslab(dataspace_ds, H5S_SELECT_SET, start, NULL, count, NULL);
+		H5Dwrite(dataset, H5T_NATIVE_INT, dataspace_mem, dataspace_ds, H5P_DEFAULT, data_slab);
+
+		H5Dclose(dataset);
+
+		dataset = H5Dopen2(file, name, H5P_DEFAULT);
+		memset(data_ds, 0, sizeof(data_ds));
+		H5Dread(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+
+		for (guint i = 0; i < 64; i++)
+		{
+			for (guint j = 0; j < 64; j++)
+			{
+				if (i >= 11 && i < 21 && j >= 11 && j < 21)
+				{
+					g_assert_cmpint(data_ds[i][j], ==, data_slab[i - 11][j - 11]);
+				}
+				else
+				{
+					g_assert_cmpint(data_ds[i][j], ==, (gint)(i * 64 + j));
+				}
+			}
+		}
+
+		H5Sclose(dataspace_mem);
+		H5Sclose(dataspace_ds);
+		H5Pclose(dcpl);
+		H5Dclose(dataset);
+	}
+
+	H5Fclose(file);
+}
+
+static void
+test_hdf_query_range(void)
+{
+	hid_t dataset;
+	hid_t dataspace_ds;
+	hid_t dataspace_query;
+	hid_t dcpl;
+	hid_t file;
+
+	hsize_t chunk_dims[2];
+	hsize_t dims_ds[2];
+
+	int data_ds[64][64];
+
+	file = H5Fcreate("JULEA.h5", H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+	dims_ds[0] = 64;
+	dims_ds[1] = 64;
+	chunk_dims[0] = 16;
+	chunk_dims[1] = 16;
+
+	dataspace_ds = H5Screate_simple(2, dims_ds, NULL);
+	dcpl = H5Pcreate(H5P_DATASET_CREATE);
+	H5Pset_chunk(dcpl, 2, chunk_dims);
+	dataset = H5Dcreate2(file, "TestDatasetQuery", H5T_NATIVE_INT, dataspace_ds, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+
+	// Only the chunk starting at (16, 32) contains values of at least 1000
+	for (guint i = 0; i < 64; i++)
+	{
+		for (guint j = 0; j < 64; j++)
+		{
+			data_ds[i][j] = (i >= 16 && i < 32 && j >= 32 && j < 48) ? (gint)(1000 + i + j) : (gint)((i + j) % 100);
+		}
+	}
+
+	H5Dwrite(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data_ds);
+	H5Dclose(dataset);
+
+	dataset = H5Dopen2(file, "TestDatasetQuery", H5P_DEFAULT);
+
+	dataspace_query = j_hdf5_dataset_query_range(dataset, 1000.0, 2000.0);
+	g_assert_cmpint(dataspace_query, >=, 0);
+	g_assert_cmpint(H5Sget_select_npoints(dataspace_query), ==, 16 * 16);
+
+	memset(data_ds, 0, sizeof(data_ds));
+	H5Dread(dataset, H5T_NATIVE_INT, dataspace_query, dataspace_query, H5P_DEFAULT, data_ds);
+
+	for (guint i = 0; i < 64; i++)
+	{
+		for (guint j = 0; j < 64; j++)
+		{
+			if (i >= 16 && i < 32 && j >= 32 && j < 48)
+			{
+				g_assert_cmpint(data_ds[i][j], ==, (gint)(1000 + i + j));
+			}
+			else
+			{
+				g_assert_cmpint(data_ds[i][j], ==, 0);
+			}
+		}
+	}
+
+	H5Sclose(dataspace_query);
+
+	dataspace_query = j_hdf5_dataset_query_range(dataset, -10.0, -1.0);
+	g_assert_cmpint(H5Sget_select_npoints(dataspace_query), ==, 0);
+	H5Sclose(dataspace_query);
+
+	dataspace_query = j_hdf5_dataset_query_range(dataset, 0.0, 2000.0);
+	g_assert_cmpint(H5Sget_select_npoints(dataspace_query), ==, 64 * 64);
+	H5Sclose(dataspace_query);
+
+	H5Sclose(dataspace_ds);
+	H5Pclose(dcpl);
+	H5Dclose(dataset);
+	H5Fclose(file);
+}
+
+static void
+test_hdf_read_write_async(void)
+{
+	hid_t connector;
+	hid_t dataset[4];
+	hid_t dataspace;
+	hid_t file;
+
+	hsize_t dims[1];
+
+	void* req[4];
+	int data[4][1024];
+
+	file = H5Fcreate("JULEA.h5", H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+	connector = H5VLget_connector_id(file);
+
+	dims[0] = 1024;
+	dataspace = H5Screate_simple(1, dims, NULL);
+
+	for (guint i = 0; i < 4; i++)
+	{
+		g_autofree gchar* name = NULL;
+
+		name = g_strdup_printf("TestDatasetAsync%u", i);
+		dataset[i] = H5Dcreate2(file, name, H5T_NATIVE_INT, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+		for (guint j = 0; j < 1024; j++)
+		{
+			data[i][j] = i * 1024 + j;
+		}
+	}
+
+	// Start all writes before waiting for any of them
+	for (guint i = 0; i < 4; i++)
+	{
+		req[i] = NULL;
+		g_assert_cmpint(H5VLdataset_write(H5VLobject(dataset[i]), connector, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data[i], &req[i]), >=, 0);
+	}
+
+	for (guint i = 0; i < 4; i++)
+	{
+#if H5_VERSION_GE(1, 12, 1)
+		H5VL_request_status_t status;
+#else
+		H5ES_status_t status;
+#endif
+
+		g_assert_nonnull(req[i]);
+		g_assert_cmpint(H5VLrequest_wait(req[i], connector, G_MAXUINT64, &status), >=, 0);
+#if H5_VERSION_GE(1, 12, 1)
+		g_assert_cmpint(status, ==, H5VL_REQUEST_STATUS_SUCCEED);
+#else
+		g_assert_cmpint(status, ==, H5ES_STATUS_SUCCEED);
+#endif
+		H5VLrequest_free(req[i], connector);
+	}
+
+	memset(data, 0, sizeof(data));
+
+	for (guint i = 0; i < 4; i++)
+	{
+		req[i] = NULL;
+		g_assert_cmpint(H5VLdataset_read(H5VLobject(dataset[i]), connector, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data[i], &req[i]), >=, 0);
+	}
+
+	for (guint i = 0; i < 4; i++)
+	{
+#if H5_VERSION_GE(1, 12, 1)
+		H5VL_request_status_t status;
+#else
+		H5ES_status_t status;
+#endif
+
+		g_assert_nonnull(req[i]);
+		g_assert_cmpint(H5VLrequest_wait(req[i], connector, G_MAXUINT64, &status), >=, 0);
+		H5VLrequest_free(req[i], connector);
+
+		for (guint j = 0; j < 1024; j++)
+		{
+			g_assert_cmpint(data[i][j], ==, (gint)(i * 1024 + j));
+		}
+	}
+
+	for (guint i = 0; i < 4; i++)
+	{
+		H5Dclose(dataset[i]);
+	}
+
+	H5Sclose(dataspace);
+	H5VLclose(connector);
+	H5Fclose(file);
+}
+
 #endif
 
 void
@@ -158,5 +703,16 @@ test_hdf_hdf(void)
 	}
 
 	g_test_add_func("/hdf5/read_write", test_hdf_read_write);
+	g_test_add_func("/hdf5/read_write_selection", test_hdf_read_write_selection);
+	g_test_add_func("/hdf5/reopen", test_hdf_reopen);
+	g_test_add_func("/hdf5/read_write_async", test_hdf_read_write_async);
+
+	// Only the DB connector supports chunked datasets and selections
+	if (g_str_has_prefix(g_getenv("HDF5_VOL_CONNECTOR"), "julea-db"))
+	{
+		g_test_add_func("/hdf5/read_write_chunked", test_hdf_read_write_chunked);
+		g_test_add_func("/hdf5/read_write_compressed", test_hdf_read_write_compressed);
+		g_test_add_func("/hdf5/query_range", test_hdf_query_range);
+	}
 #endif
 }
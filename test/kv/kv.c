@@ -213,6 +213,240 @@ test_kv_get_callback(void)
 	g_assert_cmpuint(num_callbacks, ==, 1);
 }
 
+static void
+test_kv_put_get_large(void)
+{
+	guint32 const len = 4 * 1024 * 1024;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JKV) kv1 = NULL;
+	g_autoptr(JKV) kv2 = NULL;
+	g_autofree gchar* get_value1 = NULL;
+	g_autofree gchar* get_value2 = NULL;
+	g_autofree gchar* value = NULL;
+	guint32 get_len1;
+	guint32 get_len2;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	value = g_malloc(len);
+
+	for (guint32 i = 0; i < len; i++)
+	{
+		value[i] = i % 251;
+	}
+
+	kv1 = j_kv_new("test", "test-kv-put-get-large-1");
+	g_assert_nonnull(kv1);
+	kv2 = j_kv_new("test", "test-kv-put-get-large-2");
+	g_assert_nonnull(kv2);
+
+	j_kv_put(kv1, value, len, NULL, batch);
+	j_kv_put(kv2, value, len, NULL, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	j_kv_get(kv1, (gpointer)&get_value1, &get_len1, batch);
+	j_kv_get(kv2, (gpointer)&get_value2, &get_len2, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	g_assert_cmpuint(get_len1, ==, len);
+	g_assert_cmpmem(get_value1, get_len1, value, len);
+	g_assert_cmpuint(get_len2, ==, len);
+	g_assert_cmpmem(get_value2, get_len2, value, len);
+
+	j_kv_delete(kv1, batch);
+	j_kv_delete(kv2, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+test_kv_get_range(void)
+{
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JKV) kv = NULL;
+	g_autofree gchar* value = NULL;
+	gchar buffer[16];
+	guint64 bytes_read;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	value = g_strdup("0123456789");
+
+	kv = j_kv_new("test", "test-kv-get-range");
+	g_assert_nonnull(kv);
+
+	bytes_read = 0;
+	j_kv_get_range(kv, buffer, 0, sizeof(buffer), &bytes_read, batch);
+	ret = j_batch_execute(batch);
+	g_assert_false(ret);
+	g_assert_cmpuint(bytes_read, ==, 0);
+
+	j_kv_put(kv, value, strlen(value), NULL, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	bytes_read = 0;
+	j_kv_get_range(kv, buffer, 2, 4, &bytes_read, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(bytes_read, ==, 4);
+	g_assert_cmpmem(buffer, bytes_read, "2345", 4);
+
+	// Reads beyond the end of the value are truncated
+	bytes_read = 0;
+	j_kv_get_range(kv, buffer, 8, sizeof(buffer), &bytes_read, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(bytes_read, ==, 2);
+	g_assert_cmpmem(buffer, bytes_read, "89", 2);
+
+	bytes_read = 0;
+	j_kv_get_range(kv, buffer, 42, sizeof(buffer), &bytes_read, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(bytes_read, ==, 0);
+
+	j_kv_delete(kv, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+test_kv_put_if_absent(void)
+{
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JKV) kv = NULL;
+	g_autofree gchar* get_value = NULL;
+	g_autofree gchar* value1 = NULL;
+	g_autofree gchar* value2 = NULL;
+	guint32 get_len;
+	gboolean inserted1 = FALSE;
+	gboolean inserted2 = TRUE;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	value1 = g_strdup("first-value");
+	value2 = g_strdup("second-value");
+
+	kv = j_kv_new("test", "test-kv-put-if-absent");
+	g_assert_nonnull(kv);
+
+	j_kv_put_if_absent(kv, value1, strlen(value1) + 1, NULL, &inserted1, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_true(inserted1);
+
+	j_kv_put_if_absent(kv, value2, strlen(value2) + 1, NULL, &inserted2, batch);
+	j_kv_get(kv, (gpointer)&get_value, &get_len, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_false(inserted2);
+
+	g_assert_cmpstr(get_value, ==, value1);
+	g_assert_cmpuint(get_len, ==, strlen(value1) + 1);
+
+	j_kv_delete(kv, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+test_kv_compare_and_swap(void)
+{
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JKV) kv = NULL;
+	g_autofree gchar* get_value = NULL;
+	g_autofree gchar* value1 = NULL;
+	g_autofree gchar* value2 = NULL;
+	g_autofree gchar* value3 = NULL;
+	guint32 get_len;
+	gboolean swapped1 = TRUE;
+	gboolean swapped2 = FALSE;
+	gboolean swapped3 = TRUE;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	value1 = g_strdup("first-value");
+	value2 = g_strdup("second-value");
+	value3 = g_strdup("third-value");
+
+	kv = j_kv_new("test", "test-kv-compare-and-swap");
+	g_assert_nonnull(kv);
+
+	// Swapping a missing key fails
+	j_kv_compare_and_swap(kv, value1, strlen(value1) + 1, value2, strlen(value2) + 1, NULL, &swapped1, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_false(swapped1);
+
+	j_kv_put(kv, value1, strlen(value1) + 1, NULL, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	j_kv_compare_and_swap(kv, value1, strlen(value1) + 1, value2, strlen(value2) + 1, NULL, &swapped2, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_true(swapped2);
+
+	// The value has changed, so the expected value does not match anymore
+	j_kv_compare_and_swap(kv, value1, strlen(value1) + 1, value3, strlen(value3) + 1, NULL, &swapped3, batch);
+	j_kv_get(kv, (gpointer)&get_value, &get_len, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_false(swapped3);
+
+	g_assert_cmpstr(get_value, ==, value2);
+	g_assert_cmpuint(get_len, ==, strlen(value2) + 1);
+
+	j_kv_delete(kv, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
+static void
+test_kv_fetch_add(void)
+{
+	guint const n = 100;
+
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JKV) kv = NULL;
+	g_autofree gint64* previous = NULL;
+	gint64 last = -1;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	previous = g_new0(gint64, n);
+
+	kv = j_kv_new("test", "test-kv-fetch-add");
+	g_assert_nonnull(kv);
+
+	for (guint i = 0; i < n; i++)
+	{
+		j_kv_fetch_add(kv, 2, &(previous[i]), batch);
+	}
+
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+
+	// A missing counter starts at 0
+	for (guint i = 0; i < n; i++)
+	{
+		g_assert_cmpint(previous[i], ==, 2 * i);
+	}
+
+	j_kv_fetch_add(kv, -2 * (gint64)n, &last, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpint(last, ==, 2 * n);
+
+	j_kv_delete(kv, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
 void
 test_kv_kv(void)
 {
@@ -222,4 +456,9 @@ test_kv_kv(void)
 	g_test_add_func("/kv/kv/put_update", test_kv_put_update);
 	g_test_add_func("/kv/kv/get", test_kv_get);
 	g_test_add_func("/kv/kv/get_callback", test_kv_get_callback);
+	g_test_add_func("/kv/kv/put_get_large", test_kv_put_get_large);
+	g_test_add_func("/kv/kv/get_range", test_kv_get_range);
+	g_test_add_func("/kv/kv/put_if_absent", test_kv_put_if_absent);
+	g_test_add_func("/kv/kv/compare_and_swap", test_kv_compare_and_swap);
+	g_test_add_func("/kv/kv/fetch_add", test_kv_fetch_add);
 }
@@ -168,6 +168,80 @@ test_object_read_write(void)
 	g_assert_true(ret);
 }
 
+static void
+test_object_read_write_strided(void)
+{
+	g_autoptr(JBatch) batch = NULL;
+	g_autoptr(JDistribution) distribution = NULL;
+	g_autoptr(JDistributedObject) object = NULL;
+	g_autofree gchar* buffer = NULL;
+	g_autofree gchar* buffer2 = NULL;
+	guint64 count[2] = { 16, 4 };
+	guint64 stride[2] = { 256, 16 };
+	guint64 nbytes = 0;
+	gboolean ret;
+
+	batch = j_batch_new_for_template(J_SEMANTICS_TEMPLATE_DEFAULT);
+	buffer = g_malloc0(4096);
+	buffer2 = g_malloc0(4096);
+
+	for (guint i = 0; i < 4096; i++)
+	{
+		buffer[i] = i % 251;
+	}
+
+	// Use a small block size to spread the selection across all servers
+	distribution = j_distribution_new(J_DISTRIBUTION_ROUND_ROBIN);
+	j_distribution_set_block_size(distribution, 100);
+	object = j_distributed_object_new("test", "test-distributed-object-rw-strided", distribution);
+	g_assert_true(object != NULL);
+
+	j_distributed_object_create(object, batch);
+	j_distributed_object_write(object, buffer, 4096, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, 4096);
+
+	// Read 4 columns of 8 bytes each from 16 rows of 256 bytes
+	j_distributed_object_read_strided(object, buffer2, 8, 3, 2, count, stride, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, 16 * 4 * 8);
+
+	for (guint i = 0; i < 16; i++)
+	{
+		for (guint j = 0; j < 4; j++)
+		{
+			g_assert_cmpmem(buffer2 + (i * 4 + j) * 8, 8, buffer + 3 + i * 256 + j * 16, 8);
+		}
+	}
+
+	memset(buffer2, 'j', 16 * 4 * 8);
+
+	j_distributed_object_write_strided(object, buffer2, 8, 3, 2, count, stride, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, 16 * 4 * 8);
+
+	for (guint i = 0; i < 16; i++)
+	{
+		for (guint j = 0; j < 4; j++)
+		{
+			memset(buffer + 3 + i * 256 + j * 16, 'j', 8);
+		}
+	}
+
+	j_distributed_object_read(object, buffer2, 4096, 0, &nbytes, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+	g_assert_cmpuint(nbytes, ==, 4096);
+	g_assert_cmpmem(buffer2, 4096, buffer, 4096);
+
+	j_distributed_object_delete(object, batch);
+	ret = j_batch_execute(batch);
+	g_assert_true(ret);
+}
+
 static void
 test_object_status(void)
 {
@@ -248,6 +322,7 @@ test_object_distributed_object(void)
 	g_test_add_func("/object/distributed-object/new_free", test_object_new_free);
 	g_test_add_func("/object/distributed-object/create_delete", test_object_create_delete);
 	g_test_add_func("/object/distributed-object/read_write", test_object_read_write);
+	g_test_add_func("/object/distributed-object/read_write_strided", test_object_read_write_strided);
 	g_test_add_func("/object/distributed-object/status", test_object_status);
 	g_test_add_func("/object/distributed-object/sync", test_object_sync);
 }
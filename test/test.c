@@ -38,6 +38,7 @@ main(int argc, char** argv)
 
 	// Core
 	test_core_background_operation();
+	test_core_backend_row();
 	test_core_batch();
 	test_core_cache();
 	test_core_configuration();
@@ -20,6 +20,7 @@
 #define JULEA_TEST_T
 
 void test_core_background_operation(void);
+void test_core_backend_row(void);
 void test_core_batch(void);
 void test_core_cache(void);
 void test_core_configuration(void);
@@ -0,0 +1,306 @@
+/*
+ * JULEA - Flexible storage framework
+ * Copyright (C) 2021 Michael Kuhn
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <julea-config.h>
+
+#include <glib.h>
+
+#include <locale.h>
+#include <string.h>
+
+#include <hdf5/jhdf5-log.h>
+
+static gchar const* opt_format = "text";
+static gchar** opt_files = NULL;
+
+struct JHDF5LogEntry
+{
+	JHDF5LogRecord record;
+	gchar const* name;
+	guint index;
+};
+
+typedef struct JHDF5LogEntry JHDF5LogEntry;
+
+static gint
+entry_compare(gconstpointer a, gconstpointer b)
+{
+	JHDF5LogEntry const* entry_a = a;
+	JHDF5LogEntry const* entry_b = b;
+
+	if (entry_a->record.timestamp != entry_b->record.timestamp)
+	{
+		return (entry_a->record.timestamp < entry_b->record.timestamp) ? -1 : 1;
+	}
+
+	// Keep the order of records with the same timestamp
+	return (entry_a->index < entry_b->index) ? -1 : (entry_a->index > entry_b->index);
+}
+
+static gchar*
+object_key(gchar type, guint64 id)
+{
+	return g_strdup_printf("%c%" G_GUINT64_FORMAT, type, id);
+}
+
+/**
+ * Returns the name of an object, names are known from the object's create or open records.
+ **/
+static gchar const*
+object_name(GHashTable* names, gchar type, guint64 id)
+{
+	g_autofree gchar* key = NULL;
+	gchar const* name;
+
+	key = object_key(type, id);
+
+	if ((name = g_hash_table_lookup(names, key)) == NULL)
+	{
+		name = "?";
+	}
+
+	return name;
+}
+
+/**
+ * Reads the records of a log, names are stored in contents and names.
+ **/
+static gboolean
+read_log(gchar const* path, GArray* entries, GHashTable* names, GPtrArray* contents)
+{
+	g_autoptr(GError) error = NULL;
+	JHDF5LogHeader header;
+	gchar* data;
+	gsize length;
+	gsize position;
+
+	if (!g_file_get_contents(path, &data, &length, &error))
+	{
+		g_printerr("%s\n", error->message);
+		return FALSE;
+	}
+
+	g_ptr_array_add(contents, data);
+
+	if (length < sizeof(header))
+	{
+		g_printerr("%s is not a JULEA HDF5 log.\n", path);
+		return FALSE;
+	}
+
+	memcpy(&header, data, sizeof(header));
+
+	if (memcmp(header.magic, J_HDF5_LOG_MAGIC, sizeof(header.magic)) != 0 || header.version != J_HDF5_LOG_VERSION)
+	{
+		g_printerr("%s is not a JULEA HDF5 log or has an unsupported version.\n", path);
+		return FALSE;
+	}
+
+	position = sizeof(header);
+
+	while (position + sizeof(JHDF5LogRecord) <= length)
+	{
+		JHDF5LogEntry entry;
+
+		memcpy(&entry.record, data + position, sizeof(entry.record));
+		position += sizeof(entry.record);
+
+		if (position + entry.record.name_length > length)
+		{
+			break;
+		}
+
+		// Make timestamps comparable across processes
+		entry.record.timestamp += header.start_time;
+		entry.name = NULL;
+		entry.index = entries->len;
+
+		if (entry.record.name_length > 0)
+		{
+			gchar* name;
+
+			name = g_strndup(data + position, entry.record.name_length);
+			g_ptr_array_add(contents, name);
+
+			entry.name = name;
+			g_hash_table_insert(names, object_key(entry.record.object_type, entry.record.backend_id), name);
+		}
+
+		position += entry.record.name_length;
+
+		g_array_append_val(entries, entry);
+	}
+
+	if (position != length)
+	{
+		g_printerr("%s is truncated.\n", path);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Prints one line per record, times are given in seconds since the first record.
+ **/
+static void
+print_text(GArray* entries, GHashTable* names)
+{
+	gint64 start_time = 0;
+
+	if (entries->len > 0)
+	{
+		start_time = g_array_index(entries, JHDF5LogEntry, 0).record.timestamp;
+	}
+
+	for (guint i = 0; i < entries->len; i++)
+	{
+		JHDF5LogEntry* entry = &g_array_index(entries, JHDF5LogEntry, i);
+		JHDF5LogRecord* record = &entry->record;
+		gint64 timestamp;
+
+		timestamp = record->timestamp - start_time;
+
+		g_print("%" G_GINT64_FORMAT ".%06" G_GINT64_FORMAT "\t[%c]\t", timestamp / G_USEC_PER_SEC, timestamp % G_USEC_PER_SEC, record->operation);
+
+		if (record->parent_id != 0)
+		{
+			g_print("[%c - %s(%" G_GUINT64_FORMAT ") -> ", record->object_type, object_name(names, record->parent_type, record->parent_id), record->parent_id);
+			g_print("%s(%" G_GUINT64_FORMAT ")]", object_name(names, record->object_type, record->backend_id), record->backend_id);
+		}
+		else
+		{
+			g_print("[%c - %s(%" G_GUINT64_FORMAT ")]", record->object_type, object_name(names, record->object_type, record->backend_id), record->backend_id);
+		}
+
+		if (record->operation == 'R' || record->operation == 'W')
+		{
+			g_print("\t%" G_GUINT64_FORMAT, record->bytes);
+		}
+
+		g_print("\n");
+	}
+}
+
+/**
+ * Prints the created objects as a graph, objects that have been written to are filled.
+ **/
+static void
+print_dot(GArray* entries, GHashTable* names)
+{
+	g_print("digraph g {\n");
+
+	for (guint i = 0; i < entries->len; i++)
+	{
+		JHDF5LogEntry* entry = &g_array_index(entries, JHDF5LogEntry, i);
+		JHDF5LogRecord* record = &entry->record;
+		gchar const* name;
+
+		name = object_name(names, record->object_type, record->backend_id);
+
+		switch (record->operation)
+		{
+			case 'C':
+				if (record->object_type == 'F')
+				{
+					g_print("\"%c%" G_GUINT64_FORMAT "\" [label=\"%s\"];\n", record->object_type, record->backend_id, name);
+				}
+				else if (record->parent_id != 0)
+				{
+					g_print("\"%c%" G_GUINT64_FORMAT "\" [label=\"%s\"%s];\n", record->object_type, record->backend_id, name, (record->object_type == 'D') ? ", shape=box" : "");
+					g_print("\"%c%" G_GUINT64_FORMAT "\" -> \"%c%" G_GUINT64_FORMAT "\"%s;\n", record->parent_type, record->parent_id, record->object_type, record->backend_id, (record->object_type == 'A') ? " [style=dotted]" : "");
+				}
+				break;
+			case 'W':
+				g_print("\"%c%" G_GUINT64_FORMAT "\" [style=filled];\n", record->object_type, record->backend_id);
+				break;
+			default:
+				break;
+		}
+	}
+
+	g_print("}\n");
+}
+
+int
+main(int argc, char** argv)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GOptionContext) context = NULL;
+	g_autoptr(GArray) entries = NULL;
+	g_autoptr(GHashTable) names = NULL;
+	g_autoptr(GPtrArray) contents = NULL;
+
+	GOptionEntry entries_option[] = {
+		{ "format", 0, 0, G_OPTION_ARG_STRING, &opt_format, "Output format", "text|dot" },
+		{ G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &opt_files, "Logs to convert", NULL },
+		{ NULL, 0, 0, 0, NULL, NULL, NULL }
+	};
+
+	// Explicitly enable UTF-8 since object names might contain UTF-8 characters.
+	setlocale(LC_ALL, "C.UTF-8");
+
+	context = g_option_context_new("LOG…");
+	g_option_context_set_summary(context, "Converts binary logs written by the julea-db HDF5 VOL plugin.");
+	g_option_context_add_main_entries(context, entries_option, NULL);
+
+	if (!g_option_context_parse(context, &argc, &argv, &error))
+	{
+		g_printerr("%s\n", error->message);
+
+		return 1;
+	}
+
+	if (opt_files == NULL || (g_strcmp0(opt_format, "text") != 0 && g_strcmp0(opt_format, "dot") != 0))
+	{
+		g_autofree gchar* help = NULL;
+
+		help = g_option_context_get_help(context, TRUE, NULL);
+
+		g_print("%s", help);
+
+		return 1;
+	}
+
+	entries = g_array_new(FALSE, FALSE, sizeof(JHDF5LogEntry));
+	names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	contents = g_ptr_array_new_with_free_func(g_free);
+
+	for (guint i = 0; opt_files[i] != NULL; i++)
+	{
+		if (!read_log(opt_files[i], entries, names, contents))
+		{
+			return 1;
+		}
+	}
+
+	// Records are written per thread and therefore have to be sorted
+	g_array_sort(entries, entry_compare);
+
+	if (g_strcmp0(opt_format, "dot") == 0)
+	{
+		print_dot(entries, names);
+	}
+	else
+	{
+		print_text(entries, names);
+	}
+
+	g_strfreev(opt_files);
+
+	return 0;
+}